@@ -182,6 +182,7 @@ public:
     void setTimeTag (OscTimeTag newTimeTag) {timeTag = newTimeTag;}
 
 protected:
+    friend class OscReceiver;
     virtual OscError decode (const char* source, size_t sizeInBytes) = 0;
     OscTimeTag timeTag;
 private:
@@ -0,0 +1,57 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "OscReceiver.h"
+
+OscReceiver::OscReceiver() : receiveSocket (false), receiveBuffer (65507)
+{
+
+}
+
+OscReceiver::~OscReceiver()
+{
+
+}
+
+bool OscReceiver::connect (int receivePort)
+{
+    return receiveSocket.bindToPort (receivePort);
+}
+
+bool OscReceiver::receive (OscMessage& message, int timeoutMsecs)
+{
+    if (receiveSocket.getBoundPort() < 0)
+        return false;
+    
+    if (receiveSocket.waitUntilReady (true, timeoutMsecs) != 1)
+        return false;
+    
+    int bytesRead = receiveSocket.read (receiveBuffer.data(), static_cast<int> (receiveBuffer.size()), false);
+    
+    if (bytesRead <= 0 || ! OscContent::encodedContentIsMessage (receiveBuffer.data()))
+        return false;
+    
+    OscMessage decoded;
+    OscContent& content = decoded;
+    if (content.decode (receiveBuffer.data(), static_cast<size_t> (bytesRead)) != OscErrorNone)
+        return false;
+    
+    message = decoded;
+    return true;
+}
+
+int OscReceiver::getReceivePort() const
+{
+    return receiveSocket.getBoundPort();
+}
@@ -0,0 +1,47 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+
+#include "../Osc/OscMessage.h"
+#include "UdpSocket.h"
+
+class OscReceiver
+{
+public:
+    
+    /** Constructor */
+    OscReceiver();
+    
+    /** Destructor */
+    ~OscReceiver();
+    
+    /** Binds the receive socket to the specified port number, returns true on success */
+    bool connect (int receivePort);
+    
+    /** Waits up to timeoutMsecs for a message and decodes it into message.
+        A timeout of 0 polls without blocking. Returns false if no valid
+        message arrived within the timeout. Bundles and packets that fail to
+        decode, e.g. truncated ones, are dropped. */
+    bool receive (OscMessage& message, int timeoutMsecs);
+    
+    /** gets the current receive port number, or -1 if not connected */
+    int getReceivePort() const;
+    
+private:
+    UdpSocket receiveSocket;
+    std::vector<char> receiveBuffer;
+};
@@ -0,0 +1,77 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "OscReceiver.h"
+
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace {
+
+// Sends the first numBytes of the encoded message to port on this host.
+void SendEncoded (const OscMessage& message, size_t numBytes, int port)
+{
+    std::vector<char> encoded (message.getEncodedSize());
+    ASSERT_EQ (encoded.size(), message.encode (encoded.data(), encoded.size()));
+    ASSERT_LE (numBytes, encoded.size());
+    UdpSocket socket;
+    ASSERT_EQ (static_cast<int> (numBytes),
+               socket.write ("127.0.0.1", port, encoded.data(), static_cast<int> (numBytes)));
+}
+
+// Connects the receiver to the first free port from a fixed test range.
+bool ConnectToFreePort (OscReceiver& receiver)
+{
+    for (int port = 45000; port < 45100; ++port)
+        if (receiver.connect (port))
+            return true;
+    return false;
+}
+
+TEST (OscReceiverTest, ReceivesMessage)
+{
+    OscReceiver receiver;
+    ASSERT_TRUE (ConnectToFreePort (receiver));
+    OscMessage sent ("/mediapipe/graph/load");
+    sent.addString ("graph.pbtxt");
+    SendEncoded (sent, sent.getEncodedSize(), receiver.getReceivePort());
+
+    OscMessage received;
+    ASSERT_TRUE (receiver.receive (received, 1000));
+    EXPECT_TRUE (received == sent);
+}
+
+TEST (OscReceiverTest, DropsTruncatedPacket)
+{
+    OscReceiver receiver;
+    ASSERT_TRUE (ConnectToFreePort (receiver));
+    OscMessage sent ("/mediapipe/graph/load");
+    sent.addString ("graph.pbtxt");
+    // Cuts the string argument, keeping its type tag, at and off a word
+    // boundary.
+    SendEncoded (sent, sent.getEncodedSize() - 4, receiver.getReceivePort());
+    SendEncoded (sent, sent.getEncodedSize() - 3, receiver.getReceivePort());
+    OscMessage next ("/mediapipe/graph/reload");
+    SendEncoded (next, next.getEncodedSize(), receiver.getReceivePort());
+
+    OscMessage received;
+    EXPECT_FALSE (receiver.receive (received, 1000));
+    EXPECT_FALSE (receiver.receive (received, 1000));
+    EXPECT_TRUE (received.isEmpty());
+    ASSERT_TRUE (receiver.receive (received, 1000));
+    EXPECT_TRUE (received == next);
+}
+
+}  // namespace
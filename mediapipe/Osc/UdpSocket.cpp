@@ -211,7 +211,7 @@ namespace SocketHelpers
                 // avoid race-condition
                 std::unique_lock<std::mutex> lock (readLock, std::try_to_lock);
                 
-                if(!lock.owns_lock())
+                if (lock.owns_lock())
                 {
                     if (senderIP == nullptr || senderPort == nullptr)
                     {
@@ -15,6 +15,7 @@
 #include "mediapipe/calculators/image/image_transformation_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
@@ -211,6 +212,7 @@ absl::Status ImageTransformationCalculator::GetContract(
     RET_CHECK(cc->Outputs().HasTag(kImageFrameTag));
     cc->Inputs().Tag(kImageFrameTag).Set<ImageFrame>();
     cc->Outputs().Tag(kImageFrameTag).Set<ImageFrame>();
+    cc->UseService(kImageFrameMultiPoolService);
   }
 #if !MEDIAPIPE_DISABLE_GPU
   if (cc->Inputs().HasTag(kGpuBufferTag)) {
@@ -460,19 +462,16 @@ absl::Status ImageTransformationCalculator::RenderCpu(CalculatorContext* cc) {
     }
   }
 
-  cv::Mat flipped_mat;
+  std::unique_ptr<ImageFrame> output_frame =
+      GetImageFrameMultiPool(cc).GetFrame(format, output_width, output_height);
+  cv::Mat output_mat = formats::MatView(output_frame.get());
   if (flip_horizontally_ || flip_vertically_) {
     const int flip_code =
         flip_horizontally_ && flip_vertically_ ? -1 : flip_horizontally_;
-    cv::flip(rotated_mat, flipped_mat, flip_code);
+    cv::flip(rotated_mat, output_mat, flip_code);
   } else {
-    flipped_mat = rotated_mat;
+    rotated_mat.copyTo(output_mat);
   }
-
-  std::unique_ptr<ImageFrame> output_frame(
-      new ImageFrame(format, output_width, output_height));
-  cv::Mat output_mat = formats::MatView(output_frame.get());
-  flipped_mat.copyTo(output_mat);
   cc->Outputs()
       .Tag(kImageFrameTag)
       .Add(output_frame.release(), cc->InputTimestamp());
@@ -0,0 +1,206 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr char kIterableTag[] = "ITERABLE";
+constexpr char kItemTag[] = "ITEM";
+constexpr char kTensorsTag[] = "TENSORS";
+constexpr char kLetterboxPaddingsTag[] = "LETTERBOX_PADDINGS";
+constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
+constexpr char kBatchEndTag[] = "BATCH_END";
+constexpr char kCloneTag[] = "CLONE";
+
+// Returns element |index| of |tensor|, whose first dimension is the batch
+// size, as a tensor with batch size 1 and the same quantization.
+Tensor SliceBatch(const Tensor& tensor, int index) {
+  std::vector<int> dims = tensor.shape().dims;
+  const int batch_size = dims[0];
+  dims[0] = 1;
+  Tensor result(tensor.element_type(), Tensor::Shape{dims},
+                tensor.quantization_parameters());
+  const int bytes = tensor.bytes() / batch_size;
+  auto read_view = tensor.GetCpuReadView();
+  auto write_view = result.GetCpuWriteView();
+  std::memcpy(write_view.buffer<char>(),
+              read_view.buffer<char>() + index * bytes, bytes);
+  return result;
+}
+
+}  // namespace
+
+// Begins a loop over the regions of interest of a batched inference, such as
+// the hands cropped by ImageToTensorCalculator with NORM_RECTS and run through
+// a single InferenceCalculator invocation. Works like
+// BeginLoopNormalizedRectCalculator, and additionally splits the batched
+// tensors and letterbox paddings, so that the per-ROI post-processing of the
+// single-ROI graphs can be reused inside the loop.
+//
+// Inputs:
+//   ITERABLE - std::vector<NormalizedRect>
+//     The regions of interest, in batch order.
+//   TENSORS - std::vector<Tensor>
+//     Tensors whose first dimension is the number of regions of interest.
+//     Missing if there are no regions of interest.
+//   LETTERBOX_PADDINGS - std::vector<std::array<float, 4>> @Optional
+//     The letterbox padding of each region of interest.
+//   CLONE - any type @Optional
+//     Packets cloned to each loop iteration, as in BeginLoopCalculator.
+//
+// Outputs (one packet per region of interest, at loop timestamps):
+//   ITEM - NormalizedRect
+//   TENSORS - std::vector<Tensor> with batch size 1.
+//   LETTERBOX_PADDING - std::array<float, 4> @Optional
+//   CLONE - any type @Optional
+//   BATCH_END - Timestamp
+//     The input timestamp, for the companion EndLoopCalculators.
+//
+// Example:
+// node {
+//   calculator: "BeginLoopTensorBatchCalculator"
+//   input_stream: "ITERABLE:hand_rects"
+//   input_stream: "TENSORS:batched_output_tensors"
+//   input_stream: "LETTERBOX_PADDINGS:letterbox_paddings"
+//   input_stream: "CLONE:image_size"
+//   output_stream: "ITEM:single_hand_rect"
+//   output_stream: "TENSORS:single_hand_tensors"
+//   output_stream: "LETTERBOX_PADDING:single_letterbox_padding"
+//   output_stream: "CLONE:image_size_for_landmarks"
+//   output_stream: "BATCH_END:hand_rects_timestamp"
+// }
+class BeginLoopTensorBatchCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    // Processes timestamp bound updates like BeginLoopCalculator, so that the
+    // companion EndLoopCalculators propagate the timestamp bound.
+    cc->SetProcessTimestampBounds(true);
+
+    cc->Inputs().Tag(kIterableTag).Set<std::vector<NormalizedRect>>();
+    cc->Inputs().Tag(kTensorsTag).Set<std::vector<Tensor>>();
+    cc->Outputs().Tag(kItemTag).Set<NormalizedRect>();
+    cc->Outputs().Tag(kTensorsTag).Set<std::vector<Tensor>>();
+    cc->Outputs().Tag(kBatchEndTag).Set<Timestamp>();
+
+    RET_CHECK_EQ(cc->Inputs().HasTag(kLetterboxPaddingsTag),
+                 cc->Outputs().HasTag(kLetterboxPaddingTag));
+    if (cc->Inputs().HasTag(kLetterboxPaddingsTag)) {
+      cc->Inputs()
+          .Tag(kLetterboxPaddingsTag)
+          .Set<std::vector<std::array<float, 4>>>();
+      cc->Outputs().Tag(kLetterboxPaddingTag).Set<std::array<float, 4>>();
+    }
+
+    RET_CHECK_EQ(cc->Inputs().NumEntries(kCloneTag),
+                 cc->Outputs().NumEntries(kCloneTag));
+    for (int i = 0; i < cc->Inputs().NumEntries(kCloneTag); ++i) {
+      cc->Inputs().Get(kCloneTag, i).SetAny();
+      cc->Outputs()
+          .Get(kCloneTag, i)
+          .SetSameAs(&cc->Inputs().Get(kCloneTag, i));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    Timestamp last_timestamp = loop_internal_timestamp_;
+    const auto& iterable = cc->Inputs().Tag(kIterableTag);
+    if (!iterable.IsEmpty() &&
+        !iterable.Get<std::vector<NormalizedRect>>().empty()) {
+      const auto& rects = iterable.Get<std::vector<NormalizedRect>>();
+      const int batch_size = rects.size();
+      RET_CHECK(!cc->Inputs().Tag(kTensorsTag).IsEmpty())
+          << "Missing tensors for " << batch_size << " regions of interest.";
+      const auto& tensors =
+          cc->Inputs().Tag(kTensorsTag).Get<std::vector<Tensor>>();
+      for (const Tensor& tensor : tensors) {
+        RET_CHECK(!tensor.shape().dims.empty() &&
+                  tensor.shape().dims[0] == batch_size)
+            << "Tensor batch size does not match the number of regions of "
+               "interest.";
+      }
+      const std::vector<std::array<float, 4>>* paddings = nullptr;
+      if (cc->Inputs().HasTag(kLetterboxPaddingsTag)) {
+        paddings = &cc->Inputs()
+                        .Tag(kLetterboxPaddingsTag)
+                        .Get<std::vector<std::array<float, 4>>>();
+        RET_CHECK_EQ(paddings->size(), rects.size());
+      }
+
+      for (int i = 0; i < batch_size; ++i) {
+        cc->Outputs().Tag(kItemTag).AddPacket(
+            MakePacket<NormalizedRect>(rects[i]).At(loop_internal_timestamp_));
+        auto item_tensors = absl::make_unique<std::vector<Tensor>>();
+        item_tensors->reserve(tensors.size());
+        for (const Tensor& tensor : tensors) {
+          item_tensors->push_back(SliceBatch(tensor, i));
+        }
+        cc->Outputs().Tag(kTensorsTag).Add(item_tensors.release(),
+                                           loop_internal_timestamp_);
+        if (paddings) {
+          cc->Outputs().Tag(kLetterboxPaddingTag).AddPacket(
+              MakePacket<std::array<float, 4>>((*paddings)[i])
+                  .At(loop_internal_timestamp_));
+        }
+        ForwardClonePackets(cc, loop_internal_timestamp_);
+        ++loop_internal_timestamp_;
+      }
+    }
+
+    // The collection was empty and nothing was processed.
+    if (last_timestamp == loop_internal_timestamp_) {
+      ++loop_internal_timestamp_;
+      for (auto it = cc->Outputs().begin(); it < cc->Outputs().end(); ++it) {
+        it->SetNextTimestampBound(loop_internal_timestamp_);
+      }
+    }
+
+    cc->Outputs()
+        .Tag(kBatchEndTag)
+        .AddPacket(MakePacket<Timestamp>(cc->InputTimestamp())
+                       .At(Timestamp(loop_internal_timestamp_ - 1)));
+    return absl::OkStatus();
+  }
+
+ private:
+  void ForwardClonePackets(CalculatorContext* cc, Timestamp output_timestamp) {
+    for (int i = 0; i < cc->Inputs().NumEntries(kCloneTag); ++i) {
+      if (!cc->Inputs().Get(kCloneTag, i).IsEmpty()) {
+        cc->Outputs()
+            .Get(kCloneTag, i)
+            .AddPacket(
+                cc->Inputs().Get(kCloneTag, i).Value().At(output_timestamp));
+      }
+    }
+  }
+
+  // Fake timestamps generated per region of interest.
+  Timestamp loop_internal_timestamp_ = Timestamp(0);
+};
+
+REGISTER_CALCULATOR(BeginLoopTensorBatchCalculator);
+
+}  // namespace mediapipe
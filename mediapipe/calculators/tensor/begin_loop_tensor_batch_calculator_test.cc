@@ -0,0 +1,171 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <array>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using Node = ::mediapipe::CalculatorGraphConfig::Node;
+
+// Returns a [batch_size, 2] tensor holding 10 * b + i at [b, i].
+Tensor MakeBatchTensor(int batch_size) {
+  Tensor tensor(Tensor::ElementType::kFloat32, Tensor::Shape{batch_size, 2});
+  auto view = tensor.GetCpuWriteView();
+  float* buffer = view.buffer<float>();
+  for (int b = 0; b < batch_size; ++b) {
+    for (int i = 0; i < 2; ++i) {
+      buffer[b * 2 + i] = 10 * b + i;
+    }
+  }
+  return tensor;
+}
+
+TEST(BeginLoopTensorBatchCalculatorTest, SplitsBatch) {
+  CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "BeginLoopTensorBatchCalculator"
+    input_stream: "ITERABLE:rects"
+    input_stream: "TENSORS:tensors"
+    input_stream: "LETTERBOX_PADDINGS:paddings"
+    input_stream: "CLONE:size"
+    output_stream: "ITEM:rect"
+    output_stream: "TENSORS:item_tensors"
+    output_stream: "LETTERBOX_PADDING:padding"
+    output_stream: "CLONE:item_size"
+    output_stream: "BATCH_END:batch_end"
+  )pb"));
+
+  constexpr int kBatchSize = 3;
+  std::vector<NormalizedRect> rects(kBatchSize);
+  std::vector<std::array<float, 4>> paddings(kBatchSize);
+  for (int b = 0; b < kBatchSize; ++b) {
+    rects[b].set_x_center(0.1f * b);
+    paddings[b] = {0.f, 0.01f * b, 0.f, 0.01f * b};
+  }
+  auto tensors = absl::make_unique<std::vector<Tensor>>();
+  tensors->push_back(MakeBatchTensor(kBatchSize));
+  const Timestamp input_timestamp(100);
+  runner.MutableInputs()->Tag("ITERABLE").packets.push_back(
+      MakePacket<std::vector<NormalizedRect>>(rects).At(input_timestamp));
+  runner.MutableInputs()->Tag("TENSORS").packets.push_back(
+      Adopt(tensors.release()).At(input_timestamp));
+  runner.MutableInputs()->Tag("LETTERBOX_PADDINGS").packets.push_back(
+      MakePacket<std::vector<std::array<float, 4>>>(paddings)
+          .At(input_timestamp));
+  runner.MutableInputs()->Tag("CLONE").packets.push_back(
+      MakePacket<int>(7).At(input_timestamp));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& rect_packets = runner.Outputs().Tag("ITEM").packets;
+  const auto& tensor_packets = runner.Outputs().Tag("TENSORS").packets;
+  const auto& padding_packets =
+      runner.Outputs().Tag("LETTERBOX_PADDING").packets;
+  const auto& clone_packets = runner.Outputs().Tag("CLONE").packets;
+  ASSERT_EQ(kBatchSize, rect_packets.size());
+  ASSERT_EQ(kBatchSize, tensor_packets.size());
+  ASSERT_EQ(kBatchSize, padding_packets.size());
+  ASSERT_EQ(kBatchSize, clone_packets.size());
+  for (int b = 0; b < kBatchSize; ++b) {
+    EXPECT_EQ(Timestamp(b), tensor_packets[b].Timestamp());
+    EXPECT_FLOAT_EQ(0.1f * b, rect_packets[b].Get<NormalizedRect>().x_center());
+    EXPECT_FLOAT_EQ(0.01f * b,
+                    padding_packets[b].Get<std::array<float, 4>>()[1]);
+    EXPECT_EQ(7, clone_packets[b].Get<int>());
+    const auto& item_tensors = tensor_packets[b].Get<std::vector<Tensor>>();
+    ASSERT_EQ(1, item_tensors.size());
+    EXPECT_EQ(std::vector<int>({1, 2}), item_tensors[0].shape().dims);
+    auto view = item_tensors[0].GetCpuReadView();
+    EXPECT_EQ(10 * b, view.buffer<float>()[0]);
+    EXPECT_EQ(10 * b + 1, view.buffer<float>()[1]);
+  }
+  const auto& batch_end_packets = runner.Outputs().Tag("BATCH_END").packets;
+  ASSERT_EQ(1, batch_end_packets.size());
+  EXPECT_EQ(Timestamp(kBatchSize - 1), batch_end_packets[0].Timestamp());
+  EXPECT_EQ(input_timestamp, batch_end_packets[0].Get<Timestamp>());
+}
+
+TEST(BeginLoopTensorBatchCalculatorTest, KeepsQuantization) {
+  CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "BeginLoopTensorBatchCalculator"
+    input_stream: "ITERABLE:rects"
+    input_stream: "TENSORS:tensors"
+    output_stream: "ITEM:rect"
+    output_stream: "TENSORS:item_tensors"
+    output_stream: "BATCH_END:batch_end"
+  )pb"));
+
+  constexpr int kBatchSize = 3;
+  constexpr float kScale = 0.25f;
+  constexpr int kZeroPoint = 128;
+  Tensor tensor(Tensor::ElementType::kUInt8, Tensor::Shape{kBatchSize, 2},
+                Tensor::QuantizationParameters(kScale, kZeroPoint));
+  {
+    auto view = tensor.GetCpuWriteView();
+    uint8* buffer = view.buffer<uint8>();
+    for (int i = 0; i < kBatchSize * 2; ++i) {
+      buffer[i] = i;
+    }
+  }
+  auto tensors = absl::make_unique<std::vector<Tensor>>();
+  tensors->push_back(std::move(tensor));
+  runner.MutableInputs()->Tag("ITERABLE").packets.push_back(
+      MakePacket<std::vector<NormalizedRect>>(kBatchSize).At(Timestamp(0)));
+  runner.MutableInputs()->Tag("TENSORS").packets.push_back(
+      Adopt(tensors.release()).At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& tensor_packets = runner.Outputs().Tag("TENSORS").packets;
+  ASSERT_EQ(kBatchSize, tensor_packets.size());
+  for (int b = 0; b < kBatchSize; ++b) {
+    const auto& item_tensors = tensor_packets[b].Get<std::vector<Tensor>>();
+    ASSERT_EQ(1, item_tensors.size());
+    EXPECT_EQ(Tensor::ElementType::kUInt8, item_tensors[0].element_type());
+    EXPECT_EQ(kScale, item_tensors[0].quantization_parameters().scale);
+    EXPECT_EQ(kZeroPoint, item_tensors[0].quantization_parameters().zero_point);
+    auto view = item_tensors[0].GetCpuReadView();
+    EXPECT_EQ(2 * b, view.buffer<uint8>()[0]);
+    EXPECT_EQ(2 * b + 1, view.buffer<uint8>()[1]);
+  }
+}
+
+TEST(BeginLoopTensorBatchCalculatorTest, RejectsMismatchedBatch) {
+  CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "BeginLoopTensorBatchCalculator"
+    input_stream: "ITERABLE:rects"
+    input_stream: "TENSORS:tensors"
+    output_stream: "ITEM:rect"
+    output_stream: "TENSORS:item_tensors"
+    output_stream: "BATCH_END:batch_end"
+  )pb"));
+  auto tensors = absl::make_unique<std::vector<Tensor>>();
+  tensors->push_back(MakeBatchTensor(2));
+  runner.MutableInputs()->Tag("ITERABLE").packets.push_back(
+      MakePacket<std::vector<NormalizedRect>>(3).At(Timestamp(0)));
+  runner.MutableInputs()->Tag("TENSORS").packets.push_back(
+      Adopt(tensors.release()).At(Timestamp(0)));
+  EXPECT_FALSE(runner.Run().ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
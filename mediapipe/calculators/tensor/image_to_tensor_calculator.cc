@@ -18,6 +18,7 @@
 
 #include "mediapipe/calculators/tensor/image_to_tensor_calculator.pb.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_converter_fused.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_converter_opencv.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
 #include "mediapipe/framework/api2/node.h"
@@ -58,6 +59,49 @@ using GpuBuffer = AnyType;
 using GpuBuffer = mediapipe::GpuBuffer;
 #endif  // MEDIAPIPE_DISABLE_GPU
 
+namespace {
+
+// Element type and value range of the output tensor.
+struct OutputTensorParams {
+  Tensor::ElementType type;
+  float range_min;
+  float range_max;
+};
+
+absl::StatusOr<OutputTensorParams> GetOutputTensorParams(
+    const mediapipe::ImageToTensorCalculatorOptions& options) {
+  switch (options.range_case()) {
+    case mediapipe::ImageToTensorCalculatorOptions::kOutputTensorFloatRange: {
+      const auto& range = options.output_tensor_float_range();
+      RET_CHECK_LT(range.min(), range.max())
+          << "Valid output tensor range is required.";
+      return OutputTensorParams{Tensor::ElementType::kFloat32, range.min(),
+                                range.max()};
+    }
+    case mediapipe::ImageToTensorCalculatorOptions::kOutputTensorIntRange: {
+      const auto& range = options.output_tensor_int_range();
+      RET_CHECK(range.min() >= -128 && range.min() < range.max() &&
+                range.max() <= 127)
+          << "Valid int8 output tensor range is required.";
+      return OutputTensorParams{Tensor::ElementType::kInt8,
+                                static_cast<float>(range.min()),
+                                static_cast<float>(range.max())};
+    }
+    case mediapipe::ImageToTensorCalculatorOptions::kOutputTensorUintRange: {
+      const auto& range = options.output_tensor_uint_range();
+      RET_CHECK(range.min() < range.max() && range.max() <= 255)
+          << "Valid uint8 output tensor range is required.";
+      return OutputTensorParams{Tensor::ElementType::kUInt8,
+                                static_cast<float>(range.min()),
+                                static_cast<float>(range.max())};
+    }
+    default:
+      return absl::InvalidArgumentError("Output tensor range is required.");
+  }
+}
+
+}  // namespace
+
 // Converts image into Tensor, possibly with cropping, resizing and
 // normalization, according to specified inputs and options.
 //
@@ -79,9 +123,18 @@ using GpuBuffer = mediapipe::GpuBuffer;
 //     Describes region of image to extract.
 //     @Optional: rect covering the whole image is used if not specified.
 //
+//   NORM_RECTS - std::vector<NormalizedRect> @Optional
+//     Describes several regions of image to extract into one batched tensor,
+//     e.g. all hands of a frame. Only supported for images on CPU. Cannot be
+//     combined with NORM_RECT. No output is produced for an empty vector.
+//
 // Outputs:
 //   TENSORS - std::vector<Tensor>
 //     Vector containing a single Tensor populated with an extrated RGB image.
+//     The Tensor is float32, or int8 / uint8 with output_tensor_int_range /
+//     output_tensor_uint_range.
+//     With NORM_RECTS, the single Tensor has shape [N, height, width, 3] and
+//     holds one extracted image per rect.
 //   MATRIX - std::array<float, 16> @Optional
 //     An std::array<float, 16> representing a 4x4 row-major-order matrix which
 //     can be used to map a point on the output tensor to a point on the input
@@ -98,6 +151,8 @@ using GpuBuffer = mediapipe::GpuBuffer;
 //     20x20 and places it in the middle of the output image with an equal
 //     padding of 10 pixels at the top and the bottom. The resulting array is
 //     therefore [0.f, 0.25f, 0.f, 0.25f] (10/40 = 0.25f).
+//   LETTERBOX_PADDINGS - std::vector<std::array<float, 4>> @Optional
+//     The LETTERBOX_PADDING of each rect in NORM_RECTS.
 //
 // Example:
 // node {
@@ -116,6 +171,7 @@ using GpuBuffer = mediapipe::GpuBuffer;
 //         max: 1.0
 //       }
 //       # gpu_origin: CONVENTIONAL # or TOP_LEFT
+//       # cpu_converter: CPU_CONVERTER_FUSED
 //     }
 //   }
 // }
@@ -126,23 +182,24 @@ class ImageToTensorCalculator : public Node {
   static constexpr Input<GpuBuffer>::Optional kInGpu{"IMAGE_GPU"};
   static constexpr Input<mediapipe::NormalizedRect>::Optional kInNormRect{
       "NORM_RECT"};
+  static constexpr Input<std::vector<mediapipe::NormalizedRect>>::Optional
+      kInNormRects{"NORM_RECTS"};
   static constexpr Output<std::vector<Tensor>> kOutTensors{"TENSORS"};
   static constexpr Output<std::array<float, 4>>::Optional kOutLetterboxPadding{
       "LETTERBOX_PADDING"};
+  static constexpr Output<std::vector<std::array<float, 4>>>::Optional
+      kOutLetterboxPaddings{"LETTERBOX_PADDINGS"};
   static constexpr Output<std::array<float, 16>>::Optional kOutMatrix{"MATRIX"};
 
-  MEDIAPIPE_NODE_CONTRACT(kIn, kInGpu, kInNormRect, kOutTensors,
-                          kOutLetterboxPadding, kOutMatrix);
+  MEDIAPIPE_NODE_CONTRACT(kIn, kInGpu, kInNormRect, kInNormRects, kOutTensors,
+                          kOutLetterboxPadding, kOutLetterboxPaddings,
+                          kOutMatrix);
 
   static absl::Status UpdateContract(CalculatorContract* cc) {
     const auto& options =
         cc->Options<mediapipe::ImageToTensorCalculatorOptions>();
 
-    RET_CHECK(options.has_output_tensor_float_range())
-        << "Output tensor range is required.";
-    RET_CHECK_LT(options.output_tensor_float_range().min(),
-                 options.output_tensor_float_range().max())
-        << "Valid output tensor range is required.";
+    MP_RETURN_IF_ERROR(GetOutputTensorParams(options).status());
     RET_CHECK_GT(options.output_tensor_width(), 0)
         << "Valid output tensor width is required.";
     RET_CHECK_GT(options.output_tensor_height(), 0)
@@ -150,6 +207,9 @@ class ImageToTensorCalculator : public Node {
 
     RET_CHECK(kIn(cc).IsConnected() ^ kInGpu(cc).IsConnected())
         << "One and only one of IMAGE and IMAGE_GPU input is expected.";
+    RET_CHECK(!(kInNormRect(cc).IsConnected() &&
+                kInNormRects(cc).IsConnected()))
+        << "At most one of NORM_RECT and NORM_RECTS input is expected.";
 
 #if MEDIAPIPE_DISABLE_GPU
     if (kInGpu(cc).IsConnected()) {
@@ -171,8 +231,10 @@ class ImageToTensorCalculator : public Node {
     options_ = cc->Options<mediapipe::ImageToTensorCalculatorOptions>();
     output_width_ = options_.output_tensor_width();
     output_height_ = options_.output_tensor_height();
-    range_min_ = options_.output_tensor_float_range().min();
-    range_max_ = options_.output_tensor_float_range().max();
+    ASSIGN_OR_RETURN(auto params, GetOutputTensorParams(options_));
+    tensor_type_ = params.type;
+    range_min_ = params.range_min;
+    range_max_ = params.range_max;
 
     return absl::OkStatus();
   }
@@ -183,6 +245,9 @@ class ImageToTensorCalculator : public Node {
       // Timestamp bound update happens automatically.
       return absl::OkStatus();
     }
+    if (kInNormRects(cc).IsConnected()) {
+      return ProcessBatch(cc);
+    }
 
     absl::optional<mediapipe::NormalizedRect> norm_rect;
     if (kInNormRect(cc).IsConnected()) {
@@ -236,6 +301,44 @@ class ImageToTensorCalculator : public Node {
   }
 
  private:
+  // Extracts all NORM_RECTS into one batched tensor.
+  absl::Status ProcessBatch(CalculatorContext* cc) {
+    if (kInNormRects(cc).IsEmpty() || kInNormRects(cc)->empty()) {
+      // Timestamp bound update happens automatically.
+      return absl::OkStatus();
+    }
+    const auto& norm_rects = *kInNormRects(cc);
+
+    ASSIGN_OR_RETURN(auto image, GetInputImage(cc));
+    RET_CHECK(!image->UsesGpu())
+        << "NORM_RECTS is only supported for images on CPU.";
+    MP_RETURN_IF_ERROR(InitConverterIfNecessary(cc, /*use_gpu=*/false));
+
+    constexpr int kNumChannels = 3;
+    const int batch_size = norm_rects.size();
+    Tensor tensor(tensor_type_, Tensor::Shape{batch_size, output_height_,
+                                              output_width_, kNumChannels});
+    auto paddings = std::make_unique<std::vector<std::array<float, 4>>>();
+    paddings->reserve(batch_size);
+    for (int i = 0; i < batch_size; ++i) {
+      RotatedRect roi = GetRoi(image->width(), image->height(), norm_rects[i]);
+      ASSIGN_OR_RETURN(auto padding,
+                       PadRoi(output_width_, output_height_,
+                              options_.keep_aspect_ratio(), &roi));
+      paddings->push_back(padding);
+      MP_RETURN_IF_ERROR(cpu_converter_->ConvertToBatch(
+          *image, roi, range_min_, range_max_, i, &tensor));
+    }
+    if (kOutLetterboxPaddings(cc).IsConnected()) {
+      kOutLetterboxPaddings(cc).Send(std::move(paddings));
+    }
+
+    auto result = std::make_unique<std::vector<Tensor>>();
+    result->push_back(std::move(tensor));
+    kOutTensors(cc).Send(std::move(result));
+    return absl::OkStatus();
+  }
+
   bool DoesInputStartAtBottom() {
     return options_.gpu_origin() != mediapipe::GpuOrigin_Mode_TOP_LEFT;
   }
@@ -282,6 +385,8 @@ class ImageToTensorCalculator : public Node {
   absl::Status InitConverterIfNecessary(CalculatorContext* cc, bool use_gpu) {
     // Lazy initialization of the GPU or CPU converter.
     if (use_gpu) {
+      RET_CHECK(tensor_type_ == Tensor::ElementType::kFloat32)
+          << "Quantized output tensors are only supported for images on CPU.";
       if (!gpu_converter_) {
 #if !MEDIAPIPE_DISABLE_GPU
 #if MEDIAPIPE_METAL_ENABLED
@@ -300,8 +405,16 @@ class ImageToTensorCalculator : public Node {
       }
     } else {
       if (!cpu_converter_) {
-        ASSIGN_OR_RETURN(cpu_converter_,
-                         CreateOpenCvConverter(cc, GetBorderMode()));
+        if (options_.cpu_converter() ==
+            mediapipe::ImageToTensorCalculatorOptions::CPU_CONVERTER_FUSED) {
+          ASSIGN_OR_RETURN(
+              cpu_converter_,
+              CreateFusedConverter(cc, GetBorderMode(), tensor_type_));
+        } else {
+          ASSIGN_OR_RETURN(
+              cpu_converter_,
+              CreateOpenCvConverter(cc, GetBorderMode(), tensor_type_));
+        }
       }
     }
     return absl::OkStatus();
@@ -312,6 +425,7 @@ class ImageToTensorCalculator : public Node {
   mediapipe::ImageToTensorCalculatorOptions options_;
   int output_width_ = 0;
   int output_height_ = 0;
+  Tensor::ElementType tensor_type_ = Tensor::ElementType::kFloat32;
   float range_min_ = 0.0f;
   float range_max_ = 1.0f;
 };
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <array>
 #include <cmath>
 #include <vector>
 
@@ -433,5 +434,107 @@ TEST(ImageToTensorCalculatorTest, NoOpExceptRangeBorderZero) {
           BorderMode::kZero, roi);
 }
 
+// Runs ImageToTensorCalculator on |image| with the rects packet as |tag|
+// input, and returns the TENSORS packets and the letterbox padding packets.
+void RunWithRects(const cv::Mat& image, const std::string& tag,
+                  const Packet& rects_packet,
+                  std::vector<Packet>* tensor_packets,
+                  std::vector<Packet>* padding_packets) {
+  const std::string padding_tag =
+      tag == "NORM_RECTS" ? "LETTERBOX_PADDINGS" : "LETTERBOX_PADDING";
+  CalculatorRunner runner(
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+          R"(
+            calculator: "ImageToTensorCalculator"
+            input_stream: "IMAGE:image"
+            input_stream: "$0:rects"
+            output_stream: "TENSORS:tensors"
+            output_stream: "$1:padding"
+            options {
+              [mediapipe.ImageToTensorCalculatorOptions.ext] {
+                output_tensor_width: 64
+                output_tensor_height: 96
+                keep_aspect_ratio: true
+                output_tensor_float_range { min: -1.0 max: 1.0 }
+              }
+            }
+          )",
+          tag, padding_tag)));
+  runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+      MakeImageFramePacket(image));
+  runner.MutableInputs()->Tag(tag).packets.push_back(
+      rects_packet.At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+  *tensor_packets = runner.Outputs().Tag("TENSORS").packets;
+  *padding_packets = runner.Outputs().Tag(padding_tag).packets;
+}
+
+TEST(ImageToTensorCalculatorTest, NormRectsMatchSingleRects) {
+  cv::Mat input = GetRgb(
+      "/mediapipe/calculators/tensor/testdata/image_to_tensor/input.jpg");
+  std::vector<mediapipe::NormalizedRect> rects(3);
+  rects[0].set_x_center(0.65f);
+  rects[0].set_y_center(0.4f);
+  rects[0].set_width(0.5f);
+  rects[0].set_height(0.5f);
+  rects[1].set_x_center(0.3f);
+  rects[1].set_y_center(0.6f);
+  rects[1].set_width(0.4f);
+  rects[1].set_height(0.2f);
+  rects[1].set_rotation(M_PI * 0.25f);
+  rects[2].set_x_center(0.5f);
+  rects[2].set_y_center(0.5f);
+  rects[2].set_width(1.0f);
+  rects[2].set_height(1.0f);
+
+  std::vector<Packet> batch_packets;
+  std::vector<Packet> padding_packets;
+  RunWithRects(input, "NORM_RECTS",
+               MakePacket<std::vector<mediapipe::NormalizedRect>>(rects),
+               &batch_packets, &padding_packets);
+  ASSERT_EQ(1, batch_packets.size());
+  ASSERT_EQ(1, padding_packets.size());
+  const auto& batch_tensors = batch_packets[0].Get<std::vector<Tensor>>();
+  ASSERT_EQ(1, batch_tensors.size());
+  EXPECT_EQ(std::vector<int>({3, 96, 64, 3}), batch_tensors[0].shape().dims);
+  const auto& paddings =
+      padding_packets[0].Get<std::vector<std::array<float, 4>>>();
+  ASSERT_EQ(3, paddings.size());
+  auto batch_view = batch_tensors[0].GetCpuReadView();
+  const int tensor_size = 96 * 64 * 3;
+
+  // Each batch element equals the tensor extracted for its rect alone.
+  for (int i = 0; i < rects.size(); ++i) {
+    std::vector<Packet> single_packets;
+    std::vector<Packet> single_padding_packets;
+    RunWithRects(input, "NORM_RECT",
+                 MakePacket<mediapipe::NormalizedRect>(rects[i]),
+                 &single_packets, &single_padding_packets);
+    ASSERT_EQ(1, single_packets.size());
+    ASSERT_EQ(1, single_padding_packets.size());
+    EXPECT_EQ(single_padding_packets[0].Get<std::array<float, 4>>(),
+              paddings[i]);
+    const Tensor& single = single_packets[0].Get<std::vector<Tensor>>()[0];
+    auto single_view = single.GetCpuReadView();
+    const float* batch_buffer = batch_view.buffer<float>() + i * tensor_size;
+    for (int j = 0; j < tensor_size; ++j) {
+      ASSERT_EQ(single_view.buffer<float>()[j], batch_buffer[j])
+          << "rect " << i << " element " << j;
+    }
+  }
+}
+
+TEST(ImageToTensorCalculatorTest, EmptyNormRectsProduceNoOutput) {
+  cv::Mat input = GetRgb(
+      "/mediapipe/calculators/tensor/testdata/image_to_tensor/input.jpg");
+  std::vector<Packet> tensor_packets;
+  std::vector<Packet> padding_packets;
+  RunWithRects(input, "NORM_RECTS",
+               MakePacket<std::vector<mediapipe::NormalizedRect>>(),
+               &tensor_packets, &padding_packets);
+  EXPECT_TRUE(tensor_packets.empty());
+  EXPECT_TRUE(padding_packets.empty());
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -49,6 +49,17 @@ class ImageToTensorConverter {
                                          const RotatedRect& roi,
                                          const Size& output_dims,
                                          float range_min, float range_max) = 0;
+
+  // Converts image into element @batch_index of @output, a tensor of shape
+  // [batch size, output height, output width, channels], so that several
+  // regions of interest can be extracted into one batched tensor.
+  virtual absl::Status ConvertToBatch(const mediapipe::Image& input,
+                                      const RotatedRect& roi, float range_min,
+                                      float range_max, int batch_index,
+                                      Tensor* output) {
+    return absl::UnimplementedError(
+        "Batched conversion is not supported by this converter.");
+  }
 };
 
 }  // namespace mediapipe
@@ -0,0 +1,261 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/image_to_tensor_converter_fused.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr int kNumChannels = 3;
+
+// Source image pixels of one conversion.
+struct SourceImage {
+  const uint8* data;
+  int width;
+  int height;
+  int step;
+  int channels;
+};
+
+// Stores a normalized value into an output element. Quantized values are
+// rounded to the nearest integer and saturated, as cv::Mat::convertTo does.
+inline void Store(float value, float* output) { *output = value; }
+
+inline void Store(float value, uint8_t* output) {
+  *output = static_cast<uint8_t>(
+      std::min(std::max(std::lrint(value), 0L), 255L));
+}
+
+inline void Store(float value, int8_t* output) {
+  *output = static_cast<int8_t>(
+      std::min(std::max(std::lrint(value), -128L), 127L));
+}
+
+// Writes the bilinear sample of |image| at (x, y) to |output|, for a point
+// whose neighbors are not all inside the image.  Neighbors outside the image
+// are black with kZero and replicate the closest edge pixel with kReplicate.
+template <typename T>
+void SampleBorder(const SourceImage& image, BorderMode border_mode, float x,
+                  float y, float scale, float offset, T* output) {
+  const int x0 = static_cast<int>(std::floor(x));
+  const int y0 = static_cast<int>(std::floor(y));
+  const float fx = x - x0;
+  const float fy = y - y0;
+  const float weights[4] = {(1.f - fx) * (1.f - fy), fx * (1.f - fy),
+                            (1.f - fx) * fy, fx * fy};
+  float sums[kNumChannels] = {0.f, 0.f, 0.f};
+  for (int i = 0; i < 4; ++i) {
+    int px = x0 + (i & 1);
+    int py = y0 + (i >> 1);
+    if (px < 0 || px >= image.width || py < 0 || py >= image.height) {
+      if (border_mode == BorderMode::kZero) continue;
+      px = std::min(std::max(px, 0), image.width - 1);
+      py = std::min(std::max(py, 0), image.height - 1);
+    }
+    const uint8* pixel = image.data + py * image.step + px * image.channels;
+    for (int c = 0; c < kNumChannels; ++c) {
+      sums[c] += weights[i] * pixel[c];
+    }
+  }
+  for (int c = 0; c < kNumChannels; ++c) {
+    Store(sums[c] * scale + offset, &output[c]);
+  }
+}
+
+// Converts a rotated region of interest of a RGB or RGBA image into a float,
+// uint8 or int8 RGB tensor in a single pass: every output value is sampled
+// from the source image, normalized and stored directly.
+//
+// Each output row is a line in the source image, so the sample positions of a
+// row are computed first in a loop the compiler vectorizes, and the pixels are
+// then blended with a branch-free path for samples inside the image.
+class FusedProcessor : public ImageToTensorConverter {
+ public:
+  FusedProcessor(BorderMode border_mode, Tensor::ElementType tensor_type)
+      : border_mode_(border_mode), tensor_type_(tensor_type) {}
+
+  absl::StatusOr<Tensor> Convert(const mediapipe::Image& input,
+                                 const RotatedRect& roi,
+                                 const Size& output_dims, float range_min,
+                                 float range_max) override {
+    Tensor tensor(
+        tensor_type_,
+        Tensor::Shape{1, output_dims.height, output_dims.width, kNumChannels});
+    MP_RETURN_IF_ERROR(ConvertToBatch(input, roi, range_min, range_max,
+                                      /*batch_index=*/0, &tensor));
+    return tensor;
+  }
+
+  absl::Status ConvertToBatch(const mediapipe::Image& input,
+                              const RotatedRect& roi, float range_min,
+                              float range_max, int batch_index,
+                              Tensor* output) override {
+    if (input.image_format() != mediapipe::ImageFormat::SRGB &&
+        input.image_format() != mediapipe::ImageFormat::SRGBA) {
+      return InvalidArgumentError(
+          absl::StrCat("Only RGBA/RGB formats are supported, passed format: ",
+                       static_cast<uint32_t>(input.image_format())));
+    }
+    RET_CHECK(output->element_type() == tensor_type_)
+        << "The output tensor type does not match the converter.";
+    const auto& dims = output->shape().dims;
+    RET_CHECK_EQ(dims.size(), 4);
+    RET_CHECK_LT(batch_index, dims[0]);
+    RET_CHECK_EQ(dims[3], kNumChannels);
+    const int output_width = dims[2];
+    const int output_height = dims[1];
+
+    const auto& image_frame = input.GetImageFrameSharedPtr();
+    RET_CHECK(image_frame) << "The fused converter requires a CPU image.";
+    const SourceImage image{image_frame->PixelData(), image_frame->Width(),
+                            image_frame->Height(), image_frame->WidthStep(),
+                            image_frame->NumberOfChannels()};
+
+    constexpr float kInputImageRangeMin = 0.0f;
+    constexpr float kInputImageRangeMax = 255.0f;
+    ASSIGN_OR_RETURN(
+        auto transform,
+        GetValueRangeTransformation(kInputImageRangeMin, kInputImageRangeMax,
+                                    range_min, range_max));
+
+    // Output pixel (x, y) samples the source image at
+    // origin + x * x_step + y * y_step, where origin is the top left corner
+    // of the region of interest, as with OpenCV's warpPerspective.
+    const float cos_r = std::cos(roi.rotation);
+    const float sin_r = std::sin(roi.rotation);
+    const float x_step_x = roi.width / output_width * cos_r;
+    const float x_step_y = roi.width / output_width * sin_r;
+    const float y_step_x = -roi.height / output_height * sin_r;
+    const float y_step_y = roi.height / output_height * cos_r;
+    const float origin_x =
+        roi.center_x - 0.5f * roi.width * cos_r + 0.5f * roi.height * sin_r;
+    const float origin_y =
+        roi.center_y - 0.5f * roi.width * sin_r - 0.5f * roi.height * cos_r;
+
+    const Geometry geometry{origin_x, origin_y, x_step_x,
+                            x_step_y, y_step_x, y_step_y};
+    const int offset =
+        batch_index * output_height * output_width * kNumChannels;
+    auto buffer_view = output->GetCpuWriteView();
+    switch (tensor_type_) {
+      case Tensor::ElementType::kUInt8:
+        ConvertRows(image, geometry, transform, output_width, output_height,
+                    buffer_view.buffer<uint8_t>() + offset);
+        break;
+      case Tensor::ElementType::kInt8:
+        ConvertRows(image, geometry, transform, output_width, output_height,
+                    buffer_view.buffer<int8_t>() + offset);
+        break;
+      default:
+        ConvertRows(image, geometry, transform, output_width, output_height,
+                    buffer_view.buffer<float>() + offset);
+        break;
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  // Sampling positions of the output pixels in the source image.
+  struct Geometry {
+    float origin_x;
+    float origin_y;
+    float x_step_x;
+    float x_step_y;
+    float y_step_x;
+    float y_step_y;
+  };
+
+  template <typename T>
+  void ConvertRows(const SourceImage& image, const Geometry& geometry,
+                   const ValueTransformation& transform, int output_width,
+                   int output_height, T* out) {
+    sample_x_.resize(output_width);
+    sample_y_.resize(output_width);
+    const float max_x = image.width - 1;
+    const float max_y = image.height - 1;
+    for (int y = 0; y < output_height; ++y) {
+      const float row_x = geometry.origin_x + y * geometry.y_step_x;
+      const float row_y = geometry.origin_y + y * geometry.y_step_y;
+      for (int x = 0; x < output_width; ++x) {
+        sample_x_[x] = row_x + x * geometry.x_step_x;
+        sample_y_[x] = row_y + x * geometry.x_step_y;
+      }
+      for (int x = 0; x < output_width; ++x, out += kNumChannels) {
+        const float sx = sample_x_[x];
+        const float sy = sample_y_[x];
+        if (!(sx >= 0.f && sx < max_x && sy >= 0.f && sy < max_y)) {
+          SampleBorder(image, border_mode_, sx, sy, transform.scale,
+                       transform.offset, out);
+          continue;
+        }
+        const int x0 = static_cast<int>(sx);
+        const int y0 = static_cast<int>(sy);
+        const float fx = sx - x0;
+        const float fy = sy - y0;
+        const uint8* top = image.data + y0 * image.step + x0 * image.channels;
+        const uint8* bottom = top + image.step;
+        const int right = image.channels;
+        for (int c = 0; c < kNumChannels; ++c) {
+          const float top_value = top[c] + fx * (top[c + right] - top[c]);
+          const float bottom_value =
+              bottom[c] + fx * (bottom[c + right] - bottom[c]);
+          const float value = top_value + fy * (bottom_value - top_value);
+          Store(value * transform.scale + transform.offset, &out[c]);
+        }
+      }
+    }
+  }
+
+  const BorderMode border_mode_;
+  const Tensor::ElementType tensor_type_;
+  // Source positions of the samples of one output row.
+  std::vector<float> sample_x_;
+  std::vector<float> sample_y_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<ImageToTensorConverter>> CreateFusedConverter(
+    CalculatorContext* cc, BorderMode border_mode,
+    Tensor::ElementType tensor_type) {
+  RET_CHECK(tensor_type == Tensor::ElementType::kFloat32 ||
+            tensor_type == Tensor::ElementType::kUInt8 ||
+            tensor_type == Tensor::ElementType::kInt8)
+      << "Unsupported output tensor type.";
+  return std::unique_ptr<ImageToTensorConverter>(
+      absl::make_unique<FusedProcessor>(border_mode, tensor_type));
+}
+
+}  // namespace mediapipe
@@ -27,15 +27,31 @@
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/statusor.h"
 
 namespace mediapipe {
 
 namespace {
 
+constexpr int kNumChannels = 3;
+
 class OpenCvProcessor : public ImageToTensorConverter {
  public:
-  OpenCvProcessor(BorderMode border_mode) {
+  OpenCvProcessor(BorderMode border_mode, Tensor::ElementType tensor_type)
+      : tensor_type_(tensor_type) {
+    switch (tensor_type) {
+      case Tensor::ElementType::kUInt8:
+        mat_type_ = CV_8UC3;
+        break;
+      case Tensor::ElementType::kInt8:
+        mat_type_ = CV_8SC3;
+        break;
+      default:
+        mat_type_ = CV_32FC3;
+        break;
+    }
     switch (border_mode) {
       case BorderMode::kReplicate:
         border_mode_ = cv::BORDER_REPLICATE;
@@ -50,21 +66,38 @@ class OpenCvProcessor : public ImageToTensorConverter {
                                  const RotatedRect& roi,
                                  const Size& output_dims, float range_min,
                                  float range_max) override {
+    Tensor tensor(
+        tensor_type_,
+        Tensor::Shape{1, output_dims.height, output_dims.width, kNumChannels});
+    MP_RETURN_IF_ERROR(ConvertToBatch(input, roi, range_min, range_max,
+                                      /*batch_index=*/0, &tensor));
+    return tensor;
+  }
+
+  absl::Status ConvertToBatch(const mediapipe::Image& input,
+                              const RotatedRect& roi, float range_min,
+                              float range_max, int batch_index,
+                              Tensor* output) override {
     if (input.image_format() != mediapipe::ImageFormat::SRGB &&
         input.image_format() != mediapipe::ImageFormat::SRGBA) {
       return InvalidArgumentError(
           absl::StrCat("Only RGBA/RGB formats are supported, passed format: ",
                        static_cast<uint32_t>(input.image_format())));
     }
+    RET_CHECK(output->element_type() == tensor_type_)
+        << "The output tensor type does not match the converter.";
+    const auto& dims = output->shape().dims;
+    RET_CHECK_EQ(dims.size(), 4);
+    RET_CHECK_LT(batch_index, dims[0]);
+    RET_CHECK_EQ(dims[3], kNumChannels);
+    const Size output_dims{dims[2], dims[1]};
     cv::Mat src = mediapipe::formats::MatView(&input);
 
-    constexpr int kNumChannels = 3;
-    Tensor tensor(
-        Tensor::ElementType::kFloat32,
-        Tensor::Shape{1, output_dims.height, output_dims.width, kNumChannels});
-    auto buffer_view = tensor.GetCpuWriteView();
-    cv::Mat dst(output_dims.height, output_dims.width, CV_32FC3,
-                buffer_view.buffer<float>());
+    auto buffer_view = output->GetCpuWriteView();
+    char* batch_buffer = buffer_view.buffer<char>() +
+                         batch_index * output_dims.height * output_dims.width *
+                             kNumChannels * output->element_size();
+    cv::Mat dst(output_dims.height, output_dims.width, mat_type_, batch_buffer);
 
     const cv::RotatedRect rotated_rect(cv::Point2f(roi.center_x, roi.center_y),
                                        cv::Size2f(roi.width, roi.height),
@@ -102,22 +135,30 @@ class OpenCvProcessor : public ImageToTensorConverter {
         auto transform,
         GetValueRangeTransformation(kInputImageRangeMin, kInputImageRangeMax,
                                     range_min, range_max));
-    transformed.convertTo(dst, CV_32FC3, transform.scale, transform.offset);
-    return tensor;
+    // Quantized values are rounded and saturated.
+    transformed.convertTo(dst, mat_type_, transform.scale, transform.offset);
+    return absl::OkStatus();
   }
 
  private:
   enum cv::BorderTypes border_mode_;
+  Tensor::ElementType tensor_type_;
+  int mat_type_;
 };
 
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<ImageToTensorConverter>> CreateOpenCvConverter(
-    CalculatorContext* cc, BorderMode border_mode) {
+    CalculatorContext* cc, BorderMode border_mode,
+    Tensor::ElementType tensor_type) {
+  RET_CHECK(tensor_type == Tensor::ElementType::kFloat32 ||
+            tensor_type == Tensor::ElementType::kUInt8 ||
+            tensor_type == Tensor::ElementType::kInt8)
+      << "Unsupported output tensor type.";
   // Simply "return absl::make_unique<OpenCvProcessor>()" failed to build on
   // macOS with bazel.
   return std::unique_ptr<ImageToTensorConverter>(
-      absl::make_unique<OpenCvProcessor>(border_mode));
+      absl::make_unique<OpenCvProcessor>(border_mode, tensor_type));
 }
 
 }  // namespace mediapipe
@@ -19,13 +19,18 @@
 
 #include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/statusor.h"
 
 namespace mediapipe {
 
 // Creates OpenCV image-to-tensor converter.
+// @tensor_type is the element type of the output tensors: kFloat32, or kUInt8
+// / kInt8 for quantized models, in which case the output range is the range
+// of quantized values.
 absl::StatusOr<std::unique_ptr<ImageToTensorConverter>> CreateOpenCvConverter(
-    CalculatorContext* cc, BorderMode border_mode);
+    CalculatorContext* cc, BorderMode border_mode,
+    Tensor::ElementType tensor_type);
 
 }  // namespace mediapipe
 
@@ -0,0 +1,284 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_converter_fused.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_converter_opencv.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kImageWidth = 640;
+constexpr int kImageHeight = 480;
+
+// Returns an image with smooth gradients, so that the results of both
+// converters differ by no more than their interpolation rounding.
+Image MakeGradientImage(ImageFormat::Format format) {
+  auto frame = std::make_shared<ImageFrame>(format, kImageWidth, kImageHeight);
+  const int channels = frame->NumberOfChannels();
+  for (int y = 0; y < kImageHeight; ++y) {
+    uint8* row = frame->MutablePixelData() + y * frame->WidthStep();
+    for (int x = 0; x < kImageWidth; ++x) {
+      uint8* pixel = row + x * channels;
+      pixel[0] = x * 255 / (kImageWidth - 1);
+      pixel[1] = y * 255 / (kImageHeight - 1);
+      pixel[2] = (x + y) * 255 / (kImageWidth + kImageHeight - 2);
+      if (channels == 4) pixel[3] = 255;
+    }
+  }
+  return Image(std::move(frame));
+}
+
+// Returns the values of a float, uint8 or int8 tensor as floats.
+std::vector<float> GetValues(const Tensor& tensor) {
+  const int num_elements = tensor.shape().num_elements();
+  auto view = tensor.GetCpuReadView();
+  switch (tensor.element_type()) {
+    case Tensor::ElementType::kUInt8: {
+      const uint8_t* data = view.buffer<uint8_t>();
+      return std::vector<float>(data, data + num_elements);
+    }
+    case Tensor::ElementType::kInt8: {
+      const int8_t* data = view.buffer<int8_t>();
+      return std::vector<float>(data, data + num_elements);
+    }
+    default: {
+      const float* data = view.buffer<float>();
+      return std::vector<float>(data, data + num_elements);
+    }
+  }
+}
+
+void ExpectFusedMatchesOpenCv(
+    const Image& image, const RotatedRect& roi, BorderMode border_mode,
+    Tensor::ElementType tensor_type = Tensor::ElementType::kFloat32,
+    float range_min = -1.0f, float range_max = 1.0f) {
+  const Size output_dims{224, 192};
+  auto status_or_opencv =
+      CreateOpenCvConverter(nullptr, border_mode, tensor_type);
+  MP_ASSERT_OK(status_or_opencv.status());
+  auto status_or_fused =
+      CreateFusedConverter(nullptr, border_mode, tensor_type);
+  MP_ASSERT_OK(status_or_fused.status());
+
+  auto status_or_expected = status_or_opencv.value()->Convert(
+      image, roi, output_dims, range_min, range_max);
+  MP_ASSERT_OK(status_or_expected.status());
+  auto status_or_actual = status_or_fused.value()->Convert(
+      image, roi, output_dims, range_min, range_max);
+  MP_ASSERT_OK(status_or_actual.status());
+
+  const Tensor& expected = status_or_expected.value();
+  const Tensor& actual = status_or_actual.value();
+  ASSERT_EQ(expected.shape().dims, actual.shape().dims);
+  ASSERT_EQ(expected.element_type(), tensor_type);
+  ASSERT_EQ(actual.element_type(), tensor_type);
+  const std::vector<float> expected_values = GetValues(expected);
+  const std::vector<float> actual_values = GetValues(actual);
+  float max_difference = 0.0f;
+  for (size_t i = 0; i < expected_values.size(); ++i) {
+    max_difference = std::max(max_difference,
+                              std::abs(expected_values[i] - actual_values[i]));
+  }
+  // OpenCV interpolates with fixed-point weights and rounds to 8 bits before
+  // normalization; allow a few levels of the 8-bit input range.
+  EXPECT_LE(max_difference, 3.0f * (range_max - range_min) / 255.0f);
+}
+
+TEST(ImageToTensorConverterTest, FusedMatchesOpenCvInsideImage) {
+  const RotatedRect roi{/*center_x=*/320.0f, /*center_y=*/240.0f,
+                        /*width=*/300.0f, /*height=*/200.0f,
+                        /*rotation=*/0.0f};
+  ExpectFusedMatchesOpenCv(MakeGradientImage(ImageFormat::SRGB), roi,
+                           BorderMode::kReplicate);
+  ExpectFusedMatchesOpenCv(MakeGradientImage(ImageFormat::SRGBA), roi,
+                           BorderMode::kReplicate);
+}
+
+TEST(ImageToTensorConverterTest, FusedMatchesOpenCvWithRotation) {
+  const RotatedRect roi{/*center_x=*/300.0f, /*center_y=*/260.0f,
+                        /*width=*/250.0f, /*height=*/180.0f,
+                        /*rotation=*/0.6f};
+  ExpectFusedMatchesOpenCv(MakeGradientImage(ImageFormat::SRGB), roi,
+                           BorderMode::kReplicate);
+  ExpectFusedMatchesOpenCv(MakeGradientImage(ImageFormat::SRGBA), roi,
+                           BorderMode::kZero);
+}
+
+TEST(ImageToTensorConverterTest, FusedMatchesOpenCvOutsideImage) {
+  const RotatedRect roi{/*center_x=*/40.0f, /*center_y=*/450.0f,
+                        /*width=*/400.0f, /*height=*/300.0f,
+                        /*rotation=*/-1.2f};
+  ExpectFusedMatchesOpenCv(MakeGradientImage(ImageFormat::SRGB), roi,
+                           BorderMode::kReplicate);
+  ExpectFusedMatchesOpenCv(MakeGradientImage(ImageFormat::SRGB), roi,
+                           BorderMode::kZero);
+}
+
+TEST(ImageToTensorConverterTest, FusedMatchesOpenCvQuantized) {
+  const RotatedRect roi{/*center_x=*/300.0f, /*center_y=*/260.0f,
+                        /*width=*/250.0f, /*height=*/180.0f,
+                        /*rotation=*/0.6f};
+  ExpectFusedMatchesOpenCv(MakeGradientImage(ImageFormat::SRGB), roi,
+                           BorderMode::kReplicate,
+                           Tensor::ElementType::kUInt8, 0.0f, 255.0f);
+  ExpectFusedMatchesOpenCv(MakeGradientImage(ImageFormat::SRGBA), roi,
+                           BorderMode::kZero, Tensor::ElementType::kInt8,
+                           -128.0f, 127.0f);
+}
+
+TEST(ImageToTensorConverterTest, QuantizedOutputSaturates) {
+  const Image image = MakeGradientImage(ImageFormat::SRGB);
+  const RotatedRect roi{/*center_x=*/320.0f, /*center_y=*/240.0f,
+                        /*width=*/640.0f, /*height=*/480.0f,
+                        /*rotation=*/0.0f};
+  auto status_or_converter = CreateFusedConverter(
+      nullptr, BorderMode::kReplicate, Tensor::ElementType::kInt8);
+  MP_ASSERT_OK(status_or_converter.status());
+  // A range wider than int8 saturates the darkest and brightest pixels.
+  auto status_or_tensor = status_or_converter.value()->Convert(
+      image, roi, Size{64, 48}, -200.0f, 200.0f);
+  MP_ASSERT_OK(status_or_tensor.status());
+  const std::vector<float> values = GetValues(status_or_tensor.value());
+  EXPECT_EQ(*std::min_element(values.begin(), values.end()), -128.0f);
+  EXPECT_EQ(*std::max_element(values.begin(), values.end()), 127.0f);
+}
+
+TEST(ImageToTensorConverterTest, FusedConvertsIntoBatch) {
+  const Image image = MakeGradientImage(ImageFormat::SRGB);
+  auto status_or_converter = CreateFusedConverter(
+      nullptr, BorderMode::kReplicate, Tensor::ElementType::kFloat32);
+  MP_ASSERT_OK(status_or_converter.status());
+  ImageToTensorConverter& converter = *status_or_converter.value();
+  const RotatedRect roi{/*center_x=*/200.0f, /*center_y=*/100.0f,
+                        /*width=*/128.0f, /*height=*/128.0f,
+                        /*rotation=*/0.3f};
+
+  Tensor batch(Tensor::ElementType::kFloat32, Tensor::Shape{2, 64, 64, 3});
+  MP_ASSERT_OK(converter.ConvertToBatch(image, roi, 0.0f, 1.0f,
+                                        /*batch_index=*/1, &batch));
+  auto status_or_single =
+      converter.Convert(image, roi, Size{64, 64}, 0.0f, 1.0f);
+  MP_ASSERT_OK(status_or_single.status());
+
+  auto batch_view = batch.GetCpuReadView();
+  auto single_view = status_or_single.value().GetCpuReadView();
+  const float* batch_data = batch_view.buffer<float>() + 64 * 64 * 3;
+  const float* single_data = single_view.buffer<float>();
+  for (int i = 0; i < 64 * 64 * 3; ++i) {
+    ASSERT_EQ(single_data[i], batch_data[i]) << "at " << i;
+  }
+}
+
+TEST(ImageToTensorConverterTest, FusedRejectsGrayImage) {
+  auto status_or_converter = CreateFusedConverter(
+      nullptr, BorderMode::kReplicate, Tensor::ElementType::kFloat32);
+  MP_ASSERT_OK(status_or_converter.status());
+  const Image image(std::make_shared<ImageFrame>(ImageFormat::GRAY8, 16, 16));
+  const RotatedRect roi{8.0f, 8.0f, 16.0f, 16.0f, 0.0f};
+  EXPECT_FALSE(
+      status_or_converter.value()->Convert(image, roi, Size{8, 8}, 0.0f, 1.0f)
+          .ok());
+}
+
+// Converts a rotated hand-sized region of a 640x480 frame into a square tensor
+// of the benchmark argument size, as for landmark models. Quantized tensors
+// use the uint8 range of the input image.
+void RunConverterBenchmark(benchmark::State& state,
+                           std::unique_ptr<ImageToTensorConverter> converter,
+                           Tensor::ElementType tensor_type) {
+  const Image image = MakeGradientImage(ImageFormat::SRGB);
+  const RotatedRect roi{/*center_x=*/300.0f, /*center_y=*/220.0f,
+                        /*width=*/180.0f, /*height=*/180.0f,
+                        /*rotation=*/0.4f};
+  const int size = state.range(0);
+  const float range_max =
+      tensor_type == Tensor::ElementType::kFloat32 ? 1.0f : 255.0f;
+  Tensor tensor(tensor_type, Tensor::Shape{1, size, size, 3});
+  for (auto _ : state) {
+    MEDIAPIPE_CHECK_OK(converter->ConvertToBatch(image, roi, 0.0f, range_max,
+                                                 /*batch_index=*/0, &tensor));
+  }
+}
+
+void BM_OpenCvConverter(benchmark::State& state) {
+  constexpr auto kType = Tensor::ElementType::kFloat32;
+  RunConverterBenchmark(
+      state,
+      CreateOpenCvConverter(nullptr, BorderMode::kReplicate, kType).value(),
+      kType);
+}
+BENCHMARK(BM_OpenCvConverter)
+    ->Arg(128)
+    ->Arg(192)
+    ->Arg(224)
+    ->Arg(256)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_FusedConverter(benchmark::State& state) {
+  constexpr auto kType = Tensor::ElementType::kFloat32;
+  RunConverterBenchmark(
+      state,
+      CreateFusedConverter(nullptr, BorderMode::kReplicate, kType).value(),
+      kType);
+}
+BENCHMARK(BM_FusedConverter)
+    ->Arg(128)
+    ->Arg(192)
+    ->Arg(224)
+    ->Arg(256)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_OpenCvConverterUInt8(benchmark::State& state) {
+  constexpr auto kType = Tensor::ElementType::kUInt8;
+  RunConverterBenchmark(
+      state,
+      CreateOpenCvConverter(nullptr, BorderMode::kReplicate, kType).value(),
+      kType);
+}
+BENCHMARK(BM_OpenCvConverterUInt8)
+    ->Arg(224)
+    ->Arg(256)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_FusedConverterUInt8(benchmark::State& state) {
+  constexpr auto kType = Tensor::ElementType::kUInt8;
+  RunConverterBenchmark(
+      state,
+      CreateFusedConverter(nullptr, BorderMode::kReplicate, kType).value(),
+      kType);
+}
+BENCHMARK(BM_FusedConverterUInt8)
+    ->Arg(224)
+    ->Arg(256)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace mediapipe
@@ -59,12 +59,20 @@ absl::StatusOr<Packet<TfLiteModelPtr>> InferenceCalculator::GetModelAsPacket(
     CalculatorContext* cc) {
   const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
   if (!options.model_path().empty()) {
-    return TfLiteModelLoader::LoadFromPath(options.model_path());
+    return GetModelAsPacket(cc, options.model_path());
   }
   if (!kSideInModel(cc).IsEmpty()) return kSideInModel(cc);
   return absl::Status(mediapipe::StatusCode::kNotFound,
                       "Must specify TFLite model as path or loaded model.");
 }
 
+absl::StatusOr<Packet<TfLiteModelPtr>> InferenceCalculator::GetModelAsPacket(
+    CalculatorContext* cc, const std::string& model_path) {
+  auto registry = cc->Service(kTfLiteModelRegistryService);
+  return registry.IsAvailable()
+             ? registry.GetObject().GetModel(model_path)
+             : TfLiteModelRegistry::GetDefault()->GetModel(model_path);
+}
+
 }  // namespace api2
 }  // namespace mediapipe
@@ -27,6 +27,7 @@
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/tflite/tflite_model_loader.h"
+#include "mediapipe/util/tflite/tflite_model_registry.h"
 #include "tensorflow/lite/error_reporter.h"
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/kernels/register.h"
@@ -48,11 +49,25 @@ namespace api2 {
 // When the input tensors are on GPU, inference is GPU and output can be CPU or
 // GPU.
 //
+// On CPU, the model inputs are resized to the shapes of the input tensors, so
+// a batch of N inputs (e.g. [N, 224, 224, 3] from ImageToTensorCalculator with
+// NORM_RECTS) runs in a single invocation and yields outputs with batch size
+// N.  Models that cannot be resized run the batch one element at a time and
+// still yield batched outputs.  Unless a delegate owns the model inputs and
+// outputs, the interpreter reads the input Tensors and writes the output
+// Tensors directly, without copies.
+//
 // Input:
 //  TENSORS - Vector of Tensors
 //
 // Output:
 //  TENSORS - Vector of Tensors
+//  MODEL_VARIANT (optional) - int, the index of the model variant run on CPU
+//                             with a latency budget: 0 for model_path or the
+//                             MODEL side packet, then i + 1 for
+//                             latency_budget.variant_model_path(i). Emitted
+//                             at the first invocation and whenever the
+//                             variant changes.
 //
 // Input side packet:
 //  CUSTOM_OP_RESOLVER (optional) - Use a custom op resolver,
@@ -91,6 +106,12 @@ namespace api2 {
 // IMPORTANT Notes:
 //  Tensors are assumed to be ordered correctly (sequentially added to model).
 //  Input tensors are assumed to be of the correct size and already normalized.
+//  Models loaded from model_path are shared with the other calculators using
+//  the same TfLiteModelRegistry (see kTfLiteModelRegistryService).
+//  On CPU, latency_budget switches between the model and faster variants of
+//  it, e.g. full and lite, to keep the average invocation latency within a
+//  target.  Switches also appear as MODEL_SWITCH events in the profiler
+//  trace.
 
 class InferenceCalculator : public NodeIntf {
  public:
@@ -99,15 +120,24 @@ class InferenceCalculator : public NodeIntf {
       kSideInCustomOpResolver{"CUSTOM_OP_RESOLVER"};
   static constexpr SideInput<TfLiteModelPtr>::Optional kSideInModel{"MODEL"};
   static constexpr Output<std::vector<Tensor>> kOutTensors{"TENSORS"};
+  static constexpr Output<int>::Optional kOutModelVariant{"MODEL_VARIANT"};
   MEDIAPIPE_NODE_CONTRACT(kInTensors, kSideInCustomOpResolver, kSideInModel,
-                          kOutTensors);
+                          kOutTensors, kOutModelVariant);
 
  protected:
   using TfLiteDelegatePtr =
       std::unique_ptr<TfLiteDelegate, std::function<void(TfLiteDelegate*)>>;
 
+  // Requests the services used by GetModelAsPacket().
+  static void UseModelServices(CalculatorContract* cc) {
+    cc->UseService(kTfLiteModelRegistryService).Optional();
+  }
+
   absl::StatusOr<Packet<TfLiteModelPtr>> GetModelAsPacket(
       CalculatorContext* cc);
+  // Returns the model loaded from |model_path| through the model registry.
+  absl::StatusOr<Packet<TfLiteModelPtr>> GetModelAsPacket(
+      CalculatorContext* cc, const std::string& model_path);
 };
 
 struct InferenceCalculatorSelector : public InferenceCalculator {
@@ -12,13 +12,21 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "mediapipe/calculators/tensor/inference_calculator.h"
+#include "mediapipe/calculators/tensor/model_variant_selector.h"
+#include "mediapipe/framework/mediapipe_profiling.h"
+#include "mediapipe/framework/port/logging.h"
 
 #if defined(MEDIAPIPE_ANDROID)
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
@@ -51,6 +59,114 @@ int GetXnnpackNumThreads(const mediapipe::InferenceCalculatorOptions& opts) {
 #endif  // !__EMSCRIPTEN__ || __EMSCRIPTEN_PTHREADS__
 }
 
+// Returns the dimensions of a TfLiteTensor.
+std::vector<int> TfLiteDims(const TfLiteTensor* tensor) {
+  return std::vector<int>(tensor->dims->data,
+                          tensor->dims->data + tensor->dims->size);
+}
+
+// Returns the element type of the Tensors which hold the values of a
+// TfLiteTensor. Types without an equivalent are held in float Tensors, as all
+// types were before quantized types were supported.
+Tensor::ElementType GetElementType(const TfLiteTensor* tensor) {
+  switch (tensor->type) {
+    case kTfLiteUInt8:
+      return Tensor::ElementType::kUInt8;
+    case kTfLiteInt8:
+      return Tensor::ElementType::kInt8;
+    default:
+      return Tensor::ElementType::kFloat32;
+  }
+}
+
+// Returns the per-tensor affine quantization of a TfLiteTensor, which is
+// scale 1 and zero point 0 for float tensors.
+Tensor::QuantizationParameters GetQuantizationParameters(
+    const TfLiteTensor* tensor) {
+  if (tensor->type != kTfLiteUInt8 && tensor->type != kTfLiteInt8) {
+    return Tensor::QuantizationParameters();
+  }
+  return Tensor::QuantizationParameters(tensor->params.scale,
+                                        tensor->params.zero_point);
+}
+
+// Returns true if all inputs and outputs of |interpreter| are float, uint8 or
+// int8 tensors in the TfLite arena, which can be replaced by the buffers of
+// Tensors.
+bool CanBindTensors(const tflite::Interpreter& interpreter) {
+  for (const auto* indexes : {&interpreter.inputs(), &interpreter.outputs()}) {
+    for (int index : *indexes) {
+      const TfLiteTensor* tensor = interpreter.tensor(index);
+      if ((tensor->type != kTfLiteFloat32 && tensor->type != kTfLiteUInt8 &&
+           tensor->type != kTfLiteInt8) ||
+          tensor->allocation_type != kTfLiteArenaRw ||
+          tensor->dims->size == 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+using TfLiteDelegatePtr =
+    std::unique_ptr<TfLiteDelegate, std::function<void(TfLiteDelegate*)>>;
+
+// Runs one TfLite model on CPU, with its interpreter and delegate.
+class InterpreterRunner {
+ public:
+  // Creates the interpreter of the model and applies the delegate of the
+  // calculator options.
+  absl::Status Open(CalculatorContext* cc, Packet<TfLiteModelPtr> model_packet);
+  // Runs the model on |input_tensors| and appends the results to
+  // |output_tensors|.
+  absl::Status Run(const std::vector<Tensor>& input_tensors,
+                   std::vector<Tensor>* output_tensors);
+
+ private:
+  absl::Status LoadModel(CalculatorContext* cc);
+  absl::Status LoadDelegate(CalculatorContext* cc);
+  // Resizes the interpreter inputs to the shapes of |input_tensors|, e.g. to
+  // run all ROIs of a frame as one batch.  Models which cannot be resized
+  // along the batch dimension run the batch one element at a time.
+  absl::Status ResizeInputs(const std::vector<Tensor>& input_tensors);
+  // Resizes the interpreter inputs, and checks that all outputs have
+  // |batch_size| as leading dimension if it is larger than 1.  Restores the
+  // model input shapes on failure.
+  absl::Status ResizeInterpreterInputs(
+      const std::vector<std::vector<int>>& shapes, int batch_size);
+  // Invokes the interpreter on |input_tensors|, or on their |batch_index|
+  // slice when running the batch one element at a time, and appends the
+  // results to |output_tensors|.
+  absl::Status Invoke(const std::vector<Tensor>& input_tensors,
+                      int batch_index, std::vector<Tensor>* output_tensors);
+  // Makes the interpreter use |data| as the buffer of tensor |tensor_index|.
+  absl::Status BindTensor(int tensor_index, const void* data, size_t bytes);
+  // Binds buffers large enough for the given input shapes and batch size.
+  // Resizing checks the bound buffers against the new tensor sizes, and the
+  // buffers of the last Invoke() may be too small or released.
+  absl::Status BindResizeBuffers(const std::vector<std::vector<int>>& shapes,
+                                 int batch_size);
+
+  // TfLite requires us to keep the model alive as long as the interpreter is.
+  Packet<TfLiteModelPtr> model_packet_;
+  std::unique_ptr<tflite::Interpreter> interpreter_;
+  TfLiteDelegatePtr delegate_;
+  // The input shapes of the loaded model.
+  std::vector<std::vector<int>> model_input_shapes_;
+  // The batch size of the current input when it exceeds the model batch
+  // size and the model cannot be resized, or 1.
+  int split_batch_size_ = 1;
+  // Set once a model failed to resize to a larger batch.
+  bool batch_resize_failed_ = false;
+  // The output sizes of the loaded model.
+  std::vector<size_t> model_output_bytes_;
+  // If set, the interpreter reads the input Tensors and writes the output
+  // Tensors in place instead of its own buffers, saving two copies.
+  bool bind_tensors_ = false;
+  // The buffers bound while resizing the interpreter.
+  std::vector<Tensor> resize_buffers_;
+};
+
 }  // namespace
 
 class InferenceCalculatorCpuImpl
@@ -63,13 +179,13 @@ class InferenceCalculatorCpuImpl
   absl::Status Close(CalculatorContext* cc) override;
 
  private:
-  absl::Status LoadModel(CalculatorContext* cc);
-  absl::Status LoadDelegate(CalculatorContext* cc);
-
-  // TfLite requires us to keep the model alive as long as the interpreter is.
-  Packet<TfLiteModelPtr> model_packet_;
-  std::unique_ptr<tflite::Interpreter> interpreter_;
-  TfLiteDelegatePtr delegate_;
+  // The runners of the model and of its latency budget variants, from the
+  // most accurate to the fastest.
+  std::vector<std::unique_ptr<InterpreterRunner>> runners_;
+  // Selects the variant to run with a latency budget.
+  std::unique_ptr<ModelVariantSelector> variant_selector_;
+  // The variant of the last invocation, or -1 before the first one.
+  int last_variant_ = -1;
 };
 
 absl::Status InferenceCalculatorCpuImpl::UpdateContract(
@@ -77,13 +193,36 @@ absl::Status InferenceCalculatorCpuImpl::UpdateContract(
   const auto& options = cc->Options<::mediapipe::InferenceCalculatorOptions>();
   RET_CHECK(!options.model_path().empty() ^ kSideInModel(cc).IsConnected())
       << "Either model as side packet or model path in options is required.";
+  if (options.has_latency_budget()) {
+    RET_CHECK_GT(options.latency_budget().target_latency_us(), 0);
+    RET_CHECK_GT(options.latency_budget().window_size(), 0);
+    const float fraction = options.latency_budget().upgrade_latency_fraction();
+    RET_CHECK(fraction > 0 && fraction < 1)
+        << "upgrade_latency_fraction must be in (0, 1).";
+  }
+  UseModelServices(cc);
 
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorCpuImpl::Open(CalculatorContext* cc) {
-  MP_RETURN_IF_ERROR(LoadModel(cc));
-  MP_RETURN_IF_ERROR(LoadDelegate(cc));
+  ASSIGN_OR_RETURN(auto model_packet, GetModelAsPacket(cc));
+  runners_.push_back(absl::make_unique<InterpreterRunner>());
+  MP_RETURN_IF_ERROR(runners_.back()->Open(cc, std::move(model_packet)));
+
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  if (options.has_latency_budget()) {
+    const auto& budget = options.latency_budget();
+    for (const auto& model_path : budget.variant_model_path()) {
+      ASSIGN_OR_RETURN(auto variant_packet, GetModelAsPacket(cc, model_path));
+      runners_.push_back(absl::make_unique<InterpreterRunner>());
+      MP_RETURN_IF_ERROR(runners_.back()->Open(cc, std::move(variant_packet)));
+    }
+    variant_selector_ = absl::make_unique<ModelVariantSelector>(
+        static_cast<int>(runners_.size()),
+        absl::Microseconds(budget.target_latency_us()),
+        budget.window_size(), budget.upgrade_latency_fraction());
+  }
   return absl::OkStatus();
 }
 
@@ -93,49 +232,278 @@ absl::Status InferenceCalculatorCpuImpl::Process(CalculatorContext* cc) {
   }
   const auto& input_tensors = *kInTensors(cc);
   RET_CHECK(!input_tensors.empty());
+
+  // The variant only changes between invocations, i.e. at frame boundaries.
+  const int variant = variant_selector_ ? variant_selector_->variant() : 0;
+  if (variant != last_variant_) {
+    if (last_variant_ >= 0) {
+      VLOG(1) << "Switching from model variant " << last_variant_ << " to "
+              << variant << ", average latency: "
+              << variant_selector_->average_latency();
+      cc->GetCounter("ModelVariantSwitches")->Increment();
+      LogEvent(cc->GetProfilingContext(),
+               TraceEvent(TraceEvent::MODEL_SWITCH)
+                   .set_node_id(cc->NodeId())
+                   .set_input_ts(cc->InputTimestamp())
+                   .set_event_data(variant));
+    }
+    kOutModelVariant(cc).Send(variant);
+    last_variant_ = variant;
+  }
+
   auto output_tensors = absl::make_unique<std::vector<Tensor>>();
+  const absl::Time start_time = absl::Now();
+  MP_RETURN_IF_ERROR(
+      runners_[variant]->Run(input_tensors, output_tensors.get()));
+  if (variant_selector_) {
+    variant_selector_->AddLatency(absl::Now() - start_time);
+  }
+  kOutTensors(cc).Send(std::move(output_tensors));
+  return absl::OkStatus();
+}
+
+absl::Status InferenceCalculatorCpuImpl::Close(CalculatorContext* cc) {
+  runners_.clear();
+  return absl::OkStatus();
+}
+
+namespace {
+
+absl::Status InterpreterRunner::Open(CalculatorContext* cc,
+                                     Packet<TfLiteModelPtr> model_packet) {
+  model_packet_ = std::move(model_packet);
+  MP_RETURN_IF_ERROR(LoadModel(cc));
+  MP_RETURN_IF_ERROR(LoadDelegate(cc));
+  // Delegates may take over the buffers of the inputs and outputs, in which
+  // case they are copied.
+  bind_tensors_ = CanBindTensors(*interpreter_);
+  return absl::OkStatus();
+}
+
+absl::Status InterpreterRunner::Run(const std::vector<Tensor>& input_tensors,
+                                    std::vector<Tensor>* output_tensors) {
+  RET_CHECK_EQ(input_tensors.size(), interpreter_->inputs().size());
+  MP_RETURN_IF_ERROR(ResizeInputs(input_tensors));
 
-  // Read CPU input into tensors.
+  // Run inference once, or once per batch element.
+  if (split_batch_size_ == 1) {
+    return Invoke(input_tensors, 0, output_tensors);
+  }
+  for (int b = 0; b < split_batch_size_; ++b) {
+    std::vector<Tensor> element_tensors;
+    MP_RETURN_IF_ERROR(Invoke(input_tensors, b, &element_tensors));
+
+    // The outputs of a split batch are concatenated along the batch
+    // dimension.
+    for (int i = 0; i < element_tensors.size(); ++i) {
+      const Tensor& element_tensor = element_tensors[i];
+      if (b == 0) {
+        std::vector<int> dims = element_tensor.shape().dims;
+        RET_CHECK(!dims.empty() && dims[0] == 1)
+            << "Split batches require a leading output batch dimension.";
+        dims[0] = split_batch_size_;
+        output_tensors->emplace_back(element_tensor.element_type(),
+                                     Tensor::Shape{dims},
+                                     element_tensor.quantization_parameters());
+      }
+      auto element_view = element_tensor.GetCpuReadView();
+      auto cpu_view = (*output_tensors)[i].GetCpuWriteView();
+      std::memcpy(cpu_view.buffer<char>() + b * element_tensor.bytes(),
+                  element_view.buffer<char>(), element_tensor.bytes());
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InterpreterRunner::Invoke(
+    const std::vector<Tensor>& input_tensors, int batch_index,
+    std::vector<Tensor>* output_tensors) {
+  // The views keep the input buffers locked until the inference is done.
+  std::vector<Tensor::CpuReadView> input_views;
+  input_views.reserve(input_tensors.size());
+  // Copies of input slices which are not aligned for binding.
+  std::vector<Tensor> aligned_inputs;
+  aligned_inputs.reserve(input_tensors.size());
   for (int i = 0; i < input_tensors.size(); ++i) {
     const Tensor* input_tensor = &input_tensors[i];
-    auto input_tensor_view = input_tensor->GetCpuReadView();
-    auto input_tensor_buffer = input_tensor_view.buffer<float>();
-    float* local_tensor_buffer = interpreter_->typed_input_tensor<float>(i);
-    std::memcpy(local_tensor_buffer, input_tensor_buffer,
-                input_tensor->bytes());
+    const TfLiteTensor* model_input = interpreter_->input_tensor(i);
+    RET_CHECK(input_tensor->element_type() == GetElementType(model_input))
+        << "Input tensor " << i << " does not match the model input type.";
+    const int bytes = input_tensor->bytes() / split_batch_size_;
+    RET_CHECK_EQ(bytes, static_cast<int>(model_input->bytes))
+        << "Input tensor " << i << " does not match the model input size.";
+    input_views.push_back(input_tensor->GetCpuReadView());
+    const char* input_buffer =
+        input_views.back().buffer<char>() + batch_index * bytes;
+    if (!bind_tensors_) {
+      std::memcpy(model_input->data.raw, input_buffer, bytes);
+      continue;
+    }
+    if (reinterpret_cast<uintptr_t>(input_buffer) %
+            Tensor::kCpuBufferAlignment !=
+        0) {
+      aligned_inputs.emplace_back(Tensor::ElementType::kUInt8,
+                                  Tensor::Shape{bytes});
+      auto aligned_view = aligned_inputs.back().GetCpuWriteView();
+      std::memcpy(aligned_view.buffer<char>(), input_buffer, bytes);
+      input_buffer = aligned_view.buffer<char>();
+    }
+    MP_RETURN_IF_ERROR(
+        BindTensor(interpreter_->inputs()[i], input_buffer, bytes));
+  }
+
+  // The output Tensors are allocated up front, so that the interpreter can
+  // write into them.
+  const auto& tensor_indexes = interpreter_->outputs();
+  output_tensors->reserve(output_tensors->size() + tensor_indexes.size());
+  for (int i = 0; i < tensor_indexes.size(); ++i) {
+    const TfLiteTensor* tensor = interpreter_->tensor(tensor_indexes[i]);
+    output_tensors->emplace_back(GetElementType(tensor),
+                                 Tensor::Shape{TfLiteDims(tensor)},
+                                 GetQuantizationParameters(tensor));
+    RET_CHECK_EQ(output_tensors->back().bytes(),
+                 static_cast<int>(tensor->bytes))
+        << "Unsupported type of output tensor " << i << ".";
+    if (bind_tensors_) {
+      auto cpu_view = output_tensors->back().GetCpuWriteView();
+      MP_RETURN_IF_ERROR(BindTensor(
+          tensor_indexes[i], cpu_view.buffer<void>(), tensor->bytes));
+    }
+  }
+  if (bind_tensors_) {
+    // Verifies the bound buffers, without reallocating the interpreter.
+    RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
   }
 
   // Run inference.
   RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
 
   // Output result tensors (CPU).
-  const auto& tensor_indexes = interpreter_->outputs();
-  output_tensors->reserve(tensor_indexes.size());
-  for (int i = 0; i < tensor_indexes.size(); ++i) {
-    TfLiteTensor* tensor = interpreter_->tensor(tensor_indexes[i]);
-    output_tensors->emplace_back(
-        Tensor::ElementType::kFloat32,
-        Tensor::Shape{std::vector<int>{
-            tensor->dims->data, tensor->dims->data + tensor->dims->size}});
-    auto cpu_view = output_tensors->back().GetCpuWriteView();
-    std::memcpy(cpu_view.buffer<float>(), tensor->data.f,
-                output_tensors->back().bytes());
+  if (!bind_tensors_) {
+    for (int i = 0; i < tensor_indexes.size(); ++i) {
+      const TfLiteTensor* tensor = interpreter_->tensor(tensor_indexes[i]);
+      Tensor& output_tensor =
+          (*output_tensors)[output_tensors->size() - tensor_indexes.size() + i];
+      auto cpu_view = output_tensor.GetCpuWriteView();
+      std::memcpy(cpu_view.buffer<char>(), tensor->data.raw, tensor->bytes);
+    }
   }
-  kOutTensors(cc).Send(std::move(output_tensors));
   return absl::OkStatus();
 }
 
-absl::Status InferenceCalculatorCpuImpl::Close(CalculatorContext* cc) {
-  interpreter_ = nullptr;
-  delegate_ = nullptr;
+absl::Status InterpreterRunner::BindTensor(int tensor_index, const void* data,
+                                           size_t bytes) {
+  // TfLite only reads the input buffers.
+  TfLiteCustomAllocation allocation{const_cast<void*>(data), bytes};
+  RET_CHECK_EQ(
+      interpreter_->SetCustomAllocationForTensor(tensor_index, allocation),
+      kTfLiteOk);
+  return absl::OkStatus();
+}
+
+absl::Status InterpreterRunner::BindResizeBuffers(
+    const std::vector<std::vector<int>>& shapes, int batch_size) {
+  resize_buffers_.clear();
+  resize_buffers_.reserve(shapes.size() + model_output_bytes_.size());
+  for (int i = 0; i < shapes.size(); ++i) {
+    resize_buffers_.emplace_back(GetElementType(interpreter_->input_tensor(i)),
+                                 Tensor::Shape{shapes[i]});
+    auto cpu_view = resize_buffers_.back().GetCpuWriteView();
+    MP_RETURN_IF_ERROR(BindTensor(interpreter_->inputs()[i],
+                                  cpu_view.buffer<void>(),
+                                  resize_buffers_.back().bytes()));
+  }
+  // Outputs that do not grow with the batch size fail the resize anyway.
+  for (int i = 0; i < model_output_bytes_.size(); ++i) {
+    const int bytes = model_output_bytes_[i] * std::max(batch_size, 1);
+    resize_buffers_.emplace_back(Tensor::ElementType::kUInt8,
+                                 Tensor::Shape{bytes});
+    auto cpu_view = resize_buffers_.back().GetCpuWriteView();
+    MP_RETURN_IF_ERROR(BindTensor(interpreter_->outputs()[i],
+                                  cpu_view.buffer<void>(),
+                                  resize_buffers_.back().bytes()));
+  }
   return absl::OkStatus();
 }
 
-absl::Status InferenceCalculatorCpuImpl::LoadModel(CalculatorContext* cc) {
-  ASSIGN_OR_RETURN(model_packet_, GetModelAsPacket(cc));
+absl::Status InterpreterRunner::ResizeInputs(
+    const std::vector<Tensor>& input_tensors) {
+  std::vector<std::vector<int>> shapes;
+  for (const Tensor& tensor : input_tensors) {
+    shapes.push_back(tensor.shape().dims);
+  }
+
+  // A batch larger than the model batch size is split if the model failed
+  // to resize before.
+  int batch_size = shapes[0].empty() ? 1 : shapes[0][0];
+  split_batch_size_ = 1;
+  if (batch_resize_failed_ && batch_size > 1) {
+    for (auto& shape : shapes) {
+      RET_CHECK(!shape.empty() && shape[0] == batch_size)
+          << "All input tensors must have the same batch size.";
+      shape[0] = 1;
+    }
+    split_batch_size_ = batch_size;
+  }
+
+  bool needs_resize = false;
+  for (int i = 0; i < shapes.size(); ++i) {
+    if (shapes[i] != TfLiteDims(interpreter_->input_tensor(i))) {
+      needs_resize = true;
+    }
+  }
+  if (!needs_resize) {
+    return absl::OkStatus();
+  }
+  absl::Status status =
+      ResizeInterpreterInputs(shapes, split_batch_size_ > 1 ? 1 : batch_size);
+  if (status.ok() || split_batch_size_ > 1 || batch_size <= 1) {
+    return status;
+  }
+
+  // The model has a fixed batch size, e.g. because of a constant reshape.
+  LOG(WARNING) << "Model cannot run a batch of " << batch_size
+               << ", running the batch one element at a time: " << status;
+  batch_resize_failed_ = true;
+  return ResizeInputs(input_tensors);
+}
+
+absl::Status InterpreterRunner::ResizeInterpreterInputs(
+    const std::vector<std::vector<int>>& shapes, int batch_size) {
+  for (int i = 0; i < shapes.size(); ++i) {
+    RET_CHECK_EQ(interpreter_->ResizeInputTensor(interpreter_->inputs()[i],
+                                                 shapes[i]),
+                 kTfLiteOk);
+  }
+  if (bind_tensors_) {
+    MP_RETURN_IF_ERROR(BindResizeBuffers(shapes, batch_size));
+  }
+  bool resized = interpreter_->AllocateTensors() == kTfLiteOk;
+  if (resized && batch_size > 1) {
+    for (int i = 0; i < interpreter_->outputs().size(); ++i) {
+      std::vector<int> dims = TfLiteDims(interpreter_->output_tensor(i));
+      resized &= !dims.empty() && dims[0] == batch_size;
+    }
+  }
+  if (resized) {
+    return absl::OkStatus();
+  }
+  // Restore the model shapes, which are known to work.
+  for (int i = 0; i < model_input_shapes_.size(); ++i) {
+    interpreter_->ResizeInputTensor(interpreter_->inputs()[i],
+                                    model_input_shapes_[i]);
+  }
+  if (bind_tensors_) {
+    MP_RETURN_IF_ERROR(BindResizeBuffers(model_input_shapes_, 1));
+  }
+  RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  return absl::InvalidArgumentError("Failed to resize the model inputs.");
+}
+
+absl::Status InterpreterRunner::LoadModel(CalculatorContext* cc) {
   const auto& model = *model_packet_.Get();
   tflite::ops::builtin::BuiltinOpResolver op_resolver =
-      kSideInCustomOpResolver(cc).GetOr(
+      InferenceCalculator::kSideInCustomOpResolver(cc).GetOr(
           tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates());
 
   tflite::InterpreterBuilder(model, op_resolver)(&interpreter_);
@@ -149,14 +517,16 @@ absl::Status InferenceCalculatorCpuImpl::LoadModel(CalculatorContext* cc) {
 #endif  // __EMSCRIPTEN__
 
   RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
-  // TODO: Support quantized tensors.
-  CHECK(interpreter_->tensor(interpreter_->inputs()[0])->quantization.type !=
-        kTfLiteAffineQuantization);
-
+  for (int i = 0; i < interpreter_->inputs().size(); ++i) {
+    model_input_shapes_.push_back(TfLiteDims(interpreter_->input_tensor(i)));
+  }
+  for (int i = 0; i < interpreter_->outputs().size(); ++i) {
+    model_output_bytes_.push_back(interpreter_->output_tensor(i)->bytes);
+  }
   return absl::OkStatus();
 }
 
-absl::Status InferenceCalculatorCpuImpl::LoadDelegate(CalculatorContext* cc) {
+absl::Status InterpreterRunner::LoadDelegate(CalculatorContext* cc) {
   const auto& calculator_opts =
       cc->Options<mediapipe::InferenceCalculatorOptions>();
   if (calculator_opts.has_delegate() &&
@@ -201,5 +571,7 @@ absl::Status InferenceCalculatorCpuImpl::LoadDelegate(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
+}  // namespace
+
 }  // namespace api2
 }  // namespace mediapipe
@@ -116,6 +116,7 @@ absl::Status InferenceCalculatorMetalImpl::UpdateContract(
   const auto& options = cc->Options<::mediapipe::InferenceCalculatorOptions>();
   RET_CHECK(!options.model_path().empty() ^ kSideInModel(cc).IsConnected())
       << "Either model as side packet or model path in options is required.";
+  UseModelServices(cc);
 
   MP_RETURN_IF_ERROR([MPPMetalHelper updateContract:cc]);
   return absl::OkStatus();
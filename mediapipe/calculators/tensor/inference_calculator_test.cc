@@ -159,4 +159,58 @@ TEST(InferenceCalculatorTest, SmokeTest_ModelAsInputSidePacket) {
   DoSmokeTest(graph_proto);
 }
 
+// Tests that a batch of inputs runs in one invocation of the add model,
+// whose batch size is resized from 1.
+TEST(InferenceCalculatorTest, BatchedInput) {
+  constexpr int kBatchSize = 4;
+  constexpr int kTensorSize = 8 * 8 * 3;
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "tensor_in"
+        node {
+          calculator: "InferenceCalculator"
+          input_stream: "TENSORS:tensor_in"
+          output_stream: "TENSORS:tensor_out"
+          options {
+            [mediapipe.InferenceCalculatorOptions.ext] {
+              model_path: "mediapipe/calculators/tensor/testdata/add.bin"
+              delegate { tflite {} }
+            }
+          }
+        }
+      )");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  for (int batch_size : {kBatchSize, 1}) {
+    auto input_vec = absl::make_unique<std::vector<Tensor>>();
+    input_vec->emplace_back(Tensor::ElementType::kFloat32,
+                            Tensor::Shape{batch_size, 8, 8, 3});
+    {
+      auto view = input_vec->back().GetCpuWriteView();
+      for (int i = 0; i < batch_size * kTensorSize; ++i) {
+        view.buffer<float>()[i] = 1;
+      }
+    }
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in",
+        Adopt(input_vec.release()).At(Timestamp(output_packets.size()))));
+    MP_ASSERT_OK(graph.WaitUntilIdle());
+    ASSERT_FALSE(output_packets.empty());
+    const auto& result_vec = output_packets.back().Get<std::vector<Tensor>>();
+    ASSERT_EQ(1, result_vec.size());
+    EXPECT_EQ(std::vector<int>({batch_size, 8, 8, 3}),
+              result_vec[0].shape().dims);
+    auto view = result_vec[0].GetCpuReadView();
+    for (int i = 0; i < batch_size * kTensorSize; ++i) {
+      ASSERT_EQ(3, view.buffer<float>()[i]);
+    }
+  }
+
+  MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 }  // namespace mediapipe
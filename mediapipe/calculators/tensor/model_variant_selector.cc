@@ -0,0 +1,72 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/model_variant_selector.h"
+
+#include <algorithm>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+ModelVariantSelector::ModelVariantSelector(int num_variants,
+                                           absl::Duration target_latency,
+                                           int window_size,
+                                           float upgrade_fraction)
+    : num_variants_(num_variants),
+      target_latency_(target_latency),
+      upgrade_fraction_(upgrade_fraction),
+      window_size_(std::max(window_size, 1)),
+      latencies_(window_size_) {
+  CHECK_GE(num_variants, 1);
+}
+
+bool ModelVariantSelector::AddLatency(absl::Duration latency) {
+  if (num_latencies_ == window_size_) {
+    latency_sum_ -= latencies_[next_latency_];
+  } else {
+    ++num_latencies_;
+  }
+  latencies_[next_latency_] = latency;
+  latency_sum_ += latency;
+  next_latency_ = (next_latency_ + 1) % window_size_;
+  if (num_latencies_ < window_size_) {
+    return false;
+  }
+
+  const absl::Duration average = average_latency();
+  if (average > target_latency_ && variant_ + 1 < num_variants_) {
+    SetVariant(variant_ + 1);
+    return true;
+  }
+  if (average < target_latency_ * upgrade_fraction_ && variant_ > 0) {
+    SetVariant(variant_ - 1);
+    return true;
+  }
+  return false;
+}
+
+absl::Duration ModelVariantSelector::average_latency() const {
+  return num_latencies_ > 0 ? latency_sum_ / num_latencies_
+                            : absl::ZeroDuration();
+}
+
+void ModelVariantSelector::SetVariant(int variant) {
+  variant_ = variant;
+  num_latencies_ = 0;
+  next_latency_ = 0;
+  latency_sum_ = absl::ZeroDuration();
+}
+
+}  // namespace mediapipe
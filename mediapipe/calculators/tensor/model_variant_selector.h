@@ -0,0 +1,67 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_MODEL_VARIANT_SELECTOR_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_MODEL_VARIANT_SELECTOR_H_
+
+#include <vector>
+
+#include "absl/time/time.h"
+
+namespace mediapipe {
+
+// Selects which of several variants of a model to run so that the average
+// latency of an invocation stays within a budget. The variants are ordered
+// from the most accurate and slowest to the fastest, e.g. full then lite.
+//
+// The latency is averaged over the last |window_size| invocations of the
+// current variant. Once the window is full, the selector switches to the next
+// faster variant if the average exceeds the target, and back to the previous
+// variant if it is below |upgrade_fraction| of the target. The window starts
+// over after a switch, so variants run for at least |window_size| invocations
+// and do not alternate around the target.
+class ModelVariantSelector {
+ public:
+  ModelVariantSelector(int num_variants, absl::Duration target_latency,
+                       int window_size, float upgrade_fraction);
+
+  // The variant to run next, from 0 to num_variants - 1.
+  int variant() const { return variant_; }
+
+  // Records the latency of an invocation of variant(). Returns true if the
+  // variant changed.
+  bool AddLatency(absl::Duration latency);
+
+  // The average latency of the recorded invocations of variant(), or zero if
+  // none is recorded.
+  absl::Duration average_latency() const;
+
+ private:
+  void SetVariant(int variant);
+
+  const int num_variants_;
+  const absl::Duration target_latency_;
+  const float upgrade_fraction_;
+  const int window_size_;
+  int variant_ = 0;
+  // Ring buffer of the last latencies of variant().
+  std::vector<absl::Duration> latencies_;
+  int num_latencies_ = 0;
+  int next_latency_ = 0;
+  absl::Duration latency_sum_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_MODEL_VARIANT_SELECTOR_H_
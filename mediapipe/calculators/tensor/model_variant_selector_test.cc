@@ -0,0 +1,83 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/model_variant_selector.h"
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kWindowSize = 4;
+
+// Records |count| invocations of |latency_ms| and returns the number of
+// variant changes.
+int AddLatencies(ModelVariantSelector* selector, int count, int latency_ms) {
+  int num_changes = 0;
+  for (int i = 0; i < count; ++i) {
+    num_changes += selector->AddLatency(absl::Milliseconds(latency_ms));
+  }
+  return num_changes;
+}
+
+TEST(ModelVariantSelectorTest, KeepsVariantWithinBudget) {
+  ModelVariantSelector selector(/*num_variants=*/2, absl::Milliseconds(20),
+                                kWindowSize, /*upgrade_fraction=*/0.5f);
+  EXPECT_EQ(selector.variant(), 0);
+  EXPECT_EQ(AddLatencies(&selector, 10, 15), 0);
+  EXPECT_EQ(selector.variant(), 0);
+  EXPECT_EQ(selector.average_latency(), absl::Milliseconds(15));
+}
+
+TEST(ModelVariantSelectorTest, SwitchesToFasterVariantOverBudget) {
+  ModelVariantSelector selector(/*num_variants=*/3, absl::Milliseconds(20),
+                                kWindowSize, /*upgrade_fraction=*/0.5f);
+  // A single slow invocation does not switch.
+  EXPECT_EQ(AddLatencies(&selector, 3, 15), 0);
+  EXPECT_EQ(AddLatencies(&selector, 1, 40), 1);
+  EXPECT_EQ(selector.variant(), 1);
+  EXPECT_EQ(selector.average_latency(), absl::ZeroDuration());
+
+  // The faster variant runs a full window before the next switch.
+  EXPECT_EQ(AddLatencies(&selector, kWindowSize - 1, 30), 0);
+  EXPECT_EQ(AddLatencies(&selector, 1, 30), 1);
+  EXPECT_EQ(selector.variant(), 2);
+
+  // There is no faster variant.
+  EXPECT_EQ(AddLatencies(&selector, 10, 30), 0);
+  EXPECT_EQ(selector.variant(), 2);
+}
+
+TEST(ModelVariantSelectorTest, SwitchesBackWithHysteresis) {
+  ModelVariantSelector selector(/*num_variants=*/2, absl::Milliseconds(20),
+                                kWindowSize, /*upgrade_fraction=*/0.5f);
+  EXPECT_EQ(AddLatencies(&selector, kWindowSize, 30), 1);
+  EXPECT_EQ(selector.variant(), 1);
+
+  // Between half the target and the target, the faster variant stays.
+  EXPECT_EQ(AddLatencies(&selector, 10, 12), 0);
+  EXPECT_EQ(selector.variant(), 1);
+
+  // Well within the budget, the more accurate variant runs again.
+  EXPECT_EQ(AddLatencies(&selector, kWindowSize, 8), 1);
+  EXPECT_EQ(selector.variant(), 0);
+
+  // There is no more accurate variant.
+  EXPECT_EQ(AddLatencies(&selector, 10, 8), 0);
+  EXPECT_EQ(selector.variant(), 0);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,76 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/tensor_quantization_utils.h"
+
+#include <cstdint>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+
+namespace {
+
+template <typename T>
+void Dequantize(const T* input, int count,
+                const Tensor::QuantizationParameters& params, float* output) {
+  const float scale = params.scale;
+  const int zero_point = params.zero_point;
+  for (int i = 0; i < count; ++i) {
+    output[i] = scale * (static_cast<int>(input[i]) - zero_point);
+  }
+}
+
+}  // namespace
+
+bool IsQuantized(const Tensor& tensor) {
+  return tensor.element_type() == Tensor::ElementType::kUInt8 ||
+         tensor.element_type() == Tensor::ElementType::kInt8;
+}
+
+void DequantizeValues(const Tensor& tensor, const Tensor::CpuReadView& view,
+                      int begin, int count, float* output) {
+  const auto& params = tensor.quantization_parameters();
+  switch (tensor.element_type()) {
+    case Tensor::ElementType::kUInt8:
+      Dequantize(view.buffer<uint8_t>() + begin, count, params, output);
+      break;
+    case Tensor::ElementType::kInt8:
+      Dequantize(view.buffer<int8_t>() + begin, count, params, output);
+      break;
+    default:
+      LOG(FATAL) << "Tensor is not quantized.";
+  }
+}
+
+absl::StatusOr<const float*> GetFloatValues(const Tensor& tensor,
+                                            const Tensor::CpuReadView& view,
+                                            std::vector<float>* buffer) {
+  if (tensor.element_type() == Tensor::ElementType::kFloat32) {
+    return view.buffer<float>();
+  }
+  if (!IsQuantized(tensor)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unsupported tensor element type: ",
+                     static_cast<int>(tensor.element_type())));
+  }
+  const int num_values = tensor.shape().num_elements();
+  buffer->resize(num_values);
+  DequantizeValues(tensor, view, 0, num_values, buffer->data());
+  return buffer->data();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,44 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_TENSOR_QUANTIZATION_UTILS_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_TENSOR_QUANTIZATION_UTILS_H_
+
+#include <vector>
+
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+
+// Returns true if |tensor| holds quantized uint8 or int8 values.
+bool IsQuantized(const Tensor& tensor);
+
+// Dequantizes |count| values of the quantized |tensor| read through |view|,
+// starting at element |begin|, into |output|. Post-processing calculators use
+// it to dequantize only the values they read, e.g. the boxes above a score
+// threshold.
+void DequantizeValues(const Tensor& tensor, const Tensor::CpuReadView& view,
+                      int begin, int count, float* output);
+
+// Returns the values of a float32 or quantized |tensor| read through |view|:
+// the tensor buffer itself for float32 tensors, otherwise all values
+// dequantized into |buffer|.
+absl::StatusOr<const float*> GetFloatValues(const Tensor& tensor,
+                                            const Tensor::CpuReadView& view,
+                                            std::vector<float>* buffer);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_TENSOR_QUANTIZATION_UTILS_H_
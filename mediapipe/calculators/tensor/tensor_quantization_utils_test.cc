@@ -0,0 +1,95 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/tensor_quantization_utils.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(TensorQuantizationUtilsTest, ReadsFloatTensorInPlace) {
+  Tensor tensor(Tensor::ElementType::kFloat32, Tensor::Shape{1, 3});
+  {
+    auto view = tensor.GetCpuWriteView();
+    float* values = view.buffer<float>();
+    values[0] = 1.5f;
+    values[1] = -2.0f;
+    values[2] = 0.25f;
+  }
+  EXPECT_FALSE(IsQuantized(tensor));
+  auto view = tensor.GetCpuReadView();
+  std::vector<float> buffer;
+  auto status_or_values = GetFloatValues(tensor, view, &buffer);
+  MP_ASSERT_OK(status_or_values.status());
+  EXPECT_EQ(status_or_values.value(), view.buffer<float>());
+  EXPECT_TRUE(buffer.empty());
+}
+
+TEST(TensorQuantizationUtilsTest, DequantizesUInt8Tensor) {
+  Tensor tensor(Tensor::ElementType::kUInt8, Tensor::Shape{1, 4},
+                Tensor::QuantizationParameters(0.5f, 128));
+  {
+    auto view = tensor.GetCpuWriteView();
+    uint8_t* values = view.buffer<uint8_t>();
+    values[0] = 0;
+    values[1] = 128;
+    values[2] = 130;
+    values[3] = 255;
+  }
+  EXPECT_TRUE(IsQuantized(tensor));
+  auto view = tensor.GetCpuReadView();
+  std::vector<float> buffer;
+  auto status_or_values = GetFloatValues(tensor, view, &buffer);
+  MP_ASSERT_OK(status_or_values.status());
+  const float* values = status_or_values.value();
+  EXPECT_FLOAT_EQ(values[0], -64.0f);
+  EXPECT_FLOAT_EQ(values[1], 0.0f);
+  EXPECT_FLOAT_EQ(values[2], 1.0f);
+  EXPECT_FLOAT_EQ(values[3], 63.5f);
+}
+
+TEST(TensorQuantizationUtilsTest, DequantizesInt8Range) {
+  Tensor tensor(Tensor::ElementType::kInt8, Tensor::Shape{1, 4},
+                Tensor::QuantizationParameters(0.25f, -1));
+  {
+    auto view = tensor.GetCpuWriteView();
+    int8_t* values = view.buffer<int8_t>();
+    values[0] = -128;
+    values[1] = -1;
+    values[2] = 3;
+    values[3] = 127;
+  }
+  auto view = tensor.GetCpuReadView();
+  float values[2] = {0.0f, 0.0f};
+  DequantizeValues(tensor, view, /*begin=*/1, /*count=*/2, values);
+  EXPECT_FLOAT_EQ(values[0], 0.0f);
+  EXPECT_FLOAT_EQ(values[1], 1.0f);
+}
+
+TEST(TensorQuantizationUtilsTest, RejectsFloat16Tensor) {
+  Tensor tensor(Tensor::ElementType::kFloat16, Tensor::Shape{1, 2});
+  tensor.GetCpuWriteView();
+  auto view = tensor.GetCpuReadView();
+  std::vector<float> buffer;
+  EXPECT_FALSE(GetFloatValues(tensor, view, &buffer).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -19,6 +19,7 @@
 #include "absl/container/node_hash_map.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "mediapipe/calculators/tensor/tensor_quantization_utils.h"
 #include "mediapipe/calculators/tensor/tensors_to_classification_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -118,7 +119,9 @@ absl::Status TensorsToClassificationCalculator::Process(CalculatorContext* cc) {
     RET_CHECK_EQ(num_classes, label_map_.size());
   }
   auto view = input_tensors[0].GetCpuReadView();
-  auto raw_scores = view.buffer<float>();
+  std::vector<float> dequantized_scores;
+  ASSIGN_OR_RETURN(const float* raw_scores,
+                   GetFloatValues(input_tensors[0], view, &dequantized_scores));
 
   auto classification_list = absl::make_unique<ClassificationList>();
   if (options_.binary_classification()) {
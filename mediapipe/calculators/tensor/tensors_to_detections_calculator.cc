@@ -12,11 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <unordered_map>
 #include <vector>
 
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "mediapipe/calculators/tensor/tensor_quantization_utils.h"
 #include "mediapipe/calculators/tensor/tensors_to_detections_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -65,16 +69,39 @@ namespace api2 {
 
 namespace {
 
-void ConvertRawValuesToAnchors(const float* raw_anchors, int num_boxes,
-                               std::vector<Anchor>* anchors) {
-  anchors->clear();
+// Anchors in structure-of-arrays layout, for decoding on CPU.
+struct AnchorArrays {
+  std::vector<float> y_center;
+  std::vector<float> x_center;
+  std::vector<float> h;
+  std::vector<float> w;
+};
+
+void ConvertRawValuesToAnchorArrays(const float* raw_anchors, int num_boxes,
+                                    AnchorArrays* anchors) {
+  anchors->y_center.resize(num_boxes);
+  anchors->x_center.resize(num_boxes);
+  anchors->h.resize(num_boxes);
+  anchors->w.resize(num_boxes);
   for (int i = 0; i < num_boxes; ++i) {
-    Anchor new_anchor;
-    new_anchor.set_y_center(raw_anchors[i * kNumCoordsPerBox + 0]);
-    new_anchor.set_x_center(raw_anchors[i * kNumCoordsPerBox + 1]);
-    new_anchor.set_h(raw_anchors[i * kNumCoordsPerBox + 2]);
-    new_anchor.set_w(raw_anchors[i * kNumCoordsPerBox + 3]);
-    anchors->push_back(new_anchor);
+    anchors->y_center[i] = raw_anchors[i * kNumCoordsPerBox + 0];
+    anchors->x_center[i] = raw_anchors[i * kNumCoordsPerBox + 1];
+    anchors->h[i] = raw_anchors[i * kNumCoordsPerBox + 2];
+    anchors->w[i] = raw_anchors[i * kNumCoordsPerBox + 3];
+  }
+}
+
+void ConvertAnchorsToAnchorArrays(const std::vector<Anchor>& anchors,
+                                  AnchorArrays* anchor_arrays) {
+  anchor_arrays->y_center.clear();
+  anchor_arrays->x_center.clear();
+  anchor_arrays->h.clear();
+  anchor_arrays->w.clear();
+  for (const auto& anchor : anchors) {
+    anchor_arrays->y_center.push_back(anchor.y_center());
+    anchor_arrays->x_center.push_back(anchor.x_center());
+    anchor_arrays->h.push_back(anchor.h());
+    anchor_arrays->w.push_back(anchor.w());
   }
 }
 
@@ -108,6 +135,10 @@ void ConvertAnchorsToRawValues(const std::vector<Anchor>& anchors,
 // Output:
 //  DETECTIONS - Result MediaPipe detections.
 //
+// On CPU, boxes are scored first and only the boxes passing min_score_thresh
+// are decoded, so the cost of decoding scales with the number of detections
+// rather than with num_boxes.
+//
 // Usage example:
 // node {
 //   calculator: "TensorsToDetectionsCalculator"
@@ -148,12 +179,15 @@ class TensorsToDetectionsCalculator : public Node {
 
   absl::Status LoadOptions(CalculatorContext* cc);
   absl::Status GpuInit(CalculatorContext* cc);
-  absl::Status DecodeBoxes(const float* raw_boxes,
-                           const std::vector<Anchor>& anchors,
-                           std::vector<float>* boxes);
+  // Scores all boxes and collects the boxes which may pass min_score_thresh
+  // into candidate_boxes_, with their scores and classes.
+  void SelectCandidates(const float* raw_scores);
+  // Decodes the candidate boxes into candidate_coords_.
+  absl::Status DecodeBoxes(const float* raw_boxes);
   absl::Status ConvertToDetections(const float* detection_boxes,
                                    const float* detection_scores,
                                    const int* detection_classes,
+                                   int num_detections,
                                    std::vector<Detection>* output_detections);
   Detection ConvertToDetection(float box_ymin, float box_xmin, float box_ymax,
                                float box_xmax, float score, int class_id,
@@ -163,9 +197,26 @@ class TensorsToDetectionsCalculator : public Node {
   int num_boxes_ = 0;
   int num_coords_ = 0;
   std::set<int> ignore_classes_;
+  // The classes which are not ignored.
+  std::vector<int> score_classes_;
+  // Scores below this value, before sigmoid, can't pass min_score_thresh.
+  float raw_score_thresh_ = 0.0f;
 
   ::mediapipe::TensorsToDetectionsCalculatorOptions options_;
-  std::vector<Anchor> anchors_;
+  AnchorArrays anchors_;
+  bool cpu_anchors_init_ = false;
+
+  // Buffers of the CPU processing, reused across frames.
+  std::vector<float> box_scores_;
+  std::vector<int> box_classes_;
+  std::vector<int> candidate_boxes_;
+  std::vector<float> candidate_scores_;
+  std::vector<int> candidate_classes_;
+  std::vector<float> candidate_coords_;
+  // The values of quantized input tensors. Quantized boxes are only
+  // dequantized for the candidates.
+  std::vector<float> dequantized_scores_;
+  std::vector<float> dequantized_boxes_;
 
 #ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
   mediapipe::GlCalculatorHelper gpu_helper_;
@@ -202,6 +253,12 @@ absl::Status TensorsToDetectionsCalculator::UpdateContract(
 absl::Status TensorsToDetectionsCalculator::Open(CalculatorContext* cc) {
   MP_RETURN_IF_ERROR(LoadOptions(cc));
 
+  if (kInAnchors(cc).IsConnected() && !kInAnchors(cc).IsEmpty()) {
+    RET_CHECK_EQ(kInAnchors(cc)->size(), num_boxes_);
+    ConvertAnchorsToAnchorArrays(*kInAnchors(cc), &anchors_);
+    cpu_anchors_init_ = true;
+  }
+
   if (CanUseGpu()) {
 #ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
     MP_RETURN_IF_ERROR(gpu_helper_.Open(cc));
@@ -262,65 +319,47 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
     RET_CHECK_EQ(raw_score_tensor->shape().dims[1], num_boxes_);
     RET_CHECK_EQ(raw_score_tensor->shape().dims[2], num_classes_);
     auto raw_box_view = raw_box_tensor->GetCpuReadView();
-    auto raw_boxes = raw_box_view.buffer<float>();
     auto raw_scores_view = raw_score_tensor->GetCpuReadView();
-    auto raw_scores = raw_scores_view.buffer<float>();
+    ASSIGN_OR_RETURN(const float* raw_scores,
+                     GetFloatValues(*raw_score_tensor, raw_scores_view,
+                                    &dequantized_scores_));
 
     // TODO: Support other options to load anchors.
-    if (!anchors_init_) {
+    if (!cpu_anchors_init_) {
       if (input_tensors.size() == kNumInputTensorsWithAnchors) {
         auto anchor_tensor = &input_tensors[2];
         RET_CHECK_EQ(anchor_tensor->shape().dims.size(), 2);
         RET_CHECK_EQ(anchor_tensor->shape().dims[0], num_boxes_);
         RET_CHECK_EQ(anchor_tensor->shape().dims[1], kNumCoordsPerBox);
         auto anchor_view = anchor_tensor->GetCpuReadView();
-        auto raw_anchors = anchor_view.buffer<float>();
-        ConvertRawValuesToAnchors(raw_anchors, num_boxes_, &anchors_);
-      } else if (!kInAnchors(cc).IsEmpty()) {
-        anchors_ = *kInAnchors(cc);
+        std::vector<float> dequantized_anchors;
+        ASSIGN_OR_RETURN(const float* raw_anchors,
+                         GetFloatValues(*anchor_tensor, anchor_view,
+                                        &dequantized_anchors));
+        ConvertRawValuesToAnchorArrays(raw_anchors, num_boxes_, &anchors_);
       } else {
         return absl::UnavailableError("No anchor data available.");
       }
-      anchors_init_ = true;
+      cpu_anchors_init_ = true;
     }
-    std::vector<float> boxes(num_boxes_ * num_coords_);
-    MP_RETURN_IF_ERROR(DecodeBoxes(raw_boxes, anchors_, &boxes));
 
-    std::vector<float> detection_scores(num_boxes_);
-    std::vector<int> detection_classes(num_boxes_);
-
-    // Filter classes by scores.
-    for (int i = 0; i < num_boxes_; ++i) {
-      int class_id = -1;
-      float max_score = -std::numeric_limits<float>::max();
-      // Find the top score for box i.
-      for (int score_idx = 0; score_idx < num_classes_; ++score_idx) {
-        if (ignore_classes_.find(score_idx) == ignore_classes_.end()) {
-          auto score = raw_scores[i * num_classes_ + score_idx];
-          if (options_.sigmoid_score()) {
-            if (options_.has_score_clipping_thresh()) {
-              score = score < -options_.score_clipping_thresh()
-                          ? -options_.score_clipping_thresh()
-                          : score;
-              score = score > options_.score_clipping_thresh()
-                          ? options_.score_clipping_thresh()
-                          : score;
-            }
-            score = 1.0f / (1.0f + std::exp(-score));
-          }
-          if (max_score < score) {
-            max_score = score;
-            class_id = score_idx;
-          }
-        }
+    SelectCandidates(raw_scores);
+    const float* raw_boxes;
+    if (IsQuantized(*raw_box_tensor)) {
+      dequantized_boxes_.resize(num_boxes_ * num_coords_);
+      for (int i : candidate_boxes_) {
+        DequantizeValues(*raw_box_tensor, raw_box_view, i * num_coords_,
+                         num_coords_, &dequantized_boxes_[i * num_coords_]);
       }
-      detection_scores[i] = max_score;
-      detection_classes[i] = class_id;
+      raw_boxes = dequantized_boxes_.data();
+    } else {
+      raw_boxes = raw_box_view.buffer<float>();
     }
-
-    MP_RETURN_IF_ERROR(
-        ConvertToDetections(boxes.data(), detection_scores.data(),
-                            detection_classes.data(), output_detections));
+    MP_RETURN_IF_ERROR(DecodeBoxes(raw_boxes));
+    MP_RETURN_IF_ERROR(ConvertToDetections(
+        candidate_coords_.data(), candidate_scores_.data(),
+        candidate_classes_.data(), candidate_boxes_.size(),
+        output_detections));
   } else {
     // Postprocessing on CPU with postprocessing op (e.g. anchor decoding and
     // non-maximum suppression) within the model.
@@ -347,23 +386,35 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
     RET_CHECK_EQ(detection_scores_tensor->shape().dims[1], max_detections);
 
     auto num_boxes_view = num_boxes_tensor->GetCpuReadView();
-    auto num_boxes = num_boxes_view.buffer<float>();
+    std::vector<float> dequantized_num_boxes;
+    ASSIGN_OR_RETURN(const float* num_boxes,
+                     GetFloatValues(*num_boxes_tensor, num_boxes_view,
+                                    &dequantized_num_boxes));
     num_boxes_ = num_boxes[0];
 
     auto detection_boxes_view = detection_boxes_tensor->GetCpuReadView();
-    auto detection_boxes = detection_boxes_view.buffer<float>();
+    ASSIGN_OR_RETURN(const float* detection_boxes,
+                     GetFloatValues(*detection_boxes_tensor,
+                                    detection_boxes_view, &dequantized_boxes_));
 
     auto detection_scores_view = detection_scores_tensor->GetCpuReadView();
-    auto detection_scores = detection_scores_view.buffer<float>();
+    ASSIGN_OR_RETURN(
+        const float* detection_scores,
+        GetFloatValues(*detection_scores_tensor, detection_scores_view,
+                       &dequantized_scores_));
 
     auto detection_classes_view = detection_classes_tensor->GetCpuReadView();
-    auto detection_classes_ptr = detection_classes_view.buffer<float>();
+    std::vector<float> dequantized_classes;
+    ASSIGN_OR_RETURN(
+        const float* detection_classes_ptr,
+        GetFloatValues(*detection_classes_tensor, detection_classes_view,
+                       &dequantized_classes));
     std::vector<int> detection_classes(num_boxes_);
     for (int i = 0; i < num_boxes_; ++i) {
       detection_classes[i] = static_cast<int>(detection_classes_ptr[i]);
     }
     MP_RETURN_IF_ERROR(ConvertToDetections(detection_boxes, detection_scores,
-                                           detection_classes.data(),
+                                           detection_classes.data(), num_boxes_,
                                            output_detections));
   }
   return absl::OkStatus();
@@ -437,7 +488,7 @@ absl::Status TensorsToDetectionsCalculator::ProcessGPU(
   auto decoded_boxes_view = decoded_boxes_buffer_->GetCpuReadView();
   auto boxes = decoded_boxes_view.buffer<float>();
   MP_RETURN_IF_ERROR(ConvertToDetections(boxes, detection_scores.data(),
-                                         detection_classes.data(),
+                                         detection_classes.data(), num_boxes_,
                                          output_detections));
 #elif MEDIAPIPE_METAL_ENABLED
   id<MTLDevice> device = gpu_helper_.mtlDevice;
@@ -518,7 +569,7 @@ absl::Status TensorsToDetectionsCalculator::ProcessGPU(
   auto decoded_boxes_view = decoded_boxes_buffer_->GetCpuReadView();
   auto boxes = decoded_boxes_view.buffer<float>();
   MP_RETURN_IF_ERROR(ConvertToDetections(boxes, detection_scores.data(),
-                                         detection_classes.data(),
+                                         detection_classes.data(), num_boxes_,
                                          output_detections));
 
 #else
@@ -569,14 +620,101 @@ absl::Status TensorsToDetectionsCalculator::LoadOptions(CalculatorContext* cc) {
   for (int i = 0; i < options_.ignore_classes_size(); ++i) {
     ignore_classes_.insert(options_.ignore_classes(i));
   }
+  for (int i = 0; i < num_classes_; ++i) {
+    if (ignore_classes_.find(i) == ignore_classes_.end()) {
+      score_classes_.push_back(i);
+    }
+  }
+
+  // Sigmoid is monotonic, so boxes can be filtered before it is applied.  The
+  // float sigmoid is within a few ulps of the exact one, so the threshold is
+  // lowered by 4 ulps before taking its logit, to keep the boxes whose score
+  // rounds up to min_score_thresh; those are checked again after sigmoid.
+  raw_score_thresh_ = -std::numeric_limits<float>::infinity();
+  if (options_.has_min_score_thresh()) {
+    const float thresh = options_.min_score_thresh();
+    if (!options_.sigmoid_score()) {
+      raw_score_thresh_ = thresh;
+    } else if (thresh > 0.0f && thresh < 1.0f) {
+      const double ulp = thresh - std::nextafter(thresh, 0.0f);
+      const double lowered_thresh = thresh - 4.0 * ulp;
+      if (lowered_thresh > 0.0) {
+        raw_score_thresh_ = std::nextafter(
+            static_cast<float>(
+                std::log(lowered_thresh / (1.0 - lowered_thresh))),
+            -std::numeric_limits<float>::infinity());
+      }
+    }
+  }
 
   return absl::OkStatus();
 }
 
-absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
-    const float* raw_boxes, const std::vector<Anchor>& anchors,
-    std::vector<float>* boxes) {
+void TensorsToDetectionsCalculator::SelectCandidates(const float* raw_scores) {
+  box_scores_.resize(num_boxes_);
+  box_classes_.resize(num_boxes_);
+  candidate_boxes_.resize(num_boxes_);
+  const bool clip_scores =
+      options_.sigmoid_score() && options_.has_score_clipping_thresh();
+  const float clipping_thresh = options_.score_clipping_thresh();
+
+  // Find the top score of each box, before sigmoid.  The single-class models
+  // take a plain loop over the scores which the compiler vectorizes.
+  if (num_classes_ == 1 && score_classes_.size() == 1) {
+    for (int i = 0; i < num_boxes_; ++i) {
+      float score = raw_scores[i];
+      if (clip_scores) {
+        score = std::min(std::max(score, -clipping_thresh), clipping_thresh);
+      }
+      box_scores_[i] = score;
+      box_classes_[i] = 0;
+    }
+  } else {
+    for (int i = 0; i < num_boxes_; ++i) {
+      int class_id = -1;
+      float max_score = -std::numeric_limits<float>::max();
+      for (int score_idx : score_classes_) {
+        float score = raw_scores[i * num_classes_ + score_idx];
+        if (clip_scores) {
+          score = std::min(std::max(score, -clipping_thresh), clipping_thresh);
+        }
+        if (max_score < score) {
+          max_score = score;
+          class_id = score_idx;
+        }
+      }
+      box_scores_[i] = max_score;
+      box_classes_[i] = class_id;
+    }
+  }
+
+  // Compact the indices of the boxes above the threshold without branches.
+  int num_candidates = 0;
   for (int i = 0; i < num_boxes_; ++i) {
+    candidate_boxes_[num_candidates] = i;
+    num_candidates += box_scores_[i] >= raw_score_thresh_;
+  }
+  candidate_boxes_.resize(num_candidates);
+
+  candidate_scores_.resize(num_candidates);
+  candidate_classes_.resize(num_candidates);
+  for (int j = 0; j < num_candidates; ++j) {
+    const int i = candidate_boxes_[j];
+    float score = box_scores_[i];
+    if (options_.sigmoid_score()) {
+      score = 1.0f / (1.0f + std::exp(-score));
+    }
+    candidate_scores_[j] = score;
+    candidate_classes_[j] = box_classes_[i];
+  }
+}
+
+absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
+    const float* raw_boxes) {
+  candidate_coords_.resize(candidate_boxes_.size() * num_coords_);
+  float* boxes = candidate_coords_.data();
+  for (int j = 0; j < candidate_boxes_.size(); ++j) {
+    const int i = candidate_boxes_[j];
     const int box_offset = i * num_coords_ + options_.box_coord_offset();
 
     float y_center = raw_boxes[box_offset];
@@ -590,17 +728,19 @@ absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
       h = raw_boxes[box_offset + 3];
     }
 
-    x_center =
-        x_center / options_.x_scale() * anchors[i].w() + anchors[i].x_center();
-    y_center =
-        y_center / options_.y_scale() * anchors[i].h() + anchors[i].y_center();
+    const float anchor_w = anchors_.w[i];
+    const float anchor_h = anchors_.h[i];
+    const float anchor_x_center = anchors_.x_center[i];
+    const float anchor_y_center = anchors_.y_center[i];
+    x_center = x_center / options_.x_scale() * anchor_w + anchor_x_center;
+    y_center = y_center / options_.y_scale() * anchor_h + anchor_y_center;
 
     if (options_.apply_exponential_on_box_size()) {
-      h = std::exp(h / options_.h_scale()) * anchors[i].h();
-      w = std::exp(w / options_.w_scale()) * anchors[i].w();
+      h = std::exp(h / options_.h_scale()) * anchor_h;
+      w = std::exp(w / options_.w_scale()) * anchor_w;
     } else {
-      h = h / options_.h_scale() * anchors[i].h();
-      w = w / options_.w_scale() * anchors[i].w();
+      h = h / options_.h_scale() * anchor_h;
+      w = w / options_.w_scale() * anchor_w;
     }
 
     const float ymin = y_center - h / 2.f;
@@ -608,15 +748,16 @@ absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
     const float ymax = y_center + h / 2.f;
     const float xmax = x_center + w / 2.f;
 
-    (*boxes)[i * num_coords_ + 0] = ymin;
-    (*boxes)[i * num_coords_ + 1] = xmin;
-    (*boxes)[i * num_coords_ + 2] = ymax;
-    (*boxes)[i * num_coords_ + 3] = xmax;
+    boxes[j * num_coords_ + 0] = ymin;
+    boxes[j * num_coords_ + 1] = xmin;
+    boxes[j * num_coords_ + 2] = ymax;
+    boxes[j * num_coords_ + 3] = xmax;
 
     if (options_.num_keypoints()) {
       for (int k = 0; k < options_.num_keypoints(); ++k) {
-        const int offset = i * num_coords_ + options_.keypoint_coord_offset() +
-                           k * options_.num_values_per_keypoint();
+        const int keypoint_offset = options_.keypoint_coord_offset() +
+                                    k * options_.num_values_per_keypoint();
+        const int offset = i * num_coords_ + keypoint_offset;
 
         float keypoint_y = raw_boxes[offset];
         float keypoint_x = raw_boxes[offset + 1];
@@ -625,11 +766,11 @@ absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
           keypoint_y = raw_boxes[offset + 1];
         }
 
-        (*boxes)[offset] = keypoint_x / options_.x_scale() * anchors[i].w() +
-                           anchors[i].x_center();
-        (*boxes)[offset + 1] =
-            keypoint_y / options_.y_scale() * anchors[i].h() +
-            anchors[i].y_center();
+        float* keypoint = boxes + j * num_coords_ + keypoint_offset;
+        keypoint[0] =
+            keypoint_x / options_.x_scale() * anchor_w + anchor_x_center;
+        keypoint[1] =
+            keypoint_y / options_.y_scale() * anchor_h + anchor_y_center;
       }
     }
   }
@@ -639,8 +780,9 @@ absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
 
 absl::Status TensorsToDetectionsCalculator::ConvertToDetections(
     const float* detection_boxes, const float* detection_scores,
-    const int* detection_classes, std::vector<Detection>* output_detections) {
-  for (int i = 0; i < num_boxes_; ++i) {
+    const int* detection_classes, int num_detections,
+    std::vector<Detection>* output_detections) {
+  for (int i = 0; i < num_detections; ++i) {
     if (options_.has_min_score_thresh() &&
         detection_scores[i] < options_.min_score_thresh()) {
       continue;
@@ -0,0 +1,307 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/substitute.h"
+#include "mediapipe/calculators/tensor/tensors_to_detections_calculator.pb.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/location_data.pb.h"
+#include "mediapipe/framework/formats/object_detection/anchor.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using mediapipe::ParseTextProtoOrDie;
+using Node = ::mediapipe::CalculatorGraphConfig::Node;
+
+constexpr float kErrorMargin = 1e-5f;
+
+Tensor MakeTensor(const Tensor::Shape& shape,
+                  const std::vector<float>& values) {
+  Tensor tensor(Tensor::ElementType::kFloat32, shape);
+  auto view = tensor.GetCpuWriteView();
+  std::copy(values.begin(), values.end(), view.buffer<float>());
+  return tensor;
+}
+
+std::vector<Anchor> MakeAnchors(int num_boxes) {
+  std::vector<Anchor> anchors(num_boxes);
+  for (int i = 0; i < num_boxes; ++i) {
+    anchors[i].set_x_center(0.1f * (i + 1));
+    anchors[i].set_y_center(0.2f);
+    anchors[i].set_w(0.5f);
+    anchors[i].set_h(0.5f);
+  }
+  return anchors;
+}
+
+void AddInputs(CalculatorRunner* runner, const std::vector<Anchor>& anchors,
+               Tensor raw_boxes, Tensor raw_scores) {
+  auto tensors = absl::make_unique<std::vector<Tensor>>();
+  tensors->push_back(std::move(raw_boxes));
+  tensors->push_back(std::move(raw_scores));
+  runner->MutableInputs()->Tag("TENSORS").packets.push_back(
+      Adopt(tensors.release()).At(Timestamp(0)));
+  runner->MutableSidePackets()->Tag("ANCHORS") =
+      MakePacket<std::vector<Anchor>>(anchors);
+}
+
+TEST(TensorsToDetectionsCalculatorTest, DecodesBoxesAboveThreshold) {
+  CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "TensorsToDetectionsCalculator"
+    input_stream: "TENSORS:tensors"
+    input_side_packet: "ANCHORS:anchors"
+    output_stream: "DETECTIONS:detections"
+    options: {
+      [mediapipe.TensorsToDetectionsCalculatorOptions.ext] {
+        num_classes: 1
+        num_boxes: 4
+        num_coords: 6
+        box_coord_offset: 0
+        keypoint_coord_offset: 4
+        num_keypoints: 1
+        num_values_per_keypoint: 2
+        sigmoid_score: true
+        score_clipping_thresh: 100.0
+        reverse_output_order: true
+        x_scale: 1.0
+        y_scale: 1.0
+        h_scale: 1.0
+        w_scale: 1.0
+        min_score_thresh: 0.5
+      }
+    }
+  )pb"));
+  std::vector<float> raw_boxes;
+  for (int i = 0; i < 4; ++i) {
+    // [x_center, y_center, w, h, keypoint_x, keypoint_y]
+    raw_boxes.insert(raw_boxes.end(), {0.1f, 0.05f, 0.4f, 0.2f, 0.2f, 0.4f});
+  }
+  AddInputs(&runner, MakeAnchors(4), MakeTensor({1, 4, 6}, raw_boxes),
+            MakeTensor({1, 4, 1}, {-2.0f, 1.0f, 0.01f, -0.01f}));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& output_packets = runner.Outputs().Tag("DETECTIONS").packets;
+  ASSERT_EQ(1, output_packets.size());
+  const auto& detections = output_packets[0].Get<std::vector<Detection>>();
+  ASSERT_EQ(2, detections.size());
+  const float expected_scores[] = {1.0f / (1.0f + std::exp(-1.0f)),
+                                   1.0f / (1.0f + std::exp(-0.01f))};
+  for (int j = 0; j < 2; ++j) {
+    const int box = j + 1;
+    const Detection& detection = detections[j];
+    EXPECT_NEAR(expected_scores[j], detection.score(0), kErrorMargin);
+    EXPECT_EQ(0, detection.label_id(0));
+    const auto& bbox = detection.location_data().relative_bounding_box();
+    const float x_center = 0.05f + 0.1f * (box + 1);
+    EXPECT_NEAR(x_center - 0.1f, bbox.xmin(), kErrorMargin);
+    EXPECT_NEAR(0.175f, bbox.ymin(), kErrorMargin);
+    EXPECT_NEAR(0.2f, bbox.width(), kErrorMargin);
+    EXPECT_NEAR(0.1f, bbox.height(), kErrorMargin);
+    ASSERT_EQ(1, detection.location_data().relative_keypoints_size());
+    const auto& keypoint = detection.location_data().relative_keypoints(0);
+    EXPECT_NEAR(0.1f + 0.1f * (box + 1), keypoint.x(), kErrorMargin);
+    EXPECT_NEAR(0.4f, keypoint.y(), kErrorMargin);
+  }
+}
+
+TEST(TensorsToDetectionsCalculatorTest, ScoresNonIgnoredClasses) {
+  CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "TensorsToDetectionsCalculator"
+    input_stream: "TENSORS:tensors"
+    input_side_packet: "ANCHORS:anchors"
+    output_stream: "DETECTIONS:detections"
+    options: {
+      [mediapipe.TensorsToDetectionsCalculatorOptions.ext] {
+        num_classes: 3
+        num_boxes: 3
+        num_coords: 4
+        ignore_classes: 0
+        x_scale: 1.0
+        y_scale: 1.0
+        h_scale: 1.0
+        w_scale: 1.0
+        min_score_thresh: 0.3
+      }
+    }
+  )pb"));
+  const std::vector<float> raw_boxes(3 * 4, 0.1f);
+  // Class 0 is ignored even though it has the top score of every box.
+  const std::vector<float> raw_scores = {0.9f, 0.2f, 0.6f,  //
+                                         0.9f, 0.1f, 0.2f,  //
+                                         0.9f, 0.4f, 0.3f};
+  AddInputs(&runner, MakeAnchors(3), MakeTensor({1, 3, 4}, raw_boxes),
+            MakeTensor({1, 3, 3}, raw_scores));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& output_packets = runner.Outputs().Tag("DETECTIONS").packets;
+  ASSERT_EQ(1, output_packets.size());
+  const auto& detections = output_packets[0].Get<std::vector<Detection>>();
+  ASSERT_EQ(2, detections.size());
+  EXPECT_EQ(2, detections[0].label_id(0));
+  EXPECT_NEAR(0.6f, detections[0].score(0), kErrorMargin);
+  EXPECT_EQ(1, detections[1].label_id(0));
+  EXPECT_NEAR(0.4f, detections[1].score(0), kErrorMargin);
+}
+
+// Checks that filtering the boxes before sigmoid keeps every box whose float
+// sigmoid score reaches min_score_thresh, down to the last ulp near 0 and 1.
+TEST(TensorsToDetectionsCalculatorTest, KeepsBoxesRoundingUpToThreshold) {
+  constexpr int kNumBoxes = 201;
+  for (const float thresh : {1e-7f, 1e-3f, 0.5f, 0.999f, 0.99999f, 0.9999999f,
+                             std::nextafter(1.0f, 0.0f)}) {
+    Node node = ParseTextProtoOrDie<Node>(R"pb(
+      calculator: "TensorsToDetectionsCalculator"
+      input_stream: "TENSORS:tensors"
+      input_side_packet: "ANCHORS:anchors"
+      output_stream: "DETECTIONS:detections"
+      options: {
+        [mediapipe.TensorsToDetectionsCalculatorOptions.ext] {
+          num_classes: 1
+          num_boxes: 201
+          num_coords: 4
+          sigmoid_score: true
+          x_scale: 1.0
+          y_scale: 1.0
+          h_scale: 1.0
+          w_scale: 1.0
+        }
+      }
+    )pb");
+    node.mutable_options()
+        ->MutableExtension(TensorsToDetectionsCalculatorOptions::ext)
+        ->set_min_score_thresh(thresh);
+    CalculatorRunner runner(node);
+
+    // Scores around the logit of the threshold, in steps a fraction of the
+    // float sigmoid resolution there.
+    const double logit = std::log(thresh / (1.0 - thresh));
+    const double step = 2e-3 * (1.0 + std::abs(logit));
+    std::vector<float> raw_scores(kNumBoxes);
+    int expected_num_detections = 0;
+    for (int i = 0; i < kNumBoxes; ++i) {
+      raw_scores[i] = logit + (i - kNumBoxes / 2) * step;
+      const float score = 1.0f / (1.0f + std::exp(-raw_scores[i]));
+      expected_num_detections += score >= thresh;
+    }
+    AddInputs(&runner, MakeAnchors(kNumBoxes),
+              MakeTensor({1, kNumBoxes, 4},
+                         std::vector<float>(kNumBoxes * 4, 0.1f)),
+              MakeTensor({1, kNumBoxes, 1}, raw_scores));
+    MP_ASSERT_OK(runner.Run());
+
+    const auto& output_packets = runner.Outputs().Tag("DETECTIONS").packets;
+    ASSERT_EQ(1, output_packets.size());
+    EXPECT_EQ(expected_num_detections,
+              output_packets[0].Get<std::vector<Detection>>().size())
+        << "min_score_thresh: " << thresh;
+  }
+}
+
+// Post-processes random outputs of a detection model with the options of the
+// corresponding module graph, with about one box in a hundred above the score
+// threshold.
+void RunDetectionModelBenchmark(benchmark::State& state, int num_coords,
+                                int num_keypoints) {
+  constexpr int kNumBoxes = 896;
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(absl::Substitute(
+          R"pb(
+            input_stream: "tensors"
+            input_side_packet: "anchors"
+            node {
+              calculator: "TensorsToDetectionsCalculator"
+              input_stream: "TENSORS:tensors"
+              input_side_packet: "ANCHORS:anchors"
+              output_stream: "DETECTIONS:detections"
+              options: {
+                [mediapipe.TensorsToDetectionsCalculatorOptions.ext] {
+                  num_classes: 1
+                  num_boxes: $0
+                  num_coords: $1
+                  box_coord_offset: 0
+                  keypoint_coord_offset: 4
+                  num_keypoints: $2
+                  num_values_per_keypoint: 2
+                  sigmoid_score: true
+                  score_clipping_thresh: 100.0
+                  reverse_output_order: true
+                  x_scale: 128.0
+                  y_scale: 128.0
+                  h_scale: 128.0
+                  w_scale: 128.0
+                  min_score_thresh: 0.5
+                }
+              }
+            }
+          )pb",
+          kNumBoxes, num_coords, num_keypoints));
+
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<float> box_distribution(-10.0f, 10.0f);
+  std::normal_distribution<float> score_distribution(-6.0f, 2.6f);
+  std::vector<float> raw_boxes(kNumBoxes * num_coords);
+  for (float& value : raw_boxes) value = box_distribution(generator);
+  std::vector<float> raw_scores(kNumBoxes);
+  for (float& value : raw_scores) value = score_distribution(generator);
+
+  CalculatorGraph graph;
+  MEDIAPIPE_CHECK_OK(graph.Initialize(config));
+  MEDIAPIPE_CHECK_OK(graph.StartRun(
+      {{"anchors", MakePacket<std::vector<Anchor>>(MakeAnchors(kNumBoxes))}}));
+  int64 timestamp = 0;
+  for (auto _ : state) {
+    auto tensors = absl::make_unique<std::vector<Tensor>>();
+    tensors->push_back(MakeTensor({1, kNumBoxes, num_coords}, raw_boxes));
+    tensors->push_back(MakeTensor({1, kNumBoxes, 1}, raw_scores));
+    MEDIAPIPE_CHECK_OK(graph.AddPacketToInputStream(
+        "tensors", Adopt(tensors.release()).At(Timestamp(timestamp++))));
+    MEDIAPIPE_CHECK_OK(graph.WaitUntilIdle());
+  }
+  MEDIAPIPE_CHECK_OK(graph.CloseAllInputStreams());
+  MEDIAPIPE_CHECK_OK(graph.WaitUntilDone());
+}
+
+void BM_PalmDetection(benchmark::State& state) {
+  RunDetectionModelBenchmark(state, /*num_coords=*/18, /*num_keypoints=*/7);
+}
+BENCHMARK(BM_PalmDetection)->Unit(benchmark::kMicrosecond);
+
+void BM_FaceDetection(benchmark::State& state) {
+  RunDetectionModelBenchmark(state, /*num_coords=*/16, /*num_keypoints=*/6);
+}
+BENCHMARK(BM_FaceDetection)->Unit(benchmark::kMicrosecond);
+
+void BM_PoseDetection(benchmark::State& state) {
+  RunDetectionModelBenchmark(state, /*num_coords=*/12, /*num_keypoints=*/4);
+}
+BENCHMARK(BM_PoseDetection)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace mediapipe
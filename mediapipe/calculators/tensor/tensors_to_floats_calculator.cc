@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <vector>
+
+#include "mediapipe/calculators/tensor/tensor_quantization_utils.h"
 #include "mediapipe/calculators/tensor/tensors_to_floats_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -78,7 +81,9 @@ absl::Status TensorsToFloatsCalculator::Process(CalculatorContext* cc) {
   RET_CHECK(!input_tensors.empty());
   // TODO: Add option to specify which tensor to take from.
   auto view = input_tensors[0].GetCpuReadView();
-  auto raw_floats = view.buffer<float>();
+  std::vector<float> dequantized_values;
+  ASSIGN_OR_RETURN(const float* raw_floats,
+                   GetFloatValues(input_tensors[0], view, &dequantized_values));
   int num_values = input_tensors[0].shape().num_elements();
   auto output_floats = absl::make_unique<std::vector<float>>(
       raw_floats, raw_floats + num_values);
@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <vector>
+
+#include "mediapipe/calculators/tensor/tensor_quantization_utils.h"
 #include "mediapipe/calculators/tensor/tensors_to_landmarks_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -107,6 +110,8 @@ class TensorsToLandmarksCalculator : public Node {
   absl::Status LoadOptions(CalculatorContext* cc);
   int num_landmarks_ = 0;
   ::mediapipe::TensorsToLandmarksCalculatorOptions options_;
+  // The values of quantized input tensors.
+  std::vector<float> dequantized_values_;
 };
 MEDIAPIPE_REGISTER_NODE(TensorsToLandmarksCalculator);
 
@@ -144,7 +149,9 @@ absl::Status TensorsToLandmarksCalculator::Process(CalculatorContext* cc) {
   CHECK_GT(num_dimensions, 0);
 
   auto view = input_tensors[0].GetCpuReadView();
-  auto raw_landmarks = view.buffer<float>();
+  ASSIGN_OR_RETURN(
+      const float* raw_landmarks,
+      GetFloatValues(input_tensors[0], view, &dequantized_values_));
 
   LandmarkList output_landmarks;
 
@@ -28,6 +28,7 @@
 #endif  // !__EMSCRIPTEN__ || __EMSCRIPTEN_PTHREADS__
 
 #include "mediapipe/util/tflite/tflite_model_loader.h"
+#include "mediapipe/util/tflite/tflite_model_registry.h"
 #include "tensorflow/lite/error_reporter.h"
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/kernels/register.h"
@@ -225,7 +226,7 @@ class TfLiteInferenceCalculator : public CalculatorBase {
   absl::Status ReadKernelsFromFile();
   absl::Status WriteKernelsToFile();
   absl::Status LoadModel(CalculatorContext* cc);
-  absl::StatusOr<Packet> GetModelAsPacket(const CalculatorContext& cc);
+  absl::StatusOr<Packet> GetModelAsPacket(CalculatorContext* cc);
   absl::Status LoadDelegate(CalculatorContext* cc);
   absl::Status InitTFLiteGPURunner(CalculatorContext* cc);
   absl::Status ProcessInputsCpu(CalculatorContext* cc,
@@ -334,6 +335,7 @@ absl::Status TfLiteInferenceCalculator::GetContract(CalculatorContract* cc) {
   if (cc->InputSidePackets().HasTag("MODEL")) {
     cc->InputSidePackets().Tag("MODEL").Set<TfLiteModelPtr>();
   }
+  cc->UseService(kTfLiteModelRegistryService).Optional();
 
   if (ShouldUseGpu(cc)) {
 #if MEDIAPIPE_TFLITE_GL_INFERENCE
@@ -700,7 +702,7 @@ absl::Status TfLiteInferenceCalculator::ReadKernelsFromFile() {
 absl::Status TfLiteInferenceCalculator::InitTFLiteGPURunner(
     CalculatorContext* cc) {
 #if MEDIAPIPE_TFLITE_GL_INFERENCE
-  ASSIGN_OR_RETURN(model_packet_, GetModelAsPacket(*cc));
+  ASSIGN_OR_RETURN(model_packet_, GetModelAsPacket(cc));
   const auto& model = *model_packet_.Get<TfLiteModelPtr>();
 
   tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates
@@ -789,7 +791,7 @@ absl::Status TfLiteInferenceCalculator::LoadModel(CalculatorContext* cc) {
     return absl::OkStatus();
   }
 
-  ASSIGN_OR_RETURN(model_packet_, GetModelAsPacket(*cc));
+  ASSIGN_OR_RETURN(model_packet_, GetModelAsPacket(cc));
   const auto& model = *model_packet_.Get<TfLiteModelPtr>();
 
   tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates
@@ -835,14 +837,18 @@ absl::Status TfLiteInferenceCalculator::LoadModel(CalculatorContext* cc) {
 }
 
 absl::StatusOr<Packet> TfLiteInferenceCalculator::GetModelAsPacket(
-    const CalculatorContext& cc) {
+    CalculatorContext* cc) {
   const auto& options =
-      cc.Options<mediapipe::TfLiteInferenceCalculatorOptions>();
+      cc->Options<mediapipe::TfLiteInferenceCalculatorOptions>();
   if (!options.model_path().empty()) {
-    return TfLiteModelLoader::LoadFromPath(options.model_path());
+    auto registry = cc->Service(kTfLiteModelRegistryService);
+    return registry.IsAvailable()
+               ? registry.GetObject().GetModel(options.model_path())
+               : TfLiteModelRegistry::GetDefault()->GetModel(
+                     options.model_path());
   }
-  if (cc.InputSidePackets().HasTag("MODEL")) {
-    return cc.InputSidePackets().Tag("MODEL");
+  if (cc->InputSidePackets().HasTag("MODEL")) {
+    return cc->InputSidePackets().Tag("MODEL");
   }
   return absl::Status(absl::StatusCode::kNotFound,
                       "Must specify TFLite model as path or loaded model.");
@@ -13,14 +13,18 @@
 // limitations under the License.
 
 #include <memory>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/calculators/util/annotation_overlay_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_options.pb.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
 #include "mediapipe/framework/formats/video_stream_header.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
@@ -56,8 +60,94 @@ size_t RoundUp(size_t n, size_t m) { return ((n + m - 1) / m) * m; }  // NOLINT
 // this color is not supported and it should be set to something unlikely used.
 constexpr uchar kAnnotationBackgroundColor = 2;  // Grayscale value.
 
+// Number of canvases kept for reuse by CanvasPool.
+constexpr int kCanvasKeepCount = 4;
+
 // Future Image type.
 inline bool HasImageTag(mediapipe::CalculatorContext* cc) { return false; }
+
+// Wraps the pixels of a pooled frame into an ImageFrame. The pooled frame
+// returns to its pool when the wrapping ImageFrame is destroyed.
+std::unique_ptr<ImageFrame> WrapPooledFrame(ImageFrameSharedPtr pooled) {
+  ImageFrame* frame = pooled.get();
+  return absl::make_unique<ImageFrame>(
+      frame->Format(), frame->Width(), frame->Height(), frame->WidthStep(),
+      frame->MutablePixelData(), [pooled](uint8*) {});
+}
+
+// A pool of SRGB canvases filled with a background color. Each canvas keeps
+// the region drawn over its background, so that a reused canvas is reset to
+// the background by filling only that region.
+class CanvasPool : public std::enable_shared_from_this<CanvasPool> {
+ public:
+  struct Canvas {
+    std::unique_ptr<ImageFrame> frame;
+    // The region that may differ from the background color.
+    cv::Rect drawn_region;
+  };
+
+  static std::shared_ptr<CanvasPool> Create(int width, int height,
+                                            const cv::Scalar& color) {
+    return std::shared_ptr<CanvasPool>(new CanvasPool(width, height, color));
+  }
+
+  // Obtains a canvas filled with the background color. May either be reused
+  // or created anew.
+  std::shared_ptr<Canvas> GetCanvas() {
+    std::unique_ptr<Canvas> canvas;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (!available_.empty()) {
+        canvas = std::move(available_.back());
+        available_.pop_back();
+      }
+    }
+    if (!canvas) {
+      canvas = absl::make_unique<Canvas>();
+      canvas->frame = absl::make_unique<ImageFrame>(
+          ImageFormat::SRGB, width_, height_,
+          ImageFrame::kGlDefaultAlignmentBoundary);
+      canvas->drawn_region = cv::Rect(0, 0, width_, height_);
+    }
+    if (!canvas->drawn_region.empty()) {
+      cv::Mat canvas_mat = formats::MatView(canvas->frame.get());
+      canvas_mat(canvas->drawn_region).setTo(color_);
+      canvas->drawn_region = cv::Rect();
+    }
+
+    std::weak_ptr<CanvasPool> weak_pool(shared_from_this());
+    return std::shared_ptr<Canvas>(canvas.release(),
+                                   [weak_pool](Canvas* canvas) {
+                                     auto pool = weak_pool.lock();
+                                     if (pool) {
+                                       pool->Return(canvas);
+                                     } else {
+                                       delete canvas;
+                                     }
+                                   });
+  }
+
+ private:
+  CanvasPool(int width, int height, const cv::Scalar& color)
+      : width_(width), height_(height), color_(color) {}
+
+  // Returns a canvas to the pool, or destroys it if enough canvases are
+  // available already.
+  void Return(Canvas* canvas) {
+    std::unique_ptr<Canvas> returned(canvas);
+    absl::MutexLock lock(&mutex_);
+    if (available_.size() < static_cast<size_t>(kCanvasKeepCount)) {
+      available_.push_back(std::move(returned));
+    }
+  }
+
+  const int width_;
+  const int height_;
+  const cv::Scalar color_;
+
+  absl::Mutex mutex_;
+  std::vector<std::unique_ptr<Canvas>> available_ ABSL_GUARDED_BY(mutex_);
+};
 }  // namespace
 
 // A calculator for rendering data on images.
@@ -84,6 +174,11 @@ inline bool HasImageTag(mediapipe::CalculatorContext* cc) { return false; }
 //
 // For GPU input frames, only 4-channel images are supported.
 //
+// On CPU, the annotations are rendered directly into output frames obtained
+// from the ImageFrameMultiPool of the graph. Without an input image,
+// render_dirty_region_only in the options makes the calculator reset only the
+// region drawn on a reused output frame.
+//
 // Note: When using GPU, drawing with color kAnnotationBackgroundColor (defined
 // above) is not supported.
 //
@@ -132,17 +227,16 @@ class AnnotationOverlayCalculator : public CalculatorBase {
   absl::Status Close(CalculatorContext* cc) override;
 
  private:
-  absl::Status CreateRenderTargetCpu(CalculatorContext* cc,
-                                     std::unique_ptr<cv::Mat>& image_mat,
-                                     ImageFormat::Format* target_format);
+  absl::Status CreateRenderTargetCpu(
+      CalculatorContext* cc, std::unique_ptr<ImageFrame>& output_frame,
+      std::shared_ptr<CanvasPool::Canvas>& canvas);
   template <typename Type, const char* Tag>
   absl::Status CreateRenderTargetGpu(CalculatorContext* cc,
                                      std::unique_ptr<cv::Mat>& image_mat);
   template <typename Type, const char* Tag>
   absl::Status RenderToGpu(CalculatorContext* cc, uchar* overlay_image);
   absl::Status RenderToCpu(CalculatorContext* cc,
-                           const ImageFormat::Format& target_format,
-                           uchar* data_image);
+                           std::unique_ptr<ImageFrame> output_frame);
 
   absl::Status GlRender(CalculatorContext* cc);
   template <typename Type, const char* Tag>
@@ -157,6 +251,9 @@ class AnnotationOverlayCalculator : public CalculatorBase {
   // Indicates if image frame is available as input.
   bool image_frame_available_ = false;
 
+  // Pool of the output canvases when rendering only dirty regions on CPU.
+  std::shared_ptr<CanvasPool> canvas_pool_;
+
   bool use_gpu_ = false;
   bool gpu_initialized_ = false;
 #if !MEDIAPIPE_DISABLE_GPU
@@ -225,6 +322,8 @@ absl::Status AnnotationOverlayCalculator::GetContract(CalculatorContract* cc) {
 #if !MEDIAPIPE_DISABLE_GPU
     MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
 #endif  // !MEDIAPIPE_DISABLE_GPU
+  } else {
+    cc->UseService(kImageFrameMultiPoolService);
   }
 
   return absl::OkStatus();
@@ -251,6 +350,7 @@ absl::Status AnnotationOverlayCalculator::Open(CalculatorContext* cc) {
   // Initialize the helper renderer library.
   renderer_ = absl::make_unique<AnnotationRenderer>();
   renderer_->SetFlipTextVertically(options_.flip_text_vertically());
+  renderer_->SetUseScanlineRasterizer(options_.use_scanline_rasterizer());
   if (use_gpu_) renderer_->SetScaleFactor(options_.gpu_scale_factor());
 
   // Set the output header based on the input header (if present).
@@ -266,6 +366,11 @@ absl::Status AnnotationOverlayCalculator::Open(CalculatorContext* cc) {
 #if !MEDIAPIPE_DISABLE_GPU
     MP_RETURN_IF_ERROR(gpu_helper_.Open(cc));
 #endif  // !MEDIAPIPE_DISABLE_GPU
+  } else if (!image_frame_available_ && options_.render_dirty_region_only()) {
+    canvas_pool_ = CanvasPool::Create(
+        options_.canvas_width_px(), options_.canvas_height_px(),
+        cv::Scalar(options_.canvas_color().r(), options_.canvas_color().g(),
+                   options_.canvas_color().b()));
   }
 
   return absl::OkStatus();
@@ -274,7 +379,8 @@ absl::Status AnnotationOverlayCalculator::Open(CalculatorContext* cc) {
 absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
   // Initialize render target, drawn with OpenCV.
   std::unique_ptr<cv::Mat> image_mat;
-  ImageFormat::Format target_format;
+  std::unique_ptr<ImageFrame> output_frame;
+  std::shared_ptr<CanvasPool::Canvas> canvas;
   if (use_gpu_) {
 #if !MEDIAPIPE_DISABLE_GPU
     if (!gpu_initialized_) {
@@ -292,7 +398,10 @@ absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
 #endif  // !MEDIAPIPE_DISABLE_GPU
   } else {
     if (cc->Outputs().HasTag(kImageFrameTag)) {
-      MP_RETURN_IF_ERROR(CreateRenderTargetCpu(cc, image_mat, &target_format));
+      MP_RETURN_IF_ERROR(CreateRenderTargetCpu(cc, output_frame, canvas));
+      // Render directly into the output frame, no copy here.
+      image_mat =
+          absl::make_unique<cv::Mat>(formats::MatView(output_frame.get()));
     }
   }
 
@@ -335,9 +444,8 @@ absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
         }));
 #endif  // !MEDIAPIPE_DISABLE_GPU
   } else {
-    // Copy the rendered image to output.
-    uchar* image_mat_ptr = image_mat->data;
-    MP_RETURN_IF_ERROR(RenderToCpu(cc, target_format, image_mat_ptr));
+    if (canvas) canvas->drawn_region = renderer_->GetDrawnRegion();
+    MP_RETURN_IF_ERROR(RenderToCpu(cc, std::move(output_frame)));
   }
 
   return absl::OkStatus();
@@ -357,21 +465,7 @@ absl::Status AnnotationOverlayCalculator::Close(CalculatorContext* cc) {
 }
 
 absl::Status AnnotationOverlayCalculator::RenderToCpu(
-    CalculatorContext* cc, const ImageFormat::Format& target_format,
-    uchar* data_image) {
-  auto output_frame = absl::make_unique<ImageFrame>(
-      target_format, renderer_->GetImageWidth(), renderer_->GetImageHeight());
-
-#if !MEDIAPIPE_DISABLE_GPU
-  output_frame->CopyPixelData(target_format, renderer_->GetImageWidth(),
-                              renderer_->GetImageHeight(), data_image,
-                              ImageFrame::kGlDefaultAlignmentBoundary);
-#else
-  output_frame->CopyPixelData(target_format, renderer_->GetImageWidth(),
-                              renderer_->GetImageHeight(), data_image,
-                              ImageFrame::kDefaultAlignmentBoundary);
-#endif  // !MEDIAPIPE_DISABLE_GPU
-
+    CalculatorContext* cc, std::unique_ptr<ImageFrame> output_frame) {
   if (cc->Outputs().HasTag(kImageFrameTag)) {
     cc->Outputs()
         .Tag(kImageFrameTag)
@@ -431,48 +525,60 @@ absl::Status AnnotationOverlayCalculator::RenderToGpu(CalculatorContext* cc,
 }
 
 absl::Status AnnotationOverlayCalculator::CreateRenderTargetCpu(
-    CalculatorContext* cc, std::unique_ptr<cv::Mat>& image_mat,
-    ImageFormat::Format* target_format) {
+    CalculatorContext* cc, std::unique_ptr<ImageFrame>& output_frame,
+    std::shared_ptr<CanvasPool::Canvas>& canvas) {
+  if (canvas_pool_) {
+    canvas = canvas_pool_->GetCanvas();
+    output_frame = WrapPooledFrame(
+        ImageFrameSharedPtr(canvas, canvas->frame.get()));
+    return absl::OkStatus();
+  }
+
+  int width;
+  int height;
+  ImageFormat::Format target_format;
   if (image_frame_available_) {
     const auto& input_frame =
         cc->Inputs().Tag(kImageFrameTag).Get<ImageFrame>();
-
-    int target_mat_type;
     switch (input_frame.Format()) {
       case ImageFormat::SRGBA:
-        *target_format = ImageFormat::SRGBA;
-        target_mat_type = CV_8UC4;
+        target_format = ImageFormat::SRGBA;
         break;
       case ImageFormat::SRGB:
-        *target_format = ImageFormat::SRGB;
-        target_mat_type = CV_8UC3;
+        target_format = ImageFormat::SRGB;
         break;
       case ImageFormat::GRAY8:
-        *target_format = ImageFormat::SRGB;
-        target_mat_type = CV_8UC3;
+        target_format = ImageFormat::SRGB;
         break;
       default:
         return absl::UnknownError("Unexpected image frame format.");
         break;
     }
+    width = input_frame.Width();
+    height = input_frame.Height();
+  } else {
+    target_format = ImageFormat::SRGB;
+    width = options_.canvas_width_px();
+    height = options_.canvas_height_px();
+  }
 
-    image_mat = absl::make_unique<cv::Mat>(
-        input_frame.Height(), input_frame.Width(), target_mat_type);
+  output_frame = GetImageFrameMultiPool(cc).GetFrame(
+      target_format, width, height, ImageFrame::kGlDefaultAlignmentBoundary);
 
+  cv::Mat output_mat = formats::MatView(output_frame.get());
+  if (image_frame_available_) {
+    const auto& input_frame =
+        cc->Inputs().Tag(kImageFrameTag).Get<ImageFrame>();
     auto input_mat = formats::MatView(&input_frame);
     if (input_frame.Format() == ImageFormat::GRAY8) {
-      cv::Mat rgb_mat;
-      cv::cvtColor(input_mat, rgb_mat, CV_GRAY2RGB);
-      rgb_mat.copyTo(*image_mat);
+      cv::cvtColor(input_mat, output_mat, CV_GRAY2RGB);
     } else {
-      input_mat.copyTo(*image_mat);
+      input_mat.copyTo(output_mat);
     }
   } else {
-    image_mat = absl::make_unique<cv::Mat>(
-        options_.canvas_height_px(), options_.canvas_width_px(), CV_8UC3,
-        cv::Scalar(options_.canvas_color().r(), options_.canvas_color().g(),
-                   options_.canvas_color().b()));
-    *target_format = ImageFormat::SRGB;
+    output_mat.setTo(cv::Scalar(options_.canvas_color().r(),
+                                options_.canvas_color().g(),
+                                options_.canvas_color().b()));
   }
 
   return absl::OkStatus();
@@ -0,0 +1,197 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/calculators/util/detection_scheduler_calculator.pb.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+namespace api2 {
+
+namespace {
+
+// Returns the displacement of |rect| from the closest rect of |prev_rects|,
+// as a fraction of its size, or 0 if |prev_rects| is empty.
+float GetDisplacement(const NormalizedRect& rect,
+                      const std::vector<NormalizedRect>& prev_rects) {
+  if (prev_rects.empty() || rect.width() <= 0.0f || rect.height() <= 0.0f) {
+    return 0.0f;
+  }
+  float min_displacement = std::numeric_limits<float>::max();
+  for (const auto& prev_rect : prev_rects) {
+    const float dx = (rect.x_center() - prev_rect.x_center()) / rect.width();
+    const float dy = (rect.y_center() - prev_rect.y_center()) / rect.height();
+    min_displacement = std::min(min_displacement, std::hypot(dx, dy));
+  }
+  return min_displacement;
+}
+
+}  // namespace
+
+// Decides on every frame whether an object detector, e.g. palm detection,
+// should run in a detect-then-track pipeline, based on the regions tracked
+// on the previous frame.
+//
+// Detection runs on every frame without tracked objects, as nothing else can
+// find them. While all objects are tracked it is skipped. While some objects
+// are missing, e.g. one hand is tracked with a maximum of two, detection runs
+// on the cadence and latency budget of the options instead of on every frame.
+// Detection runs regardless of the cadence when a tracked object is about to
+// be lost, i.e. its presence score is low or its region moves too fast.
+//
+// Inputs:
+//   TICK: Any packet, typically the input image, defining the frames.
+//   PREV_RECTS: std::vector<NormalizedRect> of the objects tracked on the
+//     previous frame, e.g. from a PreviousLoopbackCalculator. An empty packet
+//     means no tracked objects.
+//   PREV_PRESENCE_SCORES (optional): std::vector<float> of the presence scores
+//     of the objects tracked on the previous frame.
+//
+// Input side packets:
+//   MAX_NUM_OBJECTS (optional): int, overrides the max_num_objects option.
+//
+// Outputs:
+//   DETECT: bool, true if detection should run on the frame. Typically feeds
+//     the ALLOW input of a GateCalculator on the detector input.
+//
+// Example:
+// node {
+//   calculator: "DetectionSchedulerCalculator"
+//   input_stream: "TICK:image"
+//   input_stream: "PREV_RECTS:prev_hand_rects_from_landmarks"
+//   input_side_packet: "MAX_NUM_OBJECTS:num_hands"
+//   output_stream: "DETECT:run_palm_detection"
+//   options: {
+//     [mediapipe.DetectionSchedulerCalculatorOptions.ext] {
+//       missing_objects_frame_interval: 5
+//     }
+//   }
+// }
+class DetectionSchedulerCalculator : public Node {
+ public:
+  static constexpr Input<AnyType> kTick{"TICK"};
+  static constexpr Input<std::vector<NormalizedRect>> kPrevRects{
+      "PREV_RECTS"};
+  static constexpr Input<std::vector<float>>::Optional kPrevPresenceScores{
+      "PREV_PRESENCE_SCORES"};
+  static constexpr SideInput<int>::Optional kMaxNumObjects{"MAX_NUM_OBJECTS"};
+  static constexpr Output<bool> kDetect{"DETECT"};
+
+  MEDIAPIPE_NODE_CONTRACT(kTick, kPrevRects, kPrevPresenceScores,
+                          kMaxNumObjects, kDetect);
+
+  static absl::Status UpdateContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  // Returns true if a tracked object is about to be lost.
+  bool IsTrackingUnreliable(CalculatorContext* cc,
+                            const std::vector<NormalizedRect>& rects) const;
+
+  DetectionSchedulerCalculatorOptions options_;
+  int max_num_objects_ = 1;
+  // The tracked regions of the last frame, to estimate their motion.
+  std::vector<NormalizedRect> last_rects_;
+  // Frames and timestamp since the last detection.
+  int frames_since_detection_ = 0;
+  int64_t last_detection_us_ = 0;
+  bool detected_ = false;
+};
+MEDIAPIPE_REGISTER_NODE(DetectionSchedulerCalculator);
+
+absl::Status DetectionSchedulerCalculator::UpdateContract(
+    CalculatorContract* cc) {
+  const auto& options = cc->Options<DetectionSchedulerCalculatorOptions>();
+  RET_CHECK_GE(options.max_num_objects(), 1);
+  RET_CHECK_GE(options.missing_objects_frame_interval(), 1);
+  RET_CHECK_GE(options.missing_objects_min_interval_us(), 0);
+  return absl::OkStatus();
+}
+
+absl::Status DetectionSchedulerCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  options_ = cc->Options<DetectionSchedulerCalculatorOptions>();
+  max_num_objects_ = kMaxNumObjects(cc).GetOr(options_.max_num_objects());
+  RET_CHECK_GE(max_num_objects_, 1);
+  return absl::OkStatus();
+}
+
+absl::Status DetectionSchedulerCalculator::Process(CalculatorContext* cc) {
+  if (kTick(cc).IsEmpty()) {
+    return absl::OkStatus();
+  }
+  std::vector<NormalizedRect> rects;
+  if (!kPrevRects(cc).IsEmpty()) {
+    rects = *kPrevRects(cc);
+  }
+  const int64_t timestamp_us = cc->InputTimestamp().Microseconds();
+  ++frames_since_detection_;
+
+  bool detect;
+  if (rects.empty()) {
+    detect = true;
+  } else if (IsTrackingUnreliable(cc, rects)) {
+    detect = true;
+  } else if (static_cast<int>(rects.size()) >= max_num_objects_) {
+    detect = false;
+  } else {
+    detect = !detected_ || (frames_since_detection_ >=
+                                options_.missing_objects_frame_interval() &&
+                            timestamp_us - last_detection_us_ >=
+                                options_.missing_objects_min_interval_us());
+  }
+
+  if (detect) {
+    frames_since_detection_ = 0;
+    last_detection_us_ = timestamp_us;
+    detected_ = true;
+  }
+  last_rects_ = std::move(rects);
+  kDetect(cc).Send(detect);
+  return absl::OkStatus();
+}
+
+bool DetectionSchedulerCalculator::IsTrackingUnreliable(
+    CalculatorContext* cc, const std::vector<NormalizedRect>& rects) const {
+  if (options_.min_presence_score() > 0.0f &&
+      !kPrevPresenceScores(cc).IsEmpty()) {
+    for (float score : *kPrevPresenceScores(cc)) {
+      if (score < options_.min_presence_score()) return true;
+    }
+  }
+  if (options_.max_roi_displacement() > 0.0f) {
+    for (const auto& rect : rects) {
+      if (GetDisplacement(rect, last_rects_) >
+          options_.max_roi_displacement()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+}  // namespace api2
+}  // namespace mediapipe
@@ -0,0 +1,170 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/substitute.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+constexpr int64 kFrameIntervalUs = 33333;
+
+NormalizedRect MakeRect(float x_center, float y_center) {
+  NormalizedRect rect;
+  rect.set_x_center(x_center);
+  rect.set_y_center(y_center);
+  rect.set_width(0.2f);
+  rect.set_height(0.2f);
+  return rect;
+}
+
+class DetectionSchedulerCalculatorTest : public ::testing::Test {
+ protected:
+  void CreateRunner(const std::string& options, int max_num_objects) {
+    runner_ = absl::make_unique<CalculatorRunner>(
+        ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+            R"pb(
+              calculator: "DetectionSchedulerCalculator"
+              input_stream: "TICK:image"
+              input_stream: "PREV_RECTS:prev_rects"
+              input_stream: "PREV_PRESENCE_SCORES:prev_scores"
+              input_side_packet: "MAX_NUM_OBJECTS:max_num_objects"
+              output_stream: "DETECT:detect"
+              options {
+                [mediapipe.DetectionSchedulerCalculatorOptions.ext] { $0 }
+              }
+            )pb",
+            options)));
+    runner_->MutableSidePackets()->Tag("MAX_NUM_OBJECTS") =
+        MakePacket<int>(max_num_objects);
+  }
+
+  // Adds a frame with the regions and presence scores tracked on the previous
+  // frame. No regions means an empty packet, as for the first frame.
+  void AddFrame(const std::vector<NormalizedRect>& rects,
+                const std::vector<float>& scores = {}) {
+    const Timestamp timestamp(num_frames_++ * kFrameIntervalUs);
+    runner_->MutableInputs()->Tag("TICK").packets.push_back(
+        MakePacket<int>(0).At(timestamp));
+    if (!rects.empty()) {
+      runner_->MutableInputs()->Tag("PREV_RECTS").packets.push_back(
+          MakePacket<std::vector<NormalizedRect>>(rects).At(timestamp));
+    }
+    if (!scores.empty()) {
+      runner_->MutableInputs()->Tag("PREV_PRESENCE_SCORES").packets.push_back(
+          MakePacket<std::vector<float>>(scores).At(timestamp));
+    }
+  }
+
+  std::vector<bool> Run() {
+    MP_EXPECT_OK(runner_->Run());
+    std::vector<bool> detect;
+    for (const Packet& packet : runner_->Outputs().Tag("DETECT").packets) {
+      detect.push_back(packet.Get<bool>());
+    }
+    return detect;
+  }
+
+  std::unique_ptr<CalculatorRunner> runner_;
+  int num_frames_ = 0;
+};
+
+TEST_F(DetectionSchedulerCalculatorTest, DetectsWithoutTrackedObjects) {
+  CreateRunner("missing_objects_frame_interval: 10", /*max_num_objects=*/2);
+  AddFrame({});
+  AddFrame({});
+  AddFrame({});
+  EXPECT_THAT(Run(), ElementsAre(true, true, true));
+}
+
+TEST_F(DetectionSchedulerCalculatorTest, SkipsWhenAllObjectsAreTracked) {
+  CreateRunner("missing_objects_frame_interval: 1", /*max_num_objects=*/2);
+  AddFrame({});
+  for (int i = 0; i < 3; ++i) {
+    AddFrame({MakeRect(0.3f, 0.5f), MakeRect(0.7f, 0.5f)});
+  }
+  EXPECT_THAT(Run(), ElementsAre(true, false, false, false));
+}
+
+TEST_F(DetectionSchedulerCalculatorTest, DetectsEveryFrameByDefault) {
+  CreateRunner("", /*max_num_objects=*/2);
+  AddFrame({});
+  for (int i = 0; i < 3; ++i) {
+    AddFrame({MakeRect(0.3f, 0.5f)});
+  }
+  EXPECT_THAT(Run(), ElementsAre(true, true, true, true));
+}
+
+TEST_F(DetectionSchedulerCalculatorTest, FollowsFrameIntervalWhenMissing) {
+  CreateRunner("missing_objects_frame_interval: 3", /*max_num_objects=*/2);
+  AddFrame({});
+  for (int i = 0; i < 6; ++i) {
+    AddFrame({MakeRect(0.3f, 0.5f)});
+  }
+  EXPECT_THAT(Run(),
+              ElementsAre(true, false, false, true, false, false, true));
+}
+
+TEST_F(DetectionSchedulerCalculatorTest, FollowsMinIntervalWhenMissing) {
+  // Just over two frame intervals.
+  CreateRunner(absl::StrCat("missing_objects_min_interval_us: ",
+                            2 * kFrameIntervalUs + 1),
+               /*max_num_objects=*/2);
+  AddFrame({});
+  for (int i = 0; i < 6; ++i) {
+    AddFrame({MakeRect(0.3f, 0.5f)});
+  }
+  EXPECT_THAT(Run(),
+              ElementsAre(true, false, false, true, false, false, true));
+}
+
+TEST_F(DetectionSchedulerCalculatorTest, DetectsOnLowPresenceScore) {
+  CreateRunner("missing_objects_frame_interval: 10 min_presence_score: 0.8",
+               /*max_num_objects=*/2);
+  AddFrame({});
+  AddFrame({MakeRect(0.3f, 0.5f), MakeRect(0.7f, 0.5f)}, {0.9f, 0.95f});
+  AddFrame({MakeRect(0.3f, 0.5f), MakeRect(0.7f, 0.5f)}, {0.9f, 0.6f});
+  AddFrame({MakeRect(0.3f, 0.5f)}, {0.9f});
+  EXPECT_THAT(Run(), ElementsAre(true, false, true, false));
+}
+
+TEST_F(DetectionSchedulerCalculatorTest, DetectsOnUnstableRegion) {
+  CreateRunner("missing_objects_frame_interval: 10 max_roi_displacement: 0.5",
+               /*max_num_objects=*/2);
+  AddFrame({});
+  AddFrame({MakeRect(0.3f, 0.5f), MakeRect(0.7f, 0.5f)});
+  // Moves by a quarter of the region size.
+  AddFrame({MakeRect(0.35f, 0.5f), MakeRect(0.7f, 0.5f)});
+  // Moves by more than half of the region size.
+  AddFrame({MakeRect(0.35f, 0.5f), MakeRect(0.7f, 0.65f)});
+  AddFrame({MakeRect(0.35f, 0.5f), MakeRect(0.7f, 0.65f)});
+  EXPECT_THAT(Run(), ElementsAre(true, false, false, true, false));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -13,15 +13,17 @@
 // limitations under the License.
 
 #include <memory>
+#include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/memory/memory.h"
+#include "absl/types/span.h"
 #include "mediapipe/calculators/util/landmarks_smoothing_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/timestamp.h"
-#include "mediapipe/util/filtering/one_euro_filter.h"
-#include "mediapipe/util/filtering/relative_velocity_filter.h"
+#include "mediapipe/util/filtering/filter_bank.h"
 
 namespace mediapipe {
 
@@ -33,8 +35,8 @@ constexpr char kImageSizeTag[] = "IMAGE_SIZE";
 constexpr char kNormalizedFilteredLandmarksTag[] = "NORM_FILTERED_LANDMARKS";
 constexpr char kFilteredLandmarksTag[] = "FILTERED_LANDMARKS";
 
-using mediapipe::OneEuroFilter;
-using mediapipe::RelativeVelocityFilter;
+using mediapipe::OneEuroFilterBank;
+using mediapipe::RelativeVelocityFilterBank;
 
 void NormalizedLandmarksToLandmarks(
     const NormalizedLandmarkList& norm_landmarks, const int image_width,
@@ -94,6 +96,40 @@ float GetObjectScale(const LandmarkList& landmarks) {
   return (object_width + object_height) / 2.0f;
 }
 
+// Gathers the coordinates of the landmarks into |values|, as all x, then all
+// y, then all z coordinates, for the filter banks.
+void GetCoordinates(const LandmarkList& landmarks, std::vector<float>* values) {
+  const int n_landmarks = landmarks.landmark_size();
+  values->resize(n_landmarks * 3);
+  float* x = values->data();
+  float* y = x + n_landmarks;
+  float* z = y + n_landmarks;
+  for (int i = 0; i < n_landmarks; ++i) {
+    const auto& landmark = landmarks.landmark(i);
+    x[i] = landmark.x();
+    y[i] = landmark.y();
+    z[i] = landmark.z();
+  }
+}
+
+// Adds |in_landmarks| to |out_landmarks| with the coordinates from |values|,
+// laid out as by GetCoordinates.
+void SetCoordinates(const LandmarkList& in_landmarks,
+                    const std::vector<float>& values,
+                    LandmarkList* out_landmarks) {
+  const int n_landmarks = in_landmarks.landmark_size();
+  const float* x = values.data();
+  const float* y = x + n_landmarks;
+  const float* z = y + n_landmarks;
+  for (int i = 0; i < n_landmarks; ++i) {
+    auto* out_landmark = out_landmarks->add_landmark();
+    *out_landmark = in_landmarks.landmark(i);
+    out_landmark->set_x(x[i]);
+    out_landmark->set_y(y[i]);
+    out_landmark->set_z(z[i]);
+  }
+}
+
 // Abstract class for various landmarks filters.
 class LandmarksFilter {
  public:
@@ -128,9 +164,7 @@ class VelocityFilter : public LandmarksFilter {
         disable_value_scaling_(disable_value_scaling) {}
 
   absl::Status Reset() override {
-    x_filters_.clear();
-    y_filters_.clear();
-    z_filters_.clear();
+    filters_.reset();
     return absl::OkStatus();
   }
 
@@ -154,18 +188,9 @@ class VelocityFilter : public LandmarksFilter {
     MP_RETURN_IF_ERROR(InitializeFiltersIfEmpty(in_landmarks.landmark_size()));
 
     // Filter landmarks. Every axis of every landmark is filtered separately.
-    for (int i = 0; i < in_landmarks.landmark_size(); ++i) {
-      const auto& in_landmark = in_landmarks.landmark(i);
-
-      auto* out_landmark = out_landmarks->add_landmark();
-      *out_landmark = in_landmark;
-      out_landmark->set_x(
-          x_filters_[i].Apply(timestamp, value_scale, in_landmark.x()));
-      out_landmark->set_y(
-          y_filters_[i].Apply(timestamp, value_scale, in_landmark.y()));
-      out_landmark->set_z(
-          z_filters_[i].Apply(timestamp, value_scale, in_landmark.z()));
-    }
+    GetCoordinates(in_landmarks, &values_);
+    filters_->Apply(timestamp, value_scale, values_, absl::MakeSpan(values_));
+    SetCoordinates(in_landmarks, values_, out_landmarks);
 
     return absl::OkStatus();
   }
@@ -174,19 +199,14 @@ class VelocityFilter : public LandmarksFilter {
   // Initializes filters for the first time or after Reset. If initialized then
   // check the size.
   absl::Status InitializeFiltersIfEmpty(const int n_landmarks) {
-    if (!x_filters_.empty()) {
-      RET_CHECK_EQ(x_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(y_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(z_filters_.size(), n_landmarks);
+    // Like an empty bank, a bank created for no landmarks is uninitialized.
+    if (filters_ && filters_->num_values() > 0) {
+      RET_CHECK_EQ(filters_->num_values(), n_landmarks * 3);
       return absl::OkStatus();
     }
 
-    x_filters_.resize(n_landmarks,
-                      RelativeVelocityFilter(window_size_, velocity_scale_));
-    y_filters_.resize(n_landmarks,
-                      RelativeVelocityFilter(window_size_, velocity_scale_));
-    z_filters_.resize(n_landmarks,
-                      RelativeVelocityFilter(window_size_, velocity_scale_));
+    filters_ = absl::make_unique<RelativeVelocityFilterBank>(
+        n_landmarks * 3, window_size_, velocity_scale_);
 
     return absl::OkStatus();
   }
@@ -196,9 +216,8 @@ class VelocityFilter : public LandmarksFilter {
   float min_allowed_object_scale_;
   bool disable_value_scaling_;
 
-  std::vector<RelativeVelocityFilter> x_filters_;
-  std::vector<RelativeVelocityFilter> y_filters_;
-  std::vector<RelativeVelocityFilter> z_filters_;
+  std::unique_ptr<RelativeVelocityFilterBank> filters_;
+  std::vector<float> values_;
 };
 
 // Please check OneEuroFilter documentation for details.
@@ -212,9 +231,7 @@ class OneEuroFilterImpl : public LandmarksFilter {
         derivate_cutoff_(derivate_cutoff) {}
 
   absl::Status Reset() override {
-    x_filters_.clear();
-    y_filters_.clear();
-    z_filters_.clear();
+    filters_.reset();
     return absl::OkStatus();
   }
 
@@ -225,15 +242,9 @@ class OneEuroFilterImpl : public LandmarksFilter {
     MP_RETURN_IF_ERROR(InitializeFiltersIfEmpty(in_landmarks.landmark_size()));
 
     // Filter landmarks. Every axis of every landmark is filtered separately.
-    for (int i = 0; i < in_landmarks.landmark_size(); ++i) {
-      const auto& in_landmark = in_landmarks.landmark(i);
-
-      auto* out_landmark = out_landmarks->add_landmark();
-      *out_landmark = in_landmark;
-      out_landmark->set_x(x_filters_[i].Apply(timestamp, in_landmark.x()));
-      out_landmark->set_y(y_filters_[i].Apply(timestamp, in_landmark.y()));
-      out_landmark->set_z(z_filters_[i].Apply(timestamp, in_landmark.z()));
-    }
+    GetCoordinates(in_landmarks, &values_);
+    filters_->Apply(timestamp, values_, absl::MakeSpan(values_));
+    SetCoordinates(in_landmarks, values_, out_landmarks);
 
     return absl::OkStatus();
   }
@@ -242,21 +253,14 @@ class OneEuroFilterImpl : public LandmarksFilter {
   // Initializes filters for the first time or after Reset. If initialized then
   // check the size.
   absl::Status InitializeFiltersIfEmpty(const int n_landmarks) {
-    if (!x_filters_.empty()) {
-      RET_CHECK_EQ(x_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(y_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(z_filters_.size(), n_landmarks);
+    // Like an empty bank, a bank created for no landmarks is uninitialized.
+    if (filters_ && filters_->num_values() > 0) {
+      RET_CHECK_EQ(filters_->num_values(), n_landmarks * 3);
       return absl::OkStatus();
     }
 
-    for (int i = 0; i < n_landmarks; ++i) {
-      x_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-      y_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-      z_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-    }
+    filters_ = absl::make_unique<OneEuroFilterBank>(
+        n_landmarks * 3, frequency_, min_cutoff_, beta_, derivate_cutoff_);
 
     return absl::OkStatus();
   }
@@ -266,9 +270,8 @@ class OneEuroFilterImpl : public LandmarksFilter {
   double beta_;
   double derivate_cutoff_;
 
-  std::vector<OneEuroFilter> x_filters_;
-  std::vector<OneEuroFilter> y_filters_;
-  std::vector<OneEuroFilter> z_filters_;
+  std::unique_ptr<OneEuroFilterBank> filters_;
+  std::vector<float> values_;
 };
 
 }  // namespace
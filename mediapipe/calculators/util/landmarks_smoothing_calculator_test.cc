@@ -0,0 +1,83 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_replace.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+CalculatorGraphConfig::Node GetNode(const std::string& filter_options) {
+  return ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::StrReplaceAll(
+      R"pb(
+        calculator: "LandmarksSmoothingCalculator"
+        input_stream: "LANDMARKS:landmarks"
+        output_stream: "FILTERED_LANDMARKS:filtered_landmarks"
+        options: {
+          [mediapipe.LandmarksSmoothingCalculatorOptions.ext] { $filter }
+        }
+      )pb",
+      {{"$filter", filter_options}}));
+}
+
+LandmarkList CreateLandmarks(int num_landmarks) {
+  LandmarkList landmarks;
+  for (int i = 0; i < num_landmarks; ++i) {
+    Landmark* landmark = landmarks.add_landmark();
+    landmark->set_x(10 * i);
+    landmark->set_y(20 * i);
+    landmark->set_z(i);
+  }
+  return landmarks;
+}
+
+// An empty first packet leaves the filters uninitialized, so that the
+// following packets can have any number of landmarks.
+void ExpectFiltersEmptyThenNonEmpty(const std::string& filter_options) {
+  CalculatorRunner runner(GetNode(filter_options));
+  auto& packets = runner.MutableInputs()->Tag("LANDMARKS").packets;
+  packets.push_back(MakePacket<LandmarkList>(CreateLandmarks(0)).At(
+      Timestamp(0)));
+  packets.push_back(MakePacket<LandmarkList>(CreateLandmarks(3)).At(
+      Timestamp(33000)));
+  packets.push_back(MakePacket<LandmarkList>(CreateLandmarks(3)).At(
+      Timestamp(66000)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& output = runner.Outputs().Tag("FILTERED_LANDMARKS").packets;
+  ASSERT_EQ(3, output.size());
+  EXPECT_EQ(0, output[0].Get<LandmarkList>().landmark_size());
+  EXPECT_EQ(3, output[1].Get<LandmarkList>().landmark_size());
+  EXPECT_EQ(3, output[2].Get<LandmarkList>().landmark_size());
+}
+
+TEST(LandmarksSmoothingCalculatorTest, VelocityFilterEmptyThenNonEmpty) {
+  ExpectFiltersEmptyThenNonEmpty(
+      "velocity_filter { disable_value_scaling: true }");
+}
+
+TEST(LandmarksSmoothingCalculatorTest, OneEuroFilterEmptyThenNonEmpty) {
+  ExpectFiltersEmptyThenNonEmpty("one_euro_filter {}");
+}
+
+}  // namespace
+}  // namespace mediapipe
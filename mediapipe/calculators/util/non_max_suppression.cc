@@ -0,0 +1,341 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/util/non_max_suppression.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+using OverlapType = NonMaxSuppressionCalculatorOptions::OverlapType;
+
+constexpr int kMaxGridCellsPerSide = 64;
+
+// Computes the overlap similarities of a box with other boxes.  The results
+// are the same as with Rectangle_f operations on each pair, with the other
+// box as the first rectangle.  The other boxes are gathered into contiguous
+// arrays first, so that the computation itself vectorizes.
+class SimilarityKernel {
+ public:
+  SimilarityKernel(OverlapType overlap_type, const NmsBoxes& boxes)
+      : overlap_type_(overlap_type), boxes_(boxes) {}
+
+  // Returns the similarities of the boxes |others| with |box|.
+  const std::vector<float>& Compute(const std::vector<int>& others, int box) {
+    const int num_others = others.size();
+    xmin_.resize(num_others);
+    ymin_.resize(num_others);
+    xmax_.resize(num_others);
+    ymax_.resize(num_others);
+    area_.resize(num_others);
+    similarities_.resize(num_others);
+    for (int k = 0; k < num_others; ++k) {
+      const int other = others[k];
+      xmin_[k] = boxes_.xmin[other];
+      ymin_[k] = boxes_.ymin[other];
+      xmax_[k] = boxes_.xmax[other];
+      ymax_[k] = boxes_.ymax[other];
+      area_[k] = boxes_.area[other];
+    }
+    switch (overlap_type_) {
+      case NonMaxSuppressionCalculatorOptions::JACCARD:
+        ComputeGathered<NonMaxSuppressionCalculatorOptions::JACCARD>(box);
+        break;
+      case NonMaxSuppressionCalculatorOptions::MODIFIED_JACCARD:
+        ComputeGathered<NonMaxSuppressionCalculatorOptions::MODIFIED_JACCARD>(
+            box);
+        break;
+      case NonMaxSuppressionCalculatorOptions::INTERSECTION_OVER_UNION:
+        ComputeGathered<
+            NonMaxSuppressionCalculatorOptions::INTERSECTION_OVER_UNION>(box);
+        break;
+      default:
+        LOG(FATAL) << "Unrecognized overlap type: " << overlap_type_;
+    }
+    return similarities_;
+  }
+
+ private:
+  template <OverlapType kOverlapType>
+  void ComputeGathered(int box) {
+    const float box_xmin = boxes_.xmin[box];
+    const float box_ymin = boxes_.ymin[box];
+    const float box_xmax = boxes_.xmax[box];
+    const float box_ymax = boxes_.ymax[box];
+    const float box_area = boxes_.area[box];
+    const bool box_empty = box_xmin > box_xmax || box_ymin > box_ymax;
+    const int num_others = similarities_.size();
+    for (int k = 0; k < num_others; ++k) {
+      const bool intersects =
+          !(box_empty || xmin_[k] > xmax_[k] || ymin_[k] > ymax_[k] ||
+            box_xmax < xmin_[k] || xmax_[k] < box_xmin ||
+            box_ymax < ymin_[k] || ymax_[k] < box_ymin);
+      const float intersection_area =
+          (std::min(xmax_[k], box_xmax) - std::max(xmin_[k], box_xmin)) *
+          (std::min(ymax_[k], box_ymax) - std::max(ymin_[k], box_ymin));
+      float normalization;
+      switch (kOverlapType) {
+        case NonMaxSuppressionCalculatorOptions::JACCARD:
+          normalization =
+              (std::max(xmax_[k], box_xmax) - std::min(xmin_[k], box_xmin)) *
+              (std::max(ymax_[k], box_ymax) - std::min(ymin_[k], box_ymin));
+          break;
+        case NonMaxSuppressionCalculatorOptions::MODIFIED_JACCARD:
+          normalization = box_area;
+          break;
+        default:  // INTERSECTION_OVER_UNION
+          normalization = area_[k] + box_area - intersection_area;
+          break;
+      }
+      similarities_[k] = intersects && normalization > 0.0f
+                             ? intersection_area / normalization
+                             : 0.0f;
+    }
+  }
+
+  const OverlapType overlap_type_;
+  const NmsBoxes& boxes_;
+  std::vector<float> xmin_;
+  std::vector<float> ymin_;
+  std::vector<float> xmax_;
+  std::vector<float> ymax_;
+  std::vector<float> area_;
+  std::vector<float> similarities_;
+};
+
+// A uniform grid over boxes, listing the inserted boxes overlapping each cell.
+// Boxes with a positive intersection share at least one cell.
+class BoxGrid {
+ public:
+  // With |cells_per_side| = 1, all inserted boxes are neighbors.
+  BoxGrid(const NmsBoxes& boxes, int cells_per_side)
+      : boxes_(boxes),
+        cells_per_side_(cells_per_side),
+        cells_(cells_per_side * cells_per_side),
+        visit_stamps_(boxes.size(), 0) {
+    if (cells_per_side_ == 1) return;
+    float min_x = boxes.xmin[0];
+    float max_x = boxes.xmin[0];
+    float min_y = boxes.ymin[0];
+    float max_y = boxes.ymin[0];
+    for (int i = 0; i < boxes.size(); ++i) {
+      min_x = std::min(min_x, std::min(boxes.xmin[i], boxes.xmax[i]));
+      max_x = std::max(max_x, std::max(boxes.xmin[i], boxes.xmax[i]));
+      min_y = std::min(min_y, std::min(boxes.ymin[i], boxes.ymax[i]));
+      max_y = std::max(max_y, std::max(boxes.ymin[i], boxes.ymax[i]));
+    }
+    min_x_ = min_x;
+    min_y_ = min_y;
+    x_cells_per_unit_ = max_x > min_x ? cells_per_side_ / (max_x - min_x) : 0;
+    y_cells_per_unit_ = max_y > min_y ? cells_per_side_ / (max_y - min_y) : 0;
+  }
+
+  void Insert(int box) {
+    int x0, y0, x1, y1;
+    GetCellRange(box, &x0, &y0, &x1, &y1);
+    for (int y = y0; y <= y1; ++y) {
+      for (int x = x0; x <= x1; ++x) {
+        cells_[y * cells_per_side_ + x].push_back(box);
+      }
+    }
+  }
+
+  // Sets |neighbors| to the inserted boxes sharing a cell with |box| and
+  // accepted by |filter|.
+  template <typename Filter>
+  void FindNeighbors(int box, Filter filter, std::vector<int>* neighbors) {
+    neighbors->clear();
+    ++visit_stamp_;
+    int x0, y0, x1, y1;
+    GetCellRange(box, &x0, &y0, &x1, &y1);
+    for (int y = y0; y <= y1; ++y) {
+      for (int x = x0; x <= x1; ++x) {
+        for (int other : cells_[y * cells_per_side_ + x]) {
+          if (visit_stamps_[other] == visit_stamp_) continue;
+          visit_stamps_[other] = visit_stamp_;
+          if (filter(other)) neighbors->push_back(other);
+        }
+      }
+    }
+  }
+
+ private:
+  int GetCell(float value, float min_value, float cells_per_unit) const {
+    const int cell = static_cast<int>((value - min_value) * cells_per_unit);
+    return std::min(std::max(cell, 0), cells_per_side_ - 1);
+  }
+
+  // Boxes with a negative size cover no cell.
+  void GetCellRange(int box, int* x0, int* y0, int* x1, int* y1) const {
+    if (cells_per_side_ == 1) {
+      *x0 = *y0 = *x1 = *y1 = 0;
+      return;
+    }
+    *x0 = GetCell(boxes_.xmin[box], min_x_, x_cells_per_unit_);
+    *x1 = GetCell(boxes_.xmax[box], min_x_, x_cells_per_unit_);
+    *y0 = GetCell(boxes_.ymin[box], min_y_, y_cells_per_unit_);
+    *y1 = GetCell(boxes_.ymax[box], min_y_, y_cells_per_unit_);
+  }
+
+  const NmsBoxes& boxes_;
+  const int cells_per_side_;
+  float min_x_ = 0.0f;
+  float min_y_ = 0.0f;
+  float x_cells_per_unit_ = 0.0f;
+  float y_cells_per_unit_ = 0.0f;
+  std::vector<std::vector<int>> cells_;
+  std::vector<int> visit_stamps_;
+  int visit_stamp_ = 0;
+};
+
+// Returns the number of grid cells per side to use for |boxes|.  Boxes which
+// don't intersect can only be skipped if they can't be suppressed, i.e. for a
+// non-negative suppression threshold, and if all coordinates are finite.
+int GetGridCellsPerSide(const NmsBoxes& boxes,
+                        const NonMaxSuppressionCalculatorOptions& options) {
+  if (boxes.size() == 0 || options.min_suppression_threshold() < 0.0f) {
+    return 1;
+  }
+  for (int i = 0; i < boxes.size(); ++i) {
+    if (!std::isfinite(boxes.xmin[i]) || !std::isfinite(boxes.ymin[i]) ||
+        !std::isfinite(boxes.xmax[i]) || !std::isfinite(boxes.ymax[i])) {
+      return 1;
+    }
+  }
+  const int cells_per_side = std::sqrt(static_cast<float>(boxes.size()));
+  return std::min(std::max(cells_per_side, 1), kMaxGridCellsPerSide);
+}
+
+bool IsBelowMinScore(const NmsBoxes& boxes, int box,
+                     const NonMaxSuppressionCalculatorOptions& options) {
+  return options.min_score_threshold() > 0 &&
+         boxes.score[box] < options.min_score_threshold();
+}
+
+}  // namespace
+
+void NmsBoxes::Clear() {
+  xmin.clear();
+  ymin.clear();
+  xmax.clear();
+  ymax.clear();
+  area.clear();
+  score.clear();
+}
+
+void NmsBoxes::Reserve(int num_boxes) {
+  xmin.reserve(num_boxes);
+  ymin.reserve(num_boxes);
+  xmax.reserve(num_boxes);
+  ymax.reserve(num_boxes);
+  area.reserve(num_boxes);
+  score.reserve(num_boxes);
+}
+
+void NmsBoxes::Add(const Rectangle_f& rect, float box_score) {
+  xmin.push_back(rect.xmin());
+  ymin.push_back(rect.ymin());
+  xmax.push_back(rect.xmax());
+  ymax.push_back(rect.ymax());
+  area.push_back(rect.Area());
+  score.push_back(box_score);
+}
+
+std::vector<int> NonMaxSuppression(
+    const NmsBoxes& boxes, const std::vector<int>& order,
+    int max_num_detections, const NonMaxSuppressionCalculatorOptions& options) {
+  std::vector<int> retained;
+  retained.reserve(max_num_detections);
+  if (order.empty()) return retained;
+  SimilarityKernel kernel(options.overlap_type(), boxes);
+  BoxGrid grid(boxes, GetGridCellsPerSide(boxes, options));
+  std::vector<int> neighbors;
+  // We traverse the boxes by decreasing score.
+  for (int box : order) {
+    if (IsBelowMinScore(boxes, box, options)) {
+      break;
+    }
+    // The current box is suppressed iff there exists a retained box whose
+    // overlap with the current box is above the threshold.
+    grid.FindNeighbors(
+        box, [](int) { return true; }, &neighbors);
+    const auto& similarities = kernel.Compute(neighbors, box);
+    const bool suppressed =
+        std::any_of(similarities.begin(), similarities.end(),
+                    [&options](float similarity) {
+                      return similarity > options.min_suppression_threshold();
+                    });
+    if (!suppressed) {
+      retained.push_back(box);
+      grid.Insert(box);
+    }
+    if (retained.size() >= max_num_detections) {
+      break;
+    }
+  }
+  return retained;
+}
+
+std::vector<NmsCluster> WeightedNonMaxSuppression(
+    const NmsBoxes& boxes, const std::vector<int>& order,
+    const NonMaxSuppressionCalculatorOptions& options) {
+  std::vector<NmsCluster> clusters;
+  if (order.empty()) return clusters;
+  SimilarityKernel kernel(options.overlap_type(), boxes);
+  BoxGrid grid(boxes, GetGridCellsPerSide(boxes, options));
+  std::vector<int> rank(boxes.size());
+  for (int i = 0; i < order.size(); ++i) {
+    rank[order[i]] = i;
+    grid.Insert(order[i]);
+  }
+  std::vector<bool> removed(boxes.size(), false);
+  std::vector<int> neighbors;
+  int first = 0;
+  while (true) {
+    // The remaining boxes keep their order, so the top box is the first one
+    // which is not removed.
+    while (first < order.size() && removed[order[first]]) ++first;
+    if (first == order.size()) break;
+    const int top = order[first];
+    if (IsBelowMinScore(boxes, top, options)) {
+      break;
+    }
+    grid.FindNeighbors(
+        top, [&removed](int box) { return !removed[box]; }, &neighbors);
+    std::sort(neighbors.begin(), neighbors.end(),
+              [&rank](int a, int b) { return rank[a] < rank[b]; });
+    const auto& similarities = kernel.Compute(neighbors, top);
+
+    NmsCluster cluster;
+    cluster.top = top;
+    for (int k = 0; k < neighbors.size(); ++k) {
+      if (similarities[k] > options.min_suppression_threshold()) {
+        cluster.members.push_back(neighbors[k]);
+        removed[neighbors[k]] = true;
+      }
+    }
+    const bool none_removed = cluster.members.empty();
+    clusters.push_back(std::move(cluster));
+    // Stops if no box was removed by this iteration.
+    if (none_removed) break;
+  }
+  return clusters;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,69 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_UTIL_NON_MAX_SUPPRESSION_H_
+#define MEDIAPIPE_CALCULATORS_UTIL_NON_MAX_SUPPRESSION_H_
+
+#include <vector>
+
+#include "mediapipe/calculators/util/non_max_suppression_calculator.pb.h"
+#include "mediapipe/framework/port/rectangle.h"
+
+namespace mediapipe {
+
+// Boxes in structure-of-arrays layout, with their scores.
+struct NmsBoxes {
+  std::vector<float> xmin;
+  std::vector<float> ymin;
+  std::vector<float> xmax;
+  std::vector<float> ymax;
+  std::vector<float> area;
+  std::vector<float> score;
+
+  void Clear();
+  void Reserve(int num_boxes);
+  void Add(const Rectangle_f& rect, float score);
+  int size() const { return xmin.size(); }
+};
+
+// A box retained by the weighted non-maximum suppression and the boxes,
+// usually including itself, it is merged with, by decreasing score.  The box
+// is output unchanged if there are no members.
+struct NmsCluster {
+  int top;
+  std::vector<int> members;
+};
+
+// Returns the boxes retained by non-maximum suppression, by decreasing score.
+// |order| lists the indices of the boxes by decreasing score.  The
+// overlap_type, min_suppression_threshold and min_score_threshold of
+// |options| are used.
+//
+// The overlaps are computed only between boxes which share a cell of a
+// uniform grid over all boxes, so the cost grows with the number of
+// overlapping boxes rather than with the square of the number of boxes.  The
+// result is the same as comparing every pair of boxes.
+std::vector<int> NonMaxSuppression(
+    const NmsBoxes& boxes, const std::vector<int>& order,
+    int max_num_detections, const NonMaxSuppressionCalculatorOptions& options);
+
+// Returns the clusters of the weighted non-maximum suppression, in output
+// order.  Arguments are as for NonMaxSuppression.
+std::vector<NmsCluster> WeightedNonMaxSuppression(
+    const NmsBoxes& boxes, const std::vector<int>& order,
+    const NonMaxSuppressionCalculatorOptions& options);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_UTIL_NON_MAX_SUPPRESSION_H_
@@ -18,11 +18,13 @@
 #include <utility>
 #include <vector>
 
+#include "mediapipe/calculators/util/non_max_suppression.h"
 #include "mediapipe/calculators/util/non_max_suppression_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/detection.pb.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/location.h"
+#include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/rectangle.h"
 #include "mediapipe/framework/port/status.h"
@@ -73,51 +75,19 @@ bool RetainMaxScoringLabelOnly(Detection* detection) {
   return true;
 }
 
-// Computes an overlap similarity between two rectangles. Similarity measure is
-// defined by overlap_type parameter.
-float OverlapSimilarity(
-    const NonMaxSuppressionCalculatorOptions::OverlapType overlap_type,
-    const Rectangle_f& rect1, const Rectangle_f& rect2) {
-  if (!rect1.Intersects(rect2)) return 0.0f;
-  const float intersection_area = Rectangle_f(rect1).Intersect(rect2).Area();
-  float normalization;
-  switch (overlap_type) {
-    case NonMaxSuppressionCalculatorOptions::JACCARD:
-      normalization = Rectangle_f(rect1).Union(rect2).Area();
-      break;
-    case NonMaxSuppressionCalculatorOptions::MODIFIED_JACCARD:
-      normalization = rect2.Area();
-      break;
-    case NonMaxSuppressionCalculatorOptions::INTERSECTION_OVER_UNION:
-      normalization = rect1.Area() + rect2.Area() - intersection_area;
-      break;
-    default:
-      LOG(FATAL) << "Unrecognized overlap type: " << overlap_type;
+// Returns the relative bounding box of a location, using the frame size if
+// the location is not already relative.
+Rectangle_f GetRelativeBBox(const LocationData& location_data,
+                            const ImageFrame* frame) {
+  if (location_data.format() == LocationData::RELATIVE_BOUNDING_BOX) {
+    const auto& box = location_data.relative_bounding_box();
+    return Rectangle_f(box.xmin(), box.ymin(), box.width(), box.height());
   }
-  return normalization > 0.0f ? intersection_area / normalization : 0.0f;
-}
-
-// Computes an overlap similarity between two locations by first extracting the
-// relative box (dimension normalized by frame width/height) from the location.
-float OverlapSimilarity(
-    const int frame_width, const int frame_height,
-    const NonMaxSuppressionCalculatorOptions::OverlapType overlap_type,
-    const Location& location1, const Location& location2) {
-  const auto rect1 = location1.ConvertToRelativeBBox(frame_width, frame_height);
-  const auto rect2 = location2.ConvertToRelativeBBox(frame_width, frame_height);
-  return OverlapSimilarity(overlap_type, rect1, rect2);
-}
-
-// Computes an overlap similarity between two locations by first extracting the
-// relative box from the location. It assumes that a relative-box representation
-// is already available in the location, and therefore frame width and height
-// are not needed for further normalization.
-float OverlapSimilarity(
-    const NonMaxSuppressionCalculatorOptions::OverlapType overlap_type,
-    const Location& location1, const Location& location2) {
-  const auto rect1 = location1.GetRelativeBBox();
-  const auto rect2 = location2.GetRelativeBBox();
-  return OverlapSimilarity(overlap_type, rect1, rect2);
+  const Location location(location_data);
+  if (frame) {
+    return location.ConvertToRelativeBBox(frame->Width(), frame->Height());
+  }
+  return location.GetRelativeBBox();
 }
 
 }  // namespace
@@ -150,6 +120,9 @@ float OverlapSimilarity(
 //     }
 //   }
 // }
+//
+// The suppression itself runs on the boxes in structure-of-arrays layout, see
+// non_max_suppression.h.
 class NonMaxSuppressionCalculator : public CalculatorBase {
  public:
   NonMaxSuppressionCalculator() = default;
@@ -225,6 +198,23 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
           std::make_pair(index, pruned_detections[index].score(0)));
     }
     std::sort(indexed_scores.begin(), indexed_scores.end(), SortBySecond);
+    order_.clear();
+    for (const auto& indexed_score : indexed_scores) {
+      order_.push_back(indexed_score.first);
+    }
+
+    // Weighted NMS only supports relative bounding boxes.
+    const ImageFrame* frame =
+        options_.algorithm() != NonMaxSuppressionCalculatorOptions::WEIGHTED &&
+                cc->Inputs().HasTag(kImageTag)
+            ? &cc->Inputs().Tag(kImageTag).Get<ImageFrame>()
+            : nullptr;
+    boxes_.Clear();
+    boxes_.Reserve(pruned_detections.size());
+    for (const auto& detection : pruned_detections) {
+      boxes_.Add(GetRelativeBBox(detection.location_data(), frame),
+                 detection.score(0));
+    }
 
     const int max_num_detections =
         (options_.max_num_detections() > -1)
@@ -236,11 +226,12 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
     retained_detections->reserve(max_num_detections);
 
     if (options_.algorithm() == NonMaxSuppressionCalculatorOptions::WEIGHTED) {
-      WeightedNonMaxSuppression(indexed_scores, pruned_detections,
-                                max_num_detections, cc, retained_detections);
+      WeightedNonMaxSuppression(pruned_detections, retained_detections);
     } else {
-      NonMaxSuppression(indexed_scores, pruned_detections, max_num_detections,
-                        cc, retained_detections);
+      for (int index : NonMaxSuppression(boxes_, order_, max_num_detections,
+                                         options_)) {
+        retained_detections->push_back(pruned_detections[index]);
+      }
     }
 
     cc->Outputs().Index(0).Add(retained_detections, cc->InputTimestamp());
@@ -249,83 +240,13 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
   }
 
  private:
-  void NonMaxSuppression(const IndexedScores& indexed_scores,
-                         const Detections& detections, int max_num_detections,
-                         CalculatorContext* cc, Detections* output_detections) {
-    std::vector<Location> retained_locations;
-    retained_locations.reserve(max_num_detections);
-    // We traverse the detections by decreasing score.
-    for (const auto& indexed_score : indexed_scores) {
-      const auto& detection = detections[indexed_score.first];
-      if (options_.min_score_threshold() > 0 &&
-          detection.score(0) < options_.min_score_threshold()) {
-        break;
-      }
-      const Location location(detection.location_data());
-      bool suppressed = false;
-      // The current detection is suppressed iff there exists a retained
-      // detection, whose location overlaps more than the specified
-      // threshold with the location of the current detection.
-      for (const auto& retained_location : retained_locations) {
-        float similarity;
-        if (cc->Inputs().HasTag(kImageTag)) {
-          const auto& frame = cc->Inputs().Tag(kImageTag).Get<ImageFrame>();
-          similarity = OverlapSimilarity(frame.Width(), frame.Height(),
-                                         options_.overlap_type(),
-                                         retained_location, location);
-        } else {
-          similarity = OverlapSimilarity(options_.overlap_type(),
-                                         retained_location, location);
-        }
-        if (similarity > options_.min_suppression_threshold()) {
-          suppressed = true;
-          break;
-        }
-      }
-      if (!suppressed) {
-        output_detections->push_back(detection);
-        retained_locations.push_back(location);
-      }
-      if (output_detections->size() >= max_num_detections) {
-        break;
-      }
-    }
-  }
-
-  void WeightedNonMaxSuppression(const IndexedScores& indexed_scores,
-                                 const Detections& detections,
-                                 int max_num_detections, CalculatorContext* cc,
+  void WeightedNonMaxSuppression(const Detections& detections,
                                  Detections* output_detections) {
-    IndexedScores remained_indexed_scores;
-    remained_indexed_scores.assign(indexed_scores.begin(),
-                                   indexed_scores.end());
-
-    IndexedScores remained;
-    IndexedScores candidates;
-    output_detections->clear();
-    while (!remained_indexed_scores.empty()) {
-      const int original_indexed_scores_size = remained_indexed_scores.size();
-      const auto& detection = detections[remained_indexed_scores[0].first];
-      if (options_.min_score_threshold() > 0 &&
-          detection.score(0) < options_.min_score_threshold()) {
-        break;
-      }
-      remained.clear();
-      candidates.clear();
-      const Location location(detection.location_data());
-      // This includes the first box.
-      for (const auto& indexed_score : remained_indexed_scores) {
-        Location rest_location(detections[indexed_score.first].location_data());
-        float similarity =
-            OverlapSimilarity(options_.overlap_type(), rest_location, location);
-        if (similarity > options_.min_suppression_threshold()) {
-          candidates.push_back(indexed_score);
-        } else {
-          remained.push_back(indexed_score);
-        }
-      }
+    for (const NmsCluster& cluster :
+         mediapipe::WeightedNonMaxSuppression(boxes_, order_, options_)) {
+      const auto& detection = detections[cluster.top];
       auto weighted_detection = detection;
-      if (!candidates.empty()) {
+      if (!cluster.members.empty()) {
         const int num_keypoints =
             detection.location_data().relative_keypoints_size();
         std::vector<float> keypoints(num_keypoints * 2);
@@ -334,21 +255,20 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
         float w_xmax = 0.0f;
         float w_ymax = 0.0f;
         float total_score = 0.0f;
-        for (const auto& candidate : candidates) {
-          total_score += candidate.second;
-          const auto& location_data =
-              detections[candidate.first].location_data();
+        for (int member : cluster.members) {
+          const float score = boxes_.score[member];
+          total_score += score;
+          const auto& location_data = detections[member].location_data();
           const auto& bbox = location_data.relative_bounding_box();
-          w_xmin += bbox.xmin() * candidate.second;
-          w_ymin += bbox.ymin() * candidate.second;
-          w_xmax += (bbox.xmin() + bbox.width()) * candidate.second;
-          w_ymax += (bbox.ymin() + bbox.height()) * candidate.second;
+          w_xmin += bbox.xmin() * score;
+          w_ymin += bbox.ymin() * score;
+          w_xmax += (bbox.xmin() + bbox.width()) * score;
+          w_ymax += (bbox.ymin() + bbox.height()) * score;
 
           for (int i = 0; i < num_keypoints; ++i) {
-            keypoints[i * 2] +=
-                location_data.relative_keypoints(i).x() * candidate.second;
+            keypoints[i * 2] += location_data.relative_keypoints(i).x() * score;
             keypoints[i * 2 + 1] +=
-                location_data.relative_keypoints(i).y() * candidate.second;
+                location_data.relative_keypoints(i).y() * score;
           }
         }
         auto* weighted_location = weighted_detection.mutable_location_data()
@@ -366,19 +286,15 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
           keypoint->set_y(keypoints[i * 2 + 1] / total_score);
         }
       }
-
       output_detections->push_back(weighted_detection);
-      // Breaks the loop if the size of indexed scores doesn't change after an
-      // iteration.
-      if (original_indexed_scores_size == remained.size()) {
-        break;
-      } else {
-        remained_indexed_scores = std::move(remained);
-      }
     }
   }
 
   NonMaxSuppressionCalculatorOptions options_;
+  // The boxes of the current detections and their indices by decreasing
+  // score, reused across timestamps.
+  NmsBoxes boxes_;
+  std::vector<int> order_;
 };
 REGISTER_CALCULATOR(NonMaxSuppressionCalculator);
 
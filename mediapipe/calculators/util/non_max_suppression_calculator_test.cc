@@ -0,0 +1,414 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/substitute.h"
+#include "mediapipe/calculators/util/non_max_suppression.h"
+#include "mediapipe/calculators/util/non_max_suppression_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/location.h"
+#include "mediapipe/framework/formats/location_data.pb.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/rectangle.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+namespace {
+
+using Detections = std::vector<Detection>;
+using IndexedScores = std::vector<std::pair<int, float>>;
+
+// Random detections around a few objects, with a label, as output by the
+// detection calculators.
+Detections MakeDetections(int num_detections, int num_keypoints, int seed) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  std::normal_distribution<float> jitter(0.0f, 0.02f);
+  const int num_objects = std::max(1, num_detections / 25);
+  std::vector<Rectangle_f> objects;
+  for (int i = 0; i < num_objects; ++i) {
+    const float size = 0.05f + 0.2f * uniform(generator);
+    objects.emplace_back(uniform(generator) * (1.0f - size),
+                         uniform(generator) * (1.0f - size), size, size);
+  }
+  Detections detections(num_detections);
+  for (int i = 0; i < num_detections; ++i) {
+    const Rectangle_f& object = objects[i % num_objects];
+    Detection& detection = detections[i];
+    detection.add_label_id(0);
+    // Quantized scores, so that some are equal.
+    detection.add_score(std::round(uniform(generator) * 64.0f) / 64.0f);
+    auto* location_data = detection.mutable_location_data();
+    location_data->set_format(LocationData::RELATIVE_BOUNDING_BOX);
+    auto* box = location_data->mutable_relative_bounding_box();
+    box->set_xmin(object.xmin() + jitter(generator));
+    box->set_ymin(object.ymin() + jitter(generator));
+    box->set_width(object.Width() * (1.0f + 5.0f * jitter(generator)));
+    box->set_height(object.Height() * (1.0f + 5.0f * jitter(generator)));
+    for (int k = 0; k < num_keypoints; ++k) {
+      auto* keypoint = location_data->add_relative_keypoints();
+      keypoint->set_x(box->xmin() + uniform(generator) * box->width());
+      keypoint->set_y(box->ymin() + uniform(generator) * box->height());
+    }
+  }
+  return detections;
+}
+
+// The suppression of NonMaxSuppressionCalculator comparing all pairs of
+// detections, as reference.
+float ReferenceOverlapSimilarity(
+    NonMaxSuppressionCalculatorOptions::OverlapType overlap_type,
+    const Location& location1, const Location& location2) {
+  const auto rect1 = location1.GetRelativeBBox();
+  const auto rect2 = location2.GetRelativeBBox();
+  if (!rect1.Intersects(rect2)) return 0.0f;
+  const float intersection_area = Rectangle_f(rect1).Intersect(rect2).Area();
+  float normalization;
+  switch (overlap_type) {
+    case NonMaxSuppressionCalculatorOptions::JACCARD:
+      normalization = Rectangle_f(rect1).Union(rect2).Area();
+      break;
+    case NonMaxSuppressionCalculatorOptions::MODIFIED_JACCARD:
+      normalization = rect2.Area();
+      break;
+    default:
+      normalization = rect1.Area() + rect2.Area() - intersection_area;
+      break;
+  }
+  return normalization > 0.0f ? intersection_area / normalization : 0.0f;
+}
+
+IndexedScores SortedScores(const Detections& detections) {
+  IndexedScores indexed_scores;
+  for (int index = 0; index < detections.size(); ++index) {
+    indexed_scores.push_back(std::make_pair(index, detections[index].score(0)));
+  }
+  std::sort(indexed_scores.begin(), indexed_scores.end(),
+            [](const std::pair<int, float>& a, const std::pair<int, float>& b) {
+              return a.second > b.second;
+            });
+  return indexed_scores;
+}
+
+Detections ReferenceNonMaxSuppression(
+    const Detections& detections, int max_num_detections,
+    const NonMaxSuppressionCalculatorOptions& options) {
+  Detections output_detections;
+  std::vector<Location> retained_locations;
+  for (const auto& indexed_score : SortedScores(detections)) {
+    const auto& detection = detections[indexed_score.first];
+    if (options.min_score_threshold() > 0 &&
+        detection.score(0) < options.min_score_threshold()) {
+      break;
+    }
+    const Location location(detection.location_data());
+    bool suppressed = false;
+    for (const auto& retained_location : retained_locations) {
+      if (ReferenceOverlapSimilarity(options.overlap_type(), retained_location,
+                                     location) >
+          options.min_suppression_threshold()) {
+        suppressed = true;
+        break;
+      }
+    }
+    if (!suppressed) {
+      output_detections.push_back(detection);
+      retained_locations.push_back(location);
+    }
+    if (output_detections.size() >= max_num_detections) {
+      break;
+    }
+  }
+  return output_detections;
+}
+
+Detections ReferenceWeightedNonMaxSuppression(
+    const Detections& detections,
+    const NonMaxSuppressionCalculatorOptions& options) {
+  Detections output_detections;
+  IndexedScores remained_indexed_scores = SortedScores(detections);
+  IndexedScores remained;
+  IndexedScores candidates;
+  while (!remained_indexed_scores.empty()) {
+    const int original_indexed_scores_size = remained_indexed_scores.size();
+    const auto& detection = detections[remained_indexed_scores[0].first];
+    if (options.min_score_threshold() > 0 &&
+        detection.score(0) < options.min_score_threshold()) {
+      break;
+    }
+    remained.clear();
+    candidates.clear();
+    const Location location(detection.location_data());
+    for (const auto& indexed_score : remained_indexed_scores) {
+      Location rest_location(detections[indexed_score.first].location_data());
+      if (ReferenceOverlapSimilarity(options.overlap_type(), rest_location,
+                                     location) >
+          options.min_suppression_threshold()) {
+        candidates.push_back(indexed_score);
+      } else {
+        remained.push_back(indexed_score);
+      }
+    }
+    auto weighted_detection = detection;
+    if (!candidates.empty()) {
+      const int num_keypoints =
+          detection.location_data().relative_keypoints_size();
+      std::vector<float> keypoints(num_keypoints * 2);
+      float w_xmin = 0.0f;
+      float w_ymin = 0.0f;
+      float w_xmax = 0.0f;
+      float w_ymax = 0.0f;
+      float total_score = 0.0f;
+      for (const auto& candidate : candidates) {
+        total_score += candidate.second;
+        const auto& location_data = detections[candidate.first].location_data();
+        const auto& bbox = location_data.relative_bounding_box();
+        w_xmin += bbox.xmin() * candidate.second;
+        w_ymin += bbox.ymin() * candidate.second;
+        w_xmax += (bbox.xmin() + bbox.width()) * candidate.second;
+        w_ymax += (bbox.ymin() + bbox.height()) * candidate.second;
+        for (int i = 0; i < num_keypoints; ++i) {
+          keypoints[i * 2] +=
+              location_data.relative_keypoints(i).x() * candidate.second;
+          keypoints[i * 2 + 1] +=
+              location_data.relative_keypoints(i).y() * candidate.second;
+        }
+      }
+      auto* weighted_location = weighted_detection.mutable_location_data()
+                                    ->mutable_relative_bounding_box();
+      weighted_location->set_xmin(w_xmin / total_score);
+      weighted_location->set_ymin(w_ymin / total_score);
+      weighted_location->set_width((w_xmax / total_score) -
+                                   weighted_location->xmin());
+      weighted_location->set_height((w_ymax / total_score) -
+                                    weighted_location->ymin());
+      for (int i = 0; i < num_keypoints; ++i) {
+        auto* keypoint = weighted_detection.mutable_location_data()
+                             ->mutable_relative_keypoints(i);
+        keypoint->set_x(keypoints[i * 2] / total_score);
+        keypoint->set_y(keypoints[i * 2 + 1] / total_score);
+      }
+    }
+    output_detections.push_back(weighted_detection);
+    if (original_indexed_scores_size == remained.size()) {
+      break;
+    } else {
+      remained_indexed_scores = std::move(remained);
+    }
+  }
+  return output_detections;
+}
+
+Detections RunCalculator(const Detections& detections,
+                         const NonMaxSuppressionCalculatorOptions& options) {
+  CalculatorGraphConfig::Node node_config;
+  node_config.set_calculator("NonMaxSuppressionCalculator");
+  node_config.add_input_stream("detections");
+  node_config.add_output_stream("nms_detections");
+  *node_config.mutable_options()->MutableExtension(
+      NonMaxSuppressionCalculatorOptions::ext) = options;
+  CalculatorRunner runner(node_config);
+  runner.MutableInputs()->Index(0).packets.push_back(
+      MakePacket<Detections>(detections).At(Timestamp(0)));
+  MEDIAPIPE_CHECK_OK(runner.Run());
+  const auto& output_packets = runner.Outputs().Index(0).packets;
+  CHECK_EQ(1, output_packets.size());
+  return output_packets[0].Get<Detections>();
+}
+
+void ExpectSameDetections(const Detections& expected,
+                          const Detections& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (int i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i].SerializeAsString(), actual[i].SerializeAsString())
+        << "Detection " << i << " differs:\n"
+        << expected[i].DebugString() << "vs\n"
+        << actual[i].DebugString();
+  }
+}
+
+class NonMaxSuppressionCalculatorTest
+    : public ::testing::TestWithParam<
+          NonMaxSuppressionCalculatorOptions::OverlapType> {};
+
+TEST_P(NonMaxSuppressionCalculatorTest, MatchesReference) {
+  for (int num_detections : {1, 7, 50, 500}) {
+    for (float min_suppression_threshold : {-0.1f, 0.0f, 0.3f, 0.7f, 1.0f}) {
+      NonMaxSuppressionCalculatorOptions options;
+      options.set_overlap_type(GetParam());
+      options.set_min_suppression_threshold(min_suppression_threshold);
+      const Detections detections =
+          MakeDetections(num_detections, /*num_keypoints=*/3,
+                         /*seed=*/num_detections);
+      SCOPED_TRACE(absl::Substitute("$0 detections, threshold $1",
+                                    num_detections,
+                                    min_suppression_threshold));
+      ExpectSameDetections(
+          ReferenceNonMaxSuppression(detections, detections.size(), options),
+          RunCalculator(detections, options));
+
+      options.set_max_num_detections(3);
+      options.set_min_score_threshold(0.2f);
+      ExpectSameDetections(
+          ReferenceNonMaxSuppression(detections, 3, options),
+          RunCalculator(detections, options));
+    }
+  }
+}
+
+TEST_P(NonMaxSuppressionCalculatorTest, WeightedMatchesReference) {
+  for (int num_detections : {1, 7, 50, 500}) {
+    for (float min_suppression_threshold : {-0.1f, 0.0f, 0.3f, 0.7f, 1.0f}) {
+      NonMaxSuppressionCalculatorOptions options;
+      options.set_algorithm(NonMaxSuppressionCalculatorOptions::WEIGHTED);
+      options.set_overlap_type(GetParam());
+      options.set_min_suppression_threshold(min_suppression_threshold);
+      const Detections detections =
+          MakeDetections(num_detections, /*num_keypoints=*/3,
+                         /*seed=*/num_detections);
+      SCOPED_TRACE(absl::Substitute("$0 detections, threshold $1",
+                                    num_detections,
+                                    min_suppression_threshold));
+      ExpectSameDetections(
+          ReferenceWeightedNonMaxSuppression(detections, options),
+          RunCalculator(detections, options));
+
+      options.set_min_score_threshold(0.2f);
+      ExpectSameDetections(
+          ReferenceWeightedNonMaxSuppression(detections, options),
+          RunCalculator(detections, options));
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    OverlapTypes, NonMaxSuppressionCalculatorTest,
+    ::testing::Values(
+        NonMaxSuppressionCalculatorOptions::JACCARD,
+        NonMaxSuppressionCalculatorOptions::MODIFIED_JACCARD,
+        NonMaxSuppressionCalculatorOptions::INTERSECTION_OVER_UNION));
+
+TEST(NonMaxSuppressionTest, KeepsBoxesWithEmptyIntersection) {
+  NmsBoxes boxes;
+  boxes.Add(Rectangle_f(0.0f, 0.0f, 0.5f, 0.5f), 0.9f);
+  // Touches the first box along an edge.
+  boxes.Add(Rectangle_f(0.5f, 0.0f, 0.5f, 0.5f), 0.8f);
+  boxes.Add(Rectangle_f(0.1f, 0.1f, 0.4f, 0.4f), 0.7f);
+  NonMaxSuppressionCalculatorOptions options;
+  options.set_overlap_type(NonMaxSuppressionCalculatorOptions::JACCARD);
+  options.set_min_suppression_threshold(0.0f);
+  EXPECT_EQ(std::vector<int>({0, 1}),
+            NonMaxSuppression(boxes, {0, 1, 2}, 3, options));
+}
+
+// Suppresses overlapping detections with the options of the palm detection
+// graphs, for the benchmark argument number of candidates.
+NonMaxSuppressionCalculatorOptions BenchmarkOptions(bool weighted) {
+  NonMaxSuppressionCalculatorOptions options;
+  options.set_min_suppression_threshold(0.3f);
+  options.set_overlap_type(
+      NonMaxSuppressionCalculatorOptions::INTERSECTION_OVER_UNION);
+  if (weighted) {
+    options.set_algorithm(NonMaxSuppressionCalculatorOptions::WEIGHTED);
+  }
+  return options;
+}
+
+void RunNmsBenchmark(benchmark::State& state, bool weighted) {
+  const Detections detections =
+      MakeDetections(state.range(0), /*num_keypoints=*/7, /*seed=*/0);
+  const NonMaxSuppressionCalculatorOptions options = BenchmarkOptions(weighted);
+  std::vector<int> order;
+  for (const auto& indexed_score : SortedScores(detections)) {
+    order.push_back(indexed_score.first);
+  }
+  NmsBoxes boxes;
+  for (auto _ : state) {
+    boxes.Clear();
+    for (const auto& detection : detections) {
+      boxes.Add(Location(detection.location_data()).GetRelativeBBox(),
+                detection.score(0));
+    }
+    if (weighted) {
+      benchmark::DoNotOptimize(
+          WeightedNonMaxSuppression(boxes, order, options));
+    } else {
+      benchmark::DoNotOptimize(
+          NonMaxSuppression(boxes, order, detections.size(), options));
+    }
+  }
+}
+
+void RunReferenceNmsBenchmark(benchmark::State& state, bool weighted) {
+  const Detections detections =
+      MakeDetections(state.range(0), /*num_keypoints=*/7, /*seed=*/0);
+  const NonMaxSuppressionCalculatorOptions options = BenchmarkOptions(weighted);
+  for (auto _ : state) {
+    if (weighted) {
+      benchmark::DoNotOptimize(
+          ReferenceWeightedNonMaxSuppression(detections, options));
+    } else {
+      benchmark::DoNotOptimize(ReferenceNonMaxSuppression(
+          detections, detections.size(), options));
+    }
+  }
+}
+
+void BM_NonMaxSuppression(benchmark::State& state) {
+  RunNmsBenchmark(state, /*weighted=*/false);
+}
+BENCHMARK(BM_NonMaxSuppression)
+    ->Arg(50)
+    ->Arg(500)
+    ->Arg(5000)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_ReferenceNonMaxSuppression(benchmark::State& state) {
+  RunReferenceNmsBenchmark(state, /*weighted=*/false);
+}
+BENCHMARK(BM_ReferenceNonMaxSuppression)
+    ->Arg(50)
+    ->Arg(500)
+    ->Arg(5000)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_WeightedNonMaxSuppression(benchmark::State& state) {
+  RunNmsBenchmark(state, /*weighted=*/true);
+}
+BENCHMARK(BM_WeightedNonMaxSuppression)
+    ->Arg(50)
+    ->Arg(500)
+    ->Arg(5000)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_ReferenceWeightedNonMaxSuppression(benchmark::State& state) {
+  RunReferenceNmsBenchmark(state, /*weighted=*/true);
+}
+BENCHMARK(BM_ReferenceWeightedNonMaxSuppression)
+    ->Arg(50)
+    ->Arg(500)
+    ->Arg(5000)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace mediapipe
@@ -1175,9 +1175,37 @@ void BoxTrackerCalculator::StreamTrack(const TrackingData& data,
   const int from_frame = data_frame_num - (forward ? 1 : 0);
   const int to_frame = forward ? from_frame + 1 : from_frame - 1;
 
+  // The boxes only share the read-only motion vectors, so they are tracked
+  // in parallel. Results are processed in the map's iteration order, as for
+  // serial tracking.
+  std::vector<MotionBoxMap::value_type*> motion_boxes;
+  std::vector<MotionBox*> boxes;
+  motion_boxes.reserve(box_map->size());
+  boxes.reserve(box_map->size());
   for (auto& motion_box : *box_map) {
-    if (!motion_box.second.box.TrackStep(from_frame,  // from frame.
-                                         mvf, forward)) {
+    motion_boxes.push_back(&motion_box);
+    boxes.push_back(&motion_box.second.box);
+  }
+
+  std::vector<int> failed_indices;
+  if (options_.parallel_streaming_track() && boxes.size() > 1) {
+    failed_indices = TrackStepParallel(from_frame, mvf, forward, boxes);
+  } else {
+    for (int i = 0; i < boxes.size(); ++i) {
+      if (!boxes[i]->TrackStep(from_frame, mvf, forward)) {
+        failed_indices.push_back(i);
+      }
+    }
+  }
+  if (!boxes.empty()) {
+    actively_discarded_tracked_ids_.clear();
+  }
+
+  auto failed_index = failed_indices.begin();
+  for (int i = 0; i < motion_boxes.size(); ++i) {
+    auto& motion_box = *motion_boxes[i];
+    if (failed_index != failed_indices.end() && *failed_index == i) {
+      ++failed_index;
       failed_ids->push_back(motion_box.first);
       LOG(INFO) << "lost track. pushed failed id: " << motion_box.first;
     } else {
@@ -14,10 +14,21 @@
 
 #include <stdlib.h>
 
+#include <deque>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <tuple>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/video/opencv_video_decoder_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
 #include "mediapipe/framework/formats/video_stream_header.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/opencv_video_inc.h"
@@ -47,6 +58,10 @@ ImageFormat::Format GetImageFormat(int num_channels) {
   }
   return format;
 }
+
+// The number of pooled frames kept in addition to the frames read ahead, for
+// the frames held downstream.
+constexpr int kFramesInFlight = 4;
 }  // namespace
 
 // This Calculator takes no input streams and produces video packets.
@@ -84,6 +99,26 @@ ImageFormat::Format GetImageFormat(int num_channels) {
 //   output_stream: "VIDEO_PRESTREAM:video_header"
 // }
 //
+// With read_ahead_frames set, a background thread decodes up to that many
+// frames ahead of the output, so decoding overlaps with the processing of the
+// previous frames downstream, e.g. for offline jobs over recorded videos.
+// frame_stride and start_time_us output a subsampled part of the video. The
+// output frames come from a pool and are reused once released downstream.
+// The output throughput is logged when the calculator closes.
+//
+// Example config:
+// node {
+//   calculator: "OpenCvVideoDecoderCalculator"
+//   input_side_packet: "INPUT_FILE_PATH:input_file_path"
+//   output_stream: "VIDEO:video_frames"
+//   options {
+//     [mediapipe.OpenCvVideoDecoderCalculatorOptions.ext] {
+//       read_ahead_frames: 8
+//       frame_stride: 2
+//     }
+//   }
+// }
+//
 class OpenCvVideoDecoderCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
@@ -99,6 +134,12 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
   }
 
   absl::Status Open(CalculatorContext* cc) override {
+    const auto& options = cc->Options<OpenCvVideoDecoderCalculatorOptions>();
+    RET_CHECK_GE(options.read_ahead_frames(), 0);
+    RET_CHECK_GE(options.frame_stride(), 1);
+    read_ahead_frames_ = options.read_ahead_frames();
+    frame_stride_ = options.frame_stride();
+    decodes_all_frames_ = frame_stride_ == 1 && options.start_time_us() <= 0;
     const std::string& input_file_path =
         cc->InputSidePackets().Tag("INPUT_FILE_PATH").Get<std::string>();
     cap_ = absl::make_unique<cv::VideoCapture>(input_file_path);
@@ -137,7 +178,7 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
     header->format = format_;
     header->width = width_;
     header->height = height_;
-    header->frame_rate = fps;
+    header->frame_rate = fps / frame_stride_;
     header->duration = frame_count_ / fps;
 
     if (cc->Outputs().HasTag("VIDEO_PRESTREAM")) {
@@ -148,6 +189,9 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
     }
     // Rewind to the very first frame.
     cap_->set(cv::CAP_PROP_POS_AVI_RATIO, 0);
+    if (options.start_time_us() > 0) {
+      cap_->set(cv::CAP_PROP_POS_MSEC, options.start_time_us() / 1000.0);
+    }
 
     if (cc->OutputSidePackets().HasTag("SAVED_AUDIO_PATH")) {
 #ifdef HAVE_FFMPEG
@@ -177,34 +221,38 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
                 "config.";
 #endif
     }
+
+    pool_ = ImageFramePool::Create(width_, height_, format_,
+                                   read_ahead_frames_ + kFramesInFlight);
+    start_time_ = absl::Now();
+    if (read_ahead_frames_ > 0) {
+      decode_thread_ = std::thread([this]() { DecodeAhead(); });
+    }
     return absl::OkStatus();
   }
 
   absl::Status Process(CalculatorContext* cc) override {
-    auto image_frame = absl::make_unique<ImageFrame>(format_, width_, height_,
-                                                     /*alignment_boundary=*/1);
-    // Use microsecond as the unit of time.
-    Timestamp timestamp(cap_->get(cv::CAP_PROP_POS_MSEC) * 1000);
-    if (format_ == ImageFormat::GRAY8) {
-      cv::Mat frame = formats::MatView(image_frame.get());
-      cap_->read(frame);
-      if (frame.empty()) {
+    std::unique_ptr<ImageFrame> image_frame;
+    Timestamp timestamp;
+    const absl::Time wait_start = absl::Now();
+    if (read_ahead_frames_ > 0) {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(
+          this, &OpenCvVideoDecoderCalculator::HasDecodedFrame));
+      if (decoded_frames_queue_.empty()) {
         return tool::StatusStop();
       }
+      std::tie(image_frame, timestamp) =
+          std::move(decoded_frames_queue_.front());
+      decoded_frames_queue_.pop_front();
     } else {
-      cv::Mat tmp_frame;
-      cap_->read(tmp_frame);
-      if (tmp_frame.empty()) {
+      image_frame = DecodeFrame(&timestamp);
+      if (!image_frame) {
         return tool::StatusStop();
       }
-      if (format_ == ImageFormat::SRGB) {
-        cv::cvtColor(tmp_frame, formats::MatView(image_frame.get()),
-                     cv::COLOR_BGR2RGB);
-      } else if (format_ == ImageFormat::SRGBA) {
-        cv::cvtColor(tmp_frame, formats::MatView(image_frame.get()),
-                     cv::COLOR_BGRA2RGBA);
-      }
     }
+    wait_time_ += absl::Now() - wait_start;
+
     // If the timestamp of the current frame is not greater than the one of the
     // previous frame, the new frame will be discarded.
     if (prev_timestamp_ < timestamp) {
@@ -217,10 +265,27 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
   }
 
   absl::Status Close(CalculatorContext* cc) override {
+    if (decode_thread_.joinable()) {
+      {
+        absl::MutexLock lock(&mutex_);
+        stop_decoding_ = true;
+      }
+      decode_thread_.join();
+      absl::MutexLock lock(&mutex_);
+      decoded_frames_queue_.clear();
+    }
     if (cap_ && cap_->isOpened()) {
       cap_->release();
     }
-    if (decoded_frames_ != frame_count_) {
+    // Only logs the decoding rate by default when decoding ahead.
+    if (pool_ && (read_ahead_frames_ > 0 || VLOG_IS_ON(1))) {
+      const double seconds = absl::ToDoubleSeconds(absl::Now() - start_time_);
+      LOG(INFO) << "OpenCvVideoDecoderCalculator output " << decoded_frames_
+                << " frames in " << seconds << " s ("
+                << (seconds > 0 ? decoded_frames_ / seconds : 0)
+                << " fps), waiting " << wait_time_ << " for decoding.";
+    }
+    if (decodes_all_frames_ && decoded_frames_ != frame_count_) {
       LOG(WARNING) << "Not all the frames are decoded (total frames: "
                    << frame_count_ << " vs decoded frames: " << decoded_frames_
                    << ").";
@@ -229,6 +294,71 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
   }
 
  private:
+  // Decodes the next frame into a pooled ImageFrame and skips the following
+  // frame_stride - 1 frames. Returns nullptr at the end of the video.
+  std::unique_ptr<ImageFrame> DecodeFrame(Timestamp* timestamp) {
+    // The pooled buffer returns to the pool when the ImageFrame adopting its
+    // pixels is destroyed.
+    ImageFrameSharedPtr buffer = pool_->GetBuffer();
+    auto image_frame = absl::make_unique<ImageFrame>(
+        format_, width_, height_, buffer->WidthStep(),
+        buffer->MutablePixelData(), [buffer](uint8*) {});
+    // Use microsecond as the unit of time.
+    *timestamp = Timestamp(cap_->get(cv::CAP_PROP_POS_MSEC) * 1000);
+    if (format_ == ImageFormat::GRAY8) {
+      cv::Mat frame = formats::MatView(image_frame.get());
+      cap_->read(frame);
+      if (frame.empty()) {
+        return nullptr;
+      }
+    } else {
+      cap_->read(bgr_frame_);
+      if (bgr_frame_.empty()) {
+        return nullptr;
+      }
+      if (format_ == ImageFormat::SRGB) {
+        cv::cvtColor(bgr_frame_, formats::MatView(image_frame.get()),
+                     cv::COLOR_BGR2RGB);
+      } else if (format_ == ImageFormat::SRGBA) {
+        cv::cvtColor(bgr_frame_, formats::MatView(image_frame.get()),
+                     cv::COLOR_BGRA2RGBA);
+      }
+    }
+    // Grabbing skips the frames without converting them.
+    for (int i = 1; i < frame_stride_; ++i) {
+      if (!cap_->grab()) break;
+    }
+    return image_frame;
+  }
+
+  // Runs on decode_thread_ until the end of the video or Close().
+  void DecodeAhead() {
+    while (true) {
+      {
+        absl::MutexLock lock(&mutex_);
+        mutex_.Await(
+            absl::Condition(this, &OpenCvVideoDecoderCalculator::CanDecode));
+        if (stop_decoding_) break;
+      }
+      Timestamp timestamp;
+      std::unique_ptr<ImageFrame> image_frame = DecodeFrame(&timestamp);
+      if (!image_frame) break;
+      absl::MutexLock lock(&mutex_);
+      decoded_frames_queue_.emplace_back(std::move(image_frame), timestamp);
+    }
+    absl::MutexLock lock(&mutex_);
+    decoding_done_ = true;
+  }
+
+  bool CanDecode() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return stop_decoding_ ||
+           static_cast<int>(decoded_frames_queue_.size()) < read_ahead_frames_;
+  }
+
+  bool HasDecodedFrame() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return decoding_done_ || !decoded_frames_queue_.empty();
+  }
+
   std::unique_ptr<cv::VideoCapture> cap_;
   int width_;
   int height_;
@@ -236,6 +366,23 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
   int decoded_frames_ = 0;
   ImageFormat::Format format_;
   Timestamp prev_timestamp_ = Timestamp::Unset();
+  int read_ahead_frames_ = 0;
+  int frame_stride_ = 1;
+  // Whether all the frames of the video are expected in the output.
+  bool decodes_all_frames_ = true;
+  std::shared_ptr<ImageFramePool> pool_;
+  // The decoded BGR(A) frame before conversion, reused across frames.
+  cv::Mat bgr_frame_;
+  // Statistics for the throughput logged on Close().
+  absl::Time start_time_;
+  absl::Duration wait_time_;
+
+  std::thread decode_thread_;
+  absl::Mutex mutex_;
+  std::deque<std::pair<std::unique_ptr<ImageFrame>, Timestamp>>
+      decoded_frames_queue_ ABSL_GUARDED_BY(mutex_);
+  bool decoding_done_ ABSL_GUARDED_BY(mutex_) = false;
+  bool stop_decoding_ ABSL_GUARDED_BY(mutex_) = false;
 };
 
 REGISTER_CALCULATOR(OpenCvVideoDecoderCalculator);
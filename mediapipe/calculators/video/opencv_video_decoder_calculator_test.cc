@@ -12,6 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/substitute.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/deps/file_path.h"
 #include "mediapipe/framework/formats/image_frame.h"
@@ -165,5 +170,61 @@ TEST(OpenCvVideoDecoderCalculatorTest, TestMkvVp8Video) {
   }
 }
 
+constexpr char kMkvVp8VideoPath[] =
+    "/mediapipe/calculators/video/testdata/format_MKV_VP8_VORBIS.video";
+
+std::unique_ptr<CalculatorRunner> RunDecoder(const std::string& options) {
+  auto runner = absl::make_unique<CalculatorRunner>(
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+          R"pb(
+            calculator: "OpenCvVideoDecoderCalculator"
+            input_side_packet: "INPUT_FILE_PATH:input_file_path"
+            output_stream: "VIDEO:video"
+            output_stream: "VIDEO_PRESTREAM:video_prestream"
+            options {
+              [mediapipe.OpenCvVideoDecoderCalculatorOptions.ext] { $0 }
+            }
+          )pb",
+          options)));
+  runner->MutableSidePackets()->Tag("INPUT_FILE_PATH") =
+      MakePacket<std::string>(file::JoinPath("./", kMkvVp8VideoPath));
+  MP_EXPECT_OK(runner->Run());
+  return runner;
+}
+
+TEST(OpenCvVideoDecoderCalculatorTest, TestReadAheadMatchesDecodeOnOutput) {
+  auto runner = RunDecoder("");
+  auto read_ahead_runner = RunDecoder("read_ahead_frames: 4");
+  const auto& packets = runner->Outputs().Tag("VIDEO").packets;
+  const auto& read_ahead_packets =
+      read_ahead_runner->Outputs().Tag("VIDEO").packets;
+  ASSERT_EQ(packets.size(), read_ahead_packets.size());
+  for (int i = 0; i < packets.size(); ++i) {
+    EXPECT_EQ(packets[i].Timestamp(), read_ahead_packets[i].Timestamp());
+    cv::Mat mat = formats::MatView(&packets[i].Get<ImageFrame>());
+    cv::Mat read_ahead_mat =
+        formats::MatView(&read_ahead_packets[i].Get<ImageFrame>());
+    EXPECT_EQ(cv::norm(mat, read_ahead_mat, cv::NORM_INF), 0);
+  }
+}
+
+TEST(OpenCvVideoDecoderCalculatorTest, TestFrameStrideAndStartTime) {
+  auto runner = RunDecoder(
+      "read_ahead_frames: 4 frame_stride: 3 start_time_us: 2000000");
+  const mediapipe::VideoHeader& header =
+      runner->Outputs().Tag("VIDEO_PRESTREAM").packets[0].Get<VideoHeader>();
+  EXPECT_FLOAT_EQ(10.0f, header.frame_rate);
+  // 4 seconds of the 30 fps video, every third frame.
+  const auto& packets = runner->Outputs().Tag("VIDEO").packets;
+  EXPECT_GE(packets.size(), 39);
+  EXPECT_LE(packets.size(), 40);
+  ASSERT_FALSE(packets.empty());
+  EXPECT_NEAR(packets[0].Timestamp().Seconds(), 2.0, 0.04);
+  for (int i = 1; i < packets.size(); ++i) {
+    EXPECT_NEAR((packets[i].Timestamp() - packets[i - 1].Timestamp()).Seconds(),
+                0.1, 0.01);
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -14,11 +14,17 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
+#include <deque>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "mediapipe/calculators/video/opencv_video_encoder_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
@@ -55,6 +61,29 @@ namespace mediapipe {
 //   }
 // }
 //
+// With write_queue_size set, the frames are queued to a background writer
+// thread which converts and encodes them, so encoding does not hold up the
+// graph, e.g. when recording annotated output of live tracking. When the
+// queue is full, the input frame either waits (BLOCK) or is dropped (DROP)
+// according to queue_full_policy. The encoding throughput and the queue
+// occupancy are logged when the calculator closes.
+//
+// Example config:
+// node {
+//   calculator: "OpenCvVideoEncoderCalculator"
+//   input_stream: "VIDEO:video"
+//   input_stream: "VIDEO_PRESTREAM:video_header"
+//   input_side_packet: "OUTPUT_FILE_PATH:output_file_path"
+//   node_options {
+//     [type.googleapis.com/mediapipe.OpenCvVideoEncoderCalculatorOptions]: {
+//        codec: "avc1"
+//        video_format: "mp4"
+//        write_queue_size: 16
+//        queue_full_policy: DROP
+//     }
+//   }
+// }
+//
 // OpenCV's VideoWriter doesn't encode audio. If an input side packet with tag
 // "AUDIO_FILE_PATH" is specified, the calculator will call FFmpeg binary to
 // attach the audio file to the video as the last step in Close().
@@ -83,10 +112,39 @@ class OpenCvVideoEncoderCalculator : public CalculatorBase {
 
  private:
   absl::Status SetUpVideoWriter(float frame_rate, int width, int height);
+  // Converts the frame to BGR if needed and encodes it.
+  void WriteFrame(const ImageFrame& image_frame);
+  // Runs on writer_thread_ until Close().
+  void WriteQueuedFrames();
+  bool HasQueuedFrame() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return writing_done_ || !queued_frames_.empty();
+  }
+  bool CanQueueFrame() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return static_cast<int>(queued_frames_.size()) < write_queue_size_;
+  }
 
   std::string output_file_path_;
   int four_cc_;
   std::unique_ptr<cv::VideoWriter> writer_;
+  int write_queue_size_ = 0;
+  OpenCvVideoEncoderCalculatorOptions::QueueFullPolicy queue_full_policy_;
+  // The converted BGR frame, reused across frames.
+  cv::Mat bgr_frame_;
+
+  // Statistics for the throughput and queue occupancy logged on Close(), once
+  // the writer thread is done. The queue statistics are guarded by mutex_
+  // while it runs, and the encoding ones are only updated by the writer.
+  int encoded_frames_ = 0;
+  absl::Duration encode_time_;
+  int dropped_frames_ = 0;
+  int64 queued_frames_sum_ = 0;
+  int max_queued_frames_ = 0;
+
+  std::thread writer_thread_;
+  absl::Mutex mutex_;
+  // The input packets keep the queued frames alive without copies.
+  std::deque<Packet> queued_frames_ ABSL_GUARDED_BY(mutex_);
+  bool writing_done_ ABSL_GUARDED_BY(mutex_) = false;
 };
 
 absl::Status OpenCvVideoEncoderCalculator::GetContract(CalculatorContract* cc) {
@@ -106,6 +164,9 @@ absl::Status OpenCvVideoEncoderCalculator::GetContract(CalculatorContract* cc) {
 absl::Status OpenCvVideoEncoderCalculator::Open(CalculatorContext* cc) {
   OpenCvVideoEncoderCalculatorOptions options =
       cc->Options<OpenCvVideoEncoderCalculatorOptions>();
+  RET_CHECK_GE(options.write_queue_size(), 0);
+  write_queue_size_ = options.write_queue_size();
+  queue_full_policy_ = options.queue_full_policy();
   RET_CHECK(options.has_codec() && options.codec().length() == 4)
       << "A 4-character codec code must be specified in "
          "OpenCvVideoEncoderCalculatorOptions";
@@ -140,43 +201,109 @@ absl::Status OpenCvVideoEncoderCalculator::Process(CalculatorContext* cc) {
                             video_header.height);
   }
 
-  const ImageFrame& image_frame =
-      cc->Inputs().Tag("VIDEO").Value().Get<ImageFrame>();
+  const Packet& packet = cc->Inputs().Tag("VIDEO").Value();
+  const ImageFrame& image_frame = packet.Get<ImageFrame>();
   ImageFormat::Format format = image_frame.Format();
-  cv::Mat frame;
-  if (format == ImageFormat::GRAY8) {
-    frame = formats::MatView(&image_frame);
-    if (frame.empty()) {
-      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-             << "Receive empty frame at timestamp "
-             << cc->Inputs().Tag("VIDEO").Value().Timestamp()
-             << " in OpenCvVideoEncoderCalculator::Process()";
-    }
+  if (format != ImageFormat::GRAY8 && format != ImageFormat::SRGB &&
+      format != ImageFormat::SRGBA) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Unsupported image format: " << format;
+  }
+  if (image_frame.IsEmpty()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Receive empty frame at timestamp " << packet.Timestamp()
+           << " in OpenCvVideoEncoderCalculator::Process()";
+  }
+  if (write_queue_size_ == 0) {
+    WriteFrame(image_frame);
+    return absl::OkStatus();
+  }
+
+  absl::MutexLock lock(&mutex_);
+  if (queue_full_policy_ == OpenCvVideoEncoderCalculatorOptions::BLOCK) {
+    mutex_.Await(
+        absl::Condition(this, &OpenCvVideoEncoderCalculator::CanQueueFrame));
+  } else if (!CanQueueFrame()) {
+    ++dropped_frames_;
+    queued_frames_sum_ += write_queue_size_;
+    cc->GetCounter("DroppedFrames")->Increment();
+    return absl::OkStatus();
+  }
+  queued_frames_.push_back(packet);
+  const int num_queued = static_cast<int>(queued_frames_.size());
+  queued_frames_sum_ += num_queued;
+  max_queued_frames_ = std::max(max_queued_frames_, num_queued);
+  return absl::OkStatus();
+}
+
+void OpenCvVideoEncoderCalculator::WriteFrame(const ImageFrame& image_frame) {
+  const absl::Time start_time = absl::Now();
+  const cv::Mat frame = formats::MatView(&image_frame);
+  if (image_frame.Format() == ImageFormat::GRAY8) {
+    writer_->write(frame);
   } else {
-    cv::Mat tmp_frame = formats::MatView(&image_frame);
-    if (tmp_frame.empty()) {
-      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-             << "Receive empty frame at timestamp "
-             << cc->Inputs().Tag("VIDEO").Value().Timestamp()
-             << " in OpenCvVideoEncoderCalculator::Process()";
-    }
-    if (format == ImageFormat::SRGB) {
-      cv::cvtColor(tmp_frame, frame, cv::COLOR_RGB2BGR);
-    } else if (format == ImageFormat::SRGBA) {
-      cv::cvtColor(tmp_frame, frame, cv::COLOR_RGBA2BGR);
-    } else {
-      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-             << "Unsupported image format: " << format;
+    cv::cvtColor(frame, bgr_frame_,
+                 image_frame.Format() == ImageFormat::SRGB
+                     ? cv::COLOR_RGB2BGR
+                     : cv::COLOR_RGBA2BGR);
+    writer_->write(bgr_frame_);
+  }
+  encode_time_ += absl::Now() - start_time;
+  ++encoded_frames_;
+}
+
+void OpenCvVideoEncoderCalculator::WriteQueuedFrames() {
+  while (true) {
+    Packet packet;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(
+          absl::Condition(this, &OpenCvVideoEncoderCalculator::HasQueuedFrame));
+      if (queued_frames_.empty()) return;
+      packet = queued_frames_.front();
     }
+    WriteFrame(packet.Get<ImageFrame>());
+    // The frame leaves the queue once written, so that a full queue waits for
+    // the encoding in progress.
+    absl::MutexLock lock(&mutex_);
+    queued_frames_.pop_front();
   }
-  writer_->write(frame);
-  return absl::OkStatus();
 }
 
 absl::Status OpenCvVideoEncoderCalculator::Close(CalculatorContext* cc) {
+  if (writer_thread_.joinable()) {
+    {
+      absl::MutexLock lock(&mutex_);
+      writing_done_ = true;
+    }
+    // Writes the remaining queued frames.
+    writer_thread_.join();
+  }
   if (writer_ && writer_->isOpened()) {
     writer_->release();
   }
+  if (encoded_frames_ > 0) {
+    // Like the decoder with read-ahead, only logs the encoding rate by
+    // default when writing asynchronously.
+    if (write_queue_size_ > 0 || VLOG_IS_ON(1)) {
+      const double encode_seconds = absl::ToDoubleSeconds(encode_time_);
+      LOG(INFO) << "OpenCvVideoEncoderCalculator encoded " << encoded_frames_
+                << " frames in " << encode_seconds << " s ("
+                << (encode_seconds > 0 ? encoded_frames_ / encode_seconds : 0)
+                << " fps).";
+    }
+    cc->GetCounter("EncodedFrames")->IncrementBy(encoded_frames_);
+  }
+  if (write_queue_size_ > 0) {
+    const int queued_frames = encoded_frames_ + dropped_frames_;
+    LOG(INFO) << "OpenCvVideoEncoderCalculator write queue occupancy: "
+              << (queued_frames > 0
+                      ? static_cast<double>(queued_frames_sum_) / queued_frames
+                      : 0)
+              << " frames on average, " << max_queued_frames_ << " at most, of "
+              << write_queue_size_ << "; dropped " << dropped_frames_
+              << " frames.";
+  }
   if (cc->InputSidePackets().HasTag("AUDIO_FILE_PATH")) {
 #ifdef HAVE_FFMPEG
     const std::string& audio_file_path =
@@ -219,6 +346,9 @@ absl::Status OpenCvVideoEncoderCalculator::SetUpVideoWriter(float frame_rate,
     return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
            << "Fail to open file at " << output_file_path_;
   }
+  if (write_queue_size_ > 0) {
+    writer_thread_ = std::thread([this]() { WriteQueuedFrames(); });
+  }
   return absl::OkStatus();
 }
 
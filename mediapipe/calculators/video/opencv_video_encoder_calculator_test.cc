@@ -220,5 +220,54 @@ TEST(OpenCvVideoEncoderCalculatorTest, TestMkvVp8Video) {
                                         cap.get(cv::CAP_PROP_FPS))));
 }
 
+TEST(OpenCvVideoEncoderCalculatorTest, TestMkvVp8VideoWithWriteQueue) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        node {
+          calculator: "OpenCvVideoDecoderCalculator"
+          input_side_packet: "INPUT_FILE_PATH:input_file_path"
+          output_stream: "VIDEO:video"
+          output_stream: "VIDEO_PRESTREAM:video_prestream"
+        }
+        node {
+          calculator: "OpenCvVideoEncoderCalculator"
+          input_stream: "VIDEO:video"
+          input_stream: "VIDEO_PRESTREAM:video_prestream"
+          input_side_packet: "OUTPUT_FILE_PATH:output_file_path"
+          node_options {
+            [type.googleapis.com/
+             mediapipe.OpenCvVideoEncoderCalculatorOptions]: {
+              codec: "PIM1"
+              video_format: "mkv"
+              write_queue_size: 4
+              queue_full_policy: BLOCK
+            }
+          }
+        }
+      )pb");
+  std::map<std::string, Packet> input_side_packets;
+  const std::string input_file_path =
+      file::JoinPath("./",
+                     "/mediapipe/calculators/video/"
+                     "testdata/format_MKV_VP8_VORBIS.video");
+  input_side_packets["input_file_path"] =
+      MakePacket<std::string>(input_file_path);
+  const std::string output_file_path = "/tmp/tmp_queued_video.mkv";
+  DeletingFile deleting_file(output_file_path, true);
+  input_side_packets["output_file_path"] =
+      MakePacket<std::string>(output_file_path);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config, input_side_packets));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  // With the BLOCK policy, all the frames are encoded in the output file.
+  cv::VideoCapture input_cap(input_file_path);
+  cv::VideoCapture cap(output_file_path);
+  ASSERT_TRUE(cap.isOpened());
+  EXPECT_NEAR(input_cap.get(cv::CAP_PROP_FRAME_COUNT),
+              cap.get(cv::CAP_PROP_FRAME_COUNT), 1);
+}
+
 }  // namespace
 }  // namespace mediapipe
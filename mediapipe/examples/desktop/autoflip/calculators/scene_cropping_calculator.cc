@@ -15,9 +15,11 @@
 #include "mediapipe/examples/desktop/autoflip/calculators/scene_cropping_calculator.h"
 
 #include <cmath>
+#include <limits>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "mediapipe/examples/desktop/autoflip/autoflip_messages.pb.h"
 #include "mediapipe/examples/desktop/autoflip/quality/scene_cropping_viz.h"
 #include "mediapipe/examples/desktop/autoflip/quality/utils.h"
@@ -145,6 +147,9 @@ absl::Status SceneCroppingCalculator::Open(CalculatorContext* cc) {
       << "Maximum scene size is non-positive.";
   RET_CHECK_GE(options_.prior_frame_buffer_size(), 0)
       << "Prior frame buffer size is negative.";
+  RET_CHECK(options_.streaming_lookahead_size() >= 0 &&
+            options_.streaming_lookahead_size() < options_.max_scene_size())
+      << "Streaming lookahead size is not in [0, max_scene_size).";
 
   RET_CHECK(options_.solid_background_frames_padding_fraction() >= 0.0 &&
             options_.solid_background_frames_padding_fraction() <= 1.0)
@@ -158,6 +163,8 @@ absl::Status SceneCroppingCalculator::Open(CalculatorContext* cc) {
   overlay_opacity_ = padding_params.overlay_opacity();
   RET_CHECK(overlay_opacity_ >= 0.0 && overlay_opacity_ <= 1.0)
       << "Overlay opacity " << overlay_opacity_ << " is not in [0, 1].";
+  RET_CHECK_GT(padding_params.blur_downscale_factor(), 0)
+      << "Blur downscale factor is non-positive.";
 
   // Set default camera model to polynomial_path_solver.
   if (!options_.camera_motion_options().has_kinematic_options()) {
@@ -173,6 +180,13 @@ absl::Status SceneCroppingCalculator::Open(CalculatorContext* cc) {
         absl::make_unique<std::vector<ExternalRenderFrame>>();
   }
   should_perform_frame_cropping_ = cc->Outputs().HasTag(kOutputCroppedFrames);
+  RET_CHECK_GT(options_.num_threads(), 0)
+      << "Number of threads is non-positive.";
+  if (options_.num_threads() > 1 && should_perform_frame_cropping_) {
+    pool_ = absl::make_unique<ThreadPool>("SceneCroppingCalculator",
+                                          options_.num_threads());
+    pool_->StartWorkers();
+  }
   scene_camera_motion_analyzer_ = absl::make_unique<SceneCameraMotionAnalyzer>(
       options_.scene_camera_motion_analyzer_options());
   return absl::OkStatus();
@@ -372,7 +386,8 @@ absl::Status SceneCroppingCalculator::Process(
 
   if (!scene_frame_timestamps_.empty() && (is_end_of_scene)) {
     continue_last_scene_ = false;
-    MP_RETURN_IF_ERROR(ProcessScene(is_end_of_scene, cc));
+    MP_RETURN_IF_ERROR(
+        ProcessScene(is_end_of_scene, /* num_lookahead_frames = */ 0, cc));
   }
 
   // Saves frame and timestamp and whether it is a key frame.
@@ -412,7 +427,13 @@ absl::Status SceneCroppingCalculator::Process(
   const bool force_buffer_flush =
       scene_frame_timestamps_.size() >= options_.max_scene_size();
   if (!scene_frame_timestamps_.empty() && force_buffer_flush) {
-    MP_RETURN_IF_ERROR(ProcessScene(is_end_of_scene, cc));
+    // The kinematic path solver is causal and keeps its state across flushes,
+    // so it gains nothing from lookahead frames.
+    const int num_lookahead_frames =
+        options_.camera_motion_options().has_kinematic_options()
+            ? 0
+            : options_.streaming_lookahead_size();
+    MP_RETURN_IF_ERROR(ProcessScene(is_end_of_scene, num_lookahead_frames, cc));
     continue_last_scene_ = true;
   }
 
@@ -421,7 +442,8 @@ absl::Status SceneCroppingCalculator::Process(
 
 absl::Status SceneCroppingCalculator::Close(mediapipe::CalculatorContext* cc) {
   if (!scene_frame_timestamps_.empty()) {
-    MP_RETURN_IF_ERROR(ProcessScene(/* is_end_of_scene = */ true, cc));
+    MP_RETURN_IF_ERROR(ProcessScene(/* is_end_of_scene = */ true,
+                                    /* num_lookahead_frames = */ 0, cc));
   }
   if (cc->Outputs().HasTag(kOutputSummary)) {
     cc->Outputs()
@@ -528,8 +550,45 @@ void SceneCroppingCalculator::FilterKeyFrameInfo() {
   }
 }
 
-absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
-                                                   CalculatorContext* cc) {
+absl::Status SceneCroppingCalculator::ProcessScene(
+    const bool is_end_of_scene, const int num_lookahead_frames,
+    CalculatorContext* cc) {
+  const int num_frames = scene_frame_timestamps_.size();
+  RET_CHECK(num_lookahead_frames >= 0 && num_lookahead_frames < num_frames)
+      << "Invalid number of lookahead frames " << num_lookahead_frames;
+  const int num_output_frames = num_frames - num_lookahead_frames;
+
+  // Copies the lookahead frames and their features before they are modified
+  // below, to buffer them again for the next call.
+  const int64 lookahead_start_time =
+      num_lookahead_frames > 0 ? scene_frame_timestamps_[num_output_frames]
+                               : std::numeric_limits<int64>::max();
+  std::vector<cv::Mat> lookahead_frames;
+  if (!scene_frames_or_empty_.empty()) {
+    lookahead_frames.assign(scene_frames_or_empty_.begin() + num_output_frames,
+                            scene_frames_or_empty_.end());
+  }
+  std::vector<int64> lookahead_timestamps(
+      scene_frame_timestamps_.begin() + num_output_frames,
+      scene_frame_timestamps_.end());
+  std::vector<bool> lookahead_is_key_frames(
+      is_key_frames_.begin() + num_output_frames, is_key_frames_.end());
+  std::vector<KeyFrameInfo> lookahead_key_frame_infos;
+  for (const auto& key_frame_info : key_frame_infos_) {
+    if (key_frame_info.timestamp_ms() >= lookahead_start_time) {
+      lookahead_key_frame_infos.push_back(key_frame_info);
+    }
+  }
+  std::vector<StaticFeatures> lookahead_static_features;
+  std::vector<int64> lookahead_static_features_timestamps;
+  for (int i = 0; i < static_features_timestamps_.size(); ++i) {
+    if (static_features_timestamps_[i] >= lookahead_start_time) {
+      lookahead_static_features.push_back(static_features_[i]);
+      lookahead_static_features_timestamps.push_back(
+          static_features_timestamps_[i]);
+    }
+  }
+
   // Removes detections under special circumstances.
   FilterKeyFrameInfo();
 
@@ -586,29 +645,31 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
   std::vector<cv::Scalar> padding_colors;
   MP_RETURN_IF_ERROR(FormatAndOutputCroppedFrames(
       scene_summary.crop_window_width(), scene_summary.crop_window_height(),
-      scene_frame_timestamps_.size(), &render_to_locations, &apply_padding,
-      &padding_colors, &vertical_fill_percent, cropped_frames_ptr, cc));
-  // Caches prior FocusPointFrames if this was not the end of a scene.
+      num_output_frames, &render_to_locations, &apply_padding, &padding_colors,
+      &vertical_fill_percent, cropped_frames_ptr, cc));
+  // Caches prior FocusPointFrames of the output frames if this was not the end
+  // of a scene.
   prior_focus_point_frames_.clear();
   if (!is_end_of_scene) {
-    const int start =
-        std::max(0, static_cast<int>(scene_frame_timestamps_.size()) -
-                        options_.camera_motion_options()
-                            .polynomial_path_solver()
-                            .prior_frame_buffer_size());
-    for (int i = start; i < num_key_frames; ++i) {
+    const int start = std::max(0, num_output_frames -
+                                      options_.camera_motion_options()
+                                          .polynomial_path_solver()
+                                          .prior_frame_buffer_size());
+    const int end = std::min(num_output_frames, num_key_frames);
+    for (int i = start; i < end; ++i) {
       prior_focus_point_frames_.push_back(focus_point_frames[i]);
     }
   }
 
   // Optionally outputs visualization frames.
-  MP_RETURN_IF_ERROR(OutputVizFrames(key_frame_crop_results, focus_point_frames,
-                                     crop_from_locations,
-                                     scene_summary.crop_window_width(),
-                                     scene_summary.crop_window_height(), cc));
+  MP_RETURN_IF_ERROR(OutputVizFrames(
+      key_frame_crop_results, focus_point_frames, crop_from_locations,
+      scene_summary.crop_window_width(), scene_summary.crop_window_height(),
+      num_output_frames, cc));
 
   const double start_sec = Timestamp(scene_frame_timestamps_.front()).Seconds();
-  const double end_sec = Timestamp(scene_frame_timestamps_.back()).Seconds();
+  const double end_sec =
+      Timestamp(scene_frame_timestamps_[num_output_frames - 1]).Seconds();
   VLOG(1) << absl::StrFormat("Processed a scene from %.2f sec to %.2f sec",
                              start_sec, end_sec);
 
@@ -620,10 +681,12 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
     *(scene_summary->mutable_camera_motion()) = scene_camera_motion;
     scene_summary->set_is_end_of_scene(is_end_of_scene);
     scene_summary->set_is_padded(apply_padding);
+    scene_summary->set_num_buffered_frames(num_frames);
+    scene_summary->set_num_output_frames(num_output_frames);
   }
 
   if (cc->Outputs().HasTag(kExternalRenderingPerFrame)) {
-    for (int i = 0; i < scene_frame_timestamps_.size(); i++) {
+    for (int i = 0; i < num_output_frames; i++) {
       auto external_render_message = absl::make_unique<ExternalRenderFrame>();
       ConstructExternalRenderMessage(
           crop_from_locations[i], render_to_locations[i], padding_colors[i],
@@ -636,7 +699,7 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
   }
 
   if (cc->Outputs().HasTag(kExternalRenderingFullVid)) {
-    for (int i = 0; i < scene_frame_timestamps_.size(); i++) {
+    for (int i = 0; i < num_output_frames; i++) {
       ExternalRenderFrame render_frame;
       ConstructExternalRenderMessage(crop_from_locations[i],
                                      render_to_locations[i], padding_colors[i],
@@ -645,12 +708,12 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
     }
   }
 
-  key_frame_infos_.clear();
-  scene_frames_or_empty_.clear();
-  scene_frame_timestamps_.clear();
-  is_key_frames_.clear();
-  static_features_.clear();
-  static_features_timestamps_.clear();
+  key_frame_infos_ = std::move(lookahead_key_frame_infos);
+  scene_frames_or_empty_ = std::move(lookahead_frames);
+  scene_frame_timestamps_ = std::move(lookahead_timestamps);
+  is_key_frames_ = std::move(lookahead_is_key_frames);
+  static_features_ = std::move(lookahead_static_features);
+  static_features_timestamps_ = std::move(lookahead_static_features_timestamps);
   return absl::OkStatus();
 }
 
@@ -680,6 +743,7 @@ absl::Status SceneCroppingCalculator::FormatAndOutputCroppedFrames(
   if (*apply_padding) {
     padder_ = absl::make_unique<PaddingEffectGenerator>(
         scaled_width, scaled_height, target_aspect_ratio_);
+    padder_->SetFastBlur(options_.padding_parameters().blur_downscale_factor());
     VLOG(1) << "Scene is padded: scaled width = " << scaled_width
             << " target width = " << target_width_
             << " scaled height = " << scaled_height
@@ -730,46 +794,114 @@ absl::Status SceneCroppingCalculator::FormatAndOutputCroppedFrames(
     return absl::OkStatus();
   }
 
-  // Resizes cropped frames, pads frames, and output frames.
-  for (int i = 0; i < num_frames; ++i) {
-    const int64 time_ms = scene_frame_timestamps_[i];
-    const Timestamp timestamp(time_ms);
-    auto scaled_frame = absl::make_unique<ImageFrame>(
-        frame_format_, scaled_width, scaled_height);
-    auto destination = formats::MatView(scaled_frame.get());
-    if (scaled_width == crop_width && scaled_height == crop_height) {
-      cropped_frames_ptr->at(i).copyTo(destination);
-    } else {
-      // cubic is better quality for upscaling and area is good for
-      // downscaling
-      const int interpolation_method =
-          scaling > 1 ? cv::INTER_CUBIC : cv::INTER_AREA;
-      cv::resize(cropped_frames_ptr->at(i), destination, destination.size(), 0,
-                 0, interpolation_method);
+  // Resizes and pads cropped frames, which are independent of each other, on
+  // the thread pool if there is one.
+  std::vector<std::unique_ptr<ImageFrame>> output_frames(num_frames);
+  RunTasks(num_frames, [&](int i) {
+    output_frames[i] = ScaleCroppedFrame(cropped_frames_ptr->at(i),
+                                         scaled_width, scaled_height, scaling);
+  });
+  if (*apply_padding) {
+    // Frames sharing a blurred background are selected in frame order, so
+    // that the padded frames do not depend on the threads.
+    std::vector<cv::Mat> blurred_backgrounds;
+    std::vector<int> references;
+    const float reuse_threshold =
+        options_.padding_parameters().blur_reuse_threshold();
+    if (!has_solid_background_ && padder_->HasFastBlur() &&
+        reuse_threshold > 0.0f) {
+      std::vector<cv::Mat> backgrounds(num_frames);
+      RunTasks(num_frames, [&](int i) {
+        backgrounds[i] = padder_->DownscaleBackground(*output_frames[i]);
+      });
+      references = PaddingEffectGenerator::SelectBackgroundReferences(
+          backgrounds, reuse_threshold);
+      blurred_backgrounds.resize(num_frames);
+      const int blur_cv_size =
+          std::min({blur_cv_size_, scaled_width, scaled_height});
+      RunTasks(num_frames, [&](int i) {
+        if (references[i] == i) {
+          blurred_backgrounds[i] =
+              padder_->BlurBackground(backgrounds[i], blur_cv_size);
+        }
+      });
     }
-    if (*apply_padding) {
-      cv::Scalar* background_color = nullptr;
-      if (has_solid_background_) {
-        background_color = &padding_colors->at(i);
-      }
-      auto padded_frame = absl::make_unique<ImageFrame>();
-      MP_RETURN_IF_ERROR(padder_->Process(
-          *scaled_frame, background_contrast_,
-          std::min({blur_cv_size_, scaled_width, scaled_height}),
-          overlay_opacity_, padded_frame.get(), background_color));
-      RET_CHECK_EQ(padded_frame->Width(), target_width_)
-          << "Padded frame width is off.";
-      RET_CHECK_EQ(padded_frame->Height(), target_height_)
-          << "Padded frame height is off.";
-      cc->Outputs()
-          .Tag(kOutputCroppedFrames)
-          .Add(padded_frame.release(), timestamp);
-    } else {
-      cc->Outputs()
-          .Tag(kOutputCroppedFrames)
-          .Add(scaled_frame.release(), timestamp);
+    std::vector<absl::Status> statuses(num_frames);
+    RunTasks(num_frames, [&](int i) {
+      const cv::Scalar* background_color =
+          has_solid_background_ ? &padding_colors->at(i) : nullptr;
+      const cv::Mat* blurred_background =
+          references.empty() ? nullptr : &blurred_backgrounds[references[i]];
+      statuses[i] = PadScaledFrame(background_color, blurred_background,
+                                   &output_frames[i]);
+    });
+    for (const absl::Status& status : statuses) {
+      MP_RETURN_IF_ERROR(status);
     }
   }
+
+  // Outputs frames in order.
+  for (int i = 0; i < num_frames; ++i) {
+    cc->Outputs()
+        .Tag(kOutputCroppedFrames)
+        .Add(output_frames[i].release(), Timestamp(scene_frame_timestamps_[i]));
+  }
+  return absl::OkStatus();
+}
+
+void SceneCroppingCalculator::RunTasks(
+    const int num_tasks, const std::function<void(int)>& task) const {
+  if (pool_ == nullptr || num_tasks <= 1) {
+    for (int i = 0; i < num_tasks; ++i) {
+      task(i);
+    }
+    return;
+  }
+  absl::BlockingCounter counter(num_tasks);
+  for (int i = 0; i < num_tasks; ++i) {
+    pool_->Schedule([&task, &counter, i] {
+      task(i);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+}
+
+std::unique_ptr<ImageFrame> SceneCroppingCalculator::ScaleCroppedFrame(
+    const cv::Mat& cropped_frame, const int scaled_width,
+    const int scaled_height, const double scaling) const {
+  auto scaled_frame =
+      absl::make_unique<ImageFrame>(frame_format_, scaled_width, scaled_height);
+  auto destination = formats::MatView(scaled_frame.get());
+  if (scaled_width == cropped_frame.cols &&
+      scaled_height == cropped_frame.rows) {
+    cropped_frame.copyTo(destination);
+  } else {
+    // cubic is better quality for upscaling and area is good for
+    // downscaling
+    const int interpolation_method =
+        scaling > 1 ? cv::INTER_CUBIC : cv::INTER_AREA;
+    cv::resize(cropped_frame, destination, destination.size(), 0, 0,
+               interpolation_method);
+  }
+  return scaled_frame;
+}
+
+absl::Status SceneCroppingCalculator::PadScaledFrame(
+    const cv::Scalar* background_color, const cv::Mat* blurred_background,
+    std::unique_ptr<ImageFrame>* frame) const {
+  const ImageFrame& scaled_frame = **frame;
+  auto padded_frame = absl::make_unique<ImageFrame>();
+  MP_RETURN_IF_ERROR(padder_->Process(
+      scaled_frame, background_contrast_,
+      std::min({blur_cv_size_, scaled_frame.Width(), scaled_frame.Height()}),
+      overlay_opacity_, padded_frame.get(), background_color,
+      blurred_background));
+  RET_CHECK_EQ(padded_frame->Width(), target_width_)
+      << "Padded frame width is off.";
+  RET_CHECK_EQ(padded_frame->Height(), target_height_)
+      << "Padded frame height is off.";
+  *frame = std::move(padded_frame);
   return absl::OkStatus();
 }
 
@@ -778,13 +910,13 @@ absl::Status SceneCroppingCalculator::OutputVizFrames(
     const std::vector<FocusPointFrame>& focus_point_frames,
     const std::vector<cv::Rect>& crop_from_locations,
     const int crop_window_width, const int crop_window_height,
-    CalculatorContext* cc) const {
+    const int num_frames, CalculatorContext* cc) const {
   if (cc->Outputs().HasTag(kOutputKeyFrameCropViz)) {
     std::vector<std::unique_ptr<ImageFrame>> viz_frames;
     MP_RETURN_IF_ERROR(DrawDetectionsAndCropRegions(
         scene_frames_or_empty_, is_key_frames_, key_frame_infos_,
         key_frame_crop_results, frame_format_, &viz_frames));
-    for (int i = 0; i < scene_frames_or_empty_.size(); ++i) {
+    for (int i = 0; i < num_frames; ++i) {
       cc->Outputs()
           .Tag(kOutputKeyFrameCropViz)
           .Add(viz_frames[i].release(), Timestamp(scene_frame_timestamps_[i]));
@@ -796,7 +928,7 @@ absl::Status SceneCroppingCalculator::OutputVizFrames(
         scene_frames_or_empty_, focus_point_frames,
         options_.viz_overlay_opacity(), crop_window_width, crop_window_height,
         frame_format_, &viz_frames));
-    for (int i = 0; i < scene_frames_or_empty_.size(); ++i) {
+    for (int i = 0; i < num_frames; ++i) {
       cc->Outputs()
           .Tag(kOutputFocusPointFrameViz)
           .Add(viz_frames[i].release(), Timestamp(scene_frame_timestamps_[i]));
@@ -807,7 +939,7 @@ absl::Status SceneCroppingCalculator::OutputVizFrames(
     MP_RETURN_IF_ERROR(DrawDetectionAndFramingWindow(
         raw_scene_frames_or_empty_, crop_from_locations, frame_format_,
         options_.viz_overlay_opacity(), &viz_frames));
-    for (int i = 0; i < raw_scene_frames_or_empty_.size(); ++i) {
+    for (int i = 0; i < num_frames; ++i) {
       cc->Outputs()
           .Tag(kOutputFramingAndDetections)
           .Add(viz_frames[i].release(), Timestamp(scene_frame_timestamps_[i]));
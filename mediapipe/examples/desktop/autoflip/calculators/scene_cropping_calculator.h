@@ -15,6 +15,7 @@
 #ifndef MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_CALCULATORS_SCENE_CROPPING_CALCULATOR_H_
 #define MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_CALCULATORS_SCENE_CROPPING_CALCULATOR_H_
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -33,6 +34,7 @@
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/threadpool.h"
 
 namespace mediapipe {
 namespace autoflip {
@@ -67,6 +69,13 @@ namespace autoflip {
 // the scene using a Retargeter, which solves linear programming problems
 // through a L1 path solver (default) or least squares problems through a L2
 // path solver.
+//
+// By default a scene is buffered until its shot boundary (or until
+// max_scene_size frames), which gives the smoothest camera path offline. For
+// live streams, set a small max_scene_size and a streaming_lookahead_size: the
+// buffer then acts as a sliding window of at most max_scene_size frames, and
+// its last streaming_lookahead_size frames are only used to smooth the camera
+// path of the frames before them, and are cropped again with the next window.
 
 // Input streams:
 // - required tag VIDEO_FRAMES (type ImageFrame):
@@ -134,7 +143,8 @@ class SceneCroppingCalculator : public CalculatorBase {
   // Buffers each scene frame and its timestamp. Packs and stores KeyFrameInfo
   // for key frames (a.k.a. frames with detection features). When a shot
   // boundary is encountered or when the buffer is full, calls ProcessScene()
-  // to process the scene at once, and clears buffers.
+  // to process the scene at once, and clears buffers except for lookahead
+  // frames.
   absl::Status Process(CalculatorContext* cc) override;
 
   // Calls ProcessScene() on remaining buffered frames. Optionally outputs a
@@ -164,7 +174,11 @@ class SceneCroppingCalculator : public CalculatorBase {
   //    to force flush).
   // 6. Optionally outputs visualization frames.
   // 7. Optionally updates cropping summary.
-  absl::Status ProcessScene(const bool is_end_of_scene, CalculatorContext* cc);
+  // The last |num_lookahead_frames| buffered frames are not output, and are
+  // kept in the buffers with their features for the next call.
+  absl::Status ProcessScene(const bool is_end_of_scene,
+                            const int num_lookahead_frames,
+                            CalculatorContext* cc);
 
   // Formats and outputs the cropped frames passed in through
   // |cropped_frames_ptr|. Scales them to be at least as big as the target
@@ -181,13 +195,32 @@ class SceneCroppingCalculator : public CalculatorBase {
       std::vector<cv::Scalar>* padding_colors, float* vertical_fill_percent,
       const std::vector<cv::Mat>* cropped_frames_ptr, CalculatorContext* cc);
 
-  // Draws and outputs visualization frames if those streams are present.
+  // Runs |task| for indices 0 to |num_tasks| - 1 on the thread pool if there
+  // is one, and returns once all of them are done.
+  void RunTasks(const int num_tasks,
+                const std::function<void(int)>& task) const;
+
+  // Scales a cropped frame to |scaled_width| x |scaled_height|. Thread-safe.
+  std::unique_ptr<ImageFrame> ScaleCroppedFrame(const cv::Mat& cropped_frame,
+                                                const int scaled_width,
+                                                const int scaled_height,
+                                                const double scaling) const;
+
+  // Replaces the scaled |*frame| with its padding to the target size. Uses
+  // |background_color| for padding if not null, otherwise a blurred
+  // background, which is |blurred_background| if not null. Thread-safe.
+  absl::Status PadScaledFrame(const cv::Scalar* background_color,
+                              const cv::Mat* blurred_background,
+                              std::unique_ptr<ImageFrame>* frame) const;
+
+  // Draws and outputs the first |num_frames| visualization frames if those
+  // streams are present.
   absl::Status OutputVizFrames(
       const std::vector<KeyFrameCropResult>& key_frame_crop_results,
       const std::vector<FocusPointFrame>& focus_point_frames,
       const std::vector<cv::Rect>& crop_from_locations,
       const int crop_window_width, const int crop_window_height,
-      CalculatorContext* cc) const;
+      const int num_frames, CalculatorContext* cc) const;
 
   // Filters detections based on USER_HINT under specific flag conditions.
   void FilterKeyFrameInfo();
@@ -273,6 +306,9 @@ class SceneCroppingCalculator : public CalculatorBase {
   // Object for padding an image to a target aspect ratio.
   std::unique_ptr<PaddingEffectGenerator> padder_ = nullptr;
 
+  // Optional pool for scaling and padding the frames of a scene in parallel.
+  std::unique_ptr<ThreadPool> pool_ = nullptr;
+
   // Optional diagnostic summary output emitted in Close().
   std::unique_ptr<VideoCroppingSummary> summary_ = nullptr;
 
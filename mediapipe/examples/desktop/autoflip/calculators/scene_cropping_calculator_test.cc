@@ -22,6 +22,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
@@ -301,6 +302,14 @@ void AddScene(const int start_frame_index, const int num_scene_frames,
   }
 }
 
+// Copies the input packets of |from| to |to|, which has the same streams.
+void CopyInputs(const CalculatorRunner::StreamContentsSet& from,
+                CalculatorRunner::StreamContentsSet* to) {
+  for (CollectionItemId id = from.BeginId(); id < from.EndId(); ++id) {
+    to->Get(id).packets = from.Get(id).packets;
+  }
+}
+
 // Checks that the output stream for cropped frames has the correct number of
 // frames, and that the size of each frame is correct.
 void CheckCroppedFrames(const CalculatorRunner& runner, const int num_frames,
@@ -381,6 +390,165 @@ TEST(SceneCroppingCalculatorTest, HandlesLongScene) {
   CheckCroppedFrames(*runner, 2 * kMaxSceneSize, kTargetWidth, kTargetHeight);
 }
 
+// Checks that the calculator checks the streaming lookahead size is valid.
+TEST(SceneCroppingCalculatorTest, ChecksStreamingLookaheadSize) {
+  CalculatorGraphConfig::Node config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+          kConfig, kTargetWidth, kTargetHeight, kTargetSizeType, kMaxSceneSize,
+          kPriorFrameBufferSize));
+  config.mutable_options()
+      ->MutableExtension(SceneCroppingCalculatorOptions::ext)
+      ->set_streaming_lookahead_size(kMaxSceneSize);
+  auto runner = absl::make_unique<CalculatorRunner>(config);
+  const auto status = runner->Run();
+  EXPECT_FALSE(status.ok());
+  EXPECT_THAT(status.ToString(),
+              HasSubstr("Streaming lookahead size is not in"));
+}
+
+// Checks that with a streaming lookahead, a long scene is cropped in sliding
+// windows of at most maximum scene size frames, and that the lookahead frames
+// of each window are output with the next one.
+TEST(SceneCroppingCalculatorTest, StreamsLongSceneWithLookahead) {
+  constexpr int kLookaheadSize = 4;
+  CalculatorGraphConfig::Node config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+          kConfig, kTargetWidth, kTargetHeight, kTargetSizeType, kMaxSceneSize,
+          kPriorFrameBufferSize));
+  config.add_output_stream("CROPPING_SUMMARY:cropping_summaries");
+  config.mutable_options()
+      ->MutableExtension(SceneCroppingCalculatorOptions::ext)
+      ->set_streaming_lookahead_size(kLookaheadSize);
+  auto runner = absl::make_unique<CalculatorRunner>(config);
+  const int num_frames = 4 * kMaxSceneSize;
+  AddScene(0, num_frames, kInputFrameWidth, kInputFrameHeight, kKeyFrameWidth,
+           kKeyFrameHeight, kDownSampleRate, runner->MutableInputs());
+  MP_EXPECT_OK(runner->Run());
+  CheckCroppedFrames(*runner, num_frames, kTargetWidth, kTargetHeight);
+  const auto& cropped_frames = runner->Outputs().Tag("CROPPED_FRAMES").packets;
+  for (int i = 0; i < num_frames; ++i) {
+    EXPECT_EQ(cropped_frames[i].Timestamp().Value(), i * kTimestampDiff);
+  }
+
+  const auto& summary_output =
+      runner->Outputs().Tag("CROPPING_SUMMARY").packets;
+  ASSERT_EQ(summary_output.size(), 1);
+  const auto& summary = summary_output[0].Get<VideoCroppingSummary>();
+  int num_output_frames = 0;
+  for (const auto& scene_summary : summary.scene_summaries()) {
+    EXPECT_LE(scene_summary.num_buffered_frames(), kMaxSceneSize);
+    if (!scene_summary.is_end_of_scene()) {
+      EXPECT_EQ(scene_summary.num_buffered_frames(), kMaxSceneSize);
+      EXPECT_EQ(scene_summary.num_output_frames(),
+                kMaxSceneSize - kLookaheadSize);
+    }
+    num_output_frames += scene_summary.num_output_frames();
+  }
+  EXPECT_EQ(num_output_frames, num_frames);
+}
+
+// Checks that two runners output the same cropped frames, in order.
+void ExpectSameCroppedFrames(const CalculatorRunner& expected_runner,
+                             const CalculatorRunner& runner) {
+  const auto& expected_frames =
+      expected_runner.Outputs().Tag("CROPPED_FRAMES").packets;
+  const auto& frames = runner.Outputs().Tag("CROPPED_FRAMES").packets;
+  ASSERT_EQ(expected_frames.size(), frames.size());
+  for (int i = 0; i < expected_frames.size(); ++i) {
+    EXPECT_EQ(frames[i].Timestamp(), expected_frames[i].Timestamp());
+    const cv::Mat expected_mat =
+        formats::MatView(&expected_frames[i].Get<ImageFrame>());
+    const cv::Mat mat = formats::MatView(&frames[i].Get<ImageFrame>());
+    EXPECT_EQ(cv::norm(expected_mat, mat, cv::NORM_INF), 0)
+        << "at frame " << i;
+  }
+}
+
+// Checks that scaling and padding frames on several threads outputs the same
+// frames, in order, as on a single thread.
+TEST(SceneCroppingCalculatorTest, CropsOnThreadPool) {
+  CalculatorGraphConfig::Node config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+          kConfig, kTargetWidth, kTargetHeight, kTargetSizeType, kMaxSceneSize,
+          kPriorFrameBufferSize));
+  auto serial_runner = absl::make_unique<CalculatorRunner>(config);
+  config.mutable_options()
+      ->MutableExtension(SceneCroppingCalculatorOptions::ext)
+      ->set_num_threads(4);
+  auto parallel_runner = absl::make_unique<CalculatorRunner>(config);
+  const int num_frames = 2 * kMaxSceneSize;
+  AddScene(0, num_frames, kInputFrameWidth, kInputFrameHeight, kKeyFrameWidth,
+           kKeyFrameHeight, kDownSampleRate, serial_runner->MutableInputs());
+  CopyInputs(*serial_runner->MutableInputs(), parallel_runner->MutableInputs());
+  MP_ASSERT_OK(serial_runner->Run());
+  MP_ASSERT_OK(parallel_runner->Run());
+  CheckCroppedFrames(*parallel_runner, num_frames, kTargetWidth,
+                     kTargetHeight);
+  ExpectSameCroppedFrames(*serial_runner, *parallel_runner);
+}
+
+// Checks that the blurred backgrounds reused on several threads are the ones
+// selected in frame order on a single thread.
+TEST(SceneCroppingCalculatorTest, ReusesBlurredBackgroundsOnThreadPool) {
+  const int target_width = 100, target_height = 200;
+  const int input_width = 100, input_height = 100;
+  CalculatorGraphConfig::Node config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+          absl::Substitute(kNoKeyFrameConfig, target_width, target_height));
+  auto* options = config.mutable_options()->MutableExtension(
+      SceneCroppingCalculatorOptions::ext);
+  options->mutable_padding_parameters()->set_blur_downscale_factor(4);
+  options->mutable_padding_parameters()->set_blur_reuse_threshold(10.0f);
+  auto serial_runner = absl::make_unique<CalculatorRunner>(config);
+  options->set_num_threads(4);
+  auto parallel_runner = absl::make_unique<CalculatorRunner>(config);
+
+  // Gray frames getting brighter by 4 levels per frame, so that every third
+  // frame has its own blurred background.
+  auto* inputs = serial_runner->MutableInputs();
+  for (int i = 0; i < kSceneSize; ++i) {
+    Timestamp timestamp(i * kTimestampDiff);
+    auto frame = MakeImageFrameFromColor(cv::Scalar(4 * i, 4 * i, 4 * i),
+                                         input_width, input_height);
+    inputs->Tag("VIDEO_FRAMES")
+        .packets.push_back(Adopt(frame.release()).At(timestamp));
+    auto static_features = absl::make_unique<StaticFeatures>();
+    inputs->Tag("STATIC_FEATURES")
+        .packets.push_back(Adopt(static_features.release()).At(timestamp));
+    if (i % kDownSampleRate == 0) {
+      // Target crop size is (50, 100). Adds one required detection with size
+      // (80, 100) larger than the target crop size to force padding.
+      auto detections = absl::make_unique<DetectionSet>();
+      auto* salient_region = detections->add_detections();
+      salient_region->set_is_required(true);
+      auto* location = salient_region->mutable_location();
+      location->set_x(10);
+      location->set_y(0);
+      location->set_width(80);
+      location->set_height(input_height);
+      inputs->Tag("DETECTION_FEATURES")
+          .packets.push_back(Adopt(detections.release()).At(timestamp));
+    }
+  }
+  CopyInputs(*serial_runner->MutableInputs(), parallel_runner->MutableInputs());
+  MP_ASSERT_OK(serial_runner->Run());
+  MP_ASSERT_OK(parallel_runner->Run());
+  CheckCroppedFrames(*parallel_runner, kSceneSize, target_width,
+                     target_height);
+  ExpectSameCroppedFrames(*serial_runner, *parallel_runner);
+
+  // The top padding row of frames 1 and 2 is the one of frame 0, while frame 3
+  // differs by more than the threshold and has its own.
+  const auto& frames =
+      parallel_runner->Outputs().Tag("CROPPED_FRAMES").packets;
+  auto top_row = [&frames](int i) {
+    return formats::MatView(&frames[i].Get<ImageFrame>()).row(0);
+  };
+  EXPECT_EQ(cv::norm(top_row(0), top_row(1), cv::NORM_INF), 0);
+  EXPECT_EQ(cv::norm(top_row(0), top_row(2), cv::NORM_INF), 0);
+  EXPECT_GT(cv::norm(top_row(0), top_row(3), cv::NORM_INF), 0);
+}
+
 // Checks that the calculator can optionally output debug streams.
 TEST(SceneCroppingCalculatorTest, OutputsDebugStreams) {
   const CalculatorGraphConfig::Node config =
@@ -904,6 +1072,36 @@ TEST(SceneCroppingCalculatorTest, OutputsCropMessageKinematicPathNoVideo) {
     EXPECT_EQ(ext_render_message.render_to_location().height(), 1124);
   }
 }
+
+// Crops a padded scene of 720p frames with the given number of threads. Items
+// are frames.
+void BM_SceneCroppingThreads(benchmark::State& state) {
+  constexpr int kNumFrames = 60;
+  CalculatorGraphConfig::Node config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+          kConfig, kTargetWidth, kTargetHeight, kTargetSizeType, kNumFrames,
+          kPriorFrameBufferSize));
+  config.mutable_options()
+      ->MutableExtension(SceneCroppingCalculatorOptions::ext)
+      ->set_num_threads(state.range(0));
+  CalculatorRunner input_runner(config);
+  AddScene(0, kNumFrames, kInputFrameWidth, kInputFrameHeight, kKeyFrameWidth,
+           kKeyFrameHeight, kDownSampleRate, input_runner.MutableInputs());
+  for (auto _ : state) {
+    CalculatorRunner runner(config);
+    CopyInputs(*input_runner.MutableInputs(), runner.MutableInputs());
+    CHECK_OK(runner.Run());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumFrames);
+}
+BENCHMARK(BM_SceneCroppingThreads)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
 }  // namespace
 }  // namespace autoflip
 }  // namespace mediapipe
@@ -14,6 +14,8 @@
 
 #include "mediapipe/examples/desktop/autoflip/quality/padding_effect_generator.h"
 
+#include <algorithm>
+
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
@@ -48,7 +50,8 @@ PaddingEffectGenerator::PaddingEffectGenerator(const int input_width,
 absl::Status PaddingEffectGenerator::Process(
     const ImageFrame& input_frame, const float background_contrast,
     const int blur_cv_size, const float overlay_opacity,
-    ImageFrame* output_frame, const cv::Scalar* background_color_in_rgb) {
+    ImageFrame* output_frame, const cv::Scalar* background_color_in_rgb,
+    const cv::Mat* blurred_background) {
   RET_CHECK_EQ(input_frame.Width(), input_width_);
   RET_CHECK_EQ(input_frame.Height(), input_height_);
   RET_CHECK(output_frame);
@@ -82,6 +85,18 @@ absl::Status PaddingEffectGenerator::Process(
   //     the final frame, and then we blur it and adjust contrast and opacity.
   if (background_color_in_rgb != nullptr) {
     canvas = *background_color_in_rgb;
+  } else if (HasFastBlur()) {
+    cv::Mat blurred;
+    if (blurred_background != nullptr) {
+      blurred = *blurred_background;
+    } else {
+      blurred = BlurBackground(DownscaleEffectiveBackground(original_image),
+                               blur_cv_size);
+    }
+    RET_CHECK(!blurred.empty() && blurred.type() == canvas.type());
+    DrawDownscaledBlurredBackground(blurred, foreground_height,
+                                    background_contrast, overlay_opacity,
+                                    &canvas);
   } else {
     // Copy the original image to the background.
     x = 0.5 * (effective_input_width - effective_output_width);
@@ -95,10 +110,8 @@ absl::Status PaddingEffectGenerator::Process(
     const int cv_size =
         blur_cv_size % 2 == 1 ? blur_cv_size : (blur_cv_size + 1);
     const cv::Size kernel(cv_size, cv_size);
-    // TODO: the larger the kernel size, the slower the blurring
-    // operation is. Consider running multiple sequential blurs with smaller
-    // sizes to simulate the effect of using a large size. This might be able to
-    // speed up the process.
+    // Note: the larger the kernel size, the slower the blurring operation is.
+    // SetFastBlur() approximates it at a lower resolution.
     x = 0;
     width = effective_output_width;
     const cv::Rect canvas_rect(0, 0, canvas.cols, canvas.rows);
@@ -173,6 +186,98 @@ absl::Status PaddingEffectGenerator::Process(
   return absl::OkStatus();
 }
 
+void PaddingEffectGenerator::SetFastBlur(const int downscale_factor) {
+  blur_downscale_factor_ = std::max(1, downscale_factor);
+}
+
+cv::Mat PaddingEffectGenerator::DownscaleBackground(
+    const ImageFrame& input_frame) const {
+  cv::Mat image = formats::MatView(&input_frame);
+  if (!is_vertical_padding_) {
+    image = image.t();
+  }
+  return DownscaleEffectiveBackground(image);
+}
+
+cv::Mat PaddingEffectGenerator::DownscaleEffectiveBackground(
+    const cv::Mat& image) const {
+  const int effective_output_width =
+      is_vertical_padding_ ? output_width_ : output_height_;
+  const int effective_output_height =
+      is_vertical_padding_ ? output_height_ : output_width_;
+  const int x = 0.5 * (image.cols - effective_output_width);
+  const cv::Rect crop_window_for_background(x, 0, effective_output_width,
+                                            effective_output_height);
+  const int factor = blur_downscale_factor_;
+  const cv::Size small_size(
+      std::max(1, (effective_output_width + factor - 1) / factor),
+      std::max(1, (effective_output_height + factor - 1) / factor));
+  cv::Mat small_background;
+  cv::resize(image(crop_window_for_background), small_background, small_size,
+             0, 0, cv::INTER_AREA);
+  return small_background;
+}
+
+cv::Mat PaddingEffectGenerator::BlurBackground(const cv::Mat& background,
+                                               const int blur_cv_size) const {
+  const int cv_size = blur_cv_size % 2 == 1 ? blur_cv_size : (blur_cv_size + 1);
+  // Uses the sigma that OpenCV derives from the full resolution kernel size,
+  // scaled down with the background.
+  const double sigma = 0.3 * ((cv_size - 1) * 0.5 - 1) + 0.8;
+  cv::Mat blurred;
+  cv::GaussianBlur(background, blurred, cv::Size(),
+                   sigma / blur_downscale_factor_);
+  return blurred;
+}
+
+// static
+std::vector<int> PaddingEffectGenerator::SelectBackgroundReferences(
+    const std::vector<cv::Mat>& backgrounds, const float reuse_threshold) {
+  std::vector<int> references(backgrounds.size());
+  for (int i = 0; i < backgrounds.size(); ++i) {
+    references[i] = i;
+    if (i == 0 || reuse_threshold <= 0.0f) continue;
+    const cv::Mat& reference = backgrounds[references[i - 1]];
+    const cv::Mat& background = backgrounds[i];
+    if (reference.size() == background.size() &&
+        reference.type() == background.type() &&
+        cv::norm(background, reference, cv::NORM_L1) <=
+            reuse_threshold * background.total() * background.channels()) {
+      references[i] = references[i - 1];
+    }
+  }
+  return references;
+}
+
+void PaddingEffectGenerator::DrawDownscaledBlurredBackground(
+    const cv::Mat& blurred_background, const int foreground_height,
+    const float background_contrast, const float overlay_opacity,
+    cv::Mat* canvas) const {
+  // Contrast adjustment and alpha blending with a black layer are both
+  // scalings, which are applied at once at the low resolution.
+  cv::Mat darkened;
+  blurred_background.convertTo(darkened, -1,
+                               background_contrast * (1 - overlay_opacity));
+
+  // Upsamples straight into the padding regions, mapping the pixel centers of
+  // the canvas to the downscaled background.
+  const double scale_x = static_cast<double>(darkened.cols) / canvas->cols;
+  const double scale_y = static_cast<double>(darkened.rows) / canvas->rows;
+  const int top_height = (canvas->rows - foreground_height) / 2;
+  for (const cv::Range& rows :
+       {cv::Range(0, top_height),
+        cv::Range(top_height + foreground_height, canvas->rows)}) {
+    if (rows.size() <= 0) continue;
+    const cv::Mat transform =
+        (cv::Mat_<double>(2, 3) << scale_x, 0, 0.5 * scale_x - 0.5, 0, scale_y,
+         (rows.start + 0.5) * scale_y - 0.5);
+    cv::Mat region = (*canvas)(rows, cv::Range::all());
+    cv::warpAffine(darkened, region, transform, region.size(),
+                   cv::INTER_LINEAR | cv::WARP_INVERSE_MAP,
+                   cv::BORDER_REPLICATE);
+  }
+}
+
 cv::Rect PaddingEffectGenerator::ComputeOutputLocation() {
   const int effective_input_width =
       is_vertical_padding_ ? input_width_ : input_height_;
@@ -1,6 +1,8 @@
 #ifndef MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_QUALITY_PADDING_EFFECT_GENERATOR_H_
 #define MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_QUALITY_PADDING_EFFECT_GENERATOR_H_
 
+#include <vector>
+
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
@@ -49,22 +51,66 @@ class PaddingEffectGenerator {
   //   the opacity of the black layer.
   // - background_color_in_rgb: If not null, uses this solid color as background
   //   instead of blurring the image, and does not adjust contrast or opacity.
+  // - blurred_background: If not null and the fast blur is enabled, uses this
+  //   result of BlurBackground() instead of blurring the image.
   absl::Status Process(const ImageFrame& input_frame,
                        const float background_contrast, const int blur_cv_size,
                        const float overlay_opacity, ImageFrame* output_frame,
-                       const cv::Scalar* background_color_in_rgb = nullptr);
+                       const cv::Scalar* background_color_in_rgb = nullptr,
+                       const cv::Mat* blurred_background = nullptr);
 
   // Compute the "render location" on the output frame where the "crop from"
   // location is to be placed.  For use with external rendering soutions.
   cv::Rect ComputeOutputLocation();
 
+  // Enables a faster approximation of the blurred background: it is blurred
+  // and darkened at 1/|downscale_factor| of the output size, then upsampled
+  // only into the padding regions. A factor of 1 disables the fast path.
+  void SetFastBlur(const int downscale_factor);
+
+  // Returns true if the fast blurred background is enabled.
+  bool HasFastBlur() const { return blur_downscale_factor_ > 1; }
+
+  // With the fast blur, the blurred background of a frame can be computed
+  // ahead of Process() and shared by frames with similar backgrounds. Returns
+  // the downscaled background of |input_frame|, which BlurBackground() blurs.
+  cv::Mat DownscaleBackground(const ImageFrame& input_frame) const;
+
+  // Returns the downscaled |background| blurred for |blur_cv_size|.
+  cv::Mat BlurBackground(const cv::Mat& background,
+                         const int blur_cv_size) const;
+
+  // Returns, for the downscaled |backgrounds| of consecutive frames, the index
+  // of the frame whose blurred background each frame uses. The frames are
+  // visited in order, and reuse the blurred background of the last frame using
+  // its own while their background differs from it by at most a mean absolute
+  // difference of |reuse_threshold| intensity levels.
+  static std::vector<int> SelectBackgroundReferences(
+      const std::vector<cv::Mat>& backgrounds, const float reuse_threshold);
+
  private:
+  // Returns the downscaled background of |image|, which is transposed for
+  // horizontal padding.
+  cv::Mat DownscaleEffectiveBackground(const cv::Mat& image) const;
+
+  // Draws the darkened |blurred_background| into the regions of |canvas| above
+  // and below the centered |foreground_height| rows, using the downscaled fast
+  // path.
+  void DrawDownscaledBlurredBackground(const cv::Mat& blurred_background,
+                                       const int foreground_height,
+                                       const float background_contrast,
+                                       const float overlay_opacity,
+                                       cv::Mat* canvas) const;
+
   double target_aspect_ratio_;
   int input_width_ = -1;
   int input_height_ = -1;
   int output_width_ = -1;
   int output_height_ = -1;
   bool is_vertical_padding_;
+
+  // Downscale factor of the fast blurred background, see SetFastBlur().
+  int blur_downscale_factor_ = 1;
 };
 
 }  // namespace autoflip
@@ -14,11 +14,15 @@
 
 #include "mediapipe/examples/desktop/autoflip/quality/padding_effect_generator.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/flags/flag.h"
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/deps/file_path.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -46,6 +50,19 @@ constexpr char kResultImagePrefix[] =
 
 const cv::Scalar kRed = cv::Scalar(255, 0, 0);
 
+// Loads the test image into an RGB frame.
+void LoadTestFrame(std::unique_ptr<ImageFrame>* frame) {
+  std::string test_image;
+  MP_ASSERT_OK(mediapipe::file::GetContents(
+      mediapipe::file::JoinPath("./", kTestImage), &test_image));
+  const std::vector<char> contents_vector(test_image.begin(), test_image.end());
+  const cv::Mat decoded_mat = cv::imdecode(contents_vector, cv::IMREAD_COLOR);
+  *frame = absl::make_unique<ImageFrame>(ImageFormat::SRGB, decoded_mat.cols,
+                                         decoded_mat.rows);
+  cv::Mat frame_mat = formats::MatView(frame->get());
+  cv::cvtColor(decoded_mat, frame_mat, cv::COLOR_BGR2RGB);
+}
+
 void TestWithAspectRatio(const double aspect_ratio,
                          const cv::Scalar* background_color_in_rgb = nullptr) {
   std::string test_image;
@@ -186,6 +203,95 @@ TEST(PaddingEffectGeneratorTest, ScaleToMultipleOfTwo) {
   EXPECT_EQ(result_frame.Height(), expect_height);
 }
 
+TEST(PaddingEffectGeneratorTest, FastBlurIsCloseToExactBlur) {
+  std::unique_ptr<ImageFrame> test_frame;
+  LoadTestFrame(&test_frame);
+  const int blur_cv_size = std::min(test_frame->Width(), test_frame->Height());
+  for (const double aspect_ratio : {0.3, 1.0, 3.4}) {
+    PaddingEffectGenerator exact_generator(
+        test_frame->Width(), test_frame->Height(), aspect_ratio);
+    PaddingEffectGenerator fast_generator(test_frame->Width(),
+                                          test_frame->Height(), aspect_ratio);
+    fast_generator.SetFastBlur(/*downscale_factor=*/4);
+    ImageFrame exact_frame;
+    ImageFrame fast_frame;
+    MP_ASSERT_OK(exact_generator.Process(*test_frame, 0.8, blur_cv_size, 0.6,
+                                         &exact_frame));
+    MP_ASSERT_OK(fast_generator.Process(*test_frame, 0.8, blur_cv_size, 0.6,
+                                        &fast_frame));
+    EXPECT_GT(cv::PSNR(formats::MatView(&exact_frame),
+                       formats::MatView(&fast_frame)),
+              35.0)
+        << "for aspect ratio " << aspect_ratio;
+  }
+}
+
+TEST(PaddingEffectGeneratorTest, ReusesBlurredBackground) {
+  std::unique_ptr<ImageFrame> test_frame;
+  LoadTestFrame(&test_frame);
+  // A slightly brighter and a very different (inverted) version of the frame.
+  auto brighter_frame = absl::make_unique<ImageFrame>(
+      ImageFormat::SRGB, test_frame->Width(), test_frame->Height());
+  cv::Mat brighter_mat = formats::MatView(brighter_frame.get());
+  formats::MatView(test_frame.get()).convertTo(brighter_mat, -1, 1.0, 1.0);
+  auto inverted_frame = absl::make_unique<ImageFrame>(
+      ImageFormat::SRGB, test_frame->Width(), test_frame->Height());
+  cv::Mat inverted_mat = formats::MatView(inverted_frame.get());
+  cv::bitwise_not(formats::MatView(test_frame.get()), inverted_mat);
+
+  // Pads above and below the foreground.
+  PaddingEffectGenerator generator(test_frame->Width(), test_frame->Height(),
+                                   /*target_aspect_ratio=*/1.0);
+  generator.SetFastBlur(/*downscale_factor=*/4);
+  const std::vector<cv::Mat> backgrounds = {
+      generator.DownscaleBackground(*test_frame),
+      generator.DownscaleBackground(*brighter_frame),
+      generator.DownscaleBackground(*inverted_frame)};
+  const std::vector<int> references =
+      PaddingEffectGenerator::SelectBackgroundReferences(
+          backgrounds, /*reuse_threshold=*/2.0f);
+  EXPECT_THAT(references, testing::ElementsAre(0, 0, 2));
+  EXPECT_THAT(PaddingEffectGenerator::SelectBackgroundReferences(
+                  backgrounds, /*reuse_threshold=*/0.0f),
+              testing::ElementsAre(0, 1, 2));
+
+  std::vector<cv::Mat> blurred_backgrounds(backgrounds.size());
+  for (int i = 0; i < backgrounds.size(); ++i) {
+    blurred_backgrounds[i] = generator.BlurBackground(backgrounds[i], 40);
+  }
+  ImageFrame result_frame;
+  ImageFrame brighter_result_frame;
+  ImageFrame inverted_result_frame;
+  MP_ASSERT_OK(generator.Process(*test_frame, 1.0, 40, 0.0, &result_frame,
+                                 nullptr, &blurred_backgrounds[references[0]]));
+  MP_ASSERT_OK(generator.Process(*brighter_frame, 1.0, 40, 0.0,
+                                 &brighter_result_frame, nullptr,
+                                 &blurred_backgrounds[references[1]]));
+  MP_ASSERT_OK(generator.Process(*inverted_frame, 1.0, 40, 0.0,
+                                 &inverted_result_frame, nullptr,
+                                 &blurred_backgrounds[references[2]]));
+  // Blurring a background ahead of Process() gives the same frame.
+  ImageFrame unshared_result_frame;
+  MP_ASSERT_OK(
+      generator.Process(*test_frame, 1.0, 40, 0.0, &unshared_result_frame));
+  EXPECT_EQ(cv::norm(formats::MatView(&result_frame),
+                     formats::MatView(&unshared_result_frame), cv::NORM_INF),
+            0);
+
+  const cv::Rect top_padding(0, 0, result_frame.Width(),
+                             generator.ComputeOutputLocation().y);
+  ASSERT_GT(top_padding.area(), 0);
+  const cv::Mat result_mat = formats::MatView(&result_frame);
+  EXPECT_EQ(cv::norm(result_mat(top_padding),
+                     formats::MatView(&brighter_result_frame)(top_padding),
+                     cv::NORM_INF),
+            0);
+  EXPECT_GT(cv::norm(result_mat(top_padding),
+                     formats::MatView(&inverted_result_frame)(top_padding),
+                     cv::NORM_INF),
+            0);
+}
+
 TEST(PaddingEffectGeneratorTest, ComputeOutputLocation) {
   PaddingEffectGenerator generator(1920, 1080, 1.0);
 
@@ -195,6 +301,30 @@ TEST(PaddingEffectGeneratorTest, ComputeOutputLocation) {
   EXPECT_EQ(result_rect.width, 1080);
   EXPECT_EQ(result_rect.height, 607);
 }
+
+// Pads a 720p frame to portrait with a large blur, at full resolution
+// (Arg(1)) or downscaled by Arg(). Items are frames.
+void BM_PaddingEffectGenerator(benchmark::State& state) {
+  std::unique_ptr<ImageFrame> test_frame;
+  LoadTestFrame(&test_frame);
+  ImageFrame input_frame(ImageFormat::SRGB, 1280, 720);
+  cv::Mat input_mat = formats::MatView(&input_frame);
+  cv::resize(formats::MatView(test_frame.get()), input_mat, input_mat.size());
+  PaddingEffectGenerator generator(input_frame.Width(), input_frame.Height(),
+                                   /*target_aspect_ratio=*/9.0 / 16.0);
+  generator.SetFastBlur(state.range(0));
+  for (auto _ : state) {
+    ImageFrame result_frame;
+    CHECK_OK(generator.Process(input_frame, 1.0, 200, 0.6, &result_frame));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PaddingEffectGenerator)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond);
+
 }  // namespace
 }  // namespace autoflip
 }  // namespace mediapipe
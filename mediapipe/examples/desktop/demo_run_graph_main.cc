@@ -13,12 +13,20 @@
 // limitations under the License.
 //
 // An example of sending OpenCV webcam frames into a MediaPipe graph.
+#include <sys/stat.h>
+
 #include <cstdlib>
+#include <map>
+#include <string>
 
 #include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
 #include "mediapipe/framework/formats/classification.pb.h"
@@ -28,6 +36,10 @@
 #include "mediapipe/framework/port/opencv_video_inc.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/tool/graph_config_cache.h"
+#include "mediapipe/framework/tool/hot_swap_graph.h"
+#include "mediapipe/util/tflite/tflite_model_registry.h"
+#include "mediapipe/Osc/OscReceiver.h"
 #include "mediapipe/Osc/OscSender.h"
 
 constexpr char kInputStream[] = "input_video";
@@ -45,22 +57,178 @@ ABSL_FLAG(std::string, input_video_path, "",
 ABSL_FLAG(std::string, output_video_path, "",
           "Full path of where to save result (.mp4 only). "
           "If not provided, show result in a window.");
+ABSL_FLAG(std::string, graph_cache_dir, "",
+          "Directory caching the expanded and validated graph config. "
+          "If not provided, the graph config is expanded on every start.");
+ABSL_FLAG(std::string, graph_cache_salt, "",
+          "Build ID separating the graph config cache entries of different "
+          "builds. If not provided, the size and modification time of this "
+          "binary are used.");
+ABSL_FLAG(int, metrics_osc_interval_ms, 0,
+          "Interval between graph metrics sent over OSC under "
+          "/mediapipe/metrics. If 0, no metrics are sent. Latencies are "
+          "only recorded if the graph enables the profiler.");
+ABSL_FLAG(int, osc_control_port, 0,
+          "Port receiving OSC control messages. /mediapipe/graph/load <path> "
+          "replaces the running graph with the graph config in <path>, and "
+          "/mediapipe/graph/reload reloads the current graph config file. "
+          "If 0, no control messages are received.");
 
-absl::Status RunMPPGraph() {
-  OscSender sender;
+// Returns |name| with the characters not allowed in an OSC address replaced.
+std::string OscAddressPart(const std::string& name) {
+  std::string result = name;
+  for (char& c : result) {
+    if (c == ' ' || c == '#' || c == '*' || c == ',' || c == '/' ||
+        c == '?' || c == '[' || c == ']' || c == '{' || c == '}') {
+      c = '_';
+    }
+  }
+  return result;
+}
+
+// Sends one OSC message per latency summary, with the arguments
+// count, mean, p50, p90, p99 and max in microseconds.
+void SendLatencyMetrics(
+    const std::string& prefix,
+    const std::map<std::string, mediapipe::LatencySummary>& summaries,
+    OscSender* sender) {
+  for (const auto& entry : summaries) {
+    const mediapipe::LatencySummary& summary = entry.second;
+    std::string address = absl::StrCat(prefix, OscAddressPart(entry.first));
+    OscMessage mes(address.c_str());
+    mes.addInt32(summary.count);
+    mes.addInt32(summary.mean_usec);
+    mes.addInt32(summary.p50_usec);
+    mes.addInt32(summary.p90_usec);
+    mes.addInt32(summary.p99_usec);
+    mes.addInt32(summary.max_usec);
+    sender->send(mes, "127.0.0.1", 8000);
+  }
+}
+
+// Sends the graph metrics collected since the previous call over OSC.
+absl::Status SendGraphMetrics(mediapipe::CalculatorGraph* graph,
+                              OscSender* sender) {
+  mediapipe::GraphMetrics metrics;
+  MP_RETURN_IF_ERROR(graph->GetGraphMetrics(&metrics, /*reset=*/true));
+  SendLatencyMetrics("/mediapipe/metrics/process/", metrics.process_latency,
+                     sender);
+  SendLatencyMetrics("/mediapipe/metrics/input_stream/",
+                     metrics.input_stream_latency, sender);
+  SendLatencyMetrics("/mediapipe/metrics/source/", metrics.source_latency,
+                     sender);
+  for (const auto& entry : metrics.queue_depth) {
+    std::string address = absl::StrCat("/mediapipe/metrics/queue_depth/",
+                                       OscAddressPart(entry.first));
+    OscMessage mes(address.c_str());
+    mes.addInt32(entry.second);
+    sender->send(mes, "127.0.0.1", 8000);
+  }
+  auto pool = graph->GetServiceObject(mediapipe::kImageFrameMultiPoolService);
+  if (pool) {
+    OscMessage mes("/mediapipe/metrics/image_frame_pool/max_in_use_bytes");
+    mes.addInt32(pool->GetMaxInUseBytes());
+    sender->send(mes, "127.0.0.1", 8000);
+  }
+  return absl::OkStatus();
+}
+
+// Reads the text format graph config in |path|, through the graph config
+// cache if one is configured.
+absl::Status LoadGraphConfig(const std::string& path,
+                             mediapipe::CalculatorGraphConfig* config) {
   std::string calculator_graph_config_contents;
   MP_RETURN_IF_ERROR(mediapipe::file::GetContents(
-      absl::GetFlag(FLAGS_calculator_graph_config_file),
-      &calculator_graph_config_contents));
+      path, &calculator_graph_config_contents));
   LOG(INFO) << "Get calculator graph config contents: "
             << calculator_graph_config_contents;
-  mediapipe::CalculatorGraphConfig config =
-      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(
-          calculator_graph_config_contents);
+  if (absl::GetFlag(FLAGS_graph_cache_dir).empty()) {
+    RET_CHECK(mediapipe::ParseTextProto<mediapipe::CalculatorGraphConfig>(
+        calculator_graph_config_contents, config))
+        << "Failed to parse the graph config in " << path;
+  } else {
+    // Outlives the call, so that startup does not wait for the subgraph
+    // check that a cache hit schedules.
+    static auto* cache = new mediapipe::tool::GraphConfigCache(
+        absl::GetFlag(FLAGS_graph_cache_dir),
+        absl::GetFlag(FLAGS_graph_cache_salt));
+    ASSIGN_OR_RETURN(
+        *config, cache->GetCanonicalConfig(calculator_graph_config_contents));
+  }
+  return absl::OkStatus();
+}
+
+// Handles the pending OSC control messages.  Replacing the graph is started
+// in the background and takes effect at a later frame, so errors are logged
+// and the running graph is kept.
+void HandleControlMessages(OscReceiver* receiver, std::string* graph_path,
+                           mediapipe::tool::HotSwapGraph* graph) {
+  OscMessage mes;
+  while (receiver->receive(mes, /*timeoutMsecs=*/0)) {
+    std::string path;
+    if (mes.getAddressPattern() == "/mediapipe/graph/load" &&
+        mes.getNumberOfArguments() > 0) {
+      path = mes.getArgumentAsString(0);
+    } else if (mes.getAddressPattern() == "/mediapipe/graph/reload") {
+      path = *graph_path;
+    } else {
+      LOG(WARNING) << "Ignore OSC control message " << mes.getAddressPattern();
+      continue;
+    }
+    LOG(INFO) << "Reconfigure the calculator graph from " << path;
+    mediapipe::CalculatorGraphConfig config;
+    absl::Status status = LoadGraphConfig(path, &config);
+    if (status.ok()) status = graph->Reconfigure(config);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to reconfigure the graph: " << status.message();
+      continue;
+    }
+    *graph_path = path;
+  }
+}
 
-  LOG(INFO) << "Initialize the calculator graph.";
-  mediapipe::CalculatorGraph graph;
-  MP_RETURN_IF_ERROR(graph.Initialize(config));
+// Logs the memory use and load time of the TfLite models, which are shared
+// between the running graph and a reconfigured one.
+void LogModelStats() {
+  for (const auto& stats :
+       mediapipe::TfLiteModelRegistry::GetDefault()->GetStats()) {
+    LOG(INFO) << "Model " << stats.path << ": " << stats.model_bytes
+              << " bytes, loaded " << stats.load_count << " time(s) in "
+              << stats.load_time << ", shared " << stats.hit_count
+              << " time(s)" << (stats.loaded ? "" : ", released");
+  }
+  LOG(INFO) << "TfLite models in use: "
+            << mediapipe::TfLiteModelRegistry::GetDefault()->GetLoadedBytes()
+            << " bytes";
+}
+
+// Logs the high-water marks of the image frames allocated from the pool of
+// |graph|.
+void LogImageFramePoolStats(mediapipe::CalculatorGraph* graph) {
+  auto pool = graph->GetServiceObject(mediapipe::kImageFrameMultiPoolService);
+  if (!pool) return;
+  for (const auto& stats : pool->GetStats()) {
+    LOG(INFO) << "Image frames " << stats.width << "x" << stats.height
+              << " format " << stats.format << ": " << stats.request_count
+              << " requested, at most " << stats.max_in_use_count
+              << " in use of " << stats.frame_bytes << " bytes";
+  }
+  LOG(INFO) << "Image frames in use at most: " << pool->GetMaxInUseBytes()
+            << " bytes";
+}
+
+absl::Status RunMPPGraph() {
+  OscSender sender;
+  std::string graph_path = absl::GetFlag(FLAGS_calculator_graph_config_file);
+  mediapipe::CalculatorGraphConfig config;
+  MP_RETURN_IF_ERROR(LoadGraphConfig(graph_path, &config));
+
+  OscReceiver receiver;
+  const int control_port = absl::GetFlag(FLAGS_osc_control_port);
+  if (control_port > 0) {
+    RET_CHECK(receiver.connect(control_port))
+        << "Failed to bind the OSC control port " << control_port;
+  }
 
   LOG(INFO) << "Initialize the camera or load the video.";
   cv::VideoCapture capture;
@@ -84,18 +252,22 @@ absl::Status RunMPPGraph() {
   }
 
   LOG(INFO) << "Start running the calculator graph.";
-  ASSIGN_OR_RETURN(mediapipe::OutputStreamPoller poller,
-                   graph.AddOutputStreamPoller(kOutputStream));
-
-  ASSIGN_OR_RETURN(mediapipe::OutputStreamPoller poller_landmarks,
-                   graph.AddOutputStreamPoller(kLandmarksStream));
-
-  ASSIGN_OR_RETURN(mediapipe::OutputStreamPoller poller_handidness,
-                   graph.AddOutputStreamPoller(kHandidnessStream));
-
-  MP_RETURN_IF_ERROR(graph.StartRun({}));
+  // Polls the video, landmarks and handedness streams together so that each
+  // frame's outputs are returned at once. The graph can be replaced while
+  // running through the OSC control port.
+  mediapipe::tool::HotSwapGraph graph(
+      {absl::StrCat("VIDEO:", kOutputStream),
+       absl::StrCat("LANDMARKS:", kLandmarksStream),
+       absl::StrCat("HANDEDNESS:", kHandidnessStream)});
+  MP_RETURN_IF_ERROR(graph.Start(config));
+  LogModelStats();
+  mediapipe::PacketSet output_packets(graph.TagMap());
+  int64 swap_count = 0;
 
   LOG(INFO) << "Start grabbing and processing frames.";
+  const absl::Duration metrics_interval =
+      absl::Milliseconds(absl::GetFlag(FLAGS_metrics_osc_interval_ms));
+  absl::Time next_metrics_time = absl::Now() + metrics_interval;
   bool grab_frames = true;
   while (grab_frames) 
   {
@@ -125,6 +297,10 @@ absl::Status RunMPPGraph() {
     cv::Mat input_frame_mat = mediapipe::formats::MatView(input_frame.get());
     camera_frame.copyTo(input_frame_mat);
 
+    if (control_port > 0) {
+      HandleControlMessages(&receiver, &graph_path, &graph);
+    }
+
     // Send image packet into the graph.
     size_t frame_timestamp_us =
         (double)cv::getTickCount() / (double)cv::getTickFrequency() * 1e6;
@@ -132,22 +308,37 @@ absl::Status RunMPPGraph() {
         kInputStream, mediapipe::Adopt(input_frame.release())
                           .At(mediapipe::Timestamp(frame_timestamp_us))));
 
-    // Get the graph result packet and stop if it fails.
+    // Get the graph result packets for one frame and stop if it fails. The
+    // landmarks and handedness packets are empty when no hands are detected.
     mediapipe::Packet packet;
-    if (!poller.Next(&packet)) break;
-  
-    mediapipe::Packet landmark_packet;
-    mediapipe::Packet handidness_packet;
-    if (poller_landmarks.QueueSize() != poller_handidness.QueueSize())
-        std::cout << "Queue Missmatch:" << poller_landmarks.QueueSize() << " : " << poller_handidness.QueueSize() << std::endl;
+    do {
+      if (!graph.Next(&output_packets)) {
+        grab_frames = false;
+        break;
+      }
+      packet = output_packets.Tag("VIDEO");
+    } while (packet.IsEmpty());
+    if (!grab_frames) break;
+
+    mediapipe::tool::HotSwapStats swap_stats = graph.GetStats();
+    if (swap_stats.swap_count != swap_count) {
+      swap_count = swap_stats.swap_count;
+      LOG(INFO) << "Swapped the calculator graph: prepared in "
+                << swap_stats.prepare_time << ", swapped "
+                << swap_stats.swap_latency << " after the request, "
+                << "previous graph drained in " << swap_stats.drain_time;
+      LogModelStats();
+    }
+
+    const mediapipe::Packet& landmark_packet =
+        output_packets.Tag("LANDMARKS");
+    const mediapipe::Packet& handidness_packet =
+        output_packets.Tag("HANDEDNESS");
 
     //check that palms and hands are detected
-    if (poller_landmarks.QueueSize() > 0 && poller_handidness.QueueSize() > 0)
+    if (!landmark_packet.IsEmpty() && !handidness_packet.IsEmpty())
     {
-      if (!poller_handidness.Next(&handidness_packet)) break;
       auto& handidnessListVec = handidness_packet.Get<std::vector<::mediapipe::ClassificationList>>();
-
-      if (!poller_landmarks.Next(&landmark_packet)) break;
       auto& landmarkListVec = landmark_packet.Get<std::vector<::mediapipe::NormalizedLandmarkList>>();  
 
       if (handidnessListVec.size() == landmarkListVec.size())
@@ -175,6 +366,12 @@ absl::Status RunMPPGraph() {
       }
     } 
 
+    if (metrics_interval > absl::ZeroDuration() &&
+        absl::Now() >= next_metrics_time) {
+      MP_RETURN_IF_ERROR(SendGraphMetrics(graph.graph(), &sender));
+      next_metrics_time = absl::Now() + metrics_interval;
+    }
+
     auto& output_frame = packet.Get<mediapipe::ImageFrame>();
     // Convert back to opencv for display or saving.
     cv::Mat output_frame_mat = mediapipe::formats::MatView(&output_frame);
@@ -198,13 +395,27 @@ absl::Status RunMPPGraph() {
 
   LOG(INFO) << "Shutting down.";
   if (writer.isOpened()) writer.release();
-  MP_RETURN_IF_ERROR(graph.CloseInputStream(kInputStream));
-  return graph.WaitUntilDone();
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+  LogImageFramePoolStats(graph.graph());
+  return absl::OkStatus();
+}
+
+// Returns an ID of the binary at |path| that changes when it is rebuilt.
+std::string BinaryBuildId(const char* path) {
+  struct stat info;
+  if (stat(path, &info) != 0) {
+    return path;
+  }
+  return absl::StrCat(path, ":", info.st_size, ":", info.st_mtime);
 }
 
 int main(int argc, char** argv) {
   google::InitGoogleLogging(argv[0]);
   absl::ParseCommandLine(argc, argv);
+  if (absl::GetFlag(FLAGS_graph_cache_salt).empty()) {
+    absl::SetFlag(&FLAGS_graph_cache_salt, BinaryBuildId(argv[0]));
+  }
   absl::Status run_status = RunMPPGraph();
   if (!run_status.ok()) {
     LOG(ERROR) << "Failed to run the graph: " << run_status.message();
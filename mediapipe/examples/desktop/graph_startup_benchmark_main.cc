@@ -0,0 +1,161 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Measures the startup time of MediaPipe graphs, stage by stage: text
+// parsing, subgraph expansion and validation, a graph config cache hit on its
+// own, CalculatorGraph initialization with and without the graph config
+// cache, and running Open and Close.
+//
+// Example:
+//   bazel run -c opt \
+//     mediapipe/examples/desktop/hand_tracking:hand_tracking_startup_benchmark \
+//     -- --calculator_graph_config_files=\
+//     mediapipe/graphs/hand_tracking/hand_tracking_desktop_live.pbtxt
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/tool/graph_config_cache.h"
+#include "mediapipe/framework/validated_graph_config.h"
+
+ABSL_FLAG(std::string, calculator_graph_config_files, "",
+          "Comma-separated list of text format CalculatorGraphConfig files.");
+ABSL_FLAG(std::string, graph_cache_dir, "/tmp/mediapipe_graph_cache",
+          "Directory for the graph config cache benchmarks.");
+
+namespace mediapipe {
+namespace {
+
+CalculatorGraphConfig ParseConfig(const std::string& config_text) {
+  CalculatorGraphConfig config;
+  CHECK(ParseTextProto(config_text, &config));
+  return config;
+}
+
+// Parses the text format config.
+void BM_Parse(benchmark::State& state, const std::string& config_text) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ParseConfig(config_text));
+  }
+}
+
+// Expands subgraphs, then validates and sorts the parsed config.
+void BM_ExpandAndValidate(benchmark::State& state,
+                          const std::string& config_text) {
+  CalculatorGraphConfig config = ParseConfig(config_text);
+  for (auto _ : state) {
+    ValidatedGraphConfig validated_graph;
+    MEDIAPIPE_CHECK_OK(validated_graph.Initialize(config));
+  }
+}
+
+// Parses the config and initializes a CalculatorGraph.
+void BM_Initialize(benchmark::State& state, const std::string& config_text) {
+  for (auto _ : state) {
+    CalculatorGraph graph;
+    MEDIAPIPE_CHECK_OK(graph.Initialize(ParseConfig(config_text)));
+  }
+}
+
+// Loads the cached canonical config. The subgraph check that each hit
+// schedules in the background is not timed.
+void BM_CacheHit(benchmark::State& state, const std::string& config_text) {
+  tool::GraphConfigCache cache(absl::GetFlag(FLAGS_graph_cache_dir));
+  MEDIAPIPE_CHECK_OK(cache.GetCanonicalConfig(config_text).status());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cache.GetCanonicalConfig(config_text).value());
+    state.PauseTiming();
+    cache.WaitForChecks();
+    state.ResumeTiming();
+  }
+}
+
+// Loads the cached canonical config and initializes a CalculatorGraph.
+void BM_CachedInitialize(benchmark::State& state,
+                         const std::string& config_text) {
+  tool::GraphConfigCache cache(absl::GetFlag(FLAGS_graph_cache_dir));
+  MEDIAPIPE_CHECK_OK(cache.GetCanonicalConfig(config_text).status());
+  for (auto _ : state) {
+    CalculatorGraph graph;
+    MEDIAPIPE_CHECK_OK(
+        graph.Initialize(cache.GetCanonicalConfig(config_text).value()));
+    state.PauseTiming();
+    cache.WaitForChecks();
+    state.ResumeTiming();
+  }
+}
+
+// Initializes a CalculatorGraph, then runs Open and Close on all
+// calculators without sending packets.
+void BM_OpenAndClose(benchmark::State& state, const std::string& config_text) {
+  CalculatorGraphConfig config = ParseConfig(config_text);
+  for (auto _ : state) {
+    CalculatorGraph graph;
+    MEDIAPIPE_CHECK_OK(graph.Initialize(config));
+    MEDIAPIPE_CHECK_OK(graph.StartRun({}));
+    MEDIAPIPE_CHECK_OK(graph.CloseAllInputStreams());
+    MEDIAPIPE_CHECK_OK(graph.WaitUntilDone());
+  }
+}
+
+void RegisterGraphBenchmarks(const std::string& path) {
+  std::string config_text;
+  MEDIAPIPE_CHECK_OK(file::GetContents(path, &config_text));
+  std::string graph_name = std::string(file::Basename(path));
+  benchmark::RegisterBenchmark(absl::StrCat("BM_Parse/", graph_name).c_str(),
+                               BM_Parse, config_text);
+  benchmark::RegisterBenchmark(
+      absl::StrCat("BM_ExpandAndValidate/", graph_name).c_str(),
+      BM_ExpandAndValidate, config_text);
+  benchmark::RegisterBenchmark(
+      absl::StrCat("BM_Initialize/", graph_name).c_str(), BM_Initialize,
+      config_text);
+  benchmark::RegisterBenchmark(
+      absl::StrCat("BM_CacheHit/", graph_name).c_str(), BM_CacheHit,
+      config_text);
+  benchmark::RegisterBenchmark(
+      absl::StrCat("BM_CachedInitialize/", graph_name).c_str(),
+      BM_CachedInitialize, config_text);
+  benchmark::RegisterBenchmark(
+      absl::StrCat("BM_OpenAndClose/", graph_name).c_str(), BM_OpenAndClose,
+      config_text)
+      ->Unit(benchmark::kMillisecond);
+}
+
+}  // namespace
+}  // namespace mediapipe
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  benchmark::Initialize(&argc, argv);
+  absl::ParseCommandLine(argc, argv);
+  for (const std::string& path :
+       absl::StrSplit(absl::GetFlag(FLAGS_calculator_graph_config_files), ',',
+                      absl::SkipEmpty())) {
+    mediapipe::RegisterGraphBenchmarks(path);
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  return EXIT_SUCCESS;
+}
@@ -36,6 +36,7 @@
 #include "mediapipe/framework/calculator_base.h"
 #include "mediapipe/framework/counter_factory.h"
 #include "mediapipe/framework/delegating_executor.h"
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
 #include "mediapipe/framework/graph_service_manager.h"
 #include "mediapipe/framework/input_stream_manager.h"
 #include "mediapipe/framework/mediapipe_profiling.h"
@@ -56,6 +57,7 @@
 #include "mediapipe/framework/thread_pool_executor.h"
 #include "mediapipe/framework/thread_pool_executor.pb.h"
 #include "mediapipe/framework/tool/fill_packet_set.h"
+#include "mediapipe/framework/tool/name_util.h"
 #include "mediapipe/framework/tool/status_util.h"
 #include "mediapipe/framework/tool/tag_map.h"
 #include "mediapipe/framework/tool/validate.h"
@@ -176,6 +178,10 @@ absl::Status CalculatorGraph::InitializeStreams() {
     const EdgeInfo& edge_info = validated_graph_->InputStreamInfos()[index];
     MP_RETURN_IF_ERROR(input_stream_managers_[index].Initialize(
         edge_info.name, edge_info.packet_type, edge_info.back_edge));
+    input_stream_metric_names_.push_back(absl::StrCat(
+        tool::CanonicalNodeName(validated_graph_->Config(),
+                                edge_info.parent_node.index),
+        ":", edge_info.name));
   }
 
   // Create and initialize the output streams.
@@ -451,6 +457,39 @@ absl::StatusOr<OutputStreamPoller> CalculatorGraph::AddOutputStreamPoller(
   return std::move(poller);
 }
 
+absl::StatusOr<MultiStreamPoller> CalculatorGraph::AddMultiStreamPoller(
+    const std::vector<std::string>& stream_names) {
+  RET_CHECK(initialized_).SetNoLogging()
+      << "CalculatorGraph is not initialized.";
+  proto_ns::RepeatedPtrField<ProtoString> stream_field;
+  for (const std::string& stream_name : stream_names) {
+    stream_field.Add()->assign(stream_name);
+  }
+  ASSIGN_OR_RETURN(std::shared_ptr<tool::TagMap> tag_map,
+                   tool::TagMap::Create(stream_field));
+  std::vector<OutputStreamManager*> output_stream_managers;
+  for (const std::string& stream_name : tag_map->Names()) {
+    int output_stream_index = validated_graph_->OutputStreamIndex(stream_name);
+    if (output_stream_index < 0) {
+      return mediapipe::NotFoundErrorBuilder(MEDIAPIPE_LOC)
+             << "Unable to attach poller to output stream \"" << stream_name
+             << "\" because it doesn't exist.";
+    }
+    output_stream_managers.push_back(
+        &output_stream_managers_[output_stream_index]);
+  }
+  auto internal_poller =
+      std::make_shared<internal::MultiOutputStreamPollerImpl>();
+  MP_RETURN_IF_ERROR(internal_poller->Initialize(
+      tag_map, &any_packet_type_,
+      std::bind(&CalculatorGraph::UpdateThrottledNodes, this,
+                std::placeholders::_1, std::placeholders::_2),
+      output_stream_managers));
+  MultiStreamPoller poller(std::move(tag_map), internal_poller);
+  graph_output_streams_.push_back(std::move(internal_poller));
+  return std::move(poller);
+}
+
 absl::StatusOr<Packet> CalculatorGraph::GetOutputSidePacket(
     const std::string& packet_name) {
   int side_packet_index = validated_graph_->OutputSidePacketIndex(packet_name);
@@ -584,6 +623,22 @@ absl::StatusOr<std::map<std::string, Packet>> CalculatorGraph::PrepareGpu(
 }
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
+absl::Status CalculatorGraph::PrepareImageFrameMultiPool() {
+  if (service_manager_.GetServiceObject(kImageFrameMultiPoolService)) {
+    return absl::OkStatus();
+  }
+  for (const NodeTypeInfo& node_type_info :
+       validated_graph_->CalculatorInfos()) {
+    if (mediapipe::ContainsKey(node_type_info.Contract().ServiceRequests(),
+                               kImageFrameMultiPoolService.key)) {
+      return service_manager_.SetServiceObject(
+          kImageFrameMultiPoolService,
+          std::make_shared<ImageFrameMultiPool>());
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status CalculatorGraph::PrepareForRun(
     const std::map<std::string, Packet>& extra_side_packets,
     const std::map<std::string, Packet>& stream_headers) {
@@ -604,6 +659,7 @@ absl::Status CalculatorGraph::PrepareForRun(
 #if !MEDIAPIPE_DISABLE_GPU
   ASSIGN_OR_RETURN(additional_side_packets, PrepareGpu(extra_side_packets));
 #endif  // !MEDIAPIPE_DISABLE_GPU
+  MP_RETURN_IF_ERROR(PrepareImageFrameMultiPool());
 
   const std::map<std::string, Packet>* input_side_packets;
   if (!additional_side_packets.empty()) {
@@ -1104,7 +1160,7 @@ bool IsGraphOutputStream(
     const std::vector<std::shared_ptr<internal::GraphOutputStream>>&
         graph_output_streams) {
   for (auto& graph_output_stream : graph_output_streams) {
-    if (stream == graph_output_stream->input_stream()) {
+    if (graph_output_stream->HasInputStream(stream)) {
       return true;
     }
   }
@@ -1248,7 +1304,7 @@ void CalculatorGraph::CleanupAfterRun(absl::Status* status) {
   }
 
   for (auto& graph_output_stream : graph_output_streams_) {
-    graph_output_stream->input_stream()->Close();
+    graph_output_stream->CloseInputStreams();
   }
 
   scheduler_.CleanupAfterRun();
@@ -1295,6 +1351,18 @@ bool MetricElementComparator(const std::pair<std::string, int64>& e1,
 }
 }  // namespace
 
+absl::Status CalculatorGraph::GetGraphMetrics(GraphMetrics* metrics,
+                                              bool reset) {
+  RET_CHECK(initialized_)
+      << "CalculatorGraph::GetGraphMetrics() called before Initialize().";
+  profiler_->GetLatencyMetrics(metrics, reset);
+  for (int i = 0; i < input_stream_metric_names_.size(); ++i) {
+    metrics->queue_depth[input_stream_metric_names_[i]] =
+        input_stream_managers_[i].QueueSize();
+  }
+  return absl::OkStatus();
+}
+
 absl::Status CalculatorGraph::GetCalculatorProfiles(
     std::vector<CalculatorProfile>* profiles) const {
   return profiler_->GetCalculatorProfiles(profiles);
@@ -51,6 +51,7 @@
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/profiler/graph_metrics.h"
 #include "mediapipe/framework/scheduler.h"
 #include "mediapipe/framework/thread_pool_executor.pb.h"
 
@@ -64,6 +65,7 @@ struct GpuSharedData;
 namespace mediapipe {
 
 typedef absl::StatusOr<OutputStreamPoller> StatusOrPoller;
+typedef absl::StatusOr<MultiStreamPoller> StatusOrMultiStreamPoller;
 
 // The class representing a DAG of calculator nodes.
 //
@@ -165,6 +167,14 @@ class CalculatorGraph {
   // also the helpers in tool/sink.h.
   StatusOrPoller AddOutputStreamPoller(const std::string& stream_name);
 
+  // Adds a MultiStreamPoller for several streams. Streams are given as
+  // "TAG:index:name" strings (tag and index are optional) which define the
+  // layout of the PacketSets returned by MultiStreamPoller::Next(). A single
+  // wait covers all streams and the packets of one timestamp are returned
+  // together. Should only be called before Run() or StartRun().
+  StatusOrMultiStreamPoller AddMultiStreamPoller(
+      const std::vector<std::string>& stream_names);
+
   // Gets output side packet by name after the graph is done. However, base
   // packets (generated by PacketGenerators) can be retrieved before
   // graph is done. Returns error if the graph is still running (for non-base
@@ -290,6 +300,12 @@ class CalculatorGraph {
   ABSL_DEPRECATED("Use profiler()->GetCalculatorProfiles() instead")
   absl::Status GetCalculatorProfiles(std::vector<CalculatorProfile>*) const;
 
+  // Returns a snapshot of the live latency histograms and input queue depths.
+  // If |reset| is true, the latency histograms start a new interval.  May be
+  // called at any time after the graph has been initialized, and does not
+  // block the running graph.
+  absl::Status GetGraphMetrics(GraphMetrics* metrics, bool reset);
+
   // Set the type of counter used in this graph.
   void SetCounterFactory(CounterFactory* factory) {
     counter_factory_.reset(factory);
@@ -375,6 +391,12 @@ class CalculatorGraph {
   absl::StatusOr<std::map<std::string, Packet>> PrepareGpu(
       const std::map<std::string, Packet>& side_packets);
 #endif  // !MEDIAPIPE_DISABLE_GPU
+
+  // Helper for PrepareForRun. If a node uses the kImageFrameMultiPoolService
+  // and no pool has been set, provides a pool owned by the graph, which is
+  // kept across runs.
+  absl::Status PrepareImageFrameMultiPool();
+
   template <typename T>
   absl::Status SetServiceObject(const GraphService<T>& service,
                                 std::shared_ptr<T> object) {
@@ -554,6 +576,8 @@ class CalculatorGraph {
   // internal structures may point to individual entries in the array.
   std::unique_ptr<InputStreamManager[]> input_stream_managers_;
   std::unique_ptr<OutputStreamManager[]> output_stream_managers_;
+  // The GraphMetrics::queue_depth keys for input_stream_managers_.
+  std::vector<std::string> input_stream_metric_names_;
   std::unique_ptr<OutputSidePacketImpl[]> output_side_packets_;
   std::unique_ptr<absl::FixedArray<CalculatorNode>> nodes_;
 
@@ -3671,6 +3671,130 @@ TEST(CalculatorGraph, ObserveOutputStreamNonexistent) {
   EXPECT_THAT(status.message(), testing::HasSubstr("not_found"));
 }
 
+// Verifies that a MultiStreamPoller returns the packets of all polled streams
+// grouped by timestamp, with empty packets for streams that only advanced
+// their timestamp bound.
+TEST(CalculatorGraph, MultiStreamPoller) {
+  const int num_packets = 10;
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'select'
+        input_stream: 'value'
+        node {
+          calculator: 'DemuxTimedCalculator'
+          input_stream: 'SELECT:select'
+          input_stream: 'INPUT:value'
+          output_stream: 'OUTPUT:0:even'
+          output_stream: 'OUTPUT:1:odd'
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'value'
+          output_stream: 'all'
+        }
+      )pb");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  auto status_or_poller =
+      graph.AddMultiStreamPoller({"ALL:all", "EVEN:even", "ODD:odd"});
+  MP_ASSERT_OK(status_or_poller.status());
+  MultiStreamPoller poller = std::move(status_or_poller.value());
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < num_packets; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "select", MakePacket<int>(i % 2).At(Timestamp(i))));
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "value", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+
+  PacketSet packets(poller.TagMap());
+  for (int i = 0; i < num_packets; ++i) {
+    ASSERT_TRUE(poller.Next(&packets));
+    const Packet& all = packets.Tag("ALL");
+    ASSERT_FALSE(all.IsEmpty());
+    EXPECT_EQ(i, all.Get<int>());
+    EXPECT_EQ(Timestamp(i), all.Timestamp());
+    const Packet& selected = packets.Tag(i % 2 == 0 ? "EVEN" : "ODD");
+    ASSERT_FALSE(selected.IsEmpty());
+    EXPECT_EQ(i, selected.Get<int>());
+    EXPECT_EQ(Timestamp(i), selected.Timestamp());
+    EXPECT_TRUE(packets.Tag(i % 2 == 0 ? "ODD" : "EVEN").IsEmpty());
+  }
+  EXPECT_FALSE(poller.Next(&packets));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+TEST(CalculatorGraph, MultiStreamPollerNonexistent) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'in'
+          output_stream: 'out'
+        }
+      )pb");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  absl::Status status =
+      graph.AddMultiStreamPoller({"out", "not_found"}).status();
+  EXPECT_EQ(status.code(), absl::StatusCode::kNotFound);
+  EXPECT_THAT(status.message(), testing::HasSubstr("not_found"));
+}
+
+// Verify that GetGraphMetrics reports queue depths and Process latencies.
+TEST(CalculatorGraph, GetGraphMetrics) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'in'
+          output_stream: 'mid'
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'mid'
+          output_stream: 'out'
+        }
+        profiler_config {
+          enable_profiler: true
+          enable_stream_latency: true
+        }
+      )pb");
+  CalculatorGraph graph;
+  GraphMetrics metrics;
+  EXPECT_FALSE(graph.GetGraphMetrics(&metrics, false).ok());
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 5; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+
+  MP_ASSERT_OK(graph.GetGraphMetrics(&metrics, /*reset=*/true));
+  EXPECT_EQ(0, metrics.queue_depth["PassThroughCalculator_1:in"]);
+  EXPECT_EQ(0, metrics.queue_depth["PassThroughCalculator_2:mid"]);
+#ifdef MEDIAPIPE_PROFILER_AVAILABLE
+  EXPECT_EQ(5, metrics.process_latency["PassThroughCalculator_1"].count);
+  EXPECT_EQ(5, metrics.process_latency["PassThroughCalculator_2"].count);
+  EXPECT_EQ(5, metrics.source_latency["PassThroughCalculator_2"].count);
+  EXPECT_EQ(
+      5,
+      metrics.input_stream_latency["PassThroughCalculator_2:mid"].count);
+#endif  // MEDIAPIPE_PROFILER_AVAILABLE
+
+  // The latency histograms were reset by the previous snapshot.
+  GraphMetrics next_metrics;
+  MP_ASSERT_OK(graph.GetGraphMetrics(&next_metrics, /*reset=*/false));
+  EXPECT_EQ(0, next_metrics.process_latency["PassThroughCalculator_1"].count);
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 // Verify that after a fast source node is closed, a slow sink node can
 // consume all the accumulated input packets. In other words, closing an
 // output stream still allows its mirrors to process all the received packets.
@@ -0,0 +1,107 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+
+namespace mediapipe {
+
+// The maximum number of pools. When the limit is reached, the least recently
+// used pool is dropped; its frames still in use stay valid.
+static constexpr int kMaxPoolCount = 20;
+
+const GraphService<ImageFrameMultiPool> kImageFrameMultiPoolService(
+    "kImageFrameMultiPoolService");
+
+std::unique_ptr<ImageFrame> ImageFrameMultiPool::GetFrame(
+    ImageFormat::Format format, int width, int height,
+    uint32 alignment_boundary) {
+  const BufferSpec key(format, width, height, alignment_boundary);
+  std::shared_ptr<Entry> entry;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto entry_it = entries_.find(key);
+    if (entry_it == entries_.end()) {
+      // Discard the least recently used pool.
+      if (entries_.size() >= static_cast<size_t>(kMaxPoolCount)) {
+        entries_.erase(buffer_specs_.front());
+        buffer_specs_.pop_front();
+      }
+      entry = std::make_shared<Entry>();
+      entry->pool = ImageFramePool::Create(width, height, format, keep_count_,
+                                           alignment_boundary);
+      {
+        absl::MutexLock entry_lock(&entry->mutex);
+        entry->stats.format = format;
+        entry->stats.width = width;
+        entry->stats.height = height;
+        entry->stats.alignment_boundary = alignment_boundary;
+      }
+      entries_.emplace(key, entry);
+    } else {
+      entry = entry_it->second;
+      buffer_specs_.erase(
+          std::find(buffer_specs_.begin(), buffer_specs_.end(), key));
+    }
+    buffer_specs_.push_back(key);
+  }
+
+  ImageFrameSharedPtr buffer = entry->pool->GetBuffer();
+  {
+    absl::MutexLock lock(&entry->mutex);
+    PoolStats& stats = entry->stats;
+    stats.frame_bytes = buffer->PixelDataSize();
+    ++stats.request_count;
+    ++stats.in_use_count;
+    stats.max_in_use_count =
+        std::max(stats.max_in_use_count, stats.in_use_count);
+  }
+
+  // The buffer returns to its pool when the frame adopting its pixels is
+  // destroyed.
+  uint8* pixel_data = buffer->MutablePixelData();
+  const int width_step = buffer->WidthStep();
+  return absl::make_unique<ImageFrame>(
+      format, width, height, width_step, pixel_data,
+      [buffer, entry](uint8*) mutable {
+        buffer.reset();
+        absl::MutexLock lock(&entry->mutex);
+        --entry->stats.in_use_count;
+      });
+}
+
+std::vector<ImageFrameMultiPool::PoolStats> ImageFrameMultiPool::GetStats() {
+  absl::MutexLock lock(&mutex_);
+  std::vector<PoolStats> stats;
+  stats.reserve(buffer_specs_.size());
+  for (const BufferSpec& key : buffer_specs_) {
+    Entry& entry = *entries_[key];
+    absl::MutexLock entry_lock(&entry.mutex);
+    stats.push_back(entry.stats);
+  }
+  return stats;
+}
+
+int64 ImageFrameMultiPool::GetMaxInUseBytes() {
+  int64 bytes = 0;
+  for (const PoolStats& stats : GetStats()) {
+    bytes += stats.max_in_use_count * stats.frame_bytes;
+  }
+  return bytes;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,122 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This class lets CPU calculators allocate output ImageFrames of various
+// formats and sizes, caching and reusing their pixel buffers. It does so by
+// automatically creating an ImageFramePool for each requested format, size
+// and alignment.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_MULTI_POOL_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_MULTI_POOL_H_
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
+#include "mediapipe/framework/graph_service.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// Shares pooled ImageFrame pixel buffers between the calculators of a graph.
+// A frame obtained from the pool owns its pixels as usual, but returns them to
+// the pool when it is destroyed, e.g. when the last packet holding it is
+// released. Thread-safe.
+//
+// CPU image calculators allocate their output frames through the pool of the
+// kImageFrameMultiPoolService (see GetImageFrameMultiPool()). CalculatorGraph
+// provides a pool of its own to the graphs using the service, unless one is
+// set beforehand. The buffers are released with the graph.
+//
+// Example (limiting the reused buffers of one graph):
+//   auto pool = std::make_shared<ImageFrameMultiPool>(/*keep_count=*/2);
+//   MP_RETURN_IF_ERROR(
+//       graph.SetServiceObject(kImageFrameMultiPoolService, pool));
+class ImageFrameMultiPool {
+ public:
+  // Usage of the buffers of one format, size and alignment.
+  struct PoolStats {
+    ImageFormat::Format format = ImageFormat::UNKNOWN;
+    int width = 0;
+    int height = 0;
+    uint32 alignment_boundary = 0;
+    // Size of the pixel buffer of one frame.
+    int64 frame_bytes = 0;
+    // The number of frames requested.
+    int64 request_count = 0;
+    // The number of frames currently alive.
+    int in_use_count = 0;
+    // The high-water mark of in_use_count.
+    int max_in_use_count = 0;
+  };
+
+  // Keeps up to keep_count buffers allocated for each format, size and
+  // alignment.
+  explicit ImageFrameMultiPool(int keep_count = kDefaultKeepCount)
+      : keep_count_(keep_count) {}
+
+  // Returns a frame whose pixels may either be reused or allocated anew. The
+  // pixel values are undefined.
+  std::unique_ptr<ImageFrame> GetFrame(
+      ImageFormat::Format format, int width, int height,
+      uint32 alignment_boundary = ImageFrame::kDefaultAlignmentBoundary);
+
+  // Returns the statistics of the pools used recently.
+  std::vector<PoolStats> GetStats();
+
+  // Returns the sum over the recently used pools of their high-water mark of
+  // frames in use, in bytes.
+  int64 GetMaxInUseBytes();
+
+ private:
+  static constexpr int kDefaultKeepCount = 4;
+
+  // The buffers of one format, size and alignment.
+  struct Entry {
+    std::shared_ptr<ImageFramePool> pool;
+    absl::Mutex mutex;
+    PoolStats stats ABSL_GUARDED_BY(mutex);
+  };
+
+  // Format, width, height and alignment boundary.
+  using BufferSpec = std::tuple<ImageFormat::Format, int, int, uint32>;
+
+  const int keep_count_;
+
+  absl::Mutex mutex_;
+  std::map<BufferSpec, std::shared_ptr<Entry>> entries_ ABSL_GUARDED_BY(mutex_);
+  // The specs in entries_, from the least to the most recently used.
+  std::deque<BufferSpec> buffer_specs_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Graph service selecting the ImageFrameMultiPool of a graph.
+extern const GraphService<ImageFrameMultiPool> kImageFrameMultiPoolService;
+
+// Returns the pool of the kImageFrameMultiPoolService. Calculators calling
+// this must declare cc->UseService(kImageFrameMultiPoolService) in their
+// contract.
+template <typename CalculatorContextT>
+ImageFrameMultiPool& GetImageFrameMultiPool(CalculatorContextT* cc) {
+  return cc->Service(kImageFrameMultiPoolService).GetObject();
+}
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_MULTI_POOL_H_
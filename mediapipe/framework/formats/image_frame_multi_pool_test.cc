@@ -0,0 +1,98 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kWidth = 300;
+constexpr int kHeight = 200;
+constexpr int kKeepCount = 2;
+
+TEST(ImageFrameMultiPoolTest, ReusesPixels) {
+  ImageFrameMultiPool pool(kKeepCount);
+  auto frame = pool.GetFrame(ImageFormat::SRGB, kWidth, kHeight);
+  EXPECT_EQ(frame->Width(), kWidth);
+  EXPECT_EQ(frame->Height(), kHeight);
+  EXPECT_EQ(frame->Format(), ImageFormat::SRGB);
+  const uint8* pixels = frame->PixelData();
+  frame = nullptr;
+  frame = pool.GetFrame(ImageFormat::SRGB, kWidth, kHeight);
+  EXPECT_EQ(frame->PixelData(), pixels);
+}
+
+TEST(ImageFrameMultiPoolTest, KeepsAlignment) {
+  ImageFrameMultiPool pool(kKeepCount);
+  auto frame = pool.GetFrame(ImageFormat::SRGB, 301, kHeight);
+  EXPECT_EQ(frame->WidthStep() % ImageFrame::kDefaultAlignmentBoundary, 0);
+  auto gl_frame = pool.GetFrame(ImageFormat::SRGB, 301, kHeight,
+                                ImageFrame::kGlDefaultAlignmentBoundary);
+  EXPECT_EQ(gl_frame->WidthStep(), 904);
+  EXPECT_EQ(pool.GetStats().size(), 2);
+}
+
+TEST(ImageFrameMultiPoolTest, SeparatesSpecs) {
+  ImageFrameMultiPool pool(kKeepCount);
+  auto rgb_frame = pool.GetFrame(ImageFormat::SRGB, kWidth, kHeight);
+  const uint8* rgb_pixels = rgb_frame->PixelData();
+  rgb_frame = nullptr;
+  auto gray_frame = pool.GetFrame(ImageFormat::GRAY8, kWidth, kHeight);
+  EXPECT_NE(gray_frame->PixelData(), rgb_pixels);
+  auto small_frame = pool.GetFrame(ImageFormat::SRGB, kWidth / 2, kHeight);
+  EXPECT_NE(small_frame->PixelData(), rgb_pixels);
+
+  const auto stats = pool.GetStats();
+  ASSERT_EQ(stats.size(), 3);
+  // From the least to the most recently used.
+  EXPECT_EQ(stats[0].format, ImageFormat::SRGB);
+  EXPECT_EQ(stats[0].width, kWidth);
+  EXPECT_EQ(stats[1].format, ImageFormat::GRAY8);
+  EXPECT_EQ(stats[2].width, kWidth / 2);
+}
+
+TEST(ImageFrameMultiPoolTest, TracksHighWaterMark) {
+  ImageFrameMultiPool pool(kKeepCount);
+  std::vector<std::unique_ptr<ImageFrame>> frames;
+  for (int i = 0; i < 3; ++i) {
+    frames.push_back(pool.GetFrame(ImageFormat::GRAY8, kWidth, kHeight));
+  }
+  frames.pop_back();
+  frames.push_back(pool.GetFrame(ImageFormat::GRAY8, kWidth, kHeight));
+  frames.pop_back();
+
+  const auto stats = pool.GetStats();
+  ASSERT_EQ(stats.size(), 1);
+  EXPECT_EQ(stats[0].request_count, 4);
+  EXPECT_EQ(stats[0].in_use_count, 2);
+  EXPECT_EQ(stats[0].max_in_use_count, 3);
+  EXPECT_EQ(stats[0].frame_bytes, frames[0]->PixelDataSize());
+  EXPECT_EQ(pool.GetMaxInUseBytes(), 3 * frames[0]->PixelDataSize());
+
+  frames.clear();
+  EXPECT_EQ(pool.GetStats()[0].in_use_count, 0);
+}
+
+TEST(ImageFrameMultiPoolTest, FrameCanOutlivePool) {
+  auto pool = std::make_shared<ImageFrameMultiPool>(kKeepCount);
+  auto frame = pool->GetFrame(ImageFormat::SRGBA, kWidth, kHeight);
+  pool = nullptr;
+  frame->SetToZero();
+  frame = nullptr;
+}
+
+}  // namespace
+}  // namespace mediapipe
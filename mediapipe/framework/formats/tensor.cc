@@ -26,6 +26,9 @@
 #include <mach/vm_map.h>
 #else
 #include <cstdlib>
+#if defined(_WIN32)
+#include <malloc.h>
+#endif  // _WIN32
 #endif  // MEDIAPIPE_METAL_ENABLED
 
 namespace mediapipe {
@@ -59,6 +62,32 @@ int BhwcDepthFromShape(const Tensor::Shape& shape) {
 // 2) Allocate cpu_buffer_ with padded amount of memory
 // 3) pad/"unpad" the bitmap after transfer CPU <-> GPU
 
+#if !MEDIAPIPE_METAL_ENABLED
+namespace {
+// Allocates |size| bytes aligned to Tensor::kCpuBufferAlignment.
+void* AllocateAlignedMemory(size_t size) {
+#if defined(_WIN32)
+  void* pointer = _aligned_malloc(size, Tensor::kCpuBufferAlignment);
+#else
+  void* pointer = nullptr;
+  if (posix_memalign(&pointer, Tensor::kCpuBufferAlignment, size) != 0) {
+    pointer = nullptr;
+  }
+#endif  // _WIN32
+  LOG_IF(FATAL, !pointer && size > 0) << "Can't allocate memory for Tensor.";
+  return pointer;
+}
+
+void DeallocateAlignedMemory(void* pointer) {
+#if defined(_WIN32)
+  _aligned_free(pointer);
+#else
+  free(pointer);
+#endif  // _WIN32
+}
+}  // namespace
+#endif  // !MEDIAPIPE_METAL_ENABLED
+
 #if MEDIAPIPE_METAL_ENABLED
 namespace {
 // MTLBuffer can use existing properly aligned and allocated CPU memory.
@@ -306,6 +335,7 @@ void Tensor::Move(Tensor* src) {
   valid_ = src->valid_;
   src->valid_ = kValidNone;
   shape_ = src->shape();
+  quantization_parameters_ = src->quantization_parameters();
   element_type_ = src->element_type();
   src->element_type_ = ElementType::kNone;  // Mark as invalidated.
   cpu_buffer_ = src->cpu_buffer_;
@@ -335,6 +365,12 @@ void Tensor::Move(Tensor* src) {
 Tensor::Tensor(ElementType element_type, const Shape& shape)
     : element_type_(element_type), shape_(shape) {}
 
+Tensor::Tensor(ElementType element_type, const Shape& shape,
+               const QuantizationParameters& quantization_parameters)
+    : element_type_(element_type),
+      shape_(shape),
+      quantization_parameters_(quantization_parameters) {}
+
 void Tensor::Invalidate() {
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
   GLuint cleanup_gl_tex = GL_INVALID_INDEX;
@@ -352,7 +388,7 @@ void Tensor::Invalidate() {
     metal_buffer_ = nil;
 #else
     if (cpu_buffer_) {
-      free(cpu_buffer_);
+      DeallocateAlignedMemory(cpu_buffer_);
     }
 #endif  // MEDIAPIPE_METAL_ENABLED
     cpu_buffer_ = nullptr;
@@ -468,7 +504,7 @@ void Tensor::AllocateCpuBuffer() const {
 #if MEDIAPIPE_METAL_ENABLED
     cpu_buffer_ = AllocateVirtualMemory(bytes());
 #else
-    cpu_buffer_ = malloc(bytes());
+    cpu_buffer_ = AllocateAlignedMemory(bytes());
 #endif  // MEDIAPIPE_METAL_ENABLED
   }
 }
@@ -76,7 +76,16 @@ class Tensor {
 
  public:
   // No resources are allocated here.
-  enum class ElementType { kNone, kFloat16, kFloat32 };
+  enum class ElementType { kNone, kFloat16, kFloat32, kUInt8, kInt8 };
+  // Affine quantization of kUInt8 and kInt8 tensors, as in TfLite:
+  // real_value = scale * (quantized_value - zero_point).
+  struct QuantizationParameters {
+    QuantizationParameters() = default;
+    QuantizationParameters(float scale, int zero_point)
+        : scale(scale), zero_point(zero_point) {}
+    float scale = 1.0f;
+    int zero_point = 0;
+  };
   struct Shape {
     Shape() = default;
     Shape(std::initializer_list<int> dimensions) : dims(dimensions) {}
@@ -89,7 +98,13 @@ class Tensor {
     std::vector<int> dims;
   };
 
+  // Alignment of CPU buffers, which allows them to be used directly as
+  // TfLite tensor buffers (page size with Metal).
+  static constexpr int kCpuBufferAlignment = 64;
+
   Tensor(ElementType element_type, const Shape& shape);
+  Tensor(ElementType element_type, const Shape& shape,
+         const QuantizationParameters& quantization_parameters);
 
   // Non-copyable.
   Tensor(const Tensor&) = delete;
@@ -215,8 +230,17 @@ class Tensor {
         return 2;
       case ElementType::kFloat32:
         return sizeof(float);
+      case ElementType::kUInt8:
+        return 1;
+      case ElementType::kInt8:
+        return 1;
     }
   }
+  // The quantization of kUInt8 and kInt8 tensors; scale 1 and zero point 0
+  // otherwise.
+  const QuantizationParameters& quantization_parameters() const {
+    return quantization_parameters_;
+  }
   int bytes() const { return shape_.num_elements() * element_size(); }
 
   bool ready_on_cpu() const { return valid_ & kValidCpu; }
@@ -236,6 +260,7 @@ class Tensor {
 
   ElementType element_type_;
   Shape shape_;
+  QuantizationParameters quantization_parameters_;
 
   // The flags describe the current source of truth resource type.
   enum {
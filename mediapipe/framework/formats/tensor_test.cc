@@ -1,5 +1,7 @@
 #include "mediapipe/framework/formats/tensor.h"
 
+#include <cstdint>
+
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #if !MEDIAPIPE_DISABLE_GPU
@@ -23,6 +25,25 @@ TEST(General, TestDataTypes) {
 
   Tensor t2(Tensor::ElementType::kFloat16, Tensor::Shape{4, 3, 2, 3});
   EXPECT_EQ(t2.bytes(), t2.shape().num_elements() * 2);
+
+  Tensor t3(Tensor::ElementType::kUInt8, Tensor::Shape{4, 3, 2, 3});
+  EXPECT_EQ(t3.bytes(), t3.shape().num_elements());
+
+  Tensor t4(Tensor::ElementType::kInt8, Tensor::Shape{4, 3, 2, 3});
+  EXPECT_EQ(t4.bytes(), t4.shape().num_elements());
+}
+
+TEST(General, TestQuantizationParameters) {
+  Tensor t1(Tensor::ElementType::kFloat32, Tensor::Shape{1, 2});
+  EXPECT_EQ(t1.quantization_parameters().scale, 1.0f);
+  EXPECT_EQ(t1.quantization_parameters().zero_point, 0);
+
+  Tensor t2(Tensor::ElementType::kInt8, Tensor::Shape{1, 2},
+            Tensor::QuantizationParameters(0.5f, -3));
+  Tensor t3(std::move(t2));
+  EXPECT_EQ(t3.element_type(), Tensor::ElementType::kInt8);
+  EXPECT_EQ(t3.quantization_parameters().scale, 0.5f);
+  EXPECT_EQ(t3.quantization_parameters().zero_point, -3);
 }
 
 TEST(Cpu, TestMemoryAllocation) {
@@ -32,6 +53,14 @@ TEST(Cpu, TestMemoryAllocation) {
   EXPECT_NE(f1, nullptr);
 }
 
+TEST(Cpu, TestMemoryAlignment) {
+  Tensor t1(Tensor::ElementType::kFloat32, Tensor::Shape{1, 3});
+  auto v1 = t1.GetCpuWriteView();
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(v1.buffer<float>()) %
+                Tensor::kCpuBufferAlignment,
+            0);
+}
+
 TEST(Cpu, TestTensorMove) {
   Tensor t1(Tensor::ElementType::kFloat32, Tensor::Shape{4, 3, 2, 3});
   void* p1 = t1.GetCpuWriteView().buffer<float>();
@@ -14,6 +14,8 @@
 
 #include "mediapipe/framework/graph_output_stream.h"
 
+#include <algorithm>
+
 namespace mediapipe {
 
 namespace internal {
@@ -162,5 +164,145 @@ bool OutputStreamPollerImpl::Next(Packet* packet) {
   return true;
 }
 
+absl::Status MultiOutputStreamPollerImpl::Initialize(
+    std::shared_ptr<tool::TagMap> tag_map, const PacketType* packet_type,
+    std::function<void(InputStreamManager*, bool*)> queue_size_callback,
+    const std::vector<OutputStreamManager*>& output_stream_managers) {
+  RET_CHECK(tag_map);
+  RET_CHECK_EQ(tag_map->NumEntries(), output_stream_managers.size());
+  RET_CHECK_GT(tag_map->NumEntries(), 0)
+      << "At least one output stream must be polled.";
+
+  // Initializes input_stream_handler_ with one mirror input stream per
+  // polled output stream.
+  input_stream_handler_ = absl::make_unique<GraphOutputStreamHandler>(
+      tag_map, /*cc_manager=*/nullptr, MediaPipeOptions(),
+      /*calculator_run_in_parallel=*/false);
+  num_input_streams_ = tag_map->NumEntries();
+  input_streams_ = absl::make_unique<InputStreamManager[]>(num_input_streams_);
+  for (CollectionItemId id = tag_map->BeginId(); id < tag_map->EndId(); ++id) {
+    MP_RETURN_IF_ERROR(input_streams_[id.value()].Initialize(
+        tag_map->Names()[id.value()], packet_type, /*back_edge=*/false));
+  }
+  MP_RETURN_IF_ERROR(
+      input_stream_handler_->InitializeInputStreamManagers(input_streams_.get()));
+  for (CollectionItemId id = tag_map->BeginId(); id < tag_map->EndId(); ++id) {
+    OutputStreamManager* output_stream_manager =
+        output_stream_managers[id.value()];
+    RET_CHECK(output_stream_manager);
+    output_stream_manager->AddMirror(input_stream_handler_.get(), id);
+  }
+  input_stream_handler_->SetQueueSizeCallbacks(queue_size_callback,
+                                               queue_size_callback);
+  return absl::OkStatus();
+}
+
+void MultiOutputStreamPollerImpl::PrepareForRun(
+    std::function<void()> notification_callback,
+    std::function<void(absl::Status)> error_callback) {
+  input_stream_handler_->PrepareForRun(
+      /*headers_ready_callback=*/[] {}, std::move(notification_callback),
+      /*schedule_callback=*/nullptr, std::move(error_callback));
+  mutex_.Lock();
+  graph_has_error_ = false;
+  mutex_.Unlock();
+}
+
+void MultiOutputStreamPollerImpl::Reset() {
+  mutex_.Lock();
+  graph_has_error_ = false;
+  for (int i = 0; i < num_input_streams_; ++i) {
+    input_streams_[i].PrepareForRun();
+  }
+  mutex_.Unlock();
+}
+
+void MultiOutputStreamPollerImpl::SetMaxQueueSize(int queue_size) {
+  CHECK(queue_size >= -1)
+      << "Max queue size must be either -1 or non-negative.";
+  input_stream_handler_->SetMaxQueueSize(queue_size);
+}
+
+int MultiOutputStreamPollerImpl::QueueSize(CollectionItemId id) {
+  CHECK(id.IsValid() && id.value() < num_input_streams_);
+  return input_streams_[id.value()].QueueSize();
+}
+
+absl::Status MultiOutputStreamPollerImpl::Notify() {
+  mutex_.Lock();
+  handler_condvar_.Signal();
+  mutex_.Unlock();
+  return absl::OkStatus();
+}
+
+void MultiOutputStreamPollerImpl::NotifyError() {
+  mutex_.Lock();
+  graph_has_error_ = true;
+  handler_condvar_.Signal();
+  mutex_.Unlock();
+}
+
+bool MultiOutputStreamPollerImpl::HasInputStream(
+    const InputStreamManager* stream) const {
+  return stream >= &input_streams_[0] &&
+         stream < &input_streams_[0] + num_input_streams_;
+}
+
+void MultiOutputStreamPollerImpl::CloseInputStreams() {
+  for (int i = 0; i < num_input_streams_; ++i) {
+    input_streams_[i].Close();
+  }
+}
+
+Timestamp MultiOutputStreamPollerImpl::SettledTimestamp(bool* all_done) {
+  // The earliest packet is settled once every empty stream has a timestamp
+  // bound beyond it, which mirrors the DefaultInputStreamHandler readiness.
+  Timestamp min_packet = Timestamp::Done();
+  Timestamp min_bound = Timestamp::Done();
+  for (int i = 0; i < num_input_streams_; ++i) {
+    bool empty;
+    Timestamp stream_timestamp = input_streams_[i].MinTimestampOrBound(&empty);
+    if (empty) {
+      min_bound = std::min(min_bound, stream_timestamp);
+    } else {
+      min_packet = std::min(min_packet, stream_timestamp);
+    }
+  }
+  *all_done = min_packet == Timestamp::Done() && min_bound == Timestamp::Done();
+  return min_packet < min_bound ? min_packet : Timestamp::Unset();
+}
+
+bool MultiOutputStreamPollerImpl::Next(PacketSet* packets) {
+  CHECK(packets);
+  CHECK_EQ(packets->NumEntries(), num_input_streams_);
+  bool all_done = false;
+  Timestamp input_timestamp = Timestamp::Unset();
+  mutex_.Lock();
+  while (true) {
+    input_timestamp = SettledTimestamp(&all_done);
+    if (graph_has_error_ || all_done || input_timestamp != Timestamp::Unset()) {
+      break;
+    }
+    handler_condvar_.Wait(&mutex_);
+  }
+  mutex_.Unlock();
+  if (input_timestamp == Timestamp::Unset()) {
+    return false;
+  }
+  // Packets are popped outside of mutex_, as in OutputStreamPollerImpl::Next,
+  // because popping may unthrottle nodes which in turn notify this poller.
+  for (CollectionItemId id = packets->BeginId(); id < packets->EndId(); ++id) {
+    int num_packets_dropped = 0;
+    bool stream_is_done = false;
+    InputStreamManager& stream = input_streams_[id.value()];
+    packets->Get(id) = stream.PopPacketAtTimestamp(
+        input_timestamp, &num_packets_dropped, &stream_is_done);
+    CHECK_EQ(num_packets_dropped, 0)
+        << absl::Substitute("Dropped $0 packet(s) on input stream \"$1\".",
+                            num_packets_dropped, stream.Name());
+  }
+  return true;
+}
+
 }  // namespace internal
 }  // namespace mediapipe
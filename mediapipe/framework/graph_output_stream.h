@@ -34,6 +34,7 @@
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/timestamp.h"
+#include "mediapipe/framework/tool/tag_map.h"
 
 namespace mediapipe {
 
@@ -67,6 +68,15 @@ class GraphOutputStream {
 
   InputStreamManager* input_stream() { return input_stream_.get(); }
 
+  // Returns true if `stream` is one of the mirror input streams owned by this
+  // graph output stream.
+  virtual bool HasInputStream(const InputStreamManager* stream) const {
+    return stream == input_stream_.get();
+  }
+
+  // Closes the mirror input stream(s) at the end of a graph run.
+  virtual void CloseInputStreams() { input_stream_->Close(); }
+
  protected:
   // A simple input stream handler that manages one input stream. The input
   // stream is only for observation/polling purpose and should never be used
@@ -165,6 +175,66 @@ class OutputStreamPollerImpl : public GraphOutputStream {
   bool graph_has_error_ ABSL_GUARDED_BY(mutex_);
 };
 
+// MultiOutputStreamPollerImpl polls several output streams through a single
+// input stream handler, so that one notification and one condition variable
+// cover all of them. Next() returns the packets of every stream at the
+// earliest settled timestamp.
+class MultiOutputStreamPollerImpl : public GraphOutputStream {
+ public:
+  virtual ~MultiOutputStreamPollerImpl() {}
+
+  // Initializes a MultiOutputStreamPollerImpl. output_stream_managers must
+  // contain one OutputStreamManager per entry of tag_map, in id order.
+  absl::Status Initialize(
+      std::shared_ptr<tool::TagMap> tag_map, const PacketType* packet_type,
+      std::function<void(InputStreamManager*, bool*)> queue_size_callback,
+      const std::vector<OutputStreamManager*>& output_stream_managers);
+
+  void PrepareForRun(std::function<void()> notification_callback,
+                     std::function<void(absl::Status)> error_callback) override;
+
+  // Resets graph_has_error_ and cleans the internal packet queues.
+  void Reset();
+
+  void SetMaxQueueSize(int queue_size);
+
+  // Returns the number of packets queued on the stream with the given id.
+  int QueueSize(CollectionItemId id);
+
+  // Notifies the poller of new packets or timestamp bounds emitted by any of
+  // the polled output streams.
+  absl::Status Notify() override;
+
+  // Notifies the poller of the errors in the calculator graph.
+  void NotifyError() override;
+
+  bool HasInputStream(const InputStreamManager* stream) const override;
+
+  void CloseInputStreams() override;
+
+  // Blocks until some stream has a packet at a timestamp that is settled on
+  // all streams (i.e. no stream can still receive a packet at or before it),
+  // then moves the packets of all streams at that timestamp into packets.
+  // Streams without a packet at that timestamp receive an empty Packet.
+  // packets must have been constructed with the poller's tag map. Returns
+  // false once all streams are done or the graph has an error.
+  ABSL_MUST_USE_RESULT bool Next(PacketSet* packets);
+
+ private:
+  // Returns the earliest timestamp at which packets can be popped, or
+  // Timestamp::Unset() if no timestamp is settled yet. Sets *all_done to true
+  // if every stream is done and empty.
+  Timestamp SettledTimestamp(bool* all_done)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  int num_input_streams_ = 0;
+  std::unique_ptr<InputStreamManager[]> input_streams_;
+
+  absl::Mutex mutex_;
+  absl::CondVar handler_condvar_ ABSL_GUARDED_BY(mutex_);
+  bool graph_has_error_ ABSL_GUARDED_BY(mutex_);
+};
+
 }  // namespace internal
 }  // namespace mediapipe
 #endif  // MEDIAPIPE_FRAMEWORK_GRAPH_OUTPUT_STREAM_H_
@@ -16,6 +16,8 @@
 
 #include "mediapipe/framework/calculator_contract.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -150,5 +152,68 @@ TEST_F(GraphServiceTest, OptionalIsAvailable) {
   EXPECT_EQ(PacketValues<int>(output_packets_), (std::vector<int>{108}));
 }
 
+// Outputs a 4x4 frame from the ImageFrameMultiPool of the graph for every
+// input packet.
+class PooledFrameCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).Set<ImageFrame>();
+    cc->UseService(kImageFrameMultiPoolService);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    cc->Outputs().Index(0).Add(
+        GetImageFrameMultiPool(cc).GetFrame(ImageFormat::SRGB, 4, 4).release(),
+        cc->InputTimestamp());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(PooledFrameCalculator);
+
+// Runs a graph allocating one pooled frame and returns its pool.
+std::shared_ptr<ImageFrameMultiPool> RunPooledFrameGraph(
+    CalculatorGraph* graph) {
+  MP_EXPECT_OK(graph->Initialize(
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "in"
+        node {
+          calculator: "PooledFrameCalculator"
+          input_stream: "in"
+          output_stream: "out"
+        }
+      )pb")));
+  MP_EXPECT_OK(graph->StartRun({}));
+  MP_EXPECT_OK(
+      graph->AddPacketToInputStream("in", MakePacket<int>(0).At(Timestamp(0))));
+  MP_EXPECT_OK(graph->CloseAllInputStreams());
+  MP_EXPECT_OK(graph->WaitUntilDone());
+  return graph->GetServiceObject(kImageFrameMultiPoolService);
+}
+
+TEST(ImageFrameMultiPoolServiceTest, ProvidedByGraph) {
+  CalculatorGraph graph_1;
+  CalculatorGraph graph_2;
+  std::shared_ptr<ImageFrameMultiPool> pool_1 = RunPooledFrameGraph(&graph_1);
+  std::shared_ptr<ImageFrameMultiPool> pool_2 = RunPooledFrameGraph(&graph_2);
+  ASSERT_NE(pool_1, nullptr);
+  ASSERT_NE(pool_2, nullptr);
+  // Each graph has its own pool.
+  EXPECT_NE(pool_1, pool_2);
+  const auto stats = pool_1->GetStats();
+  ASSERT_EQ(1, stats.size());
+  EXPECT_EQ(1, stats[0].request_count);
+  EXPECT_EQ(0, stats[0].in_use_count);
+}
+
+TEST(ImageFrameMultiPoolServiceTest, SetOnGraph) {
+  auto pool = std::make_shared<ImageFrameMultiPool>(/*keep_count=*/1);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.SetServiceObject(kImageFrameMultiPoolService, pool));
+  EXPECT_EQ(pool, RunPooledFrameGraph(&graph));
+  EXPECT_EQ(1, pool->GetStats().size());
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -16,8 +16,12 @@
 #define MEDIAPIPE_FRAMEWORK_OUTPUT_STREAM_POLLER_H_
 
 #include <memory>
+#include <string>
 
+#include "mediapipe/framework/collection_item_id.h"
 #include "mediapipe/framework/graph_output_stream.h"
+#include "mediapipe/framework/packet_set.h"
+#include "mediapipe/framework/tool/tag_map.h"
 
 namespace mediapipe {
 
@@ -73,6 +77,81 @@ class OutputStreamPoller {
   friend class CalculatorGraph;
 };
 
+// The public interface of a poller that waits on several output streams at
+// once and returns their packets grouped by timestamp.
+//
+// Example:
+//   ASSIGN_OR_RETURN(MultiStreamPoller poller,
+//                    graph.AddMultiStreamPoller(
+//                        {"VIDEO:output_video", "LANDMARKS:landmarks"}));
+//   MP_RETURN_IF_ERROR(graph.StartRun({}));
+//   PacketSet packets(poller.TagMap());
+//   while (poller.Next(&packets)) {
+//     const Packet& landmarks = packets.Tag("LANDMARKS");
+//     if (!landmarks.IsEmpty()) { ... }
+//   }
+class MultiStreamPoller {
+ public:
+  MultiStreamPoller(const MultiStreamPoller&) = delete;
+  MultiStreamPoller& operator=(const MultiStreamPoller&) = delete;
+  MultiStreamPoller(MultiStreamPoller&&) = default;
+  // Move assignment needs to be explicitly defaulted to allow ASSIGN_OR_RETURN
+  // on `StatusOr<MultiStreamPoller>`.
+  MultiStreamPoller& operator=(MultiStreamPoller&&) = default;
+
+  // Returns the tag map of the polled streams. PacketSets passed to Next()
+  // must be constructed from it.
+  const std::shared_ptr<tool::TagMap>& TagMap() const { return tag_map_; }
+
+  // Resets MultiOutputStreamPollerImpl and cleans the internal packet queues.
+  void Reset() {
+    auto poller = internal_poller_impl_.lock();
+    CHECK(poller) << "MultiOutputStreamPollerImpl is already destroyed.";
+    poller->Reset();
+  }
+
+  // Gets the packets of all polled streams at the next settled timestamp
+  // (block until one is available or all streams are done). Streams without
+  // a packet at that timestamp are set to an empty Packet. Returns true if
+  // successful.
+  ABSL_MUST_USE_RESULT bool Next(PacketSet* packets) {
+    auto poller = internal_poller_impl_.lock();
+    if (!poller) {
+      return false;
+    }
+    return poller->Next(packets);
+  }
+
+  // Sets the max queue size of every polled stream.
+  void SetMaxQueueSize(int queue_size) {
+    auto poller = internal_poller_impl_.lock();
+    CHECK(poller) << "MultiOutputStreamPollerImpl is already destroyed.";
+    return poller->SetMaxQueueSize(queue_size);
+  }
+
+  // Returns the number of packets in the queue of the given stream.
+  int QueueSize(const std::string& tag, int index) {
+    auto poller = internal_poller_impl_.lock();
+    CHECK(poller) << "MultiOutputStreamPollerImpl is already destroyed.";
+    return poller->QueueSize(tag_map_->GetId(tag, index));
+  }
+
+ private:
+  MultiStreamPoller(
+      std::shared_ptr<tool::TagMap> tag_map,
+      std::shared_ptr<internal::MultiOutputStreamPollerImpl>
+          internal_poller_impl)
+      : tag_map_(std::move(tag_map)),
+        internal_poller_impl_(internal_poller_impl) {}
+
+  std::shared_ptr<tool::TagMap> tag_map_;
+  std::weak_ptr<internal::MultiOutputStreamPollerImpl> internal_poller_impl_;
+
+  // Friend class to connect MultiStreamPoller with
+  // internal::MultiOutputStreamPollerImpl.
+  friend class CalculatorGraph;
+};
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_FRAMEWORK_OUTPUT_STREAM_POLLER_H_
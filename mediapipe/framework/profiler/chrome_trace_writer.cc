@@ -0,0 +1,125 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
+
+#include <fstream>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+
+namespace {
+using EventType = GraphTrace::EventType;
+
+// Returns |text| with the characters that are special in JSON strings
+// escaped.  Graph node and stream names rarely need it.
+std::string JsonEscape(absl::string_view text) {
+  static constexpr char kHexDigits[] = "0123456789abcdef";
+  std::string result;
+  result.reserve(text.size());
+  for (char c : text) {
+    const unsigned char byte = static_cast<unsigned char>(c);
+    if (byte < 0x20) {
+      // JSON strings may not contain raw control characters.
+      result.append("\\u00");
+      result.push_back(kHexDigits[byte >> 4]);
+      result.push_back(kHexDigits[byte & 0xf]);
+      continue;
+    }
+    if (c == '"' || c == '\\') {
+      result.push_back('\\');
+    }
+    result.push_back(c);
+  }
+  return result;
+}
+
+}  // namespace
+
+ChromeTraceWriter::ChromeTraceWriter(std::vector<std::string> node_names,
+                                     std::string path_prefix,
+                                     int interval_count, int file_count)
+    : node_names_(std::move(node_names)),
+      path_prefix_(std::move(path_prefix)),
+      interval_count_(interval_count),
+      file_count_(file_count) {}
+
+void ChromeTraceWriter::AppendEventJson(const CompactTraceEvent& event,
+                                        std::string* output) const {
+  const std::string category =
+      GraphTrace::EventType_Name(static_cast<EventType>(event.event_type));
+  const bool has_node = event.node_id >= 0 && event.node_id < node_names_.size();
+  const std::string name =
+      has_node ? JsonEscape(node_names_[event.node_id]) : category;
+  if (event.is_complete) {
+    absl::StrAppend(output, "{\"name\":\"", name, "\",\"cat\":\"", category,
+                    "\",\"ph\":\"X\",\"ts\":", event.start_time_usec,
+                    ",\"dur\":", event.finish_time_usec - event.start_time_usec,
+                    ",\"pid\":0,\"tid\":", event.thread_id,
+                    ",\"args\":{\"input_ts\":", event.input_ts, "}},\n");
+    return;
+  }
+  absl::StrAppend(output, "{\"name\":\"", name, "\",\"cat\":\"", category,
+                  "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":", event.start_time_usec,
+                  ",\"pid\":0,\"tid\":", event.thread_id,
+                  ",\"args\":{\"input_ts\":", event.input_ts,
+                  ",\"packet_ts\":", event.packet_ts);
+  if (event.stream_id != nullptr) {
+    absl::StrAppend(output, ",\"stream\":\"", JsonEscape(*event.stream_id),
+                    "\"");
+  }
+  absl::StrAppend(output, ",\"is_finish\":", event.is_finish ? "true" : "false",
+                  ",\"event_data\":", event.event_data, "}},\n");
+}
+
+absl::Status ChromeTraceWriter::WriteEvents(
+    const std::vector<CompactTraceEvent>& events, int64 dropped_count,
+    int64 time_usec) {
+  if (events.empty() && dropped_count == 0) {
+    return absl::OkStatus();
+  }
+  std::string json;
+  for (const CompactTraceEvent& event : events) {
+    AppendEventJson(event, &json);
+  }
+  if (dropped_count > 0) {
+    absl::StrAppend(&json,
+                    "{\"name\":\"dropped_events\",\"ph\":\"C\",\"ts\":",
+                    time_usec, ",\"pid\":0,\"args\":{\"count\":",
+                    dropped_count, "}},\n");
+  }
+
+  absl::MutexLock lock(&mutex_);
+  bool is_new_file = (write_count_ % interval_count_ == 0);
+  int log_index = write_count_ / interval_count_ % file_count_;
+  ++write_count_;
+  std::string log_path = absl::StrCat(path_prefix_, log_index, ".json");
+  std::ofstream ofs;
+  if (is_new_file) {
+    ofs.open(log_path, std::ofstream::out | std::ofstream::trunc);
+    ofs << "[\n";
+  } else {
+    ofs.open(log_path, std::ofstream::out | std::ofstream::app);
+  }
+  ofs << json;
+  RET_CHECK(ofs.good()) << "Could not write trace events to: " << log_path;
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
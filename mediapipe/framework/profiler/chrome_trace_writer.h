@@ -0,0 +1,66 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/profiler/trace_ring.h"
+
+namespace mediapipe {
+
+// Writes CompactTraceEvents as Chrome trace event JSON, which can be opened
+// in chrome://tracing or in the Perfetto UI.
+//
+// Events are appended to the files StrCat(path_prefix, index, ".json").
+// A new file is started every |interval_count| calls to WriteEvents, and
+// |file_count| files are retained in rotation.  Each file uses the JSON array
+// format without the closing bracket, which trace viewers accept so that a
+// file can be appended to while it is being read.
+class ChromeTraceWriter {
+ public:
+  ChromeTraceWriter(std::vector<std::string> node_names,
+                    std::string path_prefix, int interval_count,
+                    int file_count);
+
+  // Appends |events| to the current trace file.  If |dropped_count| is
+  // non-zero, a counter event at |time_usec| reports the number of dropped
+  // events.  Calls without events or drops leave the files unchanged.
+  absl::Status WriteEvents(const std::vector<CompactTraceEvent>& events,
+                           int64 dropped_count, int64 time_usec)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Appends the JSON for one event, followed by a comma and a newline.
+  void AppendEventJson(const CompactTraceEvent& event,
+                       std::string* output) const;
+
+ private:
+  const std::vector<std::string> node_names_;
+  const std::string path_prefix_;
+  const int interval_count_;
+  const int file_count_;
+
+  absl::Mutex mutex_;
+  // The number of non-empty calls to WriteEvents so far.
+  int64 write_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
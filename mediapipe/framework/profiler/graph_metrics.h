@@ -0,0 +1,60 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_GRAPH_METRICS_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_GRAPH_METRICS_H_
+
+#include <map>
+#include <string>
+
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// Summary statistics of the latency samples recorded in one interval.
+struct LatencySummary {
+  int64 count = 0;
+  int64 mean_usec = 0;
+  int64 p50_usec = 0;
+  int64 p90_usec = 0;
+  int64 p99_usec = 0;
+  int64 max_usec = 0;
+};
+
+// A snapshot of the live metrics of a running CalculatorGraph.
+//
+// Latencies are recorded only while ProfilerConfig::enable_profiler is set.
+// Input stream and source latencies also require enable_stream_latency.
+// Nodes are identified by their canonical node names, and input streams by
+// "node_name:stream_name".
+struct GraphMetrics {
+  // The runtime of each calculator's Process method.
+  std::map<std::string, LatencySummary> process_latency;
+
+  // The time from the production of each input packet until the start of
+  // the consuming Process call, which includes the time spent queued.
+  std::map<std::string, LatencySummary> input_stream_latency;
+
+  // The time from the start of the source Process call until the finish of
+  // each calculator's Process call.  For the calculators producing graph
+  // outputs, this is the end-to-end latency of the graph.
+  std::map<std::string, LatencySummary> source_latency;
+
+  // The number of packets currently queued in each input stream.
+  std::map<std::string, int> queue_depth;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_GRAPH_METRICS_H_
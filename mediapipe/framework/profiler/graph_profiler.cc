@@ -17,6 +17,7 @@
 #include <fstream>
 #include <list>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
@@ -152,6 +153,15 @@ void GraphProfiler::Initialize(
                              &profile);
     }
 
+    auto histograms = absl::make_unique<NodeLatencyHistograms>();
+    histograms->node_name = node_name;
+    for (const StreamProfile& stream : profile.input_stream_profiles()) {
+      histograms->input_stream_names.push_back(stream.name());
+      histograms->input_streams.push_back(
+          absl::make_unique<LatencyHistogram>());
+    }
+    latency_histograms_.push_back(std::move(histograms));
+
     auto iter = calculator_profiles_.insert({node_name, profile});
     CHECK(iter.second) << absl::Substitute(
         "Calculator \"$0\" has already been added.", node_name);
@@ -196,6 +206,13 @@ void GraphProfiler::Reset() {
       ResetTimeHistogram(input_stream_profile.mutable_latency());
     }
   }
+  for (auto& histograms : latency_histograms_) {
+    histograms->process.Clear();
+    histograms->source.Clear();
+    for (auto& input_stream : histograms->input_streams) {
+      input_stream->Clear();
+    }
+  }
 }
 
 // Begins profiling for a single graph run.
@@ -478,6 +495,9 @@ int64 GraphProfiler::AddInputStreamTimeSamples(
         packet_info->production_time_usec, start_time_usec,
         calculator_profile->mutable_input_stream_profiles(input_stream_counter)
             ->mutable_latency());
+    latency_histograms_[calculator_context.NodeId()]
+        ->input_streams[input_stream_counter]
+        ->Record(start_time_usec - packet_info->production_time_usec);
 
     min_source_process_start_usec = std::min(
         min_source_process_start_usec, packet_info->source_process_start_usec);
@@ -504,10 +524,14 @@ void GraphProfiler::AddProcessSample(
   // Update Process() runtime.
   AddTimeSample(start_time_usec, end_time_usec,
                 calculator_profile->mutable_process_runtime());
+  NodeLatencyHistograms* histograms =
+      latency_histograms_[calculator_context.NodeId()].get();
+  histograms->process.Record(end_time_usec - start_time_usec);
 
   if (profiler_config_.enable_stream_latency()) {
     int64 min_source_process_start_usec = AddStreamLatencies(
         calculator_context, start_time_usec, end_time_usec, calculator_profile);
+    histograms->source.Record(end_time_usec - min_source_process_start_usec);
     // Update input and output trace latencies.
     AddTimeSample(min_source_process_start_usec, start_time_usec,
                   calculator_profile->mutable_process_input_latency());
@@ -516,6 +540,23 @@ void GraphProfiler::AddProcessSample(
   }
 }
 
+void GraphProfiler::GetLatencyMetrics(GraphMetrics* metrics, bool reset) {
+  for (auto& histograms : latency_histograms_) {
+    const std::string& node_name = histograms->node_name;
+    metrics->process_latency[node_name] = histograms->process.Summarize(reset);
+    if (!profiler_config_.enable_stream_latency()) {
+      continue;
+    }
+    metrics->source_latency[node_name] = histograms->source.Summarize(reset);
+    for (int i = 0; i < histograms->input_streams.size(); ++i) {
+      std::string key =
+          absl::StrCat(node_name, ":", histograms->input_stream_names[i]);
+      metrics->input_stream_latency[key] =
+          histograms->input_streams[i]->Summarize(reset);
+    }
+  }
+}
+
 std::unique_ptr<GlProfilingHelper> GraphProfiler::CreateGlProfilingHelper() {
   if (!IsTracerEnabled(profiler_config_)) {
     return nullptr;
@@ -613,6 +654,9 @@ absl::Status GraphProfiler::WriteProfile() {
     // Logging is disabled, so we can exit writing without error.
     return absl::OkStatus();
   }
+  if (tracer() && tracer()->IsStreaming()) {
+    return WriteStreamingTrace();
+  }
   ASSIGN_OR_RETURN(std::string trace_log_path, GetTraceLogPath());
   int log_interval_count = GetLogIntervalCount(profiler_config_);
   int log_file_count = GetLogFileCount(profiler_config_);
@@ -648,4 +692,24 @@ absl::Status GraphProfiler::WriteProfile() {
   return absl::OkStatus();
 }
 
+absl::Status GraphProfiler::WriteStreamingTrace() {
+  absl::MutexLock lock(&trace_writer_mutex_);
+  if (!chrome_trace_writer_) {
+    ASSIGN_OR_RETURN(std::string trace_log_path, GetTraceLogPath());
+    std::vector<std::string> node_names;
+    for (int i = 0; i < validated_graph_->CalculatorInfos().size(); ++i) {
+      node_names.push_back(
+          tool::CanonicalNodeName(validated_graph_->Config(), i));
+    }
+    chrome_trace_writer_ = absl::make_unique<ChromeTraceWriter>(
+        std::move(node_names), trace_log_path,
+        GetLogIntervalCount(profiler_config_),
+        GetLogFileCount(profiler_config_));
+  }
+  std::vector<CompactTraceEvent> events;
+  tracer()->DrainEvents(&events);
+  return chrome_trace_writer_->WriteEvents(
+      events, tracer()->TakeDroppedCount(), TimeNowUsec());
+}
+
 }  // namespace mediapipe
@@ -30,7 +30,10 @@
 #include "mediapipe/framework/deps/monotonic_clock.h"
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
+#include "mediapipe/framework/profiler/graph_metrics.h"
 #include "mediapipe/framework/profiler/graph_tracer.h"
+#include "mediapipe/framework/profiler/latency_histogram.h"
 #include "mediapipe/framework/profiler/sharded_map.h"
 #include "mediapipe/framework/validated_graph_config.h"
 
@@ -153,6 +156,11 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   absl::Status GetCalculatorProfiles(std::vector<CalculatorProfile>*) const
       ABSL_LOCKS_EXCLUDED(profiler_mutex_);
 
+  // Returns the latency summaries recorded since the previous reset.  If
+  // |reset| is true, a new interval of latency samples is started.  Does
+  // not block concurrent calculator invocations.
+  void GetLatencyMetrics(GraphMetrics* metrics, bool reset);
+
   // Records recent profiling and tracing data.  Includes events since the
   // previous call to CaptureProfile.
   absl::Status CaptureProfile(GraphProfile* result);
@@ -217,9 +225,15 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
         }
       }
       if (profiler_->is_tracing_) {
-        absl::Time time_now = absl::FromUnixMicros(end_time_usec);
-        profiler_->packet_tracer_->LogOutputEvents(
-            calculator_method_, &calculator_context_, time_now);
+        GraphTracer* tracer = profiler_->packet_tracer_.get();
+        if (tracer->IsStreaming()) {
+          tracer->LogCalculatorEvent(calculator_method_, &calculator_context_,
+                                     start_time_usec_, end_time_usec);
+        } else {
+          absl::Time time_now = absl::FromUnixMicros(end_time_usec);
+          tracer->LogOutputEvents(calculator_method_, &calculator_context_,
+                                  time_now);
+        }
       }
     }
 
@@ -300,6 +314,9 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // trace_log_path.
   absl::StatusOr<std::string> GetTraceLogPath();
 
+  // Appends the streamed trace events to the Chrome trace log files.
+  absl::Status WriteStreamingTrace() ABSL_LOCKS_EXCLUDED(trace_writer_mutex_);
+
   // Helper method to get the clock time in microsecond.
   int64 TimeNowUsec() { return ToUnixMicros(clock_->TimeNow()); }
 
@@ -316,6 +333,19 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // If true, the tracer records timing events.
   std::atomic_bool is_tracing_;
 
+  // The live latency histograms of one calculator.
+  struct NodeLatencyHistograms {
+    std::string node_name;
+    LatencyHistogram process;
+    LatencyHistogram source;
+    // Indexed like CalculatorProfile::input_stream_profiles.
+    std::vector<std::string> input_stream_names;
+    std::vector<std::unique_ptr<LatencyHistogram>> input_streams;
+  };
+
+  // The live latency histograms indexed by node id.
+  std::vector<std::unique_ptr<NodeLatencyHistograms>> latency_histograms_;
+
   // Stores all the calculator profiles with the calculator name as the key.
   using CalculatorProfileMap = ShardedMap<std::string, CalculatorProfile>;
   CalculatorProfileMap calculator_profiles_;
@@ -345,6 +375,13 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // The configuration for the graph being profiled.
   const ValidatedGraphConfig* validated_graph_;
 
+  // Serializes writing of streamed trace events.
+  absl::Mutex trace_writer_mutex_;
+
+  // The writer for streamed trace events, created on first use.
+  std::unique_ptr<ChromeTraceWriter> chrome_trace_writer_
+      ABSL_GUARDED_BY(trace_writer_mutex_);
+
   // For testing.
   friend GraphProfilerTestPeer;
 };
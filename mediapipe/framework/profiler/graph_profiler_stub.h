@@ -35,6 +35,7 @@ class Packet;
 class Clock;
 class GraphTracer;
 class GlProfilingHelper;
+struct GraphMetrics;
 
 class TraceEvent {
  public:
@@ -55,6 +56,7 @@ class TraceEvent {
     TPU_TASK,
     GPU_CALIBRATION,
     PACKET_QUEUED,
+    MODEL_SWITCH,
   };
   TraceEvent(const EventType& event_type) {}
   TraceEvent() {}
@@ -85,6 +87,7 @@ class GraphProfilerStub {
       std::vector<CalculatorProfile>*) const {
     return absl::OkStatus();
   }
+  inline void GetLatencyMetrics(GraphMetrics* metrics, bool reset) {}
   inline void Pause() {}
   inline void Resume() {}
   inline void Reset() {}
@@ -497,6 +497,10 @@ TEST_F(GraphProfilerTestPeer, PauseResumeReset) {
   profiler_.Reset();
   ASSERT_THAT(Profiles()[0].process_runtime(),
               Partially(EqualsProto(CreateTimeHistogram(/*total=*/0, {0}))));
+  const std::string node_name = Profiles()[0].name();
+  GraphMetrics metrics;
+  profiler_.GetLatencyMetrics(&metrics, /*reset=*/false);
+  EXPECT_EQ(0, metrics.process_latency[node_name].count);
 
   // Checks still works after calling Reset().
   {
@@ -507,6 +511,9 @@ TEST_F(GraphProfilerTestPeer, PauseResumeReset) {
   ASSERT_THAT(
       Profiles()[0].process_runtime(),
       Partially(EqualsProto(CreateTimeHistogram(/*total=*/10000, {1}))));
+  profiler_.GetLatencyMetrics(&metrics, /*reset=*/false);
+  EXPECT_EQ(1, metrics.process_latency[node_name].count);
+  EXPECT_EQ(10000, metrics.process_latency[node_name].max_usec);
 
   simulation_clock->ThreadFinish();
 }
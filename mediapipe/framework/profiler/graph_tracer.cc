@@ -14,6 +14,7 @@
 
 #include "mediapipe/framework/profiler/graph_tracer.h"
 
+#include "absl/memory/memory.h"
 #include "absl/time/time.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_profile.pb.h"
@@ -29,6 +30,7 @@ namespace {
 using EventType = GraphTrace::EventType;
 
 const absl::Duration kDefaultTraceLogInterval = absl::Milliseconds(500);
+const int64 kDefaultTraceRingCapacity = 4096;
 
 // Returns a unique identifier for the current thread.
 inline int GetCurrentThreadId() {
@@ -51,8 +53,20 @@ int64 GraphTracer::GetTraceLogCapacity() {
              : 20000;
 }
 
+int64 GraphTracer::GetTraceRingCapacity() {
+  return profiler_config_.trace_ring_capacity()
+             ? profiler_config_.trace_ring_capacity()
+             : kDefaultTraceRingCapacity;
+}
+
 GraphTracer::GraphTracer(const ProfilerConfig& profiler_config)
-    : profiler_config_(profiler_config), trace_buffer_(GetTraceLogCapacity()) {
+    : profiler_config_(profiler_config),
+      trace_buffer_(profiler_config.trace_streaming_enabled()
+                        ? 1
+                        : GetTraceLogCapacity()) {
+  if (profiler_config_.trace_streaming_enabled()) {
+    trace_rings_ = absl::make_unique<TraceRingSet>(GetTraceRingCapacity());
+  }
   for (int disabled : profiler_config_.trace_event_types_disabled()) {
     EventType event_type = static_cast<EventType>(disabled);
     (*trace_event_registry())[event_type].set_enabled(false);
@@ -67,6 +81,24 @@ void GraphTracer::LogEvent(TraceEvent event) {
   if (!(*trace_event_registry())[event.event_type].enabled()) {
     return;
   }
+  if (trace_rings_) {
+    if (!IsSampled(event.input_ts)) {
+      return;
+    }
+    CompactTraceEvent compact;
+    compact.start_time_usec = absl::ToUnixMicros(event.event_time);
+    compact.finish_time_usec = compact.start_time_usec;
+    compact.input_ts = event.input_ts.Value();
+    compact.packet_ts = event.packet_ts.Value();
+    compact.event_data = event.event_data;
+    compact.stream_id = event.stream_id;
+    compact.node_id = event.node_id;
+    compact.thread_id = GetCurrentThreadId();
+    compact.event_type = event.event_type;
+    compact.is_finish = event.is_finish;
+    trace_rings_->Push(compact);
+    return;
+  }
   event.set_thread_id(GetCurrentThreadId());
   trace_buffer_.push_back(event);
 }
@@ -74,6 +106,10 @@ void GraphTracer::LogEvent(TraceEvent event) {
 void GraphTracer::LogInputEvents(GraphTrace::EventType event_type,
                                  const CalculatorContext* context,
                                  absl::Time event_time) {
+  // When streaming, LogCalculatorEvent records the whole invocation.
+  if (trace_rings_) {
+    return;
+  }
   Timestamp input_ts = context->InputTimestamp();
   for (const InputStreamShard& in_stream : context->Inputs()) {
     const Packet& packet = in_stream.Value();
@@ -94,6 +130,9 @@ void GraphTracer::LogInputEvents(GraphTrace::EventType event_type,
 void GraphTracer::LogOutputEvents(GraphTrace::EventType event_type,
                                   const CalculatorContext* context,
                                   absl::Time event_time) {
+  if (trace_rings_) {
+    return;
+  }
   // For source nodes, the first output timestamp is used as the input_ts.
   Timestamp input_ts = (context->Inputs().NumEntries() > 0)
                            ? context->InputTimestamp()
@@ -113,6 +152,40 @@ void GraphTracer::LogOutputEvents(GraphTrace::EventType event_type,
   }
 }
 
+void GraphTracer::LogCalculatorEvent(GraphTrace::EventType event_type,
+                                     const CalculatorContext* context,
+                                     int64 start_time_usec,
+                                     int64 finish_time_usec) {
+  if (!trace_rings_ || !(*trace_event_registry())[event_type].enabled()) {
+    return;
+  }
+  Timestamp input_ts = context->InputTimestamp();
+  if (!IsSampled(input_ts)) {
+    return;
+  }
+  CompactTraceEvent event;
+  event.start_time_usec = start_time_usec;
+  event.finish_time_usec = finish_time_usec;
+  event.input_ts = input_ts.Value();
+  event.packet_ts = input_ts.Value();
+  event.node_id = context->NodeId();
+  event.thread_id = GetCurrentThreadId();
+  event.event_type = event_type;
+  event.is_finish = true;
+  event.is_complete = true;
+  trace_rings_->Push(event);
+}
+
+void GraphTracer::DrainEvents(std::vector<CompactTraceEvent>* result) {
+  if (trace_rings_) {
+    trace_rings_->Drain(result);
+  }
+}
+
+int64 GraphTracer::TakeDroppedCount() {
+  return trace_rings_ ? trace_rings_->TakeDroppedCount() : 0;
+}
+
 Timestamp GraphTracer::TimestampAfter(absl::Time begin_time) {
   return TraceBuilder::TimestampAfter(trace_buffer_, begin_time);
 }
@@ -142,4 +215,14 @@ Timestamp GraphTracer::GetOutputTimestamp(const CalculatorContext* context) {
   return Timestamp();
 }
 
+bool GraphTracer::IsSampled(Timestamp input_ts) const {
+  int sample_interval = profiler_config_.trace_sample_interval();
+  if (sample_interval <= 1 || !input_ts.IsRangeValue()) {
+    return true;
+  }
+  // Fibonacci hashing spreads regularly spaced timestamps evenly.
+  uint64 hash = static_cast<uint64>(input_ts.Value()) * 0x9E3779B97F4A7C15ULL;
+  return (hash >> 32) % sample_interval == 0;
+}
+
 }  // namespace mediapipe
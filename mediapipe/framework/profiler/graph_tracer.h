@@ -15,13 +15,16 @@
 #ifndef MEDIAPIPE_FRAMEWORK_PROFILER_GRAPH_TRACER_H_
 #define MEDIAPIPE_FRAMEWORK_PROFILER_GRAPH_TRACER_H_
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_profile.pb.h"
 #include "mediapipe/framework/profiler/trace_buffer.h"
 #include "mediapipe/framework/profiler/trace_builder.h"
+#include "mediapipe/framework/profiler/trace_ring.h"
 
 namespace mediapipe {
 
@@ -44,6 +47,11 @@ namespace mediapipe {
 //
 //   end_time = current_time - max_packet_latency
 //
+// If ProfilerConfig::trace_streaming_enabled is set, events are instead
+// recorded as CompactTraceEvents in per-thread rings, which are emptied
+// periodically by DrainEvents.  In this mode, each calculator invocation is
+// recorded once through LogCalculatorEvent, and GetTrace returns no events.
+//
 class GraphTracer {
  public:
   // Returns the interval between trace log output.
@@ -52,6 +60,12 @@ class GraphTracer {
   // Returns the maximum number of trace events buffered in memory.
   int64 GetTraceLogCapacity();
 
+  // Returns the number of trace events buffered per thread when streaming.
+  int64 GetTraceRingCapacity();
+
+  // Returns true if trace events are recorded for streaming export.
+  bool IsStreaming() const { return trace_rings_ != nullptr; }
+
   // Create a tracer to record up to |capacity| recent events.
   GraphTracer(const ProfilerConfig& profiler_config);
 
@@ -69,6 +83,17 @@ class GraphTracer {
   void LogOutputEvents(GraphTrace::EventType event_type,
                        const CalculatorContext* context, absl::Time event_time);
 
+  // Append one complete event for a calculator invocation, when streaming.
+  void LogCalculatorEvent(GraphTrace::EventType event_type,
+                          const CalculatorContext* context,
+                          int64 start_time_usec, int64 finish_time_usec);
+
+  // Moves the events recorded since the previous call to |result|.
+  void DrainEvents(std::vector<CompactTraceEvent>* result);
+
+  // Returns and resets the number of events dropped since the previous call.
+  int64 TakeDroppedCount();
+
   // Returns the earliest packet timestamp appearing only after begin_time.
   Timestamp TimestampAfter(absl::Time begin_time);
 
@@ -85,6 +110,9 @@ class GraphTracer {
   // Returns the timestamp of the first output packet.
   Timestamp GetOutputTimestamp(const CalculatorContext* context);
 
+  // Returns true if events for |input_ts| are recorded when streaming.
+  bool IsSampled(Timestamp input_ts) const;
+
   // The settings for this tracer.
   ProfilerConfig profiler_config_;
 
@@ -93,6 +121,9 @@ class GraphTracer {
 
   // The builder for the GraphTrace protobuf.
   TraceBuilder trace_builder_;
+
+  // The per-thread event rings, if streaming.
+  std::unique_ptr<TraceRingSet> trace_rings_;
 };
 
 }  // namespace mediapipe
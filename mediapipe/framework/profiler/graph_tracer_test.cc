@@ -1236,6 +1236,25 @@ TEST_F(GraphTracerE2ETest, DemuxGraphLogFiles) {
               )pb")));
 }
 
+TEST_F(GraphTracerE2ETest, DemuxGraphStreamingLogFile) {
+  std::string log_path =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/log_file_streaming_");
+  SetUpDemuxInFlightGraph();
+  graph_config_.mutable_profiler_config()->set_trace_log_path(log_path);
+  graph_config_.mutable_profiler_config()->set_trace_log_interval_usec(-1);
+  graph_config_.mutable_profiler_config()->set_trace_streaming_enabled(true);
+  RunDemuxInFlightGraph();
+  std::string contents;
+  MP_EXPECT_OK(
+      file::GetContents(absl::StrCat(log_path, 0, ".json"), &contents));
+  EXPECT_EQ(0, contents.find("[\n"));
+  EXPECT_NE(std::string::npos,
+            contents.find("\"name\":\"RoundRobinDemuxCalculator\","
+                          "\"cat\":\"PROCESS\",\"ph\":\"X\""));
+  EXPECT_TRUE(absl::IsNotFound(
+      mediapipe::file::Exists(absl::StrCat(log_path, 0, ".binarypb"))));
+}
+
 TEST_F(GraphTracerE2ETest, DisableLoggingToDisk) {
   std::string log_path =
       absl::StrCat(getenv("TEST_TMPDIR"), "/log_file_disabled_");
@@ -0,0 +1,158 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_LATENCY_HISTOGRAM_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_LATENCY_HISTOGRAM_H_
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/profiler/graph_metrics.h"
+
+namespace mediapipe {
+
+// A lock-free histogram of latencies in microseconds with log-linear
+// buckets, similar to an HdrHistogram.  Values below 16 usec are recorded
+// exactly, and larger values with a relative error below 1/16.
+//
+// Record is wait-free and may be called concurrently from any thread.
+// A summary taken concurrently with Record may miss the samples being
+// recorded, but never double counts them.
+class LatencyHistogram {
+ public:
+  // The number of sub-buckets per power of two is 2^kSubBucketBits.
+  static constexpr int kSubBucketBits = 4;
+  static constexpr int kSubBucketCount = 1 << kSubBucketBits;
+  // Larger values, about 19 hours, are recorded in the last bucket.
+  static constexpr int kMaxValueBits = 36;
+  static constexpr int kBucketCount =
+      (kMaxValueBits - kSubBucketBits + 1) * kSubBucketCount;
+
+  LatencyHistogram() : buckets_(kBucketCount), total_(0), max_(0) {}
+
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  // Records one latency sample.  Negative values are recorded as zero.
+  inline void Record(int64 value_usec) {
+    uint64 value = value_usec < 0 ? 0 : value_usec;
+    buckets_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(value, std::memory_order_relaxed);
+    uint64 max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(
+                              max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Returns the summary of the samples recorded so far.  If |reset| is true,
+  // the returned samples are removed from the histogram.
+  LatencySummary Summarize(bool reset) {
+    std::vector<uint64> counts(kBucketCount);
+    uint64 count = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+      counts[i] = reset ? buckets_[i].exchange(0, std::memory_order_relaxed)
+                        : buckets_[i].load(std::memory_order_relaxed);
+      count += counts[i];
+    }
+    uint64 total = reset ? total_.exchange(0, std::memory_order_relaxed)
+                         : total_.load(std::memory_order_relaxed);
+    uint64 max = reset ? max_.exchange(0, std::memory_order_relaxed)
+                       : max_.load(std::memory_order_relaxed);
+    LatencySummary result;
+    if (count == 0) {
+      return result;
+    }
+    result.count = count;
+    result.mean_usec = total / count;
+    result.max_usec = max;
+    result.p50_usec = std::min(max, Percentile(counts, count, 0.50));
+    result.p90_usec = std::min(max, Percentile(counts, count, 0.90));
+    result.p99_usec = std::min(max, Percentile(counts, count, 0.99));
+    return result;
+  }
+
+  // Removes all the recorded samples.  Samples recorded concurrently may be
+  // partially removed.
+  void Clear() {
+    for (auto& bucket : buckets_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    total_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+  }
+
+  // Returns the bucket holding |value|.
+  static inline int BucketIndex(uint64 value) {
+    if (value < kSubBucketCount) {
+      return value;
+    }
+    int msb = HighestBit(value);
+    if (msb >= kMaxValueBits) {
+      return kBucketCount - 1;
+    }
+    int shift = msb - kSubBucketBits;
+    return (shift + 1) * kSubBucketCount +
+           ((value >> shift) & (kSubBucketCount - 1));
+  }
+
+  // Returns the largest value recorded in bucket |index|.
+  static inline uint64 BucketUpperBound(int index) {
+    if (index < kSubBucketCount) {
+      return index;
+    }
+    int shift = index / kSubBucketCount - 1;
+    uint64 lower = static_cast<uint64>(kSubBucketCount +
+                                       index % kSubBucketCount)
+                   << shift;
+    return lower + (uint64{1} << shift) - 1;
+  }
+
+ private:
+  // Returns the position of the highest set bit of a non-zero value.
+  static inline int HighestBit(uint64 value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    int result = 0;
+    while (value >>= 1) {
+      ++result;
+    }
+    return result;
+#endif
+  }
+
+  // Returns the upper bound of the bucket containing the |q| quantile.
+  static uint64 Percentile(const std::vector<uint64>& counts, uint64 count,
+                           double q) {
+    uint64 rank = std::max<uint64>(1, static_cast<uint64>(q * count + 0.5));
+    uint64 seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+      seen += counts[i];
+      if (seen >= rank) {
+        return BucketUpperBound(i);
+      }
+    }
+    return BucketUpperBound(kBucketCount - 1);
+  }
+
+  std::vector<std::atomic<uint64>> buckets_;
+  std::atomic<uint64> total_;
+  std::atomic<uint64> max_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_LATENCY_HISTOGRAM_H_
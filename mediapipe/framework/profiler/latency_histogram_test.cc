@@ -0,0 +1,107 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/latency_histogram.h"
+
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(LatencyHistogramTest, BucketBounds) {
+  // Small values are exact.
+  for (int value = 0; value < 32; ++value) {
+    int index = LatencyHistogram::BucketIndex(value);
+    EXPECT_EQ(value, LatencyHistogram::BucketUpperBound(index));
+  }
+  // Larger values are within 1/16 of the bucket upper bound.
+  for (uint64 value : {33, 100, 1000, 33333, 1000000, 60000000}) {
+    int index = LatencyHistogram::BucketIndex(value);
+    uint64 upper_bound = LatencyHistogram::BucketUpperBound(index);
+    EXPECT_LE(value, upper_bound);
+    EXPECT_LT(upper_bound - value, value / 16 + 1);
+    EXPECT_GT(value, LatencyHistogram::BucketUpperBound(index - 1));
+  }
+  EXPECT_EQ(LatencyHistogram::kBucketCount - 1,
+            LatencyHistogram::BucketIndex(uint64{1} << 50));
+}
+
+TEST(LatencyHistogramTest, Summarize) {
+  LatencyHistogram histogram;
+  for (int i = 1; i <= 1000; ++i) {
+    histogram.Record(i);
+  }
+  LatencySummary summary = histogram.Summarize(/*reset=*/false);
+  EXPECT_EQ(1000, summary.count);
+  EXPECT_EQ(500, summary.mean_usec);
+  EXPECT_EQ(1000, summary.max_usec);
+  EXPECT_NEAR(500, summary.p50_usec, 500 / 16);
+  EXPECT_NEAR(900, summary.p90_usec, 900 / 16);
+  EXPECT_NEAR(990, summary.p99_usec, 990 / 16);
+
+  summary = histogram.Summarize(/*reset=*/true);
+  EXPECT_EQ(1000, summary.count);
+  summary = histogram.Summarize(/*reset=*/false);
+  EXPECT_EQ(0, summary.count);
+  EXPECT_EQ(0, summary.max_usec);
+}
+
+TEST(LatencyHistogramTest, Clear) {
+  LatencyHistogram histogram;
+  histogram.Record(1000);
+  histogram.Clear();
+  LatencySummary summary = histogram.Summarize(/*reset=*/false);
+  EXPECT_EQ(0, summary.count);
+  EXPECT_EQ(0, summary.max_usec);
+
+  histogram.Record(10);
+  summary = histogram.Summarize(/*reset=*/false);
+  EXPECT_EQ(1, summary.count);
+  EXPECT_EQ(10, summary.mean_usec);
+  EXPECT_EQ(10, summary.max_usec);
+  EXPECT_EQ(10, summary.p99_usec);
+}
+
+TEST(LatencyHistogramTest, ParallelRecord) {
+  LatencyHistogram histogram;
+  {
+    ThreadPool pool(4);
+    pool.StartWorkers();
+    for (int w = 0; w < 4; ++w) {
+      pool.Schedule([&histogram, w]() {
+        for (int i = 0; i < 10000; ++i) {
+          histogram.Record(w * 100 + i % 100);
+        }
+      });
+    }
+  }
+  LatencySummary summary = histogram.Summarize(/*reset=*/true);
+  EXPECT_EQ(40000, summary.count);
+  EXPECT_EQ(399, summary.max_usec);
+}
+
+static void BM_LatencyHistogramRecord(benchmark::State& state) {
+  static LatencyHistogram* histogram = new LatencyHistogram();
+  int64 value = 0;
+  for (auto _ : state) {
+    histogram->Record(value);
+    value = (value + 997) % 100000;
+  }
+}
+BENCHMARK(BM_LatencyHistogramRecord)->ThreadRange(1, 8);
+
+}  // namespace
+}  // namespace mediapipe
@@ -109,6 +109,7 @@ struct TraceEvent {
   static constexpr EventType TPU_TASK = GraphTrace::TPU_TASK;
   static constexpr EventType GPU_CALIBRATION = GraphTrace::GPU_CALIBRATION;
   static constexpr EventType PACKET_QUEUED = GraphTrace::PACKET_QUEUED;
+  static constexpr EventType MODEL_SWITCH = GraphTrace::MODEL_SWITCH;
 };
 
 // Packet trace log buffer.
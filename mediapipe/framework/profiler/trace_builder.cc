@@ -84,6 +84,8 @@ void BasicTraceEventTypes(TraceEventRegistry* result) {
        "A time measured by GPU clock and by CPU clock.", true, false},
       {TraceEvent::PACKET_QUEUED, "An input queue size when a packet arrives.",
        true, true, false},
+      {TraceEvent::MODEL_SWITCH, "A model variant selected by a calculator.",
+       true, false, false},
   };
   for (TraceEventType t : basic_types) {
     (*result)[t.event_type()] = t;
@@ -431,6 +433,7 @@ const TraceEvent::EventType         //
     TraceEvent::DSP_TASK,           //
     TraceEvent::TPU_TASK,           //
     TraceEvent::GPU_CALIBRATION,    //
-    TraceEvent::PACKET_QUEUED;
+    TraceEvent::PACKET_QUEUED,      //
+    TraceEvent::MODEL_SWITCH;
 
 }  // namespace mediapipe
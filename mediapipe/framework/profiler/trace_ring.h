@@ -0,0 +1,207 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_TRACE_RING_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_TRACE_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// A fixed-size trace event recorded by the streaming tracer.  One event
+// describes either a complete calculator invocation (is_complete, with start
+// and finish time) or an instant event.  The struct fits in a single cache
+// line.
+struct CompactTraceEvent {
+  int64 start_time_usec = 0;
+  int64 finish_time_usec = 0;
+  int64 input_ts = 0;
+  int64 packet_ts = 0;
+  int64 event_data = 0;
+  // Stream name, owned by the graph.  Null for calculator invocations.
+  const std::string* stream_id = nullptr;
+  int32 node_id = -1;
+  int32 thread_id = 0;
+  // A GraphTrace::EventType value.
+  int16 event_type = 0;
+  bool is_finish = false;
+  bool is_complete = false;
+};
+
+// A single-producer single-consumer ring of CompactTraceEvents.
+// Push() is wait-free and is only called by the owning thread.  Drain() is
+// only called by one consumer at a time.  Events pushed while the ring is
+// full are dropped and counted.
+class TraceRing {
+ public:
+  // Creates a ring holding at least |capacity| events.  The capacity is
+  // rounded up to a power of two.
+  explicit TraceRing(size_t capacity)
+      : events_(RoundUpToPowerOfTwo(capacity)),
+        mask_(events_.size() - 1),
+        head_(0),
+        tail_(0),
+        dropped_(0) {}
+
+  TraceRing(const TraceRing&) = delete;
+  TraceRing& operator=(const TraceRing&) = delete;
+
+  // Appends one event.  Returns false if the ring is full.
+  inline bool Push(const CompactTraceEvent& event) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= events_.size()) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    events_[head & mask_] = event;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Appends all buffered events to |output| and returns their number.
+  inline size_t Drain(std::vector<CompactTraceEvent>* output) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+    for (size_t i = tail; i != head; ++i) {
+      output->push_back(events_[i & mask_]);
+    }
+    tail_.store(head, std::memory_order_release);
+    return head - tail;
+  }
+
+  // Returns the number of events in the ring.
+  size_t size() const {
+    return head_.load(std::memory_order_acquire) -
+           tail_.load(std::memory_order_acquire);
+  }
+
+  // Returns the number of slots in the ring.
+  size_t capacity() const { return events_.size(); }
+
+  // Returns and resets the number of events dropped since the last call.
+  int64 TakeDroppedCount() {
+    return dropped_.exchange(0, std::memory_order_relaxed);
+  }
+
+ private:
+  static size_t RoundUpToPowerOfTwo(size_t n) {
+    size_t result = 1;
+    while (result < n) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  std::vector<CompactTraceEvent> events_;
+  const size_t mask_;
+  // The producer and consumer indexes live on separate cache lines.
+  alignas(64) std::atomic<size_t> head_;
+  alignas(64) std::atomic<size_t> tail_;
+  std::atomic<int64> dropped_;
+};
+
+// The set of per-thread TraceRings of one tracer.  Each writing thread
+// receives its own ring on first use, so that writers never contend with
+// each other.  Only ring creation and draining acquire the mutex.
+class TraceRingSet {
+ public:
+  // Creates a set whose rings hold |ring_capacity| events each.
+  explicit TraceRingSet(size_t ring_capacity)
+      : id_(NextId()), ring_capacity_(ring_capacity) {}
+
+  TraceRingSet(const TraceRingSet&) = delete;
+  TraceRingSet& operator=(const TraceRingSet&) = delete;
+
+  // Appends one event to the ring of the calling thread.
+  inline bool Push(const CompactTraceEvent& event) {
+    return ThreadRing()->Push(event);
+  }
+
+  // Appends the events of all rings to |output|.  Events from one thread
+  // remain in order; events from different threads are not merged.
+  void Drain(std::vector<CompactTraceEvent>* output) {
+    absl::MutexLock lock(&mutex_);
+    for (auto& ring : rings_) {
+      ring->Drain(output);
+    }
+  }
+
+  // Returns and resets the number of events dropped by all rings.
+  int64 TakeDroppedCount() {
+    absl::MutexLock lock(&mutex_);
+    int64 result = 0;
+    for (auto& ring : rings_) {
+      result += ring->TakeDroppedCount();
+    }
+    return result;
+  }
+
+  // Returns the number of threads that have written events.
+  int NumRings() {
+    absl::MutexLock lock(&mutex_);
+    return rings_.size();
+  }
+
+ private:
+  // Returns the ring of the calling thread, creating it if needed.  The last
+  // ring used by each thread is cached in a thread_local, so the mutex is
+  // acquired only when a thread first writes to this set.
+  inline TraceRing* ThreadRing() {
+    struct RingCache {
+      int64 set_id = -1;
+      TraceRing* ring = nullptr;
+    };
+    static thread_local RingCache cache;
+    if (cache.set_id == id_) {
+      return cache.ring;
+    }
+    absl::MutexLock lock(&mutex_);
+    TraceRing*& ring = rings_by_thread_[std::this_thread::get_id()];
+    if (ring == nullptr) {
+      rings_.push_back(absl::make_unique<TraceRing>(ring_capacity_));
+      ring = rings_.back().get();
+    }
+    cache.set_id = id_;
+    cache.ring = ring;
+    return ring;
+  }
+
+  // Returns a process-wide unique id, so that a thread_local cache entry is
+  // never mistaken for a ring of a later TraceRingSet at the same address.
+  static int64 NextId() {
+    static std::atomic<int64> next_id(0);
+    return next_id++;
+  }
+
+  const int64 id_;
+  const size_t ring_capacity_;
+  absl::Mutex mutex_;
+  std::vector<std::unique_ptr<TraceRing>> rings_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::thread::id, TraceRing*> rings_by_thread_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_TRACE_RING_H_
@@ -0,0 +1,215 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/trace_ring.h"
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
+#include "mediapipe/framework/profiler/circular_buffer.h"
+
+namespace mediapipe {
+namespace {
+
+CompactTraceEvent MakeEvent(int64 start_time_usec) {
+  CompactTraceEvent event;
+  event.start_time_usec = start_time_usec;
+  event.finish_time_usec = start_time_usec + 10;
+  event.event_type = 2;  // PROCESS
+  event.node_id = 0;
+  event.is_complete = true;
+  return event;
+}
+
+TEST(TraceRingTest, PushAndDrain) {
+  TraceRing ring(5);
+  EXPECT_EQ(8, ring.capacity());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(ring.Push(MakeEvent(i)));
+  }
+  EXPECT_EQ(3, ring.size());
+  std::vector<CompactTraceEvent> events;
+  EXPECT_EQ(3, ring.Drain(&events));
+  ASSERT_EQ(3, events.size());
+  EXPECT_EQ(0, events[0].start_time_usec);
+  EXPECT_EQ(2, events[2].start_time_usec);
+  EXPECT_EQ(0, ring.size());
+  EXPECT_EQ(0, ring.Drain(&events));
+}
+
+TEST(TraceRingTest, DropsWhenFull) {
+  TraceRing ring(4);
+  for (int i = 0; i < 6; ++i) {
+    ring.Push(MakeEvent(i));
+  }
+  EXPECT_EQ(2, ring.TakeDroppedCount());
+  EXPECT_EQ(0, ring.TakeDroppedCount());
+  std::vector<CompactTraceEvent> events;
+  ring.Drain(&events);
+  ASSERT_EQ(4, events.size());
+  EXPECT_EQ(3, events[3].start_time_usec);
+
+  // Draining frees the slots for further events.
+  EXPECT_TRUE(ring.Push(MakeEvent(6)));
+  events.clear();
+  ring.Drain(&events);
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ(6, events[0].start_time_usec);
+}
+
+TEST(TraceRingSetTest, ParallelWriteAndDrain) {
+  TraceRingSet rings(1 << 12);
+  std::vector<CompactTraceEvent> events;
+  {
+    ThreadPool pool(4);
+    pool.StartWorkers();
+    for (int w = 0; w < 4; ++w) {
+      pool.Schedule([&rings]() {
+        for (int i = 0; i < 1000; ++i) {
+          rings.Push(MakeEvent(i));
+        }
+      });
+    }
+    // Drain concurrently with the writers.
+    for (int t = 0; t < 10; ++t) {
+      rings.Drain(&events);
+    }
+  }
+  rings.Drain(&events);
+  EXPECT_EQ(4000, events.size());
+  EXPECT_EQ(0, rings.TakeDroppedCount());
+  EXPECT_LE(rings.NumRings(), 4);
+}
+
+TEST(TraceRingSetTest, SeparateSetsUseSeparateRings) {
+  std::vector<CompactTraceEvent> events;
+  {
+    TraceRingSet rings_1(16);
+    rings_1.Push(MakeEvent(1));
+    TraceRingSet rings_2(16);
+    rings_2.Push(MakeEvent(2));
+    rings_1.Push(MakeEvent(3));
+    rings_2.Drain(&events);
+    ASSERT_EQ(1, events.size());
+    EXPECT_EQ(2, events[0].start_time_usec);
+  }
+  // A new set never reuses the cached ring of a destroyed set.
+  TraceRingSet rings_3(16);
+  rings_3.Push(MakeEvent(4));
+  events.clear();
+  rings_3.Drain(&events);
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ(4, events[0].start_time_usec);
+}
+
+TEST(ChromeTraceWriterTest, EventJson) {
+  ChromeTraceWriter writer({"Demux\"er"}, "", 1, 1);
+  std::string json;
+  CompactTraceEvent complete = MakeEvent(100);
+  complete.input_ts = 5;
+  writer.AppendEventJson(complete, &json);
+  EXPECT_EQ(
+      "{\"name\":\"Demux\\\"er\",\"cat\":\"PROCESS\",\"ph\":\"X\",\"ts\":100,"
+      "\"dur\":10,\"pid\":0,\"tid\":0,\"args\":{\"input_ts\":5}},\n",
+      json);
+
+  std::string stream_name = "frames";
+  CompactTraceEvent instant;
+  instant.start_time_usec = 200;
+  instant.input_ts = 5;
+  instant.packet_ts = 5;
+  instant.event_data = 1;
+  instant.stream_id = &stream_name;
+  instant.node_id = 0;
+  instant.thread_id = 3;
+  instant.event_type = 15;  // PACKET_QUEUED
+  json.clear();
+  writer.AppendEventJson(instant, &json);
+  EXPECT_EQ(
+      "{\"name\":\"Demux\\\"er\",\"cat\":\"PACKET_QUEUED\",\"ph\":\"i\","
+      "\"s\":\"t\",\"ts\":200,\"pid\":0,\"tid\":3,\"args\":{\"input_ts\":5,"
+      "\"packet_ts\":5,\"stream\":\"frames\",\"is_finish\":false,"
+      "\"event_data\":1}},\n",
+      json);
+}
+
+TEST(ChromeTraceWriterTest, EscapesControlCharacters) {
+  ChromeTraceWriter writer({std::string("a\tb\nc\x01\x1f\0d\\", 10)}, "",
+                           1, 1);
+  std::string json;
+  writer.AppendEventJson(MakeEvent(100), &json);
+  EXPECT_EQ(0, json.find("{\"name\":\"a\\u0009b\\u000ac\\u0001\\u001f"
+                         "\\u0000d\\\\\","));
+}
+
+TEST(ChromeTraceWriterTest, RotatesFiles) {
+  std::string path = absl::StrCat(getenv("TEST_TMPDIR"), "/chrome_trace_");
+  ChromeTraceWriter writer({"Node"}, path, 2, 2);
+  for (int i = 0; i < 5; ++i) {
+    MP_ASSERT_OK(writer.WriteEvents({MakeEvent(i)}, 0, i));
+  }
+  // Intervals without events are not counted.
+  MP_ASSERT_OK(writer.WriteEvents({}, 0, 5));
+  MP_ASSERT_OK(writer.WriteEvents({}, 3, 6));
+
+  std::string contents;
+  MP_ASSERT_OK(file::GetContents(absl::StrCat(path, 0, ".json"), &contents));
+  EXPECT_EQ(0, contents.find("[\n"));
+  EXPECT_NE(std::string::npos, contents.find("\"ts\":4,"));
+  EXPECT_NE(std::string::npos, contents.find("\"dropped_events\""));
+  EXPECT_EQ(std::string::npos, contents.find("\"ts\":0,"));
+  MP_ASSERT_OK(file::GetContents(absl::StrCat(path, 1, ".json"), &contents));
+  EXPECT_NE(std::string::npos, contents.find("\"ts\":2,"));
+  EXPECT_NE(std::string::npos, contents.find("\"ts\":3,"));
+}
+
+// The cost of recording one event in a shared CircularBuffer, as used by
+// the TraceBuffer.
+static void BM_CircularBufferPushBack(benchmark::State& state) {
+  static auto* buffer = new CircularBuffer<CompactTraceEvent>(1 << 14);
+  CompactTraceEvent event = MakeEvent(0);
+  for (auto _ : state) {
+    buffer->push_back(event);
+  }
+}
+BENCHMARK(BM_CircularBufferPushBack)->ThreadRange(1, 8);
+
+// The cost of recording one event in the per-thread rings.
+static void BM_TraceRingSetPush(benchmark::State& state) {
+  static TraceRingSet* rings = new TraceRingSet(1 << 14);
+  CompactTraceEvent event = MakeEvent(0);
+  std::vector<CompactTraceEvent> events;
+  int count = 0;
+  for (auto _ : state) {
+    rings->Push(event);
+    if (++count % (1 << 13) == 0) {
+      state.PauseTiming();
+      rings->Drain(&events);
+      events.clear();
+      state.ResumeTiming();
+    }
+  }
+}
+BENCHMARK(BM_TraceRingSetPush)->ThreadRange(1, 8);
+
+}  // namespace
+}  // namespace mediapipe
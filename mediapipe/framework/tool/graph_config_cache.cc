@@ -0,0 +1,199 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/graph_config_cache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/subgraph.h"
+#include "mediapipe/framework/validated_graph_config.h"
+
+namespace mediapipe {
+namespace tool {
+
+namespace {
+
+// Changes whenever the format of the cache entries changes.
+constexpr char kCacheFormatVersion[] = "graph_config_cache_v3";
+
+// An entry starts with the subgraph hash in 16 hex digits and a newline,
+// followed by the binary canonical config.
+constexpr int kSubgraphHashDigits = 16;
+
+constexpr uint64 kFnvOffsetBasis = 0xcbf29ce484222325ULL;
+constexpr uint64 kFnvPrime = 0x100000001b3ULL;
+
+// Adds to |hash| the config of each registered subgraph or template in
+// |config|, recursively, in the order ExpandSubgraphs inserts them.
+absl::Status HashSubgraphs(const std::string& package,
+                           const CalculatorGraphConfig& config, uint64* hash) {
+  const GraphRegistry& registry = GraphRegistry::global_graph_registry;
+  for (const auto& node : config.node()) {
+    if (!registry.IsRegistered(package, node.calculator())) {
+      continue;
+    }
+    SubgraphContext subgraph_context(&node, nullptr);
+    ASSIGN_OR_RETURN(CalculatorGraphConfig subgraph,
+                     registry.CreateByName(package, node.calculator(),
+                                           &subgraph_context));
+    *hash = GraphConfigCache::ContentHash(node.calculator(), *hash);
+    *hash = GraphConfigCache::ContentHash(subgraph.SerializeAsString(), *hash);
+    MP_RETURN_IF_ERROR(HashSubgraphs(package, subgraph, hash));
+  }
+  return absl::OkStatus();
+}
+
+// Returns the hash of the configs of the subgraphs and templates that
+// |config| expands.
+absl::StatusOr<uint64> SubgraphHash(const CalculatorGraphConfig& config) {
+  uint64 hash = kFnvOffsetBasis;
+  MP_RETURN_IF_ERROR(HashSubgraphs(config.package(), config, &hash));
+  return hash;
+}
+
+// Splits the cache entry |contents| into its subgraph hash and config.
+bool ParseEntry(const std::string& contents, uint64* subgraph_hash,
+                CalculatorGraphConfig* config) {
+  if (contents.size() <= kSubgraphHashDigits ||
+      contents[kSubgraphHashDigits] != '\n') {
+    return false;
+  }
+  const std::string digits = contents.substr(0, kSubgraphHashDigits);
+  char* end = nullptr;
+  *subgraph_hash = std::strtoull(digits.c_str(), &end, 16);
+  if (end != digits.c_str() + kSubgraphHashDigits) {
+    return false;
+  }
+  return config->ParseFromArray(contents.data() + kSubgraphHashDigits + 1,
+                                contents.size() - kSubgraphHashDigits - 1);
+}
+
+// Removes the entry at |cache_path| if the subgraphs of |config_text| no
+// longer hash to |subgraph_hash|.
+void CheckSubgraphs(const std::string& config_text,
+                    const std::string& cache_path, uint64 subgraph_hash) {
+  CalculatorGraphConfig config;
+  if (ParseTextProto(config_text, &config)) {
+    absl::StatusOr<uint64> current_hash = SubgraphHash(config);
+    if (current_hash.ok() && current_hash.value() == subgraph_hash) {
+      return;
+    }
+  }
+  LOG(WARNING) << "Removing graph config cache entry " << cache_path
+               << ", whose subgraphs have changed.";
+  std::remove(cache_path.c_str());
+}
+
+}  // namespace
+
+GraphConfigCache::GraphConfigCache(std::string cache_dir, std::string salt)
+    : cache_dir_(std::move(cache_dir)), salt_(std::move(salt)) {}
+
+GraphConfigCache::~GraphConfigCache() { WaitForChecks(); }
+
+// static
+uint64 GraphConfigCache::ContentHash(absl::string_view text, uint64 seed) {
+  uint64 hash = seed;
+  for (unsigned char c : text) {
+    hash ^= c;
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+std::string GraphConfigCache::CachePath(const std::string& config_text) const {
+  uint64 hash = ContentHash(kCacheFormatVersion, kFnvOffsetBasis);
+  hash = ContentHash(salt_, hash);
+  hash = ContentHash(config_text, hash);
+  return absl::StrCat(cache_dir_, "/graph_", absl::StrFormat("%016x", hash),
+                      ".binarypb");
+}
+
+absl::StatusOr<CalculatorGraphConfig> GraphConfigCache::GetCanonicalConfig(
+    const std::string& config_text) {
+  const std::string cache_path = CachePath(config_text);
+  std::string contents;
+  if (file::Exists(cache_path).ok() &&
+      file::GetContents(cache_path, &contents).ok()) {
+    uint64 subgraph_hash;
+    CalculatorGraphConfig cached_config;
+    if (ParseEntry(contents, &subgraph_hash, &cached_config)) {
+      ScheduleCheck(config_text, cache_path, subgraph_hash);
+      return cached_config;
+    }
+    LOG(WARNING) << "Ignoring unreadable graph config cache: " << cache_path;
+  }
+
+  CalculatorGraphConfig config;
+  RET_CHECK(ParseTextProto(config_text, &config))
+      << "Failed to parse the CalculatorGraphConfig text.";
+  ASSIGN_OR_RETURN(uint64 subgraph_hash, SubgraphHash(config));
+  ValidatedGraphConfig validated_graph;
+  MP_RETURN_IF_ERROR(validated_graph.Initialize(config));
+  config = validated_graph.Config();
+
+  // The entry is written under a temporary name and renamed, so that
+  // concurrent readers never see a partial file.
+  std::string temp_path = absl::StrCat(cache_path, ".tmp");
+  absl::Status status = file::RecursivelyCreateDir(cache_dir_);
+  if (status.ok()) {
+    status = file::SetContents(
+        temp_path, absl::StrCat(absl::StrFormat("%016x\n", subgraph_hash),
+                                config.SerializeAsString()));
+  }
+  if (status.ok() && std::rename(temp_path.c_str(), cache_path.c_str()) != 0) {
+    status = absl::InternalError(absl::StrCat("Cannot rename ", temp_path));
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Unable to write graph config cache " << cache_path << ": "
+                 << status.message();
+  }
+  return config;
+}
+
+void GraphConfigCache::ScheduleCheck(const std::string& config_text,
+                                     const std::string& cache_path,
+                                     uint64 subgraph_hash) {
+  absl::MutexLock lock(&mutex_);
+  if (!check_pool_) {
+    check_pool_ = absl::make_unique<ThreadPool>("graph_config_cache", 1);
+    check_pool_->StartWorkers();
+  }
+  ++pending_checks_;
+  check_pool_->Schedule([this, config_text, cache_path, subgraph_hash] {
+    CheckSubgraphs(config_text, cache_path, subgraph_hash);
+    absl::MutexLock lock(&mutex_);
+    --pending_checks_;
+  });
+}
+
+void GraphConfigCache::WaitForChecks() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(
+      +[](int* pending_checks) { return *pending_checks == 0; },
+      &pending_checks_));
+}
+
+}  // namespace tool
+}  // namespace mediapipe
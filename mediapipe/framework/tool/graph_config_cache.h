@@ -0,0 +1,97 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_CONFIG_CACHE_H_
+#define MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_CONFIG_CACHE_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace tool {
+
+// Caches the canonical CalculatorGraphConfig produced by ValidatedGraphConfig
+// for a text format graph config.  The canonical config has its subgraphs and
+// templates expanded and its nodes topologically sorted, so initializing a
+// CalculatorGraph from it skips text parsing, subgraph insertion, validation
+// and sorting.
+//
+// Each entry is stored in a binary file named by a hash of |salt| and the
+// config text only, so that a cache hit does no parsing or expansion.  The
+// salt should identify the build, such as a build ID, since the calculators
+// and the subgraphs linked into the binary are not part of the name.
+//
+// Each entry also records a hash of the configs produced by every subgraph
+// and template the config expands.  It is checked lazily: a hit is returned
+// at once, and the subgraphs are expanded and compared on a background thread
+// afterwards.  An entry whose subgraphs changed, e.g. because a subgraph was
+// registered again at runtime, is removed, so that the next lookup rebuilds
+// it.
+//
+// Example:
+//   GraphConfigCache cache(cache_dir, build_id);
+//   ASSIGN_OR_RETURN(CalculatorGraphConfig config,
+//                    cache.GetCanonicalConfig(config_text));
+//   MP_RETURN_IF_ERROR(graph.Initialize(config));
+class GraphConfigCache {
+ public:
+  explicit GraphConfigCache(std::string cache_dir, std::string salt = "");
+
+  // Waits for the pending subgraph checks.
+  ~GraphConfigCache();
+
+  // Returns the canonical config for |config_text|, from the cache if
+  // present.  Otherwise, the config is parsed, expanded and validated, and
+  // written to the cache.  A cache entry that cannot be read or written is
+  // ignored.
+  absl::StatusOr<CalculatorGraphConfig> GetCanonicalConfig(
+      const std::string& config_text);
+
+  // Waits until the subgraphs of the entries returned so far are checked.
+  void WaitForChecks();
+
+  // Returns the cache file path for |config_text|.
+  std::string CachePath(const std::string& config_text) const;
+
+  // Returns a stable 64-bit FNV-1a hash of |text|.
+  static uint64 ContentHash(absl::string_view text, uint64 seed);
+
+ private:
+  // Schedules the check of the subgraphs of the entry at |cache_path|, which
+  // were hashed to |subgraph_hash| when it was written.
+  void ScheduleCheck(const std::string& config_text,
+                     const std::string& cache_path, uint64 subgraph_hash);
+
+  const std::string cache_dir_;
+  const std::string salt_;
+
+  absl::Mutex mutex_;
+  // The number of scheduled checks not yet completed.
+  int pending_checks_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Runs the subgraph checks, created with the first hit.
+  std::unique_ptr<ThreadPool> check_pool_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace tool
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_CONFIG_CACHE_H_
@@ -0,0 +1,181 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/graph_config_cache.h"
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/deps/message_matchers.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/subgraph.h"
+#include "mediapipe/framework/tool/sink.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr char kGraphText[] = R"pb(
+  input_stream: "ints"
+  node {
+    calculator: "DubQuadTestSubgraph"
+    input_stream: "INTS:ints"
+    output_stream: "QUADS:quads"
+  }
+)pb";
+
+std::string CacheDir(const std::string& name) {
+  return absl::StrCat(getenv("TEST_TMPDIR"), "/", name);
+}
+
+// Registers |config| as the subgraph "CacheTestSubgraph" until the returned
+// token is unregistered.
+RegistrationToken RegisterCacheTestSubgraph(
+    const CalculatorGraphConfig& config) {
+  return SubgraphRegistry::Register("CacheTestSubgraph", [config] {
+    return std::unique_ptr<Subgraph>(new ProtoSubgraph(config));
+  });
+}
+
+TEST(GraphConfigCacheTest, WritesAndReadsCanonicalConfig) {
+  tool::GraphConfigCache cache(CacheDir("cache_roundtrip"));
+  std::string cache_path = cache.CachePath(kGraphText);
+  EXPECT_FALSE(file::Exists(cache_path).ok());
+
+  auto config_or = cache.GetCanonicalConfig(kGraphText);
+  MP_ASSERT_OK(config_or.status());
+  CalculatorGraphConfig config = config_or.value();
+  MP_EXPECT_OK(file::Exists(cache_path));
+  // The subgraph is expanded into its two calculators.
+  ASSERT_EQ(2, config.node_size());
+  EXPECT_EQ("DoubleIntCalculator", config.node(0).calculator());
+
+  auto cached_config_or = cache.GetCanonicalConfig(kGraphText);
+  MP_ASSERT_OK(cached_config_or.status());
+  CalculatorGraphConfig cached_config = cached_config_or.value();
+  EXPECT_THAT(cached_config, EqualsProto(config));
+}
+
+TEST(GraphConfigCacheTest, RunsCachedConfig) {
+  tool::GraphConfigCache cache(CacheDir("cache_run"));
+  MP_ASSERT_OK(cache.GetCanonicalConfig(kGraphText).status());
+  auto config_or = cache.GetCanonicalConfig(kGraphText);
+  MP_ASSERT_OK(config_or.status());
+  CalculatorGraphConfig config = config_or.value();
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("quads", &config, &output_packets);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "ints", MakePacket<int>(3).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(1, output_packets.size());
+  EXPECT_EQ(12, output_packets[0].Get<int>());
+}
+
+TEST(GraphConfigCacheTest, IgnoresCorruptEntry) {
+  tool::GraphConfigCache cache(CacheDir("cache_corrupt"));
+  MP_ASSERT_OK(cache.GetCanonicalConfig(kGraphText).status());
+  MP_ASSERT_OK(file::SetContents(cache.CachePath(kGraphText),
+                                 "not a binary proto\xff\xff"));
+  auto config_or = cache.GetCanonicalConfig(kGraphText);
+  MP_ASSERT_OK(config_or.status());
+  CalculatorGraphConfig config = config_or.value();
+  EXPECT_EQ(2, config.node_size());
+}
+
+TEST(GraphConfigCacheTest, KeyDependsOnTextAndSalt) {
+  tool::GraphConfigCache cache(CacheDir("cache_keys"));
+  tool::GraphConfigCache salted_cache(CacheDir("cache_keys"), "build_2");
+  std::string path = cache.CachePath(kGraphText);
+  EXPECT_NE(path, cache.CachePath(absl::StrCat(kGraphText, " ")));
+  EXPECT_NE(path, salted_cache.CachePath(kGraphText));
+  EXPECT_EQ(path, cache.CachePath(kGraphText));
+}
+
+TEST(GraphConfigCacheTest, RebuildsAfterSubgraphChanges) {
+  constexpr char kTestGraphText[] = R"pb(
+    input_stream: "ints"
+    node {
+      calculator: "CacheTestSubgraph"
+      input_stream: "INTS:ints"
+      output_stream: "OUTS:outs"
+    }
+  )pb";
+  tool::GraphConfigCache cache(CacheDir("cache_subgraph"));
+
+  RegistrationToken token =
+      RegisterCacheTestSubgraph(ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "INTS:ints"
+        output_stream: "OUTS:doubled"
+        node {
+          calculator: "DoubleIntCalculator"
+          input_stream: "ints"
+          output_stream: "doubled"
+        }
+      )pb"));
+  std::string cache_path = cache.CachePath(kTestGraphText);
+  auto config_or = cache.GetCanonicalConfig(kTestGraphText);
+  MP_ASSERT_OK(config_or.status());
+  EXPECT_EQ(1, config_or.value().node_size());
+  token.Unregister();
+
+  token =
+      RegisterCacheTestSubgraph(ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "INTS:ints"
+        output_stream: "OUTS:quadrupled"
+        node {
+          calculator: "DoubleIntCalculator"
+          input_stream: "ints"
+          output_stream: "doubled"
+        }
+        node {
+          calculator: "DoubleIntCalculator"
+          input_stream: "doubled"
+          output_stream: "quadrupled"
+        }
+      )pb"));
+  // The key does not depend on the subgraphs, so the stale entry is still
+  // returned once, and removed by the check that the hit schedules.
+  EXPECT_EQ(cache_path, cache.CachePath(kTestGraphText));
+  config_or = cache.GetCanonicalConfig(kTestGraphText);
+  MP_ASSERT_OK(config_or.status());
+  EXPECT_EQ(1, config_or.value().node_size());
+  cache.WaitForChecks();
+  EXPECT_FALSE(file::Exists(cache_path).ok());
+  config_or = cache.GetCanonicalConfig(kTestGraphText);
+  MP_ASSERT_OK(config_or.status());
+  EXPECT_EQ(2, config_or.value().node_size());
+  token.Unregister();
+}
+
+TEST(GraphConfigCacheTest, ParseError) {
+  tool::GraphConfigCache cache(CacheDir("cache_error"));
+  EXPECT_FALSE(cache.GetCanonicalConfig("node { calculator: ").ok());
+  EXPECT_FALSE(cache.GetCanonicalConfig(R"pb(
+                      node { calculator: "NoSuchCalculator" }
+                    )pb")
+                   .ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,234 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/hot_swap_graph.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+namespace tool {
+
+HotSwapGraph::HotSwapGraph(std::vector<std::string> output_streams)
+    : output_streams_(std::move(output_streams)) {}
+
+HotSwapGraph::~HotSwapGraph() {
+  JoinPrepareThread();
+  std::vector<std::shared_ptr<Instance>> instances;
+  {
+    absl::MutexLock lock(&mutex_);
+    instances.assign(output_instances_.begin(), output_instances_.end());
+    if (pending_instance_) {
+      instances.push_back(pending_instance_);
+    }
+  }
+  for (auto& instance : instances) {
+    instance->graph->Cancel();
+    instance->graph->WaitUntilDone().IgnoreError();
+  }
+}
+
+absl::Status HotSwapGraph::CreateInstance(
+    const CalculatorGraphConfig& config, std::shared_ptr<Instance>* instance) {
+  auto result = std::make_shared<Instance>();
+  result->graph = absl::make_unique<CalculatorGraph>();
+  MP_RETURN_IF_ERROR(result->graph->Initialize(config));
+  ASSIGN_OR_RETURN(MultiStreamPoller poller,
+                   result->graph->AddMultiStreamPoller(output_streams_));
+  result->poller = absl::make_unique<MultiStreamPoller>(std::move(poller));
+  *instance = std::move(result);
+  return absl::OkStatus();
+}
+
+absl::Status HotSwapGraph::Start(
+    const CalculatorGraphConfig& config,
+    const std::map<std::string, Packet>& side_packets) {
+  RET_CHECK(!input_instance_) << "HotSwapGraph is already started.";
+  std::shared_ptr<Instance> instance;
+  MP_RETURN_IF_ERROR(CreateInstance(config, &instance));
+  MP_RETURN_IF_ERROR(instance->graph->StartRun(side_packets));
+  side_packets_ = side_packets;
+  tag_map_ = instance->poller->TagMap();
+  input_instance_ = instance;
+  absl::MutexLock lock(&mutex_);
+  output_instances_.push_back(std::move(instance));
+  return absl::OkStatus();
+}
+
+absl::Status HotSwapGraph::Reconfigure(const CalculatorGraphConfig& config) {
+  if (!input_instance_) {
+    return absl::FailedPreconditionError("HotSwapGraph is not started.");
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    if (preparing_) {
+      return absl::UnavailableError("A graph is already being started.");
+    }
+  }
+  // The config is validated on the calling thread, so that errors are
+  // reported directly.  Only opening the calculators runs in the background.
+  std::shared_ptr<Instance> instance;
+  MP_RETURN_IF_ERROR(CreateInstance(config, &instance));
+  JoinPrepareThread();
+
+  std::shared_ptr<Instance> replaced;
+  {
+    absl::MutexLock lock(&mutex_);
+    // A prepared graph that was never swapped in is replaced.
+    replaced = std::move(pending_instance_);
+    pending_instance_ = instance;
+    preparing_ = true;
+    prepare_status_ = absl::OkStatus();
+    reconfigure_time_ = absl::Now();
+  }
+  if (replaced) {
+    replaced->graph->Cancel();
+    replaced->graph->WaitUntilDone().IgnoreError();
+  }
+
+  prepare_thread_ = std::thread([this, instance]() {
+    absl::Time start_time = absl::Now();
+    absl::Status status = instance->graph->StartRun(side_packets_);
+    absl::MutexLock lock(&mutex_);
+    preparing_ = false;
+    prepare_status_ = status;
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to start the reconfigured graph: " << status;
+      pending_instance_.reset();
+      return;
+    }
+    stats_.prepare_time = absl::Now() - start_time;
+  });
+  return absl::OkStatus();
+}
+
+void HotSwapGraph::JoinPrepareThread() {
+  if (prepare_thread_.joinable()) {
+    prepare_thread_.join();
+  }
+}
+
+absl::Status HotSwapGraph::WaitUntilPrepared() {
+  JoinPrepareThread();
+  absl::MutexLock lock(&mutex_);
+  return prepare_status_;
+}
+
+bool HotSwapGraph::SwapPending() {
+  absl::MutexLock lock(&mutex_);
+  return !preparing_ && pending_instance_ != nullptr;
+}
+
+absl::Status HotSwapGraph::SwapIfReady() {
+  std::shared_ptr<Instance> previous = input_instance_;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (preparing_ || !pending_instance_) {
+      return absl::OkStatus();
+    }
+    input_instance_ = std::move(pending_instance_);
+    output_instances_.push_back(input_instance_);
+    swap_time_ = absl::Now();
+    stats_.swap_latency = swap_time_ - reconfigure_time_;
+    stats_.drain_time = absl::ZeroDuration();
+  }
+  JoinPrepareThread();
+  // The previous graph finishes the packets it has received and is
+  // waited for by Next() once its outputs are returned.
+  return previous->graph->CloseAllInputStreams();
+}
+
+absl::Status HotSwapGraph::AddPacketToInputStream(
+    const std::string& stream_name, Packet packet) {
+  RET_CHECK(input_instance_) << "HotSwapGraph is not started.";
+  MP_RETURN_IF_ERROR(SwapIfReady());
+  return input_instance_->graph->AddPacketToInputStream(stream_name,
+                                                        std::move(packet));
+}
+
+bool HotSwapGraph::Next(PacketSet* packets) {
+  while (true) {
+    std::shared_ptr<Instance> instance;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (output_instances_.empty()) {
+        return false;
+      }
+      instance = output_instances_.front();
+    }
+    if (instance->poller->Next(packets)) {
+      return true;
+    }
+    {
+      absl::MutexLock lock(&mutex_);
+      // The last graph is kept for WaitUntilDone().
+      if (output_instances_.size() == 1) {
+        return false;
+      }
+    }
+    absl::Status status = instance->graph->WaitUntilDone();
+    absl::MutexLock lock(&mutex_);
+    output_instances_.pop_front();
+    if (!status.ok()) {
+      LOG(ERROR) << "Swapped out graph failed: " << status;
+      retired_status_.Update(status);
+    }
+    if (output_instances_.size() == 1) {
+      stats_.drain_time = absl::Now() - swap_time_;
+      ++stats_.swap_count;
+      VLOG(1) << "Graph swap took " << stats_.swap_latency
+              << " after Reconfigure, drained in " << stats_.drain_time;
+    }
+  }
+}
+
+absl::Status HotSwapGraph::CloseAllInputStreams() {
+  RET_CHECK(input_instance_) << "HotSwapGraph is not started.";
+  return input_instance_->graph->CloseAllInputStreams();
+}
+
+absl::Status HotSwapGraph::WaitUntilDone() {
+  JoinPrepareThread();
+  std::shared_ptr<Instance> pending;
+  std::vector<std::shared_ptr<Instance>> instances;
+  absl::Status status;
+  {
+    absl::MutexLock lock(&mutex_);
+    pending = std::move(pending_instance_);
+    instances.assign(output_instances_.begin(), output_instances_.end());
+    output_instances_.clear();
+    status = retired_status_;
+  }
+  if (pending) {
+    pending->graph->Cancel();
+    pending->graph->WaitUntilDone().IgnoreError();
+  }
+  for (auto& instance : instances) {
+    status.Update(instance->graph->WaitUntilDone());
+  }
+  return status;
+}
+
+HotSwapStats HotSwapGraph::GetStats() {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+}  // namespace tool
+}  // namespace mediapipe
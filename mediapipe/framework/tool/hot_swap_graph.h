@@ -0,0 +1,172 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_TOOL_HOT_SWAP_GRAPH_H_
+#define MEDIAPIPE_FRAMEWORK_TOOL_HOT_SWAP_GRAPH_H_
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/output_stream_poller.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace tool {
+
+// Timing of the last graph swap performed by a HotSwapGraph.
+struct HotSwapStats {
+  // The number of completed swaps.
+  int64 swap_count = 0;
+  // Time spent opening the calculators of the new graph, while the previous
+  // graph kept running.
+  absl::Duration prepare_time;
+  // Time from Reconfigure() until the first packet was sent to the new graph.
+  absl::Duration swap_latency;
+  // Time from the swap until the previous graph finished and all of its
+  // outputs were returned by Next().
+  absl::Duration drain_time;
+};
+
+// Runs a CalculatorGraph whose config can be replaced while packets keep
+// flowing.  Reconfigure() initializes the new graph immediately and opens its
+// calculators (and so loads its models) on a background thread, while the
+// running graph keeps processing.  Once the new graph is ready, the next
+// packet added through AddPacketToInputStream() starts it: all input streams
+// of the previous graph are closed, so the previous graph processes exactly
+// the packets before that timestamp and the new graph the packets from that
+// timestamp on.  Next() returns the remaining outputs of the previous graph
+// before the outputs of the new one, so no output is lost or reordered.
+//
+// The graphs must have the input streams used by the caller and the polled
+// output streams.  AddPacketToInputStream(), Reconfigure() and
+// CloseAllInputStreams() are called by one thread; Next() may be called by
+// another.
+//
+// Example:
+//   HotSwapGraph graph({"VIDEO:output_video"});
+//   MP_RETURN_IF_ERROR(graph.Start(config));
+//   PacketSet packets(graph.TagMap());
+//   ...
+//   MP_RETURN_IF_ERROR(graph.Reconfigure(new_config));
+//   ...
+//   MP_RETURN_IF_ERROR(graph.AddPacketToInputStream("input_video", packet));
+//   if (!graph.Next(&packets)) { ... }
+class HotSwapGraph {
+ public:
+  // Creates a HotSwapGraph polling |output_streams|, given as for
+  // CalculatorGraph::AddMultiStreamPoller().
+  explicit HotSwapGraph(std::vector<std::string> output_streams);
+  // Cancels and waits for all graphs which are still running.
+  ~HotSwapGraph();
+
+  HotSwapGraph(const HotSwapGraph&) = delete;
+  HotSwapGraph& operator=(const HotSwapGraph&) = delete;
+
+  // Initializes and starts the first graph.  |side_packets| are also passed
+  // to every graph started by Reconfigure().
+  absl::Status Start(const CalculatorGraphConfig& config,
+                     const std::map<std::string, Packet>& side_packets = {});
+
+  // Initializes a graph from |config| and starts it in the background.
+  // Returns an error if |config| is invalid or if another graph is still
+  // being started; the running graph is unaffected in both cases.  A graph
+  // that fails to start is discarded and the running graph is kept.
+  absl::Status Reconfigure(const CalculatorGraphConfig& config);
+
+  // Blocks until the graph started by the last Reconfigure() is ready or
+  // has failed, and returns its StartRun() status.
+  absl::Status WaitUntilPrepared();
+
+  // Returns true if a reconfigured graph is ready to replace the running one.
+  bool SwapPending();
+
+  // Adds a packet to the running graph, first swapping in a prepared graph.
+  absl::Status AddPacketToInputStream(const std::string& stream_name,
+                                      Packet packet);
+
+  // Gets the next output packets, as MultiStreamPoller::Next().  Returns
+  // false once the last graph is done.
+  ABSL_MUST_USE_RESULT bool Next(PacketSet* packets);
+
+  // Returns the tag map of the polled streams.  PacketSets passed to Next()
+  // must be constructed from it.
+  const std::shared_ptr<tool::TagMap>& TagMap() const { return tag_map_; }
+
+  // Closes the input streams of the running graph.
+  absl::Status CloseAllInputStreams();
+
+  // Waits until all graphs are done, discarding a prepared graph that was
+  // never swapped in.  Returns the first error of any graph.
+  absl::Status WaitUntilDone();
+
+  // Returns the timing of the last swap.
+  HotSwapStats GetStats();
+
+  // Returns the graph receiving input packets, or null before Start().
+  CalculatorGraph* graph() {
+    return input_instance_ ? input_instance_->graph.get() : nullptr;
+  }
+
+ private:
+  // A started graph with its output poller.
+  struct Instance {
+    std::unique_ptr<CalculatorGraph> graph;
+    std::unique_ptr<MultiStreamPoller> poller;
+  };
+
+  // Creates an initialized graph with its output poller.
+  absl::Status CreateInstance(const CalculatorGraphConfig& config,
+                              std::shared_ptr<Instance>* instance);
+
+  // Replaces the running graph with the prepared graph, if any.
+  absl::Status SwapIfReady();
+
+  // Waits for the background thread started by Reconfigure().
+  void JoinPrepareThread();
+
+  const std::vector<std::string> output_streams_;
+  std::shared_ptr<tool::TagMap> tag_map_;
+  std::map<std::string, Packet> side_packets_;
+
+  // The graph receiving input packets.
+  std::shared_ptr<Instance> input_instance_;
+  std::thread prepare_thread_;
+
+  absl::Mutex mutex_;
+  // The graphs whose outputs are not yet returned, oldest first.  The last
+  // one is the input graph.
+  std::deque<std::shared_ptr<Instance>> output_instances_
+      ABSL_GUARDED_BY(mutex_);
+  // The graph being started by the prepare thread.
+  std::shared_ptr<Instance> pending_instance_ ABSL_GUARDED_BY(mutex_);
+  bool preparing_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status prepare_status_ ABSL_GUARDED_BY(mutex_);
+  absl::Time reconfigure_time_ ABSL_GUARDED_BY(mutex_);
+  absl::Time swap_time_ ABSL_GUARDED_BY(mutex_);
+  // The first error of a graph that was swapped out.
+  absl::Status retired_status_ ABSL_GUARDED_BY(mutex_);
+  HotSwapStats stats_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace tool
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_TOOL_HOT_SWAP_GRAPH_H_
@@ -0,0 +1,133 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/hot_swap_graph.h"
+
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+CalculatorGraphConfig PassThroughConfig() {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "ints"
+    node {
+      calculator: "PassThroughCalculator"
+      input_stream: "ints"
+      output_stream: "out"
+    }
+  )pb");
+}
+
+CalculatorGraphConfig QuadrupleConfig() {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "ints"
+    node {
+      calculator: "DubQuadTestSubgraph"
+      input_stream: "INTS:ints"
+      output_stream: "QUADS:out"
+    }
+  )pb");
+}
+
+// Returns the values and timestamps of all remaining outputs.
+void ReadOutputs(tool::HotSwapGraph* graph, std::vector<int>* values,
+                 std::vector<int64>* timestamps) {
+  PacketSet packets(graph->TagMap());
+  while (graph->Next(&packets)) {
+    const Packet& packet = packets.Tag("OUT");
+    values->push_back(packet.Get<int>());
+    timestamps->push_back(packet.Timestamp().Value());
+  }
+}
+
+TEST(HotSwapGraphTest, SwapsAtTimestampBoundary) {
+  tool::HotSwapGraph graph({"OUT:out"});
+  MP_ASSERT_OK(graph.Start(PassThroughConfig()));
+  for (int i = 0; i < 5; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "ints", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.Reconfigure(QuadrupleConfig()));
+  MP_ASSERT_OK(graph.WaitUntilPrepared());
+  EXPECT_TRUE(graph.SwapPending());
+  for (int i = 5; i < 10; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "ints", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  EXPECT_FALSE(graph.SwapPending());
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+
+  std::vector<int> values;
+  std::vector<int64> timestamps;
+  ReadOutputs(&graph, &values, &timestamps);
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  // Packets before the swap are passed through by the first graph, and the
+  // following packets are quadrupled by the second graph.
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4, 20, 24, 28, 32, 36}), values);
+  EXPECT_EQ(std::vector<int64>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), timestamps);
+  tool::HotSwapStats stats = graph.GetStats();
+  EXPECT_EQ(1, stats.swap_count);
+  EXPECT_GE(stats.swap_latency, stats.prepare_time);
+}
+
+TEST(HotSwapGraphTest, SwapsRepeatedly) {
+  tool::HotSwapGraph graph({"OUT:out"});
+  MP_ASSERT_OK(graph.Start(PassThroughConfig()));
+  PacketSet packets(graph.TagMap());
+  for (int i = 0; i < 6; ++i) {
+    if (i > 0) {
+      MP_ASSERT_OK(graph.Reconfigure(i % 2 ? QuadrupleConfig()
+                                           : PassThroughConfig()));
+      MP_ASSERT_OK(graph.WaitUntilPrepared());
+    }
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "ints", MakePacket<int>(1).At(Timestamp(i))));
+    // Outputs are read in lockstep with the inputs.
+    ASSERT_TRUE(graph.Next(&packets));
+    EXPECT_EQ(i % 2 ? 4 : 1, packets.Tag("OUT").Get<int>());
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  EXPECT_FALSE(graph.Next(&packets));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_EQ(5, graph.GetStats().swap_count);
+}
+
+TEST(HotSwapGraphTest, InvalidConfigKeepsRunningGraph) {
+  tool::HotSwapGraph graph({"OUT:out"});
+  EXPECT_FALSE(graph.Reconfigure(PassThroughConfig()).ok());
+  MP_ASSERT_OK(graph.Start(PassThroughConfig()));
+  CalculatorGraphConfig invalid_config = PassThroughConfig();
+  invalid_config.mutable_node(0)->set_calculator("NoSuchCalculator");
+  EXPECT_FALSE(graph.Reconfigure(invalid_config).ok());
+  EXPECT_FALSE(graph.SwapPending());
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "ints", MakePacket<int>(7).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+
+  std::vector<int> values;
+  std::vector<int64> timestamps;
+  ReadOutputs(&graph, &values, &timestamps);
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_EQ(std::vector<int>({7}), values);
+  EXPECT_EQ(0, graph.GetStats().swap_count);
+}
+
+}  // namespace
+}  // namespace mediapipe
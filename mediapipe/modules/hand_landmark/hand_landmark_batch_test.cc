@@ -0,0 +1,239 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the per-hand and the batched hand landmark inference used by
+// HandLandmarkTrackingCpu.
+
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kImageWidth = 640;
+constexpr int kImageHeight = 480;
+
+// Runs ImageToTensorCalculator and InferenceCalculator once per hand rect.
+constexpr char kPerHandGraph[] = R"pb(
+  input_stream: "image"
+  input_stream: "hand_rects"
+  node {
+    calculator: "BeginLoopNormalizedRectCalculator"
+    input_stream: "ITERABLE:hand_rects"
+    input_stream: "CLONE:image"
+    output_stream: "ITEM:single_hand_rect"
+    output_stream: "CLONE:image_for_landmarks"
+    output_stream: "BATCH_END:hand_rects_timestamp"
+  }
+  node {
+    calculator: "ImageToTensorCalculator"
+    input_stream: "IMAGE:image_for_landmarks"
+    input_stream: "NORM_RECT:single_hand_rect"
+    output_stream: "TENSORS:input_tensors"
+    options: {
+      [mediapipe.ImageToTensorCalculatorOptions.ext] {
+        output_tensor_width: 224
+        output_tensor_height: 224
+        keep_aspect_ratio: true
+        output_tensor_float_range { min: 0.0 max: 1.0 }
+      }
+    }
+  }
+  node {
+    calculator: "InferenceCalculator"
+    input_stream: "TENSORS:input_tensors"
+    output_stream: "TENSORS:single_hand_output_tensors"
+    options: {
+      [mediapipe.InferenceCalculatorOptions.ext] {
+        model_path: "mediapipe/modules/hand_landmark/hand_landmark.tflite"
+        delegate { xnnpack {} }
+      }
+    }
+  }
+)pb";
+
+// Runs ImageToTensorCalculator and InferenceCalculator once for all hand
+// rects, as HandLandmarkTrackingCpu does.
+constexpr char kBatchedGraph[] = R"pb(
+  input_stream: "image"
+  input_stream: "hand_rects"
+  node {
+    calculator: "ImageToTensorCalculator"
+    input_stream: "IMAGE:image"
+    input_stream: "NORM_RECTS:hand_rects"
+    output_stream: "TENSORS:input_tensors"
+    output_stream: "LETTERBOX_PADDINGS:letterbox_paddings"
+    options: {
+      [mediapipe.ImageToTensorCalculatorOptions.ext] {
+        output_tensor_width: 224
+        output_tensor_height: 224
+        keep_aspect_ratio: true
+        output_tensor_float_range { min: 0.0 max: 1.0 }
+      }
+    }
+  }
+  node {
+    calculator: "InferenceCalculator"
+    input_stream: "TENSORS:input_tensors"
+    output_stream: "TENSORS:output_tensors"
+    options: {
+      [mediapipe.InferenceCalculatorOptions.ext] {
+        model_path: "mediapipe/modules/hand_landmark/hand_landmark.tflite"
+        delegate { xnnpack {} }
+      }
+    }
+  }
+  node {
+    calculator: "BeginLoopTensorBatchCalculator"
+    input_stream: "ITERABLE:hand_rects"
+    input_stream: "TENSORS:output_tensors"
+    input_stream: "LETTERBOX_PADDINGS:letterbox_paddings"
+    output_stream: "ITEM:single_hand_rect"
+    output_stream: "TENSORS:single_hand_output_tensors"
+    output_stream: "LETTERBOX_PADDING:single_hand_letterbox_padding"
+    output_stream: "BATCH_END:hand_rects_timestamp"
+  }
+)pb";
+
+// Returns a synthetic 640x480 image with a gradient pattern.
+Packet MakeImagePacket() {
+  auto image = absl::make_unique<ImageFrame>(ImageFormat::SRGB, kImageWidth,
+                                             kImageHeight);
+  for (int y = 0; y < kImageHeight; ++y) {
+    uint8* row = image->MutablePixelData() + y * image->WidthStep();
+    for (int x = 0; x < kImageWidth; ++x) {
+      row[x * 3] = x % 256;
+      row[x * 3 + 1] = y % 256;
+      row[x * 3 + 2] = (x + y) % 256;
+    }
+  }
+  return Adopt(image.release());
+}
+
+// Returns |num_hands| non-overlapping hand rects.
+std::vector<NormalizedRect> MakeHandRects(int num_hands) {
+  std::vector<NormalizedRect> rects(num_hands);
+  for (int i = 0; i < num_hands; ++i) {
+    rects[i].set_x_center(0.2f + 0.2f * (i % 4));
+    rects[i].set_y_center(i < 4 ? 0.3f : 0.7f);
+    rects[i].set_width(0.3f);
+    rects[i].set_height(0.4f);
+    rects[i].set_rotation(0.1f * i);
+  }
+  return rects;
+}
+
+// Runs |graph_config| on one image and returns the output tensors of each
+// hand.
+void RunGraph(const char* graph_config, int num_hands,
+              std::vector<Packet>* output_packets) {
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(
+      ParseTextProtoOrDie<CalculatorGraphConfig>(graph_config)));
+  MP_ASSERT_OK(graph.ObserveOutputStream(
+      "single_hand_output_tensors", [output_packets](const Packet& packet) {
+        output_packets->push_back(packet);
+        return absl::OkStatus();
+      }));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "image", MakeImagePacket().At(Timestamp(0))));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "hand_rects",
+      MakePacket<std::vector<NormalizedRect>>(MakeHandRects(num_hands))
+          .At(Timestamp(0))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+TEST(HandLandmarkBatchTest, BatchedMatchesPerHand) {
+  constexpr int kNumHands = 3;
+  std::vector<Packet> per_hand_packets;
+  std::vector<Packet> batched_packets;
+  RunGraph(kPerHandGraph, kNumHands, &per_hand_packets);
+  RunGraph(kBatchedGraph, kNumHands, &batched_packets);
+  ASSERT_EQ(kNumHands, per_hand_packets.size());
+  ASSERT_EQ(kNumHands, batched_packets.size());
+  for (int i = 0; i < kNumHands; ++i) {
+    const auto& expected = per_hand_packets[i].Get<std::vector<Tensor>>();
+    const auto& actual = batched_packets[i].Get<std::vector<Tensor>>();
+    ASSERT_EQ(expected.size(), actual.size());
+    for (int t = 0; t < expected.size(); ++t) {
+      ASSERT_EQ(expected[t].shape().dims, actual[t].shape().dims);
+      auto expected_view = expected[t].GetCpuReadView();
+      auto actual_view = actual[t].GetCpuReadView();
+      const float* expected_data = expected_view.buffer<float>();
+      const float* actual_data = actual_view.buffer<float>();
+      for (int j = 0; j < expected[t].shape().num_elements(); ++j) {
+        EXPECT_NEAR(expected_data[j], actual_data[j], 1e-3f)
+            << "hand " << i << ", tensor " << t << ", element " << j;
+      }
+    }
+  }
+}
+
+// Measures the time per frame of the hand landmark inference for
+// state.range(0) hands.
+void RunHandLandmarkBenchmark(benchmark::State& state,
+                              const char* graph_config) {
+  CalculatorGraph graph;
+  MEDIAPIPE_CHECK_OK(graph.Initialize(
+      ParseTextProtoOrDie<CalculatorGraphConfig>(graph_config)));
+  MEDIAPIPE_CHECK_OK(graph.StartRun({}));
+  const Packet image = MakeImagePacket();
+  const Packet hand_rects =
+      MakePacket<std::vector<NormalizedRect>>(MakeHandRects(state.range(0)));
+  int64 timestamp = 0;
+  for (auto _ : state) {
+    MEDIAPIPE_CHECK_OK(graph.AddPacketToInputStream(
+        "image", image.At(Timestamp(timestamp))));
+    MEDIAPIPE_CHECK_OK(graph.AddPacketToInputStream(
+        "hand_rects", hand_rects.At(Timestamp(timestamp))));
+    MEDIAPIPE_CHECK_OK(graph.WaitUntilIdle());
+    ++timestamp;
+  }
+  MEDIAPIPE_CHECK_OK(graph.CloseAllInputStreams());
+  MEDIAPIPE_CHECK_OK(graph.WaitUntilDone());
+}
+
+void BM_PerHandLandmarks(benchmark::State& state) {
+  RunHandLandmarkBenchmark(state, kPerHandGraph);
+}
+BENCHMARK(BM_PerHandLandmarks)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_BatchedHandLandmarks(benchmark::State& state) {
+  RunHandLandmarkBenchmark(state, kBatchedGraph);
+}
+BENCHMARK(BM_BatchedHandLandmarks)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace mediapipe
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/vector.h"
@@ -66,6 +67,15 @@ cv::Scalar MediapipeColorToOpenCVColor(const Color& color) {
   return cv::Scalar(color.r(), color.g(), color.b());
 }
 
+// Converts the color to the per-channel values of ScanlineRasterizer, which
+// match those of MediapipeColorToOpenCVColor().
+void MediapipeColorToRasterizerColor(const Color& color, uint8_t values[4]) {
+  values[0] = cv::saturate_cast<uint8_t>(color.r());
+  values[1] = cv::saturate_cast<uint8_t>(color.g());
+  values[2] = cv::saturate_cast<uint8_t>(color.b());
+  values[3] = 0;
+}
+
 cv::RotatedRect RectangleToOpenCVRotatedRect(int left, int top, int right,
                                              int bottom, double rotation) {
   return cv::RotatedRect(
@@ -89,6 +99,14 @@ void cv_line2(cv::Mat& img, const cv::Point& start, const cv::Point& end,
 
 void AnnotationRenderer::RenderDataOnImage(const RenderData& render_data) {
   for (const auto& annotation : render_data.render_annotations()) {
+    // Points and lines may be queued to the rasterizer, draw them before any
+    // other annotation to keep the drawing order.
+    if (!rasterizer_.empty() &&
+        annotation.data_case() != RenderAnnotation::kPoint &&
+        annotation.data_case() != RenderAnnotation::kLine &&
+        annotation.data_case() != RenderAnnotation::kGradientLine) {
+      rasterizer_.Flush();
+    }
     if (annotation.data_case() == RenderAnnotation::kRectangle) {
       DrawRectangle(annotation);
     } else if (annotation.data_case() == RenderAnnotation::kRoundedRectangle) {
@@ -116,6 +134,7 @@ void AnnotationRenderer::RenderDataOnImage(const RenderData& render_data) {
       LOG(FATAL) << "Unknown annotation type: " << annotation.data_case();
     }
   }
+  rasterizer_.Flush();
 }
 
 void AnnotationRenderer::AdoptImage(cv::Mat* input_image) {
@@ -124,6 +143,8 @@ void AnnotationRenderer::AdoptImage(cv::Mat* input_image) {
 
   // No pixel data copy here, only headers are copied.
   mat_image_ = *input_image;
+  drawn_region_ = cv::Rect();
+  ResetRasterizer();
 }
 
 int AnnotationRenderer::GetImageWidth() const { return mat_image_.cols; }
@@ -137,6 +158,38 @@ void AnnotationRenderer::SetScaleFactor(float scale_factor) {
   if (scale_factor > 0.0f) scale_factor_ = std::min(scale_factor, 1.0f);
 }
 
+void AnnotationRenderer::SetUseScanlineRasterizer(
+    bool use_scanline_rasterizer) {
+  rasterizer_.Flush();
+  use_scanline_rasterizer_ = use_scanline_rasterizer;
+}
+
+bool AnnotationRenderer::UseRasterizer() const {
+  return use_scanline_rasterizer_ && mat_image_.depth() == CV_8U &&
+         (mat_image_.channels() == 1 || mat_image_.channels() == 3 ||
+          mat_image_.channels() == 4);
+}
+
+void AnnotationRenderer::ResetRasterizer() {
+  if (mat_image_.depth() != CV_8U) return;
+  const int channels = mat_image_.channels();
+  if (channels != 1 && channels != 3 && channels != 4) return;
+  rasterizer_.Reset(mat_image_.data, mat_image_.cols, mat_image_.rows,
+                    mat_image_.step, channels);
+}
+
+void AnnotationRenderer::AddDrawnRegion(int x0, int y0, int x1, int y1,
+                                        int margin) {
+  const cv::Rect region(cv::Point(std::min(x0, x1) - margin,
+                                  std::min(y0, y1) - margin),
+                        cv::Point(std::max(x0, x1) + margin + 1,
+                                  std::max(y0, y1) + margin + 1));
+  const cv::Rect clipped = region & cv::Rect(0, 0, mat_image_.cols,
+                                             mat_image_.rows);
+  if (clipped.empty()) return;
+  drawn_region_ = drawn_region_.empty() ? clipped : drawn_region_ | clipped;
+}
+
 void AnnotationRenderer::DrawRectangle(const RenderAnnotation& annotation) {
   int left = -1;
   int top = -1;
@@ -170,9 +223,13 @@ void AnnotationRenderer::DrawRectangle(const RenderAnnotation& annotation) {
       cv::line(mat_image_, vertices[i], vertices[(i + 1) % kNumVertices], color,
                thickness);
     }
+    const cv::Rect bounds = rect.boundingRect();
+    AddDrawnRegion(bounds.x, bounds.y, bounds.br().x, bounds.br().y,
+                   thickness);
   } else {
     cv::Rect rect(left, top, right - left, bottom - top);
     cv::rectangle(mat_image_, rect, color, thickness);
+    AddDrawnRegion(left, top, right, bottom, thickness);
   }
 }
 
@@ -210,9 +267,12 @@ void AnnotationRenderer::DrawFilledRectangle(
       vertices[i] = vertices2f[i];
     }
     cv::fillConvexPoly(mat_image_, vertices, kNumVertices, color);
+    const cv::Rect bounds = rect.boundingRect();
+    AddDrawnRegion(bounds.x, bounds.y, bounds.br().x, bounds.br().y, 1);
   } else {
     cv::Rect rect(left, top, right - left, bottom - top);
     cv::rectangle(mat_image_, rect, color, -1);
+    AddDrawnRegion(left, top, right, bottom, 0);
   }
 }
 
@@ -246,6 +306,7 @@ void AnnotationRenderer::DrawRoundedRectangle(
   DrawRoundedRectangle(mat_image_, cv::Point(left, top),
                        cv::Point(right, bottom), color, thickness, line_type,
                        corner_radius);
+  AddDrawnRegion(left, top, right, bottom, thickness);
 }
 
 void AnnotationRenderer::DrawFilledRoundedRectangle(
@@ -277,6 +338,7 @@ void AnnotationRenderer::DrawFilledRoundedRectangle(
   DrawRoundedRectangle(mat_image_, cv::Point(left, top),
                        cv::Point(right, bottom), color, -1, line_type,
                        corner_radius);
+  AddDrawnRegion(left, top, right, bottom, 1);
 }
 
 void AnnotationRenderer::DrawRoundedRectangle(cv::Mat src, cv::Point top_left,
@@ -349,6 +411,10 @@ void AnnotationRenderer::DrawOval(const RenderAnnotation& annotation) {
   const int thickness =
       ClampThickness(round(annotation.thickness() * scale_factor_));
   cv::ellipse(mat_image_, center, size, rotation, 0, 360, color, thickness);
+  // Any rotation of the oval is within the circle of its largest axis.
+  const int axis = std::max(std::abs(size.width), std::abs(size.height));
+  AddDrawnRegion(center.x - axis, center.y - axis, center.x + axis,
+                 center.y + axis, thickness);
 }
 
 void AnnotationRenderer::DrawFilledOval(const RenderAnnotation& annotation) {
@@ -377,6 +443,9 @@ void AnnotationRenderer::DrawFilledOval(const RenderAnnotation& annotation) {
   const double rotation = enclosing_rectangle.rotation() / M_PI * 180.f;
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
   cv::ellipse(mat_image_, center, size, rotation, 0, 360, color, -1);
+  const int axis = std::max(std::abs(size.width), std::abs(size.height));
+  AddDrawnRegion(center.x - axis, center.y - axis, center.x + axis,
+                 center.y + axis, 1);
 }
 
 void AnnotationRenderer::DrawArrow(const RenderAnnotation& annotation) {
@@ -427,6 +496,9 @@ void AnnotationRenderer::DrawArrow(const RenderAnnotation& annotation) {
                                  static_cast<int>(round(arrowtip_right[1])));
   cv::line(mat_image_, arrowtip_left_start, arrow_end, color, thickness);
   cv::line(mat_image_, arrowtip_right_start, arrow_end, color, thickness);
+  AddDrawnRegion(x_start, y_start, x_end, y_end, thickness);
+  AddDrawnRegion(arrowtip_left_start.x, arrowtip_left_start.y,
+                 arrowtip_right_start.x, arrowtip_right_start.y, thickness);
 }
 
 void AnnotationRenderer::DrawPoint(const RenderAnnotation& annotation) {
@@ -441,10 +513,19 @@ void AnnotationRenderer::DrawPoint(const RenderAnnotation& annotation) {
     y = static_cast<int>(point.y() * scale_factor_);
   }
 
-  cv::Point point_to_draw(x, y);
-  const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
   const int thickness =
       ClampThickness(round(annotation.thickness() * scale_factor_));
+  AddDrawnRegion(x, y, x, y, thickness);
+  if (UseRasterizer()) {
+    uint8_t color[4];
+    MediapipeColorToRasterizerColor(annotation.color(), color);
+    // cv::circle() also draws the pixels at exactly the radius.
+    rasterizer_.AddDisc(x, y, thickness + 0.5f, color);
+    return;
+  }
+
+  cv::Point point_to_draw(x, y);
+  const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
   cv::circle(mat_image_, point_to_draw, thickness, color, -1);
 }
 
@@ -468,11 +549,21 @@ void AnnotationRenderer::DrawLine(const RenderAnnotation& annotation) {
     y_end = static_cast<int>(line.y_end() * scale_factor_);
   }
 
+  const int thickness =
+      ClampThickness(round(annotation.thickness() * scale_factor_));
+  AddDrawnRegion(x_start, y_start, x_end, y_end, thickness);
+  if (UseRasterizer()) {
+    uint8_t color[4];
+    MediapipeColorToRasterizerColor(annotation.color(), color);
+    // Keep one pixel wide lines visible when they fall between pixel centers.
+    const float radius = std::max(thickness / 2.f, 0.75f);
+    rasterizer_.AddLine(x_start, y_start, x_end, y_end, radius, color, color);
+    return;
+  }
+
   cv::Point start(x_start, y_start);
   cv::Point end(x_end, y_end);
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
-  const int thickness =
-      ClampThickness(round(annotation.thickness() * scale_factor_));
   cv::line(mat_image_, start, end, color, thickness);
 }
 
@@ -496,10 +587,24 @@ void AnnotationRenderer::DrawGradientLine(const RenderAnnotation& annotation) {
     y_end = static_cast<int>(line.y_end() * scale_factor_);
   }
 
-  const cv::Point start(x_start, y_start);
-  const cv::Point end(x_end, y_end);
   const int thickness =
       ClampThickness(round(annotation.thickness() * scale_factor_));
+  AddDrawnRegion(x_start, y_start, x_end, y_end, thickness);
+  if (UseRasterizer()) {
+    uint8_t color1[4];
+    uint8_t color2[4];
+    MediapipeColorToRasterizerColor(line.color1(), color1);
+    MediapipeColorToRasterizerColor(line.color2(), color2);
+    // cv_line2() draws squares with their top-left corner on the line.
+    const float offset = (thickness - 1) / 2.f;
+    const float radius = std::max(thickness / 2.f, 0.75f);
+    rasterizer_.AddLine(x_start + offset, y_start + offset, x_end + offset,
+                        y_end + offset, radius, color1, color2);
+    return;
+  }
+
+  const cv::Point start(x_start, y_start);
+  const cv::Point end(x_end, y_end);
   const cv::Scalar color1 = MediapipeColorToOpenCVColor(line.color1());
   const cv::Scalar color2 = MediapipeColorToOpenCVColor(line.color2());
   cv_line2(mat_image_, start, end, color1, color2, thickness);
@@ -543,6 +648,11 @@ void AnnotationRenderer::DrawText(const RenderAnnotation& annotation) {
   cv::putText(mat_image_, text.display_text(), origin, font_face, font_scale,
               color, thickness, /*lineType=*/8,
               /*bottomLeftOrigin=*/flip_text_vertically_);
+  // The glyphs extend up to the text height above the origin, or below it when
+  // flipped, and up to the baseline offset on the other side.
+  const int extent = text_size.height + text_baseline;
+  AddDrawnRegion(origin.x, origin.y - extent, origin.x + text_size.width,
+                 origin.y + extent, thickness);
 }
 
 double AnnotationRenderer::ComputeFontScale(int font_face, int font_size,
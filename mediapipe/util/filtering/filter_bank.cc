@@ -0,0 +1,249 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/filter_bank.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr double kEpsilon = 0.000001;
+constexpr double kNanoSecondsToSecond = 1e-9;
+
+// Low pass filters |values| with per-value |alphas| into |filtered|, as
+// LowPassFilter::Apply does. The computation is kept in the same precision.
+void ApplyLowPass(bool initialized, const float* alphas, const float* values,
+                  float* stored_values, float* filtered, int num_values) {
+  if (!initialized) {
+    std::copy(values, values + num_values, stored_values);
+  } else {
+    for (int i = 0; i < num_values; ++i) {
+      stored_values[i] =
+          alphas[i] * values[i] + (1.0 - alphas[i]) * stored_values[i];
+    }
+  }
+  std::copy(stored_values, stored_values + num_values, filtered);
+}
+
+// Stores |alpha| into |*stored_alpha| unless it is out of the [0, 1] range,
+// as LowPassFilter::SetAlpha does. Returns false if it is out of range.
+inline bool SetAlpha(float alpha, float* stored_alpha) {
+  const bool valid = !(alpha < 0.0f || alpha > 1.0f);
+  *stored_alpha = valid ? alpha : *stored_alpha;
+  return valid;
+}
+
+}  // namespace
+
+RelativeVelocityFilterBank::RelativeVelocityFilterBank(
+    int num_values, int window_size, float velocity_scale,
+    DistanceEstimationMode distance_mode)
+    : num_values_(num_values),
+      window_size_(window_size),
+      velocity_scale_(velocity_scale),
+      distance_mode_(distance_mode),
+      last_values_(num_values, 0.0f),
+      window_durations_(window_size, 0),
+      window_distances_(window_size * num_values, 0.0f),
+      distances_(num_values),
+      cumulative_distances_(num_values),
+      alphas_(num_values, 1.0f),
+      stored_values_(num_values) {}
+
+void RelativeVelocityFilterBank::Apply(absl::Duration timestamp,
+                                       float value_scale,
+                                       absl::Span<const float> values,
+                                       absl::Span<float> filtered) {
+  DCHECK_EQ(static_cast<int>(values.size()), num_values_);
+  DCHECK_EQ(static_cast<int>(filtered.size()), num_values_);
+  const int64_t new_timestamp = absl::ToInt64Nanoseconds(timestamp);
+  if (last_timestamp_ >= new_timestamp) {
+    // Results are unpredictable in this case, so nothing to do but
+    // return same values
+    LOG(WARNING) << "New timestamp is equal or less than the last one.";
+    std::copy(values.begin(), values.end(), filtered.begin());
+    return;
+  }
+
+  if (last_timestamp_ == -1) {
+    std::fill(alphas_.begin(), alphas_.end(), 1.0f);
+  } else {
+    DCHECK(distance_mode_ == DistanceEstimationMode::kLegacyTransition ||
+           distance_mode_ == DistanceEstimationMode::kForceCurrentScale);
+    const float* last_values = last_values_.data();
+    float* distances = distances_.data();
+    if (distance_mode_ == DistanceEstimationMode::kLegacyTransition) {
+      const float last_value_scale = last_value_scale_;
+      for (int i = 0; i < num_values_; ++i) {
+        distances[i] =
+            values[i] * value_scale - last_values[i] * last_value_scale;
+      }
+    } else {
+      for (int i = 0; i < num_values_; ++i) {
+        distances[i] = value_scale * (values[i] - last_values[i]);
+      }
+    }
+
+    // All values share the timestamps, so the window elements to accumulate
+    // are the same for every value.
+    auto window_slot = [this](int k) {
+      return (window_start_ + k) % window_size_;
+    };
+    const int64_t duration = new_timestamp - last_timestamp_;
+    constexpr int64_t kAssumedMaxDuration = 1000000000 / 30;
+    const int64_t max_cumulative_duration =
+        (1 + window_size_) * kAssumedMaxDuration;
+    int64_t cumulative_duration = duration;
+    int num_window_elements = 0;
+    for (; num_window_elements < window_size_; ++num_window_elements) {
+      const int64_t element_duration =
+          window_durations_[window_slot(num_window_elements)];
+      if (cumulative_duration + element_duration > max_cumulative_duration) {
+        break;
+      }
+      cumulative_duration += element_duration;
+    }
+
+    // Accumulate from the newest to the oldest element, as the filter does.
+    float* cumulative_distances = cumulative_distances_.data();
+    std::copy(distances, distances + num_values_, cumulative_distances);
+    for (int k = 0; k < num_window_elements; ++k) {
+      const float* element_distances =
+          window_distances_.data() +
+          static_cast<int64_t>(window_slot(k)) * num_values_;
+      for (int i = 0; i < num_values_; ++i) {
+        cumulative_distances[i] += element_distances[i];
+      }
+    }
+
+    const double cumulative_seconds =
+        cumulative_duration * kNanoSecondsToSecond;
+    const float velocity_scale = velocity_scale_;
+    float* alphas = alphas_.data();
+    bool all_valid = true;
+    for (int i = 0; i < num_values_; ++i) {
+      const float velocity = cumulative_distances[i] / cumulative_seconds;
+      const float alpha =
+          1.0f - 1.0f / (1.0f + velocity_scale * std::abs(velocity));
+      all_valid &= SetAlpha(alpha, &alphas[i]);
+    }
+    if (!all_valid) {
+      LOG(ERROR) << "alpha should be in [0.0, 1.0] range";
+    }
+
+    if (window_size_ > 0) {
+      window_start_ = (window_start_ + window_size_ - 1) % window_size_;
+      window_durations_[window_start_] = duration;
+      std::copy(distances, distances + num_values_,
+                window_distances_.data() +
+                    static_cast<int64_t>(window_start_) * num_values_);
+    }
+  }
+
+  std::copy(values.begin(), values.end(), last_values_.begin());
+  last_value_scale_ = value_scale;
+  last_timestamp_ = new_timestamp;
+
+  ApplyLowPass(initialized_, alphas_.data(), values.data(),
+               stored_values_.data(), filtered.data(), num_values_);
+  initialized_ = true;
+}
+
+OneEuroFilterBank::OneEuroFilterBank(int num_values, double frequency,
+                                     double min_cutoff, double beta,
+                                     double derivate_cutoff)
+    : num_values_(num_values),
+      frequency_(frequency),
+      min_cutoff_(min_cutoff),
+      beta_(beta),
+      derivate_cutoff_(derivate_cutoff),
+      raw_values_(num_values),
+      stored_values_(num_values),
+      stored_derivates_(num_values) {
+  if (frequency <= kEpsilon) {
+    LOG(ERROR) << "frequency should be > 0";
+  }
+  if (min_cutoff <= kEpsilon) {
+    LOG(ERROR) << "min_cutoff should be > 0";
+  }
+  if (derivate_cutoff <= kEpsilon) {
+    LOG(ERROR) << "derivate_cutoff should be > 0";
+  }
+  alphas_.assign(num_values, GetAlpha(min_cutoff));
+  derivate_alpha_ = GetAlpha(derivate_cutoff);
+}
+
+void OneEuroFilterBank::Apply(absl::Duration timestamp,
+                              absl::Span<const float> values,
+                              absl::Span<float> filtered) {
+  DCHECK_EQ(static_cast<int>(values.size()), num_values_);
+  DCHECK_EQ(static_cast<int>(filtered.size()), num_values_);
+  int64_t new_timestamp = absl::ToInt64Nanoseconds(timestamp);
+  if (last_time_ >= new_timestamp) {
+    // Results are unpredictable in this case, so nothing to do but
+    // return same values
+    LOG(WARNING) << "New timestamp is equal or less than the last one.";
+    std::copy(values.begin(), values.end(), filtered.begin());
+    return;
+  }
+
+  // update the sampling frequency based on timestamps
+  if (last_time_ != 0 && new_timestamp != 0) {
+    frequency_ = 1.0 / ((new_timestamp - last_time_) * kNanoSecondsToSecond);
+  }
+  last_time_ = new_timestamp;
+
+  bool all_valid = SetAlpha(GetAlpha(derivate_cutoff_), &derivate_alpha_);
+
+  // Estimate the current variation per second of every value, filter it and
+  // use it to update the cutoff frequency of the value.
+  const double frequency = frequency_;
+  const float derivate_alpha = derivate_alpha_;
+  const float* raw_values = raw_values_.data();
+  float* stored_derivates = stored_derivates_.data();
+  float* alphas = alphas_.data();
+  for (int i = 0; i < num_values_; ++i) {
+    const float dvalue =
+        initialized_ ? (values[i] - raw_values[i]) * frequency : 0.0;
+    const float edvalue =
+        initialized_ ? static_cast<float>(derivate_alpha * dvalue +
+                                          (1.0 - derivate_alpha) *
+                                              stored_derivates[i])
+                     : dvalue;
+    stored_derivates[i] = edvalue;
+    const double cutoff = min_cutoff_ + beta_ * std::fabs(edvalue);
+    all_valid &= SetAlpha(GetAlpha(cutoff), &alphas[i]);
+  }
+  if (!all_valid) {
+    LOG(ERROR) << "alpha should be in [0.0, 1.0] range";
+  }
+
+  std::copy(values.begin(), values.end(), raw_values_.begin());
+  ApplyLowPass(initialized_, alphas_.data(), values.data(),
+               stored_values_.data(), filtered.data(), num_values_);
+  initialized_ = true;
+}
+
+double OneEuroFilterBank::GetAlpha(double cutoff) const {
+  double te = 1.0 / frequency_;
+  double tau = 1.0 / (2 * M_PI * cutoff);
+  return 1.0 / (1.0 + tau / te);
+}
+
+}  // namespace mediapipe
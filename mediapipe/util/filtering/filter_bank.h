@@ -0,0 +1,110 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_FILTERING_FILTER_BANK_H_
+#define MEDIAPIPE_UTIL_FILTERING_FILTER_BANK_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "mediapipe/util/filtering/relative_velocity_filter.h"
+
+namespace mediapipe {
+
+// Filters a fixed number of values that are sampled together, such as the
+// coordinates of a set of landmarks, with one RelativeVelocityFilter per
+// value. The state of all filters is kept in contiguous arrays and the window
+// of value changes in a ring buffer, so that every value is updated by the
+// same loops. The results are the same as those of the individual filters.
+class RelativeVelocityFilterBank {
+ public:
+  using DistanceEstimationMode = RelativeVelocityFilter::DistanceEstimationMode;
+
+  RelativeVelocityFilterBank(int num_values, int window_size,
+                             float velocity_scale,
+                             DistanceEstimationMode distance_mode =
+                                 DistanceEstimationMode::kDefault);
+
+  int num_values() const { return num_values_; }
+
+  // Filters |values| into |filtered|, which both have num_values() elements
+  // and may be the same. See RelativeVelocityFilter::Apply for the arguments.
+  void Apply(absl::Duration timestamp, float value_scale,
+             absl::Span<const float> values, absl::Span<float> filtered);
+
+ private:
+  int num_values_;
+  int window_size_;
+  float velocity_scale_;
+  DistanceEstimationMode distance_mode_;
+
+  float last_value_scale_ = 1.0f;
+  int64_t last_timestamp_ = -1;
+  std::vector<float> last_values_;
+
+  // Ring buffer of the last |window_size_| value changes, newest first from
+  // |window_start_|. The distances of window element k are stored at
+  // [k * num_values_, (k + 1) * num_values_).
+  int window_start_ = 0;
+  std::vector<int64_t> window_durations_;
+  std::vector<float> window_distances_;
+
+  std::vector<float> distances_;
+  std::vector<float> cumulative_distances_;
+
+  // Low pass filter state.
+  bool initialized_ = false;
+  std::vector<float> alphas_;
+  std::vector<float> stored_values_;
+};
+
+// Filters a fixed number of values that are sampled together with one
+// OneEuroFilter per value, with the state of all filters kept in contiguous
+// arrays. The results are the same as those of the individual filters.
+class OneEuroFilterBank {
+ public:
+  OneEuroFilterBank(int num_values, double frequency, double min_cutoff,
+                    double beta, double derivate_cutoff);
+
+  int num_values() const { return num_values_; }
+
+  // Filters |values| into |filtered|, which both have num_values() elements
+  // and may be the same.
+  void Apply(absl::Duration timestamp, absl::Span<const float> values,
+             absl::Span<float> filtered);
+
+ private:
+  double GetAlpha(double cutoff) const;
+
+  int num_values_;
+  double frequency_;
+  double min_cutoff_;
+  double beta_;
+  double derivate_cutoff_;
+  int64_t last_time_ = 0;
+
+  // Low pass filter state of the values and of their derivates.
+  bool initialized_ = false;
+  std::vector<float> raw_values_;
+  std::vector<float> alphas_;
+  std::vector<float> stored_values_;
+  float derivate_alpha_;
+  std::vector<float> stored_derivates_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_FILTERING_FILTER_BANK_H_
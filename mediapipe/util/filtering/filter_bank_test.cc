@@ -0,0 +1,222 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/filter_bank.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/filtering/one_euro_filter.h"
+#include "mediapipe/util/filtering/relative_velocity_filter.h"
+
+namespace mediapipe {
+namespace {
+
+using DistanceEstimationMode =
+    mediapipe::RelativeVelocityFilter::DistanceEstimationMode;
+
+constexpr int kNumValues = 33;
+constexpr int kNumFrames = 60;
+
+// Returns frame timestamps in milliseconds with irregular intervals, a long
+// gap and a repeated timestamp.
+std::vector<int64_t> MakeTimestamps() {
+  std::vector<int64_t> timestamps;
+  int64_t timestamp = 0;
+  for (int i = 0; i < kNumFrames; ++i) {
+    timestamps.push_back(timestamp);
+    if (i == 20) continue;
+    timestamp += i == 40 ? 500 : 20 + (i * 7) % 30;
+  }
+  return timestamps;
+}
+
+// Returns a random walk of kNumValues values for every frame.
+std::vector<std::vector<float>> MakeValues() {
+  std::mt19937 generator(0);
+  std::normal_distribution<float> step_distribution(0.0f, 4.0f);
+  std::vector<std::vector<float>> values(kNumFrames);
+  std::vector<float> value(kNumValues, 100.0f);
+  for (auto& frame_values : values) {
+    for (float& v : value) v += step_distribution(generator);
+    frame_values = value;
+  }
+  return values;
+}
+
+void ExpectBankMatchesFilters(int window_size, float velocity_scale,
+                              DistanceEstimationMode distance_mode) {
+  const std::vector<int64_t> timestamps = MakeTimestamps();
+  const std::vector<std::vector<float>> values = MakeValues();
+  std::vector<RelativeVelocityFilter> filters(
+      kNumValues,
+      RelativeVelocityFilter(window_size, velocity_scale, distance_mode));
+  RelativeVelocityFilterBank bank(kNumValues, window_size, velocity_scale,
+                                  distance_mode);
+
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    const absl::Duration timestamp = absl::Milliseconds(timestamps[frame]);
+    const float value_scale = 1.0f / (50.0f + frame % 7);
+    // Filter in place to check that the bank supports it.
+    std::vector<float> filtered = values[frame];
+    bank.Apply(timestamp, value_scale, filtered, absl::MakeSpan(filtered));
+    for (int i = 0; i < kNumValues; ++i) {
+      ASSERT_FLOAT_EQ(
+          filters[i].Apply(timestamp, value_scale, values[frame][i]),
+          filtered[i])
+          << "frame " << frame << " value " << i;
+    }
+  }
+}
+
+TEST(RelativeVelocityFilterBankTest, MatchesFilters) {
+  for (auto distance_mode : {DistanceEstimationMode::kLegacyTransition,
+                             DistanceEstimationMode::kForceCurrentScale}) {
+    ExpectBankMatchesFilters(/*window_size=*/5, /*velocity_scale=*/10.0f,
+                             distance_mode);
+    ExpectBankMatchesFilters(/*window_size=*/1, /*velocity_scale=*/45.0f,
+                             distance_mode);
+    ExpectBankMatchesFilters(/*window_size=*/0, /*velocity_scale=*/0.1f,
+                             distance_mode);
+  }
+}
+
+void ExpectBankMatchesFilters(double frequency, double min_cutoff,
+                              double beta, double derivate_cutoff) {
+  const std::vector<int64_t> timestamps = MakeTimestamps();
+  const std::vector<std::vector<float>> values = MakeValues();
+  std::vector<OneEuroFilter> filters;
+  for (int i = 0; i < kNumValues; ++i) {
+    filters.emplace_back(frequency, min_cutoff, beta, derivate_cutoff);
+  }
+  OneEuroFilterBank bank(kNumValues, frequency, min_cutoff, beta,
+                         derivate_cutoff);
+
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    // The first timestamp is zero, which the filter ignores.
+    const absl::Duration timestamp = absl::Milliseconds(timestamps[frame]);
+    std::vector<float> filtered(kNumValues);
+    bank.Apply(timestamp, values[frame], absl::MakeSpan(filtered));
+    for (int i = 0; i < kNumValues; ++i) {
+      ASSERT_FLOAT_EQ(filters[i].Apply(timestamp, values[frame][i]),
+                      filtered[i])
+          << "frame " << frame << " value " << i;
+    }
+  }
+}
+
+TEST(OneEuroFilterBankTest, MatchesFilters) {
+  ExpectBankMatchesFilters(/*frequency=*/30.0, /*min_cutoff=*/1.0,
+                           /*beta=*/0.0, /*derivate_cutoff=*/1.0);
+  ExpectBankMatchesFilters(/*frequency=*/30.0, /*min_cutoff=*/0.05,
+                           /*beta=*/80.0, /*derivate_cutoff=*/1.0);
+  ExpectBankMatchesFilters(/*frequency=*/0.033, /*min_cutoff=*/2.0,
+                           /*beta=*/0.5, /*derivate_cutoff=*/5.0);
+}
+
+// Filters the benchmark argument number of values, e.g. the coordinates of
+// the 468 face mesh landmarks, over 30 frames per second.
+void BM_RelativeVelocityFilter(benchmark::State& state) {
+  const int num_values = state.range(0);
+  std::vector<RelativeVelocityFilter> filters(
+      num_values, RelativeVelocityFilter(/*window_size=*/5,
+                                         /*velocity_scale=*/10.0f));
+  std::vector<float> values(num_values, 100.0f);
+  std::vector<float> filtered(num_values);
+  int64_t timestamp = 0;
+  for (auto _ : state) {
+    timestamp += 33;
+    for (int i = 0; i < num_values; ++i) {
+      values[i] += (i + timestamp) % 5 - 2.0f;
+      filtered[i] =
+          filters[i].Apply(absl::Milliseconds(timestamp), 0.01f, values[i]);
+    }
+  }
+}
+BENCHMARK(BM_RelativeVelocityFilter)
+    ->Arg(21 * 3)
+    ->Arg(468 * 3)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_RelativeVelocityFilterBank(benchmark::State& state) {
+  const int num_values = state.range(0);
+  RelativeVelocityFilterBank bank(num_values, /*window_size=*/5,
+                                  /*velocity_scale=*/10.0f);
+  std::vector<float> values(num_values, 100.0f);
+  std::vector<float> filtered(num_values);
+  int64_t timestamp = 0;
+  for (auto _ : state) {
+    timestamp += 33;
+    for (int i = 0; i < num_values; ++i) {
+      values[i] += (i + timestamp) % 5 - 2.0f;
+    }
+    bank.Apply(absl::Milliseconds(timestamp), 0.01f, values,
+               absl::MakeSpan(filtered));
+  }
+}
+BENCHMARK(BM_RelativeVelocityFilterBank)
+    ->Arg(21 * 3)
+    ->Arg(468 * 3)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_OneEuroFilter(benchmark::State& state) {
+  const int num_values = state.range(0);
+  std::vector<OneEuroFilter> filters;
+  for (int i = 0; i < num_values; ++i) {
+    filters.emplace_back(/*frequency=*/30.0, /*min_cutoff=*/0.05,
+                         /*beta=*/80.0, /*derivate_cutoff=*/1.0);
+  }
+  std::vector<float> values(num_values, 100.0f);
+  std::vector<float> filtered(num_values);
+  int64_t timestamp = 0;
+  for (auto _ : state) {
+    timestamp += 33;
+    for (int i = 0; i < num_values; ++i) {
+      values[i] += (i + timestamp) % 5 - 2.0f;
+      filtered[i] = filters[i].Apply(absl::Milliseconds(timestamp), values[i]);
+    }
+  }
+}
+BENCHMARK(BM_OneEuroFilter)
+    ->Arg(21 * 3)
+    ->Arg(468 * 3)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_OneEuroFilterBank(benchmark::State& state) {
+  const int num_values = state.range(0);
+  OneEuroFilterBank bank(num_values, /*frequency=*/30.0, /*min_cutoff=*/0.05,
+                         /*beta=*/80.0, /*derivate_cutoff=*/1.0);
+  std::vector<float> values(num_values, 100.0f);
+  std::vector<float> filtered(num_values);
+  int64_t timestamp = 0;
+  for (auto _ : state) {
+    timestamp += 33;
+    for (int i = 0; i < num_values; ++i) {
+      values[i] += (i + timestamp) % 5 - 2.0f;
+    }
+    bank.Apply(absl::Milliseconds(timestamp), values,
+               absl::MakeSpan(filtered));
+  }
+}
+BENCHMARK(BM_OneEuroFilterBank)
+    ->Arg(21 * 3)
+    ->Arg(468 * 3)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace mediapipe
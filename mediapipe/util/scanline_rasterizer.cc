@@ -0,0 +1,206 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/scanline_rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+// Returns |value| clamped to [lower, upper].
+float ClampToRange(float value, float lower, float upper) {
+  return std::min(std::max(value, lower), upper);
+}
+
+// Intersects [*begin, *end] with the solutions u of lower <= a * u <= upper.
+void IntersectLinear(float a, float lower, float upper, float* begin,
+                     float* end) {
+  if (a > 0) {
+    *begin = std::max(*begin, lower / a);
+    *end = std::min(*end, upper / a);
+  } else if (a < 0) {
+    *begin = std::max(*begin, upper / a);
+    *end = std::min(*end, lower / a);
+  } else if (lower > 0 || upper < 0) {
+    *begin = kInfinity;
+    *end = -kInfinity;
+  }
+}
+
+// Extends [*begin, *end] to the span of the disc centered at |x| on a row at
+// vertical distance |dy| from its center.
+void UniteDisc(float x, float dy, float radius, float* begin, float* end) {
+  const float half_width_squared = radius * radius - dy * dy;
+  if (half_width_squared < 0) return;
+  const float half_width = std::sqrt(half_width_squared);
+  *begin = std::min(*begin, x - half_width);
+  *end = std::max(*end, x + half_width);
+}
+
+// Fills the pixels [begin, end] of |row|. The fixed channel count lets the
+// compiler unroll and vectorize the loop.
+template <int kChannels>
+void FillSpan(uint8_t* row, int begin, int end, const uint8_t color[4]) {
+  uint8_t* pixel = row + begin * kChannels;
+  for (int x = begin; x <= end; ++x, pixel += kChannels) {
+    for (int c = 0; c < kChannels; ++c) {
+      pixel[c] = color[c];
+    }
+  }
+}
+
+// Fills the pixels [begin, end] of |row| with the color at t = t0 + x * dt
+// between |color0| and |color1|.
+template <int kChannels>
+void FillGradientSpan(uint8_t* row, int begin, int end, float t0, float dt,
+                      const uint8_t color0[4], const uint8_t color1[4]) {
+  float base[kChannels];
+  float delta[kChannels];
+  for (int c = 0; c < kChannels; ++c) {
+    base[c] = color0[c] + 0.5f;
+    delta[c] = static_cast<float>(color1[c]) - color0[c];
+  }
+  uint8_t* pixel = row + begin * kChannels;
+  for (int x = begin; x <= end; ++x, pixel += kChannels) {
+    const float t = std::min(std::max(t0 + x * dt, 0.f), 1.f);
+    for (int c = 0; c < kChannels; ++c) {
+      pixel[c] = static_cast<uint8_t>(base[c] + delta[c] * t);
+    }
+  }
+}
+
+}  // namespace
+
+void ScanlineRasterizer::Reset(uint8_t* pixels, int width, int height,
+                               int step, int channels) {
+  CHECK(channels == 1 || channels == 3 || channels == 4);
+  pixels_ = pixels;
+  width_ = width;
+  height_ = height;
+  step_ = step;
+  channels_ = channels;
+  primitives_.clear();
+}
+
+void ScanlineRasterizer::AddLine(float x0, float y0, float x1, float y1,
+                                 float radius, const uint8_t color0[4],
+                                 const uint8_t color1[4]) {
+  Primitive primitive = {x0, y0, x1, y1, radius};
+  std::memcpy(primitive.color0, color0, sizeof(primitive.color0));
+  std::memcpy(primitive.color1, color1, sizeof(primitive.color1));
+  primitives_.push_back(primitive);
+}
+
+void ScanlineRasterizer::AddDisc(float x, float y, float radius,
+                                 const uint8_t color[4]) {
+  AddLine(x, y, x, y, radius, color, color);
+}
+
+void ScanlineRasterizer::Flush() {
+  for (const Primitive& primitive : primitives_) {
+    Draw(primitive);
+  }
+  primitives_.clear();
+}
+
+void ScanlineRasterizer::Draw(const Primitive& p) {
+  const float radius = p.radius;
+  const float dx = p.x1 - p.x0;
+  const float dy = p.y1 - p.y0;
+  const float length_squared = dx * dx + dy * dy;
+  // Skips NaN and infinite coordinates, and segments too long to measure,
+  // whose spans can not be computed.
+  if (!std::isfinite(p.x0) || !std::isfinite(p.y0) || !std::isfinite(radius) ||
+      !std::isfinite(length_squared)) {
+    return;
+  }
+  // Rows and columns are clamped to the image as floats, since converting an
+  // out of range float to int is undefined.
+  const int y_begin = static_cast<int>(std::ceil(ClampToRange(
+      std::min(p.y0, p.y1) - radius, 0.f, static_cast<float>(height_))));
+  const int y_end = static_cast<int>(std::floor(ClampToRange(
+      std::max(p.y0, p.y1) + radius, -1.f, static_cast<float>(height_ - 1))));
+  const float length = std::sqrt(length_squared);
+  const bool gradient = length_squared > 0 &&
+                        std::memcmp(p.color0, p.color1, channels_) != 0;
+
+  for (int y = y_begin; y <= y_end; ++y) {
+    // The span of the round caps, then of the body in coordinates relative to
+    // (x0, y0): its projection on the segment is within the segment, and its
+    // distance to the segment line is at most the radius.
+    const float v = y - p.y0;
+    float begin = kInfinity;
+    float end = -kInfinity;
+    UniteDisc(p.x0, v, radius, &begin, &end);
+    UniteDisc(p.x1, y - p.y1, radius, &begin, &end);
+    if (length_squared > 0) {
+      float body_begin = -kInfinity;
+      float body_end = kInfinity;
+      IntersectLinear(dx, -v * dy, length_squared - v * dy, &body_begin,
+                      &body_end);
+      IntersectLinear(dy, v * dx - radius * length, v * dx + radius * length,
+                      &body_begin, &body_end);
+      if (body_begin <= body_end) {
+        begin = std::min(begin, p.x0 + body_begin);
+        end = std::max(end, p.x0 + body_end);
+      }
+    }
+    if (!(begin <= end)) continue;
+    const int x_begin = static_cast<int>(
+        std::ceil(ClampToRange(begin, 0.f, static_cast<float>(width_))));
+    const int x_end = static_cast<int>(
+        std::floor(ClampToRange(end, -1.f, static_cast<float>(width_ - 1))));
+    if (x_begin > x_end) continue;
+
+    uint8_t* row = pixels_ + static_cast<size_t>(y) * step_;
+    if (gradient) {
+      // The position t of the pixel projection along the segment.
+      const float dt = dx / length_squared;
+      const float t0 = (v * dy - p.x0 * dx) / length_squared;
+      switch (channels_) {
+        case 1:
+          FillGradientSpan<1>(row, x_begin, x_end, t0, dt, p.color0, p.color1);
+          break;
+        case 3:
+          FillGradientSpan<3>(row, x_begin, x_end, t0, dt, p.color0, p.color1);
+          break;
+        default:
+          FillGradientSpan<4>(row, x_begin, x_end, t0, dt, p.color0, p.color1);
+          break;
+      }
+    } else {
+      switch (channels_) {
+        case 1:
+          std::memset(row + x_begin, p.color0[0], x_end - x_begin + 1);
+          break;
+        case 3:
+          FillSpan<3>(row, x_begin, x_end, p.color0);
+          break;
+        default:
+          FillSpan<4>(row, x_begin, x_end, p.color0);
+          break;
+      }
+    }
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,236 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/scanline_rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kWidth = 64;
+constexpr int kHeight = 48;
+constexpr int kChannels = 3;
+constexpr uint8_t kWhite[4] = {255, 255, 255, 0};
+
+// Distance from (x, y) to the segment from (x0, y0) to (x1, y1).
+float SegmentDistance(float x, float y, float x0, float y0, float x1,
+                      float y1) {
+  const float dx = x1 - x0;
+  const float dy = y1 - y0;
+  const float length_squared = dx * dx + dy * dy;
+  float t = 0;
+  if (length_squared > 0) {
+    t = std::min(std::max(((x - x0) * dx + (y - y0) * dy) / length_squared,
+                          0.f),
+                 1.f);
+  }
+  return std::hypot(x - (x0 + t * dx), y - (y0 + t * dy));
+}
+
+// Checks that exactly the pixels within |radius| of the segment are drawn,
+// up to rounding at the boundary.
+void ExpectSegmentPixels(const std::vector<uint8_t>& image, float x0, float y0,
+                         float x1, float y1, float radius) {
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      const float distance = SegmentDistance(x, y, x0, y0, x1, y1);
+      if (std::abs(distance - radius) < 1e-3f) continue;
+      const bool drawn = image[(y * kWidth + x) * kChannels] != 0;
+      EXPECT_EQ(drawn, distance < radius)
+          << "at (" << x << ", " << y << "), distance " << distance;
+    }
+  }
+}
+
+class ScanlineRasterizerTest : public ::testing::Test {
+ protected:
+  ScanlineRasterizerTest() : image_(kWidth * kHeight * kChannels, 0) {
+    rasterizer_.Reset(image_.data(), kWidth, kHeight, kWidth * kChannels,
+                      kChannels);
+  }
+
+  std::vector<uint8_t> image_;
+  ScanlineRasterizer rasterizer_;
+};
+
+TEST_F(ScanlineRasterizerTest, DrawsDisc) {
+  rasterizer_.AddDisc(20.3f, 15.6f, 6.5f, kWhite);
+  EXPECT_FALSE(rasterizer_.empty());
+  rasterizer_.Flush();
+  EXPECT_TRUE(rasterizer_.empty());
+  ExpectSegmentPixels(image_, 20.3f, 15.6f, 20.3f, 15.6f, 6.5f);
+}
+
+TEST_F(ScanlineRasterizerTest, DrawsLines) {
+  std::mt19937 random(0);
+  std::uniform_real_distribution<float> x_distribution(0, kWidth);
+  std::uniform_real_distribution<float> y_distribution(0, kHeight);
+  std::uniform_real_distribution<float> radius_distribution(0.5f, 5.f);
+  for (int i = 0; i < 20; ++i) {
+    std::fill(image_.begin(), image_.end(), 0);
+    const float x0 = x_distribution(random);
+    const float y0 = y_distribution(random);
+    const float x1 = x_distribution(random);
+    const float y1 = y_distribution(random);
+    const float radius = radius_distribution(random);
+    rasterizer_.AddLine(x0, y0, x1, y1, radius, kWhite, kWhite);
+    rasterizer_.Flush();
+    ExpectSegmentPixels(image_, x0, y0, x1, y1, radius);
+  }
+}
+
+TEST_F(ScanlineRasterizerTest, DrawsAxisAlignedLines) {
+  rasterizer_.AddLine(10, 10, 40, 10, 2.5f, kWhite, kWhite);
+  rasterizer_.Flush();
+  ExpectSegmentPixels(image_, 10, 10, 40, 10, 2.5f);
+
+  std::fill(image_.begin(), image_.end(), 0);
+  rasterizer_.AddLine(30, 5, 30, 40, 0.5f, kWhite, kWhite);
+  rasterizer_.Flush();
+  ExpectSegmentPixels(image_, 30, 5, 30, 40, 0.5f);
+}
+
+TEST_F(ScanlineRasterizerTest, ClipsToImage) {
+  rasterizer_.AddLine(-20, -10, kWidth + 20, kHeight + 10, 3, kWhite, kWhite);
+  rasterizer_.AddDisc(kWidth, kHeight, 10, kWhite);
+  rasterizer_.Flush();
+  EXPECT_EQ(image_[0], 255);
+  EXPECT_EQ(image_.back(), 255);
+}
+
+TEST_F(ScanlineRasterizerTest, SkipsNonFiniteCoordinates) {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float infinity = std::numeric_limits<float>::infinity();
+  rasterizer_.AddDisc(nan, 10, 5, kWhite);
+  rasterizer_.AddDisc(10, nan, 5, kWhite);
+  rasterizer_.AddLine(10, 10, infinity, 10, 2, kWhite, kWhite);
+  rasterizer_.AddLine(10, 10, 20, 20, nan, kWhite, kWhite);
+  rasterizer_.Flush();
+  EXPECT_EQ(std::count(image_.begin(), image_.end(), 0), image_.size());
+
+  // Coordinates beyond the range of int are clamped to the image.
+  rasterizer_.AddLine(-1e15f, 10, 1e15f, 10, 1e10f, kWhite, kWhite);
+  rasterizer_.Flush();
+  EXPECT_EQ(std::count(image_.begin(), image_.end(), 255), image_.size());
+}
+
+TEST_F(ScanlineRasterizerTest, InterpolatesGradient) {
+  const uint8_t black[4] = {0, 0, 0, 0};
+  const uint8_t color[4] = {200, 100, 50, 0};
+  rasterizer_.AddLine(10, 20, 50, 20, 1, black, color);
+  rasterizer_.Flush();
+  const uint8_t* middle = &image_[(20 * kWidth + 30) * kChannels];
+  EXPECT_EQ(middle[0], 100);
+  EXPECT_EQ(middle[1], 50);
+  EXPECT_EQ(middle[2], 25);
+  const uint8_t* end = &image_[(20 * kWidth + 50) * kChannels];
+  EXPECT_EQ(end[0], 200);
+}
+
+TEST_F(ScanlineRasterizerTest, DrawsInOrder) {
+  const uint8_t red[4] = {255, 0, 0, 0};
+  rasterizer_.AddDisc(20, 20, 5, kWhite);
+  rasterizer_.AddDisc(20, 20, 2, red);
+  rasterizer_.Flush();
+  const uint8_t* center = &image_[(20 * kWidth + 20) * kChannels];
+  EXPECT_EQ(center[0], 255);
+  EXPECT_EQ(center[1], 0);
+}
+
+// Lines and points with the counts and sizes of face mesh landmarks on a
+// 1280x720 frame.
+void BM_FaceMesh(benchmark::State& state) {
+  constexpr int kImageWidth = 1280;
+  constexpr int kImageHeight = 720;
+  std::vector<uint8_t> image(kImageWidth * kImageHeight * kChannels);
+  std::mt19937 random(0);
+  std::uniform_real_distribution<float> x_distribution(400, 880);
+  std::uniform_real_distribution<float> y_distribution(120, 600);
+  std::uniform_real_distribution<float> offset_distribution(-10, 10);
+  std::vector<float> points;
+  for (int i = 0; i < 1300; ++i) {
+    const float x = x_distribution(random);
+    const float y = y_distribution(random);
+    points.insert(points.end(), {x, y, x + offset_distribution(random),
+                                 y + offset_distribution(random)});
+  }
+  ScanlineRasterizer rasterizer;
+  for (auto _ : state) {
+    rasterizer.Reset(image.data(), kImageWidth, kImageHeight,
+                     kImageWidth * kChannels, kChannels);
+    for (size_t i = 0; i < points.size(); i += 4) {
+      rasterizer.AddLine(points[i], points[i + 1], points[i + 2],
+                         points[i + 3], 1, kWhite, kWhite);
+    }
+    for (int i = 0; i < 468 * 4; i += 4) {
+      rasterizer.AddDisc(points[i], points[i + 1], 2, kWhite);
+    }
+    rasterizer.Flush();
+  }
+}
+BENCHMARK(BM_FaceMesh)->Unit(benchmark::kMicrosecond);
+
+// Depth-colored connections and points with the counts and sizes of two hands
+// of landmarks, as drawn by the hand renderer, on a 1280x720 frame.
+void BM_HandLandmarks(benchmark::State& state) {
+  constexpr int kImageWidth = 1280;
+  constexpr int kImageHeight = 720;
+  constexpr int kNumHands = 2;
+  constexpr int kNumLandmarks = 21;
+  std::vector<uint8_t> image(kImageWidth * kImageHeight * kChannels);
+  std::mt19937 random(0);
+  // Each hand is within a box of 200x200 pixels.
+  std::uniform_real_distribution<float> offset_distribution(0, 200);
+  std::vector<float> points;
+  for (int hand = 0; hand < kNumHands; ++hand) {
+    for (int i = 0; i < kNumLandmarks; ++i) {
+      points.push_back(300 + 400 * hand + offset_distribution(random));
+      points.push_back(250 + offset_distribution(random));
+    }
+  }
+  const uint8_t far_color[4] = {0, 255, 0, 0};
+  const uint8_t near_color[4] = {0, 64, 0, 0};
+  const uint8_t landmark_color[4] = {255, 0, 0, 0};
+  ScanlineRasterizer rasterizer;
+  for (auto _ : state) {
+    rasterizer.Reset(image.data(), kImageWidth, kImageHeight,
+                     kImageWidth * kChannels, kChannels);
+    for (int hand = 0; hand < kNumHands; ++hand) {
+      const float* landmarks = &points[hand * kNumLandmarks * 2];
+      for (int i = 1; i < kNumLandmarks; ++i) {
+        rasterizer.AddLine(landmarks[(i - 1) * 2], landmarks[(i - 1) * 2 + 1],
+                           landmarks[i * 2], landmarks[i * 2 + 1], 2,
+                           far_color, near_color);
+      }
+      for (int i = 0; i < kNumLandmarks; ++i) {
+        rasterizer.AddDisc(landmarks[i * 2], landmarks[i * 2 + 1], 4,
+                           landmark_color);
+      }
+    }
+    rasterizer.Flush();
+  }
+}
+BENCHMARK(BM_HandLandmarks)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace mediapipe
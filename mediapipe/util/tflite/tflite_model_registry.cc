@@ -0,0 +1,92 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tflite/tflite_model_registry.h"
+
+#include <utility>
+
+#include "absl/time/clock.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/util/resource_util.h"
+
+namespace mediapipe {
+
+const GraphService<TfLiteModelRegistry> kTfLiteModelRegistryService(
+    "kTfLiteModelRegistryService");
+
+const std::shared_ptr<TfLiteModelRegistry>& TfLiteModelRegistry::GetDefault() {
+  static const auto* registry = new std::shared_ptr<TfLiteModelRegistry>(
+      std::make_shared<TfLiteModelRegistry>());
+  return *registry;
+}
+
+absl::StatusOr<api2::Packet<TfLiteModelPtr>> TfLiteModelRegistry::GetModel(
+    const std::string& path) {
+  // Loading maps the file, so it is done while holding the lock, which makes
+  // concurrent requests for the same model wait for a single load.
+  absl::MutexLock lock(&mutex_);
+  std::shared_ptr<tflite::FlatBufferModel> model;
+  auto it = entries_.find(path);
+  if (it != entries_.end()) {
+    model = it->second.model.lock();
+  }
+  if (model) {
+    ++it->second.stats.hit_count;
+  } else {
+    const absl::Time start_time = absl::Now();
+    ASSIGN_OR_RETURN(std::string model_path,
+                     mediapipe::PathToResourceAsFile(path));
+    model = tflite::FlatBufferModel::BuildFromFile(model_path.c_str());
+    RET_CHECK(model) << "Failed to load model from path " << model_path;
+
+    Entry& entry = entries_[path];
+    entry.model = model;
+    entry.stats.path = path;
+    entry.stats.model_bytes =
+        model->allocation() ? model->allocation()->bytes() : 0;
+    const absl::Duration load_time = absl::Now() - start_time;
+    entry.stats.load_time += load_time;
+    ++entry.stats.load_count;
+    VLOG(1) << "Loaded TfLite model " << path << " ("
+            << entry.stats.model_bytes << " bytes) in " << load_time;
+  }
+  // Every packet keeps the shared model alive.
+  return api2::MakePacket<TfLiteModelPtr>(
+      model.get(), [model](tflite::FlatBufferModel*) {});
+}
+
+std::vector<TfLiteModelRegistry::ModelStats> TfLiteModelRegistry::GetStats() {
+  absl::MutexLock lock(&mutex_);
+  std::vector<ModelStats> stats;
+  stats.reserve(entries_.size());
+  for (const auto& path_entry : entries_) {
+    stats.push_back(path_entry.second.stats);
+    stats.back().loaded = !path_entry.second.model.expired();
+  }
+  return stats;
+}
+
+int64 TfLiteModelRegistry::GetLoadedBytes() {
+  absl::MutexLock lock(&mutex_);
+  int64 bytes = 0;
+  for (const auto& path_entry : entries_) {
+    if (!path_entry.second.model.expired()) {
+      bytes += path_entry.second.stats.model_bytes;
+    }
+  }
+  return bytes;
+}
+
+}  // namespace mediapipe
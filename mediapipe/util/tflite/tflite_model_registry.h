@@ -0,0 +1,94 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_TFLITE_TFLITE_MODEL_REGISTRY_H_
+#define MEDIAPIPE_UTIL_TFLITE_TFLITE_MODEL_REGISTRY_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/api2/packet.h"
+#include "mediapipe/framework/graph_service.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/util/tflite/tflite_model_loader.h"
+#include "tensorflow/lite/model.h"
+
+namespace mediapipe {
+
+// Shares TfLite models between calculators and graphs.  Each model file is
+// mapped once and the FlatBufferModel is shared by all interpreters using it,
+// as long as any of them is alive; a model released by all its users is
+// loaded again on the next request.  Thread-safe.
+//
+// InferenceCalculator and TfLiteInferenceCalculator load their model_path
+// through the registry of the kTfLiteModelRegistryService if the graph
+// provides one, and through the process-wide registry otherwise.
+//
+// Example (sharing models only between the graphs of one camera rig):
+//   auto registry = std::make_shared<TfLiteModelRegistry>();
+//   MP_RETURN_IF_ERROR(
+//       graph.SetServiceObject(kTfLiteModelRegistryService, registry));
+class TfLiteModelRegistry {
+ public:
+  // Memory use and load time of a model.
+  struct ModelStats {
+    std::string path;
+    // Size of the mapped model file.
+    int64 model_bytes = 0;
+    // Time spent loading the model, summed over all loads.
+    absl::Duration load_time;
+    // The number of times the model was loaded from disk.
+    int64 load_count = 0;
+    // The number of requests served by an already loaded model.
+    int64 hit_count = 0;
+    // Whether the model is currently loaded.
+    bool loaded = false;
+  };
+
+  // Returns the process-wide registry.
+  static const std::shared_ptr<TfLiteModelRegistry>& GetDefault();
+
+  // Returns the model at |path|, which is resolved as by
+  // TfLiteModelLoader::LoadFromPath.  The model is loaded unless it is
+  // already in use.
+  absl::StatusOr<api2::Packet<TfLiteModelPtr>> GetModel(
+      const std::string& path);
+
+  // Returns the statistics of all models requested so far.
+  std::vector<ModelStats> GetStats();
+
+  // Returns the total size of the models currently loaded.
+  int64 GetLoadedBytes();
+
+ private:
+  struct Entry {
+    std::weak_ptr<tflite::FlatBufferModel> model;
+    ModelStats stats;
+  };
+
+  absl::Mutex mutex_;
+  std::map<std::string, Entry> entries_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Graph service selecting the TfLiteModelRegistry of a graph.
+extern const GraphService<TfLiteModelRegistry> kTfLiteModelRegistryService;
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_TFLITE_TFLITE_MODEL_REGISTRY_H_
@@ -0,0 +1,66 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tflite/tflite_model_registry.h"
+
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr char kModelPath[] = "mediapipe/calculators/tensor/testdata/add.bin";
+
+TEST(TfLiteModelRegistryTest, SharesLoadedModel) {
+  TfLiteModelRegistry registry;
+  auto status_or_first = registry.GetModel(kModelPath);
+  MP_ASSERT_OK(status_or_first.status());
+  auto status_or_second = registry.GetModel(kModelPath);
+  MP_ASSERT_OK(status_or_second.status());
+  EXPECT_EQ(status_or_first.value().Get().get(),
+            status_or_second.value().Get().get());
+
+  std::vector<TfLiteModelRegistry::ModelStats> stats = registry.GetStats();
+  ASSERT_EQ(1, stats.size());
+  EXPECT_EQ(kModelPath, stats[0].path);
+  EXPECT_EQ(1, stats[0].load_count);
+  EXPECT_EQ(1, stats[0].hit_count);
+  EXPECT_TRUE(stats[0].loaded);
+  EXPECT_GT(stats[0].model_bytes, 0);
+  EXPECT_EQ(stats[0].model_bytes, registry.GetLoadedBytes());
+}
+
+TEST(TfLiteModelRegistryTest, ReloadsReleasedModel) {
+  TfLiteModelRegistry registry;
+  MP_ASSERT_OK(registry.GetModel(kModelPath).status());
+  // The model is released with the only packet.
+  EXPECT_EQ(0, registry.GetLoadedBytes());
+  EXPECT_FALSE(registry.GetStats()[0].loaded);
+
+  auto status_or_model = registry.GetModel(kModelPath);
+  MP_ASSERT_OK(status_or_model.status());
+  EXPECT_EQ(2, registry.GetStats()[0].load_count);
+  EXPECT_EQ(0, registry.GetStats()[0].hit_count);
+}
+
+TEST(TfLiteModelRegistryTest, ReportsMissingModel) {
+  TfLiteModelRegistry registry;
+  EXPECT_FALSE(registry.GetModel("no/such/model.tflite").ok());
+  EXPECT_TRUE(registry.GetStats().empty());
+}
+
+}  // namespace
+}  // namespace mediapipe
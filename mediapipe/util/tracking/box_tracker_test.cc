@@ -14,8 +14,16 @@
 
 #include "mediapipe/util/tracking/box_tracker.h"
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+
+#include "absl/memory/memory.h"
 #include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/tracking/tracking.h"
 
 namespace mediapipe {
 namespace {
@@ -23,6 +31,105 @@ namespace {
 constexpr double kWidth = 1280.0;
 constexpr double kHeight = 720.0;
 
+// Returns the forward motion of the frames of the first test chunk, i.e.
+// element f holds the motion from frame f to f + 1.
+std::vector<MotionVectorFrame> ReadForwardMotion() {
+  const std::string chunk_file = file::JoinPath(
+      "./", "/mediapipe/util/tracking/testdata/box_tracker/chunk_0000");
+  std::ifstream in(chunk_file, std::ios::in | std::ios::binary);
+  const std::string data((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+  TrackingDataChunk chunk;
+  CHECK(chunk.ParseFromString(data)) << "Could not read " << chunk_file;
+
+  std::vector<MotionVectorFrame> motion;
+  for (int f = 0; f + 1 < chunk.item_size(); ++f) {
+    MotionVectorFrame mvf;
+    MotionVectorFrameFromTrackingData(chunk.item(f + 1).tracking_data(), &mvf);
+    motion.emplace_back();
+    InvertMotionVectorFrame(mvf, &motion.back());
+  }
+  return motion;
+}
+
+// Returns num_boxes boxes reset at frame 0 to small rects on a grid.
+std::vector<std::unique_ptr<MotionBox>> MakeGridBoxes(int num_boxes) {
+  constexpr int kGridSize = 4;
+  constexpr float kBoxSize = 1.0f / (kGridSize + 1);
+  std::vector<std::unique_ptr<MotionBox>> boxes;
+  for (int i = 0; i < num_boxes; ++i) {
+    TimedBox box;
+    box.left = (i % kGridSize + 0.5f) * kBoxSize;
+    box.top = (i / kGridSize % kGridSize + 0.5f) * kBoxSize;
+    box.right = box.left + kBoxSize;
+    box.bottom = box.top + kBoxSize;
+    MotionBoxState state;
+    MotionBoxStateFromTimedBox(box, &state);
+    boxes.push_back(absl::make_unique<MotionBox>(TrackStepOptions()));
+    boxes.back()->ResetAtFrame(0, state);
+  }
+  return boxes;
+}
+
+std::vector<MotionBox*> GetPointers(
+    const std::vector<std::unique_ptr<MotionBox>>& boxes) {
+  std::vector<MotionBox*> pointers;
+  for (const auto& box : boxes) {
+    pointers.push_back(box.get());
+  }
+  return pointers;
+}
+
+TEST(BoxTrackerTest, TrackStepParallelMatchesSerial) {
+  constexpr int kNumBoxes = 8;
+  const std::vector<MotionVectorFrame> motion = ReadForwardMotion();
+  ASSERT_FALSE(motion.empty());
+  auto serial_boxes = MakeGridBoxes(kNumBoxes);
+  auto parallel_boxes = MakeGridBoxes(kNumBoxes);
+  std::vector<bool> serial_tracked(kNumBoxes, true);
+  std::vector<bool> parallel_tracked(kNumBoxes, true);
+
+  for (int f = 0; f < motion.size(); ++f) {
+    for (int i = 0; i < kNumBoxes; ++i) {
+      if (serial_tracked[i] &&
+          !serial_boxes[i]->TrackStep(f, motion[f], /*forward=*/true)) {
+        serial_tracked[i] = false;
+      }
+    }
+
+    std::vector<MotionBox*> tracked_boxes;
+    std::vector<int> tracked_indices;
+    for (int i = 0; i < kNumBoxes; ++i) {
+      if (parallel_tracked[i]) {
+        tracked_boxes.push_back(parallel_boxes[i].get());
+        tracked_indices.push_back(i);
+      }
+    }
+    const std::vector<int> failed =
+        TrackStepParallel(f, motion[f], /*forward=*/true, tracked_boxes);
+    EXPECT_TRUE(std::is_sorted(failed.begin(), failed.end()));
+    for (const int k : failed) {
+      parallel_tracked[tracked_indices[k]] = false;
+    }
+
+    ASSERT_EQ(serial_tracked, parallel_tracked) << "at frame " << f;
+    for (int i = 0; i < kNumBoxes; ++i) {
+      if (!serial_tracked[i]) continue;
+      const MotionBoxState serial = serial_boxes[i]->StateAtFrame(f + 1);
+      const MotionBoxState parallel = parallel_boxes[i]->StateAtFrame(f + 1);
+      EXPECT_EQ(serial.pos_x(), parallel.pos_x());
+      EXPECT_EQ(serial.pos_y(), parallel.pos_y());
+      EXPECT_EQ(serial.width(), parallel.width());
+      EXPECT_EQ(serial.height(), parallel.height());
+    }
+  }
+}
+
+TEST(BoxTrackerTest, TrackStepParallelWithoutBoxes) {
+  EXPECT_TRUE(TrackStepParallel(0, MotionVectorFrame(), /*forward=*/true, {})
+                  .empty());
+}
+
 // Ground truth test; testing tracking accuracy and multi-thread load testing.
 TEST(BoxTrackerTest, MovingBoxTest) {
   const std::string cache_dir =
@@ -112,6 +219,29 @@ TEST(BoxTrackerTest, MovingBoxTest) {
   }
 }
 
+// Tracks the given number of boxes over the first test chunk. Items are
+// frames, so the time per frame is the inverse of the reported rate.
+void BM_TrackStepParallel(benchmark::State& state) {
+  const int num_boxes = state.range(0);
+  const std::vector<MotionVectorFrame> motion = ReadForwardMotion();
+  for (auto _ : state) {
+    auto boxes = MakeGridBoxes(num_boxes);
+    const std::vector<MotionBox*> box_pointers = GetPointers(boxes);
+    for (int f = 0; f < motion.size(); ++f) {
+      benchmark::DoNotOptimize(
+          TrackStepParallel(f, motion[f], /*forward=*/true, box_pointers));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * motion.size());
+}
+BENCHMARK(BM_TrackStepParallel)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Arg(16)
+    ->Unit(benchmark::kMillisecond);
+
 }  // namespace
 
 }  // namespace mediapipe
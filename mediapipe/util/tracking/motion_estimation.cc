@@ -3852,11 +3852,18 @@ Homography HomographyL2NormalEquationSolve(
   CHECK(rhs != nullptr);
   CHECK(solution != nullptr);
 
-  *matrix = Eigen::Matrix<T, 8, 8>::Zero();
-  *rhs = Eigen::Matrix<T, 8, 1>::Zero();
-
   // Matrix multiplications are hand-coded for speed improvements vs.
-  // opencv's cvGEMM calls.
+  // opencv's cvGEMM calls. J^t * J * w and J^t * b * w only have 23 distinct
+  // entries, which are accumulated in registers and scattered into matrix and
+  // rhs afterwards. Each entry is still summed in feature order, so results
+  // are identical to accumulating matrix and rhs element by element.
+  T sum_xxw = 0, sum_xyw = 0, sum_yyw = 0, sum_xw = 0, sum_yw = 0, sum_w = 0;
+  T sum_xxw_mx = 0, sum_xyw_mx = 0, sum_yyw_mx = 0, sum_xw_mx = 0;
+  T sum_yw_mx = 0, sum_w_mx = 0;
+  T sum_xxw_my = 0, sum_xyw_my = 0, sum_yyw_my = 0, sum_xw_my = 0;
+  T sum_yw_my = 0, sum_w_my = 0;
+  T sum_xxw_mxxyy = 0, sum_xyw_mxxyy = 0, sum_yyw_mxxyy = 0;
+  T sum_xw_mxxyy = 0, sum_yw_mxxyy = 0;
   for (const auto& feature : feature_list.feature()) {
     T scale = 1.0;
     if (prev_solution) {
@@ -3880,105 +3887,66 @@ Homography HomographyL2NormalEquationSolve(
     const T my = feature.y() + feature.dy();
 
     const T mxxyy = mx * mx + my * my;
-    // Jacobian
-    // double J[2 * 8] = {x, y, 1,  0,  0,   0, -x * m_x, -y * m_x,
-    //                   {0, 0, 0,  x,  y,   1, -x * m_y, -y * m_y}
-    //
-    // // Compute J^t * J * w =
-    // ( xx        xy    x      0       0    0    -xx*mx  -xy*mx    )
-    // ( xy        yy    y      0       0    0    -xy*mx  -yy*mx    )
-    // ( x         y     1      0       0    0     -x*mx   -y*mx    )
-    // ( 0         0     0     xx      xy    x    -xx*my  -xy*my    )
-    // ( 0         0     0     xy      yy    y    -xy*my  -yy*my    )
-    // ( 0         0     0      x      y     1     -x*my   -y*my    )
-    // ( -xx*mx -xy*mx -x*mx -xx*my -xy*my -x*my xx*mxxyy  xy*mxxyy )
-    // ( -xy*mx -yy*mx -y*mx -xy*my -yy*my -y*my xy*mxxyy  yy*mxxyy  ) * w
-
-    // 1st row:  xx        xy    x      0       0    0    -xx*mx  -xy*mx
-    T* matrix_ptr = matrix->data();
-    matrix_ptr[0] += xxw;
-    matrix_ptr[1] += xyw;
-    matrix_ptr[2] += xw;
-    matrix_ptr[6] += -xxw * mx;
-    matrix_ptr[7] += -xyw * mx;
-
-    // 2nd row:  xy       yy   y      0       0    0    -xy*mx  -yy*mx
-    matrix_ptr += 8;
-    matrix_ptr[0] += xyw;
-    matrix_ptr[1] += yyw;
-    matrix_ptr[2] += yw;
-    matrix_ptr[6] += -xyw * mx;
-    matrix_ptr[7] += -yyw * mx;
 
-    // 3rd row: x         y     1      0       0    0     -x*mx   -y*mx
-    matrix_ptr += 8;
-    matrix_ptr[0] += xw;
-    matrix_ptr[1] += yw;
-    matrix_ptr[2] += w;
-    matrix_ptr[6] += -xw * mx;
-    matrix_ptr[7] += -yw * mx;
-
-    // 4th row: 0         0     0     xx      xy    x    -xx*my  -xy*my
-    matrix_ptr += 8;
-    matrix_ptr[3] += xxw;
-    matrix_ptr[4] += xyw;
-    matrix_ptr[5] += xw;
-    matrix_ptr[6] += -xxw * my;
-    matrix_ptr[7] += -xyw * my;
-
-    // 5th row: 0         0     0     xy      yy    y    -xy*my  -yy*my
-    matrix_ptr += 8;
-    matrix_ptr[3] += xyw;
-    matrix_ptr[4] += yyw;
-    matrix_ptr[5] += yw;
-    matrix_ptr[6] += -xyw * my;
-    matrix_ptr[7] += -yyw * my;
-
-    // 6th row:  0         0     0     x     y     1      -x*my    -y*my
-    matrix_ptr += 8;
-    matrix_ptr[3] += xw;
-    matrix_ptr[4] += yw;
-    matrix_ptr[5] += w;
-    matrix_ptr[6] += -xw * my;
-    matrix_ptr[7] += -yw * my;
-
-    // 7th row:  -xx*mx -xy*mx -x*mx -xx*my -xy*my -x*my xx*mxxyy  xy*mxxyy
-    matrix_ptr += 8;
-    matrix_ptr[0] += -xxw * mx;
-    matrix_ptr[1] += -xyw * mx;
-    matrix_ptr[2] += -xw * mx;
-    matrix_ptr[3] += -xxw * my;
-    matrix_ptr[4] += -xyw * my;
-    matrix_ptr[5] += -xw * my;
-    matrix_ptr[6] += xxw * mxxyy;
-    matrix_ptr[7] += xyw * mxxyy;
-
-    // 8th row: -xy*mx -yy*mx -y*mx -xy*my -yy*my -y*my xy*mxxyy  yy*mxxyy
-    matrix_ptr += 8;
-    matrix_ptr[0] += -xyw * mx;
-    matrix_ptr[1] += -yyw * mx;
-    matrix_ptr[2] += -yw * mx;
-    matrix_ptr[3] += -xyw * my;
-    matrix_ptr[4] += -yyw * my;
-    matrix_ptr[5] += -yw * my;
-    matrix_ptr[6] += xyw * mxxyy;
-    matrix_ptr[7] += yyw * mxxyy;
-
-    // Right hand side:
-    // b = ( x
-    //       y )
-    // Compute J^t * b  * w =
-    // ( x*mx  y*mx  mx  x*my  y*my  my  -x*mxxyy -y*mxxyy ) * w
-    T* rhs_ptr = rhs->data();
-    rhs_ptr[0] += xw * mx;
-    rhs_ptr[1] += yw * mx;
-    rhs_ptr[2] += mx * w;
-    rhs_ptr[3] += xw * my;
-    rhs_ptr[4] += yw * my;
-    rhs_ptr[5] += my * w;
-    rhs_ptr[6] += -xw * mxxyy;
-    rhs_ptr[7] += -yw * mxxyy;
-  }
+    sum_xxw += xxw;
+    sum_xyw += xyw;
+    sum_yyw += yyw;
+    sum_xw += xw;
+    sum_yw += yw;
+    sum_w += w;
+    sum_xxw_mx += xxw * mx;
+    sum_xyw_mx += xyw * mx;
+    sum_yyw_mx += yyw * mx;
+    sum_xw_mx += xw * mx;
+    sum_yw_mx += yw * mx;
+    sum_w_mx += mx * w;
+    sum_xxw_my += xxw * my;
+    sum_xyw_my += xyw * my;
+    sum_yyw_my += yyw * my;
+    sum_xw_my += xw * my;
+    sum_yw_my += yw * my;
+    sum_w_my += my * w;
+    sum_xxw_mxxyy += xxw * mxxyy;
+    sum_xyw_mxxyy += xyw * mxxyy;
+    sum_yyw_mxxyy += yyw * mxxyy;
+    sum_xw_mxxyy += xw * mxxyy;
+    sum_yw_mxxyy += yw * mxxyy;
+  }
+
+  // Jacobian
+  // double J[2 * 8] = {x, y, 1,  0,  0,   0, -x * m_x, -y * m_x,
+  //                   {0, 0, 0,  x,  y,   1, -x * m_y, -y * m_y}
+  //
+  // // Compute J^t * J * w =
+  // ( xx        xy    x      0       0    0    -xx*mx  -xy*mx    )
+  // ( xy        yy    y      0       0    0    -xy*mx  -yy*mx    )
+  // ( x         y     1      0       0    0     -x*mx   -y*mx    )
+  // ( 0         0     0     xx      xy    x    -xx*my  -xy*my    )
+  // ( 0         0     0     xy      yy    y    -xy*my  -yy*my    )
+  // ( 0         0     0      x      y     1     -x*my   -y*my    )
+  // ( -xx*mx -xy*mx -x*mx -xx*my -xy*my -x*my xx*mxxyy  xy*mxxyy )
+  // ( -xy*mx -yy*mx -y*mx -xy*my -yy*my -y*my xy*mxxyy  yy*mxxyy  ) * w
+  //
+  // Negation is exact, so negated entries equal the sums of negated terms.
+  // The matrix is symmetric, so its storage order does not matter.
+  *matrix << sum_xxw, sum_xyw, sum_xw, 0, 0, 0, -sum_xxw_mx, -sum_xyw_mx,
+      sum_xyw, sum_yyw, sum_yw, 0, 0, 0, -sum_xyw_mx, -sum_yyw_mx,  //
+      sum_xw, sum_yw, sum_w, 0, 0, 0, -sum_xw_mx, -sum_yw_mx,       //
+      0, 0, 0, sum_xxw, sum_xyw, sum_xw, -sum_xxw_my, -sum_xyw_my,  //
+      0, 0, 0, sum_xyw, sum_yyw, sum_yw, -sum_xyw_my, -sum_yyw_my,  //
+      0, 0, 0, sum_xw, sum_yw, sum_w, -sum_xw_my, -sum_yw_my,       //
+      -sum_xxw_mx, -sum_xyw_mx, -sum_xw_mx, -sum_xxw_my, -sum_xyw_my,
+      -sum_xw_my, sum_xxw_mxxyy, sum_xyw_mxxyy,  //
+      -sum_xyw_mx, -sum_yyw_mx, -sum_yw_mx, -sum_xyw_my, -sum_yyw_my,
+      -sum_yw_my, sum_xyw_mxxyy, sum_yyw_mxxyy;
+
+  // Right hand side:
+  // b = ( x
+  //       y )
+  // Compute J^t * b  * w =
+  // ( x*mx  y*mx  mx  x*my  y*my  my  -x*mxxyy -y*mxxyy ) * w
+  *rhs << sum_xw_mx, sum_yw_mx, sum_w_mx, sum_xw_my, sum_yw_my, sum_w_my,
+      -sum_xw_mxxyy, -sum_yw_mxxyy;
 
   if (perspective_regularizer > 0) {
     // Additional constraint:
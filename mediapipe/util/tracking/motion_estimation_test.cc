@@ -0,0 +1,146 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/motion_estimation.h"
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
+#include "mediapipe/util/tracking/region_flow.pb.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kWidth = 640;
+constexpr int kHeight = 360;
+constexpr int kFeaturesPerFrame = 400;
+
+// Returns the features of a synthetic clip, moving by a slowly varying
+// similarity plus a fraction of outliers with random motion.
+std::vector<std::unique_ptr<RegionFlowFeatureList>> MakeClip(int num_frames) {
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  constexpr float kOutlierFraction = 0.2f;
+  std::vector<std::unique_ptr<RegionFlowFeatureList>> clip;
+  int track_id = 0;
+  for (int f = 0; f < num_frames; ++f) {
+    const float angle = 0.01f * std::sin(f * 0.05f);
+    const float scale = 1.0f + 0.01f * std::cos(f * 0.03f);
+    const float tx = 5.0f * std::sin(f * 0.02f);
+    const float ty = 3.0f * std::cos(f * 0.04f);
+
+    auto features = absl::make_unique<RegionFlowFeatureList>();
+    features->set_frame_width(kWidth);
+    features->set_frame_height(kHeight);
+    for (int k = 0; k < kFeaturesPerFrame; ++k) {
+      RegionFlowFeature* feature = features->add_feature();
+      const float x = uniform(random) * kWidth;
+      const float y = uniform(random) * kHeight;
+      feature->set_x(x);
+      feature->set_y(y);
+      if (uniform(random) < kOutlierFraction) {
+        feature->set_dx(uniform(random) * 40.0f - 20.0f);
+        feature->set_dy(uniform(random) * 40.0f - 20.0f);
+      } else {
+        const float cx = x - kWidth / 2;
+        const float cy = y - kHeight / 2;
+        const float match_x =
+            scale * (std::cos(angle) * cx - std::sin(angle) * cy) + tx;
+        const float match_y =
+            scale * (std::sin(angle) * cx + std::cos(angle) * cy) + ty;
+        feature->set_dx(match_x - cx);
+        feature->set_dy(match_y - cy);
+      }
+      feature->set_track_id(track_id++);
+    }
+    clip.push_back(std::move(features));
+  }
+  return clip;
+}
+
+// Estimates the motions of a copy of clip with the given parallel invoker
+// mode.
+void EstimateMotions(
+    const std::vector<std::unique_ptr<RegionFlowFeatureList>>& clip,
+    int parallel_invoker_mode, std::vector<RegionFlowFeatureList>* features,
+    std::vector<CameraMotion>* camera_motions) {
+  const int previous_mode = flags_parallel_invoker_mode;
+  flags_parallel_invoker_mode = parallel_invoker_mode;
+
+  features->clear();
+  for (const auto& feature_list : clip) {
+    features->push_back(*feature_list);
+  }
+  std::vector<RegionFlowFeatureList*> feature_lists;
+  for (auto& feature_list : *features) {
+    feature_lists.push_back(&feature_list);
+  }
+  camera_motions->clear();
+  camera_motions->resize(clip.size());
+
+  MotionEstimation motion_estimation(MotionEstimationOptions(), kWidth,
+                                     kHeight);
+  motion_estimation.EstimateMotionsParallel(false, &feature_lists,
+                                            camera_motions);
+  flags_parallel_invoker_mode = previous_mode;
+}
+
+TEST(MotionEstimationTest, ParallelEstimationMatchesSerial) {
+  const auto clip = MakeClip(60);
+  std::vector<RegionFlowFeatureList> serial_features;
+  std::vector<CameraMotion> serial_motions;
+  EstimateMotions(clip, PARALLEL_INVOKER_NONE, &serial_features,
+                  &serial_motions);
+  std::vector<RegionFlowFeatureList> parallel_features;
+  std::vector<CameraMotion> parallel_motions;
+  EstimateMotions(clip, PARALLEL_INVOKER_THREAD_POOL, &parallel_features,
+                  &parallel_motions);
+
+  ASSERT_EQ(serial_motions.size(), parallel_motions.size());
+  for (int f = 0; f < serial_motions.size(); ++f) {
+    EXPECT_TRUE(serial_motions[f].has_homography());
+    EXPECT_EQ(serial_motions[f].SerializeAsString(),
+              parallel_motions[f].SerializeAsString())
+        << "at frame " << f;
+    EXPECT_EQ(serial_features[f].SerializeAsString(),
+              parallel_features[f].SerializeAsString())
+        << "at frame " << f;
+  }
+}
+
+// Estimates the motions of a long clip, single threaded and distributing the
+// frames over the ParallelInvoker threads. Items are frames.
+void BM_EstimateMotionsParallel(benchmark::State& state) {
+  const auto clip = MakeClip(600);
+  std::vector<RegionFlowFeatureList> features;
+  std::vector<CameraMotion> camera_motions;
+  for (auto _ : state) {
+    EstimateMotions(clip, state.range(0), &features, &camera_motions);
+  }
+  state.SetItemsProcessed(state.iterations() * clip.size());
+}
+BENCHMARK(BM_EstimateMotionsParallel)
+    ->Arg(PARALLEL_INVOKER_NONE)
+    ->Arg(PARALLEL_INVOKER_THREAD_POOL)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace mediapipe
@@ -260,7 +260,10 @@ inline void CheckAndSetInvokerOptions() {
 #endif  // __APPLE__ || __EMSCRIPTEN__
 
 #if !defined(__APPLE__) && !defined(__EMSCRIPTEN__) && !defined(__ANDROID__)
-  flags_parallel_invoker_mode = PARALLEL_INVOKER_THREAD_POOL;
+  // Use ThreadPool unless single threaded execution is explicitly requested.
+  if (flags_parallel_invoker_mode != PARALLEL_INVOKER_NONE) {
+    flags_parallel_invoker_mode = PARALLEL_INVOKER_THREAD_POOL;
+  }
 #endif  // !__APPLE__ && !__EMSCRIPTEN__ && !__ANDROID__
 
   // If OpenMP is requested, make sure we can actually use it, and fall back
@@ -369,10 +372,11 @@ void ParallelFor(size_t start, size_t end, size_t grain_size,
     }
 
     case PARALLEL_INVOKER_OPENMP: {
-      // Use thread-local copy of invoker.
+      // Use thread-local copy of invoker. Iterations are handed out to idle
+      // threads one at a time, as their cost often varies (e.g. per frame).
       Invoker local_invoker(invoker);
 #pragma omp parallel for firstprivate(local_invoker) \
-    num_threads(flags_parallel_invoker_max_threads)
+    num_threads(flags_parallel_invoker_max_threads) schedule(dynamic)
       for (int x = start; x < end; ++x) {
         local_invoker(BlockedRange(x, x + 1, 1));
       }
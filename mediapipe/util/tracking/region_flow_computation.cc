@@ -145,14 +145,26 @@ void GetPatchDescriptorAtPoint(const cv::Mat& rgb_frame, const Vector2_i& pt,
   const cv::Mat rgb_window =
       rgb_frame(cv::Rect(pt.x() - radius, pt.y() - radius, diameter, diameter));
 
-  // Compute channel sums and means.
+  // Compute channel sums and the channel dot products in a single pass over
+  // the window. Only the upper triangular part of the products is computed;
+  // the independent integer accumulators let the compiler vectorize the loop.
   int sum[3] = {0, 0, 0};
+  int dot[6] = {0, 0, 0, 0, 0, 0};  // 00, 01, 02, 11, 12, 22.
   for (int y = 0; y < diameter; ++y) {
     const uint8* data = rgb_window.ptr<uint8>(y);
     for (int x = 0; x < diameter; ++x, data += 3) {
-      for (int c = 0; c < 3; ++c) {
-        sum[c] += data[c];
-      }
+      const int r = data[0];
+      const int g = data[1];
+      const int b = data[2];
+      sum[0] += r;
+      sum[1] += g;
+      sum[2] += b;
+      dot[0] += r * r;
+      dot[1] += r * g;
+      dot[2] += r * b;
+      dot[3] += g * g;
+      dot[4] += g * b;
+      dot[5] += b * b;
     }
   }
   const float scale = 1.f / (diameter * diameter);
@@ -162,23 +174,19 @@ void GetPatchDescriptorAtPoint(const cv::Mat& rgb_frame, const Vector2_i& pt,
 
   const float denom = 1.0f / (diameter * diameter);
 
-  // Compute the channel dot products, after centering around the respective
-  // channel means. Only computing upper triangular part.
+  // We want the channel dot products after centering around the respective
+  // channel means,
+  //     sum_{x,y}[(data[c] - mean[c]) * (data[d] - mean[d])],
+  // which simplifies to
+  //     sum_{x,y}[data[c] * data[d]] - sum[c] * sum[d] / N
+  // using N = diameter * diameter and sum[c] = N * mean[c].
   int product[3][3];
-  for (int c = 0; c < 3; ++c) {
-    for (int d = c; d < 3; ++d) {
-      // We want to compute
-      //     sum_{x,y}[(data[c] - mean[c]) * (data[d] - mean[d])],
-      // which simplifies to
-      //     sum_{x,y}[data[c] * data[d]] - sum[c] * sum[d] / N
-      // using N = diameter * diameter and sum[c] = N * mean[c].
+  for (int c = 0, k = 0; c < 3; ++c) {
+    for (int d = c; d < 3; ++d, ++k) {
+      // Truncate the correction term first, to match accumulating the dot
+      // product on top of it.
       product[c][d] = -sum[c] * sum[d] * denom;
-      for (int y = 0; y < diameter; ++y) {
-        const uint8* data = rgb_window.ptr<uint8>(y);
-        for (int x = 0; x < diameter; ++x, data += 3) {
-          product[c][d] += static_cast<int>(data[c]) * data[d];
-        }
-      }
+      product[c][d] += dot[k];
     }
   }
 
@@ -233,6 +241,120 @@ class PatchDescriptorInvoker {
   RegionFlowFeatureList* features_;
 };
 
+#if CV_MAJOR_VERSION == 3
+// Invoker for ParallelFor. Needs to be copyable.
+// Tracks the features of each tile with cv::calcOpticalFlowPyrLK. Each
+// feature is tracked independently, so the results equal tracking all
+// features in one call, provided the pyramids contain the derivatives of
+// frame1 (otherwise each tile recomputes them).
+class TiledOpticalFlowInvoker {
+ public:
+  TiledOpticalFlowInvoker(const cv::_InputArray& frame1,
+                          const cv::_InputArray& frame2,
+                          const std::vector<cv::Point2f>& features1,
+                          const std::vector<std::vector<int>>& tile_features,
+                          const cv::Size& window_size, int max_level,
+                          const cv::TermCriteria& criteria, int flags,
+                          std::vector<cv::Point2f>* features2,
+                          std::vector<uint8>* status, std::vector<float>* error)
+      : frame1_(frame1),
+        frame2_(frame2),
+        features1_(features1),
+        tile_features_(tile_features),
+        window_size_(window_size),
+        max_level_(max_level),
+        criteria_(criteria),
+        flags_(flags),
+        features2_(features2),
+        status_(status),
+        error_(error) {}
+
+  void operator()(const BlockedRange& range) const {
+    std::vector<cv::Point2f> tile_features1;
+    std::vector<cv::Point2f> tile_features2;
+    std::vector<uint8> tile_status;
+    std::vector<float> tile_error;
+    for (int tile = range.begin(); tile != range.end(); ++tile) {
+      const std::vector<int>& indices = tile_features_[tile];
+      if (indices.empty()) {
+        continue;
+      }
+      tile_features1.clear();
+      tile_features2.clear();
+      for (int idx : indices) {
+        tile_features1.push_back(features1_[idx]);
+        tile_features2.push_back((*features2_)[idx]);
+      }
+      cv::calcOpticalFlowPyrLK(frame1_, frame2_, tile_features1,
+                               tile_features2, tile_status, tile_error,
+                               window_size_, max_level_, criteria_, flags_);
+      for (int k = 0; k < indices.size(); ++k) {
+        (*features2_)[indices[k]] = tile_features2[k];
+        (*status_)[indices[k]] = tile_status[k];
+        (*error_)[indices[k]] = tile_error[k];
+      }
+    }
+  }
+
+ private:
+  const cv::_InputArray& frame1_;
+  const cv::_InputArray& frame2_;
+  const std::vector<cv::Point2f>& features1_;
+  const std::vector<std::vector<int>>& tile_features_;
+  cv::Size window_size_;
+  int max_level_;
+  cv::TermCriteria criteria_;
+  int flags_;
+  std::vector<cv::Point2f>* features2_;
+  std::vector<uint8>* status_;
+  std::vector<float>* error_;
+};
+
+// Same as cv::calcOpticalFlowPyrLK, but splits the frame of the given height
+// into num_tiles horizontal tiles whose features are tracked in parallel.
+// Features are assigned to tiles by their location in frame1.
+void TiledCalcOpticalFlowPyrLK(const cv::_InputArray& frame1,
+                               const cv::_InputArray& frame2,
+                               int frame_height, int num_tiles,
+                               const std::vector<cv::Point2f>& features1,
+                               std::vector<cv::Point2f>* features2,
+                               std::vector<uint8>* status,
+                               std::vector<float>* error,
+                               const cv::Size& window_size, int max_level,
+                               const cv::TermCriteria& criteria, int flags) {
+  if (num_tiles <= 1) {
+    cv::calcOpticalFlowPyrLK(frame1, frame2, features1, *features2, *status,
+                             *error, window_size, max_level, criteria, flags);
+    return;
+  }
+
+  // Starting from the features' own locations is equivalent to tracking
+  // without initial flow.
+  const int num_features = features1.size();
+  if (!(flags & cv::OPTFLOW_USE_INITIAL_FLOW)) {
+    *features2 = features1;
+  }
+  features2->resize(num_features);
+  status->resize(num_features);
+  error->resize(num_features);
+
+  std::vector<std::vector<int>> tile_features(num_tiles);
+  const float tile_scale = static_cast<float>(num_tiles) / frame_height;
+  for (int i = 0; i < num_features; ++i) {
+    const int tile =
+        std::min(num_tiles - 1,
+                 std::max(0, static_cast<int>(features1[i].y * tile_scale)));
+    tile_features[tile].push_back(i);
+  }
+
+  ParallelFor(0, num_tiles, 1,
+              TiledOpticalFlowInvoker(
+                  frame1, frame2, features1, tile_features, window_size,
+                  max_level, criteria, flags | cv::OPTFLOW_USE_INITIAL_FLOW,
+                  features2, status, error));
+}
+#endif  // CV_MAJOR_VERSION == 3
+
 }  // namespace.
 
 // Computes patch descriptor in color domain (LAB), see region_flow.proto for
@@ -2596,24 +2718,36 @@ void RegionFlowComputation::TrackFeatures(FrameTrackingData* from_data_ptr,
   criteria.max_iter = options_.tracking_options().tracking_iterations();
   criteria.epsilon = 0.02f;
 
+  const int num_tracking_tiles =
+      options_.tracking_options().num_tracking_tiles();
   feature_track_error_.resize(num_features);
   feature_status_.resize(num_features);
   if (use_cv_tracking_) {
 #if CV_MAJOR_VERSION == 3
     if (gain_correction) {
+      cv::_InputArray gain_input(*gain_image_);
+      if (num_tracking_tiles > 1) {
+        // Build the pyramid of the gain corrected frame once, instead of
+        // within each tile and for verification.
+        cv::buildOpticalFlowPyramid(*gain_image_, gain_image_pyramid_,
+                                    cv_window_size, pyramid_levels_,
+                                    options_.compute_derivative_in_pyramid());
+        gain_input = cv::_InputArray(gain_image_pyramid_);
+      }
       if (!frame1_gain_reference) {
-        input_frame1 = cv::_InputArray(*gain_image_);
+        input_frame1 = gain_input;
       } else {
-        input_frame2 = cv::_InputArray(*gain_image_);
+        input_frame2 = gain_input;
       }
     }
 
     if (options_.tracking_options().klt_tracker_implementation() ==
         TrackingOptions::KLT_OPENCV) {
-      cv::calcOpticalFlowPyrLK(input_frame1, input_frame2, features1, features2,
-                               feature_status_, feature_track_error_,
-                               cv_window_size, pyramid_levels_, cv_criteria,
-                               tracking_flags);
+      TiledCalcOpticalFlowPyrLK(input_frame1, input_frame2, frame_height_,
+                                num_tracking_tiles, features1, &features2,
+                                &feature_status_, &feature_track_error_,
+                                cv_window_size, pyramid_levels_, cv_criteria,
+                                tracking_flags);
     } else {
       LOG(ERROR) << "Tracking method unspecified.";
       return;
@@ -2789,10 +2923,11 @@ void RegionFlowComputation::TrackFeatures(FrameTrackingData* from_data_ptr,
 
     if (use_cv_tracking_) {
 #if CV_MAJOR_VERSION == 3
-      cv::calcOpticalFlowPyrLK(input_frame2, input_frame1, verify_features,
-                               verify_features_tracked, feature_status_,
-                               verify_track_error, cv_window_size,
-                               pyramid_levels_, cv_criteria, tracking_flags);
+      TiledCalcOpticalFlowPyrLK(input_frame2, input_frame1, frame_height_,
+                                num_tracking_tiles, verify_features,
+                                &verify_features_tracked, &feature_status_,
+                                &verify_track_error, cv_window_size,
+                                pyramid_levels_, cv_criteria, tracking_flags);
 #endif
     } else {
       LOG(ERROR) << "only cv tracking is supported.";
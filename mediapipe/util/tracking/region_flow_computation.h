@@ -418,6 +418,8 @@ class RegionFlowComputation {
   // Gain adapted version.
   std::unique_ptr<cv::Mat> gain_image_;
   std::unique_ptr<cv::Mat> gain_pyramid_;
+  // Pyramid of gain_image_, reused across frames for tiled tracking.
+  std::vector<cv::Mat> gain_image_pyramid_;
 
   // Temporary buffers.
   std::unique_ptr<cv::Mat> corner_values_;
@@ -24,6 +24,7 @@
 #include "absl/flags/flag.h"
 #include "absl/time/clock.h"
 #include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/logging.h"
@@ -44,6 +45,17 @@ namespace {
 
 using RandomEngine = std::mt19937_64;
 
+// Returns the RGB bee image.
+cv::Mat LoadTestImage() {
+  const std::string data_dir =
+      file::JoinPath("./", "/mediapipe/util/tracking/testdata/");
+  std::string png_data;
+  MEDIAPIPE_CHECK_OK(
+      file::GetContents(data_dir + "stabilize_test.png", &png_data));
+  std::vector<char> buffer(png_data.begin(), png_data.end());
+  return cv::imdecode(cv::Mat(buffer), 1);
+}
+
 struct FlowDirectionParam {
   TrackingOptions::FlowDirection internal_direction;
   TrackingOptions::FlowDirection output_direction;
@@ -60,13 +72,7 @@ class RegionFlowComputationTest
     tracking_options->set_output_flow_direction(param.output_direction);
 
     // Load bee image.
-    data_dir_ = file::JoinPath("./", "/mediapipe/util/tracking/testdata/");
-
-    std::string png_data;
-    MEDIAPIPE_CHECK_OK(
-        file::GetContents(data_dir_ + "stabilize_test.png", &png_data));
-    std::vector<char> buffer(png_data.begin(), png_data.end());
-    original_frame_ = cv::imdecode(cv::Mat(buffer), 1);
+    original_frame_ = LoadTestImage();
     ASSERT_FALSE(original_frame_.empty());
     ASSERT_EQ(original_frame_.type(), CV_8UC3);
   }
@@ -87,7 +93,6 @@ class RegionFlowComputationTest
   RegionFlowComputationOptions base_options_;
 
  private:
-  std::string data_dir_;
   cv::Mat original_frame_;
 };
 
@@ -251,6 +256,114 @@ TEST_P(RegionFlowComputationTest, FramePairTest) {
   RunFramePairTest(RegionFlowComputationOptions::FORMAT_BGRA);
 }
 
+TEST_P(RegionFlowComputationTest, TiledTrackingMatchesUntiled) {
+  std::vector<cv::Mat> movie;
+  std::vector<Vector2_f> positions;
+  const int num_frames = 10;
+  MakeMovie(num_frames, RegionFlowComputationOptions::FORMAT_RGB, &movie,
+            &positions);
+  base_options_.set_image_format(RegionFlowComputationOptions::FORMAT_RGB);
+  // Verification tracks backwards, which is tiled as well.
+  base_options_.set_verify_features(true);
+
+  RegionFlowComputationOptions tiled_options = base_options_;
+  tiled_options.mutable_tracking_options()->set_num_tracking_tiles(4);
+  RegionFlowComputation flow_computation(base_options_, movie[0].cols,
+                                         movie[0].rows);
+  RegionFlowComputation tiled_flow_computation(tiled_options, movie[0].cols,
+                                               movie[0].rows);
+
+  for (int i = 0; i < num_frames; ++i) {
+    flow_computation.AddImage(movie[i], 0);
+    tiled_flow_computation.AddImage(movie[i], 0);
+    if (i == 0) {
+      continue;
+    }
+
+    std::unique_ptr<RegionFlowFeatureList> features(
+        flow_computation.RetrieveRegionFlowFeatureList(false, false, nullptr,
+                                                       nullptr));
+    std::unique_ptr<RegionFlowFeatureList> tiled_features(
+        tiled_flow_computation.RetrieveRegionFlowFeatureList(false, false,
+                                                             nullptr, nullptr));
+    ASSERT_EQ(features->feature_size(), tiled_features->feature_size());
+    for (int k = 0; k < features->feature_size(); ++k) {
+      const RegionFlowFeature& feature = features->feature(k);
+      const RegionFlowFeature& tiled_feature = tiled_features->feature(k);
+      EXPECT_EQ(feature.x(), tiled_feature.x());
+      EXPECT_EQ(feature.y(), tiled_feature.y());
+      EXPECT_NEAR(feature.dx(), tiled_feature.dx(), 1e-4f);
+      EXPECT_NEAR(feature.dy(), tiled_feature.dy(), 1e-4f);
+    }
+  }
+}
+
+TEST_P(RegionFlowComputationTest, FeatureDescriptorsMatchReference) {
+  std::vector<cv::Mat> movie;
+  std::vector<Vector2_f> positions;
+  MakeMovie(2, RegionFlowComputationOptions::FORMAT_RGB, &movie, &positions);
+  base_options_.set_image_format(RegionFlowComputationOptions::FORMAT_RGB);
+  RegionFlowComputation flow_computation(base_options_, movie[0].cols,
+                                         movie[0].rows);
+  flow_computation.AddImage(movie[0], 0);
+  delete flow_computation.RetrieveRegionFlow();
+  flow_computation.AddImage(movie[1], 0);
+  std::unique_ptr<RegionFlowFeatureList> features(
+      flow_computation.RetrieveRegionFlowFeatureList(true, true, &movie[1],
+                                                     &movie[0]));
+  ASSERT_GT(features->feature_size(), 0);
+
+  // Mean and upper triangular covariance of the patch around location.
+  const int radius = base_options_.patch_descriptor_radius();
+  const int num_pixels = (2 * radius + 1) * (2 * radius + 1);
+  auto reference_descriptor = [&](const cv::Mat& frame,
+                                  const Vector2_i& location) {
+    std::vector<double> mean(3, 0.0);
+    for (int y = -radius; y <= radius; ++y) {
+      for (int x = -radius; x <= radius; ++x) {
+        const cv::Vec3b& pixel =
+            frame.at<cv::Vec3b>(location.y() + y, location.x() + x);
+        for (int c = 0; c < 3; ++c) {
+          mean[c] += pixel[c] / static_cast<double>(num_pixels);
+        }
+      }
+    }
+    std::vector<double> descriptor = mean;
+    for (int c = 0; c < 3; ++c) {
+      for (int d = c; d < 3; ++d) {
+        double covariance = 0;
+        for (int y = -radius; y <= radius; ++y) {
+          for (int x = -radius; x <= radius; ++x) {
+            const cv::Vec3b& pixel =
+                frame.at<cv::Vec3b>(location.y() + y, location.x() + x);
+            covariance += (pixel[c] - mean[c]) * (pixel[d] - mean[d]);
+          }
+        }
+        descriptor.push_back(covariance / num_pixels);
+      }
+    }
+    return descriptor;
+  };
+
+  // The descriptor truncates sum[c] * sum[d] / N to an integer before
+  // normalizing by N.
+  const double tolerance = 1.0 / num_pixels + 1e-3;
+  for (const auto& feature : features->feature()) {
+    const std::vector<double> expected =
+        reference_descriptor(movie[1], FeatureIntLocation(feature));
+    const std::vector<double> expected_match =
+        reference_descriptor(movie[0], FeatureMatchIntLocation(feature));
+    ASSERT_EQ(feature.feature_descriptor().data_size(), 9);
+    ASSERT_EQ(feature.feature_match_descriptor().data_size(), 9);
+    for (int k = 0; k < 9; ++k) {
+      EXPECT_NEAR(feature.feature_descriptor().data(k), expected[k],
+                  tolerance);
+      EXPECT_NEAR(feature.feature_match_descriptor().data(k),
+                  expected_match[k], tolerance);
+    }
+  }
+}
+
 TEST_P(RegionFlowComputationTest, ResolutionTests) {
   // Test all kinds of resolutions (disregard resulting flow).
   // Square test, synthetic tracks.
@@ -300,5 +413,47 @@ TEST_P(RegionFlowComputationTest, ResolutionTests) {
   }
 }
 
+// Tracks frames of the given size, shifted by a few pixels each, computing
+// feature descriptors as the motion analysis does. Items are frames.
+void BM_RegionFlowComputation(benchmark::State& state) {
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const int num_tracking_tiles = state.range(2);
+  constexpr int kNumFrames = 10;
+  constexpr int kBorder = 2 * kNumFrames;
+
+  cv::Mat image;
+  cv::resize(LoadTestImage(), image,
+             cv::Size(width + 2 * kBorder, height + 2 * kBorder));
+  std::vector<cv::Mat> movie;
+  for (int f = 0; f < kNumFrames; ++f) {
+    movie.push_back(image(cv::Rect(2 * f, f, width, height)).clone());
+  }
+
+  RegionFlowComputationOptions options;
+  options.set_image_format(RegionFlowComputationOptions::FORMAT_RGB);
+  options.mutable_tracking_options()->set_num_tracking_tiles(
+      num_tracking_tiles);
+  RegionFlowComputation flow_computation(options, width, height);
+  int frame = 0;
+  for (auto _ : state) {
+    const int curr = frame % kNumFrames;
+    const int prev = (frame + kNumFrames - 1) % kNumFrames;
+    flow_computation.AddImage(movie[curr], 0);
+    delete flow_computation.RetrieveRegionFlowFeatureList(
+        true, frame > 0, &movie[curr], &movie[prev]);
+    ++frame;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RegionFlowComputation)
+    ->Args({640, 480, 1})
+    ->Args({640, 480, 4})
+    ->Args({1280, 720, 1})
+    ->Args({1280, 720, 4})
+    ->Args({1920, 1080, 1})
+    ->Args({1920, 1080, 4})
+    ->Unit(benchmark::kMillisecond);
+
 }  // namespace
 }  // namespace mediapipe
@@ -33,6 +33,7 @@
 #include "mediapipe/util/tracking/flow_packager.pb.h"
 #include "mediapipe/util/tracking/measure_time.h"
 #include "mediapipe/util/tracking/motion_models.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
 
 namespace mediapipe {
 
@@ -1127,6 +1128,61 @@ bool MotionBox::TrackStep(int from_frame,
 
 namespace {
 
+// Invoker for ParallelFor. Needs to be copyable.
+// Tracks boxes[i] by one step, recording its success in tracked[i].
+class TrackStepInvoker {
+ public:
+  TrackStepInvoker(int from_frame, const MotionVectorFrame* motion_vectors,
+                   bool forward, const std::vector<MotionBox*>* boxes,
+                   std::vector<char>* tracked)
+      : from_frame_(from_frame),
+        motion_vectors_(motion_vectors),
+        forward_(forward),
+        boxes_(boxes),
+        tracked_(tracked) {}
+
+  void operator()(const BlockedRange& range) const {
+    for (int i = range.begin(); i != range.end(); ++i) {
+      (*tracked_)[i] =
+          (*boxes_)[i]->TrackStep(from_frame_, *motion_vectors_, forward_);
+    }
+  }
+
+ private:
+  int from_frame_;
+  const MotionVectorFrame* motion_vectors_;
+  bool forward_;
+  const std::vector<MotionBox*>* boxes_;
+  std::vector<char>* tracked_;
+};
+
+}  // namespace.
+
+std::vector<int> TrackStepParallel(int from_frame,
+                                   const MotionVectorFrame& motion_vectors,
+                                   bool forward,
+                                   const std::vector<MotionBox*>& boxes) {
+  // ParallelFor requires at least one iteration.
+  if (boxes.empty()) {
+    return {};
+  }
+  // Not std::vector<bool>, as its elements can not be written concurrently.
+  std::vector<char> tracked(boxes.size(), 0);
+  ParallelFor(0, boxes.size(), 1,
+              TrackStepInvoker(from_frame, &motion_vectors, forward, &boxes,
+                               &tracked));
+
+  std::vector<int> failed_indices;
+  for (int i = 0; i < boxes.size(); ++i) {
+    if (!tracked[i]) {
+      failed_indices.push_back(i);
+    }
+  }
+  return failed_indices;
+}
+
+namespace {
+
 Vector2_f SpatialPriorPosition(const Vector2_f& location,
                                const MotionBoxState& state) {
   const int grid_size = state.spatial_prior_grid_size();
@@ -2898,7 +2954,6 @@ void MotionBox::TrackStepImplDeNormalized(
         [&motion_frame](int id) {
           return !motion_frame.actively_discarded_tracked_ids->contains(id);
         });
-    motion_frame.actively_discarded_tracked_ids->clear();
   }
   const int num_inliers = next_pos->inlier_ids_size();
   // Must be in [0, 1].
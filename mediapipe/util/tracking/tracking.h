@@ -222,7 +222,9 @@ struct MotionVectorFrame {
   float aspect_ratio = 1.0f;
 
   // Stores the tracked ids that have been discarded actively. This information
-  // will be used to avoid misjudgement on tracking continuity.
+  // will be used to avoid misjudgement on tracking continuity. Read-only
+  // during tracking; the owner clears it once all boxes of the frame are
+  // tracked.
   absl::flat_hash_set<int>* actively_discarded_tracked_ids = nullptr;
 };
 
@@ -643,6 +645,17 @@ class MotionBox {
   MotionBoxState initial_state_;
 };
 
+// Tracks each of the boxes by one frame via MotionBox::TrackStep, distributing
+// the boxes over the threads of ParallelFor. All boxes read the same
+// motion_vectors, which are not modified; in particular the
+// actively_discarded_tracked_ids are left for the caller to clear once the
+// frame is tracked. Returns the indices of the boxes that lost track in
+// increasing order, i.e. the results do not depend on the thread schedule.
+std::vector<int> TrackStepParallel(int from_frame,
+                                   const MotionVectorFrame& motion_vectors,
+                                   bool forward,
+                                   const std::vector<MotionBox*>& boxes);
+
 }  // namespace mediapipe.
 
 #endif  // MEDIAPIPE_UTIL_TRACKING_TRACKING_H_